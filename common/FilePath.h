@@ -0,0 +1,9 @@
+#pragma once
+
+#include <filesystem>
+
+namespace Blainn
+{
+// kept apart from aliases.h, tools that build without DirectXTK include only this
+using Path = std::filesystem::path;
+} // namespace Blainn
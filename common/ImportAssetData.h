@@ -22,6 +22,14 @@ struct ImportMeshData
         data.id = uuid::fromStrFactory(node["ID"].as<std::string>());
         data.convertToLH = node["ConvertToLH"].as<bool>();
         data.createMaterials = node["CreateMaterials"].as<bool>();
+        // metas written before the option existed get the default
+        data.optimizeMesh = node["OptimizeMesh"].as<bool>(true);
+        if (const YAML::Node lodErrors = node["LODErrors"]; lodErrors && lodErrors.IsSequence())
+        {
+            data.lodErrors.clear();
+            for (const auto &error : lodErrors)
+                data.lodErrors.push_back(error.as<float>());
+        }
         return data;
     }
 
@@ -29,6 +37,10 @@ struct ImportMeshData
     Path path;
     bool convertToLH;
     bool createMaterials;
+    // reorder triangles and vertices for the GPU caches on import, see MeshOptimizer
+    bool optimizeMesh = true;
+    // simplification error of every generated LOD, relative to the model size. Empty disables LODs
+    eastl::vector<float> lodErrors = {0.005f, 0.02f, 0.06f};
 };
 
 struct ImportTextureData
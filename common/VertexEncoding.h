@@ -0,0 +1,137 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+
+// Packing helpers for the compact vertex format. Plain math without DirectX types so they can be checked on any
+// platform. Decoding counterparts of the snorm/octahedral functions live in GBufferPassVS.hlsl.
+namespace Blainn::VertexEncoding
+{
+/// @brief octahedral encoding of a direction, result is in [-1, 1]. Zero vectors map to +Z.
+inline void OctEncode(float x, float y, float z, float &outU, float &outV)
+{
+    const float l1 = std::fabs(x) + std::fabs(y) + std::fabs(z);
+    if (l1 <= 1e-20f)
+    {
+        outU = 0.0f;
+        outV = 0.0f;
+        return;
+    }
+
+    x /= l1;
+    y /= l1;
+    if (z < 0.0f)
+    {
+        const float foldedX = (1.0f - std::fabs(y)) * (x >= 0.0f ? 1.0f : -1.0f);
+        const float foldedY = (1.0f - std::fabs(x)) * (y >= 0.0f ? 1.0f : -1.0f);
+        x = foldedX;
+        y = foldedY;
+    }
+    outU = x;
+    outV = y;
+}
+
+/// @brief inverse of OctEncode, returns a unit vector
+inline void OctDecode(float u, float v, float &outX, float &outY, float &outZ)
+{
+    float x = u;
+    float y = v;
+    const float z = 1.0f - std::fabs(u) - std::fabs(v);
+    const float t = std::max(-z, 0.0f);
+    x += x >= 0.0f ? -t : t;
+    y += y >= 0.0f ? -t : t;
+
+    const float length = std::sqrt(x * x + y * y + z * z);
+    outX = x / length;
+    outY = y / length;
+    outZ = z / length;
+}
+
+inline int16_t FloatToSnorm16(float value)
+{
+    value = std::clamp(value, -1.0f, 1.0f);
+    return static_cast<int16_t>(std::lround(value * 32767.0f));
+}
+
+/// @brief matches DXGI_FORMAT_*_SNORM conversion rules
+inline float Snorm16ToFloat(int16_t value)
+{
+    return std::max(static_cast<float>(value) / 32767.0f, -1.0f);
+}
+
+/// @brief the bitangent sign is folded into v: [-1, 1] is remapped to [0, 1] for +1 and to [-1, 0) for -1.
+inline float PackSignIntoOct(float v, float sign)
+{
+    const float remapped = (v + 1.0f) * 0.5f;
+    // keep -1 away from 0 after snorm rounding, otherwise it reads back as +1
+    return sign >= 0.0f ? remapped : std::min(-remapped, -1.0f / 32767.0f);
+}
+
+inline void UnpackSignFromOct(float packedV, float &outV, float &outSign)
+{
+    outSign = packedV >= 0.0f ? 1.0f : -1.0f;
+    outV = std::fabs(packedV) * 2.0f - 1.0f;
+}
+
+/// @brief IEEE 754 binary16 with round to nearest even, same as DXGI_FORMAT_*_FLOAT
+inline uint16_t FloatToHalf(float value)
+{
+    uint32_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+
+    const uint32_t sign = (bits >> 16) & 0x8000u;
+    const uint32_t absBits = bits & 0x7FFFFFFFu;
+
+    if (absBits >= 0x7F800000u) // inf or nan
+        return static_cast<uint16_t>(sign | 0x7C00u | (absBits > 0x7F800000u ? 0x200u : 0u));
+    if (absBits >= 0x477FF000u) // rounds to a value above the max half
+        return static_cast<uint16_t>(sign | 0x7C00u);
+
+    if (absBits < 0x38800000u) // subnormal half or zero
+    {
+        if (absBits < 0x33000000u) return static_cast<uint16_t>(sign);
+
+        const uint32_t mantissa = (absBits & 0x007FFFFFu) | 0x00800000u;
+        const uint32_t shift = 126u - (absBits >> 23);
+        uint32_t half = mantissa >> shift;
+        const uint32_t remainder = mantissa & ((1u << shift) - 1u);
+        const uint32_t halfway = 1u << (shift - 1u);
+        if (remainder > halfway || (remainder == halfway && (half & 1u))) ++half;
+        return static_cast<uint16_t>(sign | half);
+    }
+
+    uint32_t half = ((absBits - 0x38000000u) >> 13);
+    const uint32_t remainder = absBits & 0x1FFFu;
+    if (remainder > 0x1000u || (remainder == 0x1000u && (half & 1u))) ++half;
+    return static_cast<uint16_t>(sign | half);
+}
+
+inline float HalfToFloat(uint16_t half)
+{
+    const uint32_t sign = static_cast<uint32_t>(half & 0x8000u) << 16;
+    uint32_t exponent = (half >> 10) & 0x1Fu;
+    uint32_t mantissa = half & 0x3FFu;
+
+    uint32_t bits;
+    if (exponent == 0x1Fu) bits = sign | 0x7F800000u | (mantissa << 13);
+    else if (exponent != 0u) bits = sign | ((exponent + 112u) << 23) | (mantissa << 13);
+    else if (mantissa == 0u) bits = sign;
+    else
+    {
+        // normalize the subnormal half
+        exponent = 113u;
+        while ((mantissa & 0x400u) == 0u)
+        {
+            mantissa <<= 1;
+            --exponent;
+        }
+        bits = sign | (exponent << 23) | ((mantissa & 0x3FFu) << 13);
+    }
+
+    float result;
+    memcpy(&result, &bits, sizeof(result));
+    return result;
+}
+} // namespace Blainn::VertexEncoding
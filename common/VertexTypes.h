@@ -5,6 +5,7 @@
 #pragma once
 
 #include "aliases.h"
+#include "VertexEncoding.h"
 #include <d3d12.h>
 
 using namespace DirectX;
@@ -12,10 +13,12 @@ using namespace DirectX;
 namespace Blainn
 {
     struct VertexPositionNormalTangentBitangentUV;
+    struct VertexPositionPackedNormalTangentUV;
     struct VertexPosition;
     struct VertexPositionColor;
     
     using BlainnVertex = VertexPositionNormalTangentBitangentUV;
+    using BlainnCompactVertex = VertexPositionPackedNormalTangentUV;
     using SimpleVertex = VertexPosition;
     using DebugVertex = VertexPositionColor;
 
@@ -74,6 +77,55 @@ namespace Blainn
         };
     };
 
+    // GPU only layout of BlainnVertex, 24 instead of 56 bytes. Position stays float3 at offset 0 so position only
+    // pipelines (shadows, UUID) can read the same vertex buffer.
+    struct VertexPositionPackedNormalTangentUV
+    {
+        VertexPositionPackedNormalTangentUV(){}
+
+        explicit VertexPositionPackedNormalTangentUV(const VertexPositionNormalTangentBitangentUV &vertex)
+            : position(vertex.position)
+        {
+            using namespace VertexEncoding;
+            float u, v;
+
+            OctEncode(vertex.normal.x, vertex.normal.y, vertex.normal.z, u, v);
+            normal[0] = FloatToSnorm16(u);
+            normal[1] = FloatToSnorm16(v);
+
+            // bitangent is rebuilt in the shader as sign * cross(normal, tangent)
+            const float sign = vertex.normal.Cross(vertex.tangent).Dot(vertex.bitangent) < 0.0f ? -1.0f : 1.0f;
+            OctEncode(vertex.tangent.x, vertex.tangent.y, vertex.tangent.z, u, v);
+            tangent[0] = FloatToSnorm16(u);
+            tangent[1] = FloatToSnorm16(PackSignIntoOct(v, sign));
+
+            texCoord[0] = FloatToHalf(vertex.texCoord.x);
+            texCoord[1] = FloatToHalf(vertex.texCoord.y);
+        }
+
+        Vec3 position = Vec3(0.0f, 0.0f, 0.0f);
+        int16_t normal[2] = {};   // octahedral
+        int16_t tangent[2] = {};  // octahedral, bitangent sign folded into y
+        uint16_t texCoord[2] = {}; // half floats
+
+    private:
+        static constexpr inline UINT InputElementCount = 4u;
+        static constexpr inline const D3D12_INPUT_ELEMENT_DESC InputElements[InputElementCount] =
+        {
+            { "POSITION", 0u, DXGI_FORMAT_R32G32B32_FLOAT, 0u, 0u, D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0u },
+            { "NORMAL", 0u, DXGI_FORMAT_R16G16_SNORM, 0u, 12u, D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0u },
+            { "TANGENT", 0u, DXGI_FORMAT_R16G16_SNORM, 0u, 16u, D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0u },
+            { "TEXCOORD", 0u, DXGI_FORMAT_R16G16_FLOAT, 0u, 20u, D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0u },
+        };
+
+    public:
+        static constexpr inline D3D12_INPUT_LAYOUT_DESC InputLayout =
+        {
+            InputElements,
+            InputElementCount
+        };
+    };
+
     struct VertexPosition
     {
         VertexPosition(){}
@@ -3,8 +3,7 @@
 #include "DirectXTK12/inc/SimpleMath.h"
 #include "entt/entt.hpp"
 #include "tools/UUID.h"
-
-#include <filesystem>
+#include "FilePath.h"
 
 namespace Blainn
 {
@@ -24,7 +23,5 @@ using Ray = DirectX::SimpleMath::Ray;
 using Viewport = DirectX::SimpleMath::Viewport;
 using Color = DirectX::SimpleMath::Color;
 
-using Path = std::filesystem::path;
-
 using ComponentTypeId = entt::id_type;
 } // namespace Blainn
\ No newline at end of file
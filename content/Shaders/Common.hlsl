@@ -1,5 +1,10 @@
 #define MaxCascades 4
 
+// Clustered lighting, should be sync with LightCluster* in FreyaCoreDefines.h
+#define LightClusterCountX 16
+#define LightClusterCountY 9
+#define LightClusterCountZ 24
+
 // Deferred Rendering
 #define GBufferSize 5 // should be sync with GBuffer class
 
@@ -31,17 +36,20 @@ struct CascadesShadows
     float4 Distances;
 };
 
-cbuffer cbPerObject : register(b0)
+struct ObjectData
 {
-    float4x4 gWorld;
-    float4x4 gInvTransposeWorld;
-    float4x4 gTexTransform;
-    uint gMaterialIndex;
-    uint gObjPad0;
-    uint gObjPad1;
-    uint gObjPad2;
+    float4x4 World;
+    float4x4 InvTransposeWorld;
+    float4x4 TexTransform;
+    uint MaterialIndex;
+    uint ObjPad0;
+    uint ObjPad1;
+    uint ObjPad2;
 };
 
+// instances of the current draw, the root descriptor points at the first one so SV_InstanceID indexes it
+StructuredBuffer<ObjectData> gObjectData : register(t3);
+
 cbuffer cbPerPass : register(b1)
 {
     float4x4 gView;
@@ -60,6 +68,10 @@ cbuffer cbPerPass : register(b1)
     
     float4 gAmbient;
     
+    float2 gClusterTileScale;
+    float gClusterDepthScale;
+    float gClusterDepthBias;
+    
     //float4 gFogColor;
     //float gFogStart;
     //float gFogRange;
@@ -70,6 +82,9 @@ cbuffer cbPerPass : register(b1)
 StructuredBuffer<MaterialData> gMaterialData : register(t0);
 StructuredBuffer<PointLightInstanceData> gPointLights : register(t1);
 StructuredBuffer<SpotLightInstanceData> gSpotLights : register(t2);
+// x - offset into gClusterLightIndices, y - point light count, z - spot light count, point lights come first
+StructuredBuffer<uint4> gClusterGrid : register(t4);
+StructuredBuffer<uint> gClusterLightIndices : register(t5);
 
 Texture2DArray gShadowMaps : register(t0, space1);
 Texture2D gGBuffer[GBufferSize] : register(t1, space1); // t1, t2, t3, t4, t5 in space1
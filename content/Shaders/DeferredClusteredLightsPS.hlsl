@@ -0,0 +1,62 @@
+#include "Common.hlsl"
+
+struct PSInput
+{
+    float4 iPosH : SV_POSITION;
+    float2 iTexC : TEXCOORD0;
+};
+
+uint GetClusterIndex(float2 pixel, float viewDepth)
+{
+    uint2 tile = min(uint2(pixel * gClusterTileScale), uint2(LightClusterCountX - 1, LightClusterCountY - 1));
+    float slice = floor(log(viewDepth) * gClusterDepthScale - gClusterDepthBias);
+    uint sliceIndex = (uint) clamp(slice, 0.0f, LightClusterCountZ - 1.0f);
+    return (sliceIndex * LightClusterCountY + tile.y) * LightClusterCountX + tile.x;
+}
+
+float4 main(PSInput input) : SV_TARGET
+{
+    // nothing was drawn here, the sky pass fills it later
+    float depth = gGBuffer[G_DEPTH].Load(int3(input.iPosH.xy, 0)).r;
+    if (depth >= 1.0f)
+        return float4(0.0f, 0.0f, 0.0f, 0.0f);
+
+    GBufferPixelData gBuffer = FetchGBufferData(input.iPosH);
+
+    float4 diffuseAlbedo = gBuffer.diffuse;
+    float4 normalTex = gBuffer.normal;
+    float4 specularTex = gBuffer.specular;
+
+    float3 posW = ComputeWorldPos(float3(input.iPosH.xy, 0.0f));
+
+    float3 fresnelR0 = specularTex.xyz;
+    float shininess = exp2(specularTex.a * 10.5f);
+
+    Material mat = { diffuseAlbedo, fresnelR0, shininess };
+
+    float3 N = normalize(normalTex.xyz);
+    float3 toEye = gEyePos - posW;
+    float3 viewDir = toEye / length(toEye);
+
+    float viewDepth = mul(float4(posW, 1.0f), gView).z;
+    uint4 cluster = gClusterGrid[GetClusterIndex(input.iPosH.xy, viewDepth)];
+
+    float3 litColor = float3(0.0f, 0.0f, 0.0f);
+
+    uint lightIndex = cluster.x;
+    uint pointEnd = cluster.x + cluster.y;
+    for (; lightIndex < pointEnd; ++lightIndex)
+    {
+        PointLightInstanceData instData = gPointLights[gClusterLightIndices[lightIndex]];
+        litColor += ComputePointLight(instData.Light, N, posW, viewDir, mat);
+    }
+
+    uint spotEnd = pointEnd + cluster.z;
+    for (; lightIndex < spotEnd; ++lightIndex)
+    {
+        SpotLightInstanceData instData = gSpotLights[gClusterLightIndices[lightIndex]];
+        litColor += ComputeSpotLight(instData.Light, N, posW, viewDir, mat);
+    }
+
+    return float4(litColor, 1.0f);
+}
@@ -3,6 +3,7 @@
 struct PSInput
 {
     float4 iPosH : SV_POSITION;
+    nointerpolation uint iMaterialIndex : MATERIAL_INDEX;
     float3 iPosW : POSITION0;
     float3 iNormalW : NORMAL;
     float3 iTangentW : TANGENT;
@@ -23,7 +24,7 @@ GBuffer main(PSInput input)
 {
     GBuffer output = (GBuffer) 0;
     
-    MaterialData matData = gMaterialData[gMaterialIndex];
+    MaterialData matData = gMaterialData[input.iMaterialIndex];
     
     // Interpolating normal can unnormalize it, so renormalize it.
     input.iNormalW = normalize(input.iNormalW);
@@ -51,7 +52,11 @@ GBuffer main(PSInput input)
     if (normalTexIndex != INVALID_INDEX)
     {
         float4 normalMapSample = gTextures[normalTexIndex].Sample(gSamplerAnisotropicWrap, input.iTexC);
-        output.Normal.xyz = NormalSampleToWorldSpace(normalMapSample.rgb, input.iNormalW, input.iTangentW);
+        // cooked normal maps are BC5 and store only xy, z is rebuilt from the unit length
+        float2 normalXY = normalMapSample.rg * 2.0f - 1.0f;
+        float normalZ = sqrt(saturate(1.0f - dot(normalXY, normalXY)));
+        output.Normal.xyz = NormalSampleToWorldSpace(float3(normalMapSample.rg, normalZ * 0.5f + 0.5f), input.iNormalW,
+                                                     input.iTangentW);
         output.Normal.a = normalMapSample.a;
     }
     
@@ -1,5 +1,24 @@
 #include "Common.hlsl"
 
+#ifdef COMPACT_VERTEX
+// BlainnCompactVertex, see VertexEncoding.h for the packing side
+struct VSInput
+{
+    float3 iPosL : POSITION0;
+    float2 iNormalOct : NORMAL;
+    float2 iTangentOct : TANGENT; // bitangent sign folded into y
+    float2 iTexC : TEXCOORD0;
+};
+
+float3 OctDecode(float2 e)
+{
+    float3 n = float3(e.x, e.y, 1.0f - abs(e.x) - abs(e.y));
+    float t = max(-n.z, 0.0f);
+    n.x += n.x >= 0.0f ? -t : t;
+    n.y += n.y >= 0.0f ? -t : t;
+    return normalize(n);
+}
+#else
 struct VSInput
 {
     float3 iPosL : POSITION0;
@@ -8,10 +27,12 @@ struct VSInput
     float3 iBitangentU : BITANGENT;
     float2 iTexC : TEXCOORD0;
 };
+#endif
 
 struct VSOutput
 {
     float4 oPosH : SV_POSITION;
+    nointerpolation uint oMaterialIndex : MATERIAL_INDEX;
     float3 oPosW : POSITION0;
     float3 oNormalW : NORMAL;
     float3 oTangentW : TANGENT;
@@ -19,13 +40,15 @@ struct VSOutput
     float2 oTexC : TEXCOORD0;
 };
 
-VSOutput main(VSInput input)
+VSOutput main(VSInput input, uint instanceID : SV_InstanceID)
 {
     VSOutput output = (VSOutput) 0;
     
-    MaterialData matData = gMaterialData[gMaterialIndex];
+    ObjectData objData = gObjectData[instanceID];
+    MaterialData matData = gMaterialData[objData.MaterialIndex];
+    output.oMaterialIndex = objData.MaterialIndex;
     
-    float4 oPosW = mul(float4(input.iPosL, 1.0f), gWorld);
+    float4 oPosW = mul(float4(input.iPosL, 1.0f), objData.World);
     output.oPosH = mul(oPosW, gViewProj);
     output.oPosW = oPosW.xyz;
     
@@ -34,11 +57,22 @@ VSOutput main(VSInput input)
     //texTransform._22 *= gWorld._11;
     //texTransform._33 *= gWorld._11 * gWorld._22;
     
-    output.oNormalW = mul(input.iNormalL, (float3x3) gInvTransposeWorld);
-    output.oTangentW = mul(input.iTangentU, (float3x3) gInvTransposeWorld);
-    output.oBitangentW = mul(input.iBitangentU, (float3x3) gInvTransposeWorld);
+#ifdef COMPACT_VERTEX
+    float bitangentSign = input.iTangentOct.y >= 0.0f ? 1.0f : -1.0f;
+    float3 normalL = OctDecode(input.iNormalOct);
+    float3 tangentL = OctDecode(float2(input.iTangentOct.x, abs(input.iTangentOct.y) * 2.0f - 1.0f));
+    float3 bitangentL = bitangentSign * cross(normalL, tangentL);
+#else
+    float3 normalL = input.iNormalL;
+    float3 tangentL = input.iTangentU;
+    float3 bitangentL = input.iBitangentU;
+#endif
+
+    output.oNormalW = mul(normalL, (float3x3) objData.InvTransposeWorld);
+    output.oTangentW = mul(tangentL, (float3x3) objData.InvTransposeWorld);
+    output.oBitangentW = mul(bitangentL, (float3x3) objData.InvTransposeWorld);
     
-    float4 texCoord = mul(float4(input.iTexC, 0.0f, 1.0f), gTexTransform);
+    float4 texCoord = mul(float4(input.iTexC, 0.0f, 1.0f), objData.TexTransform);
     output.oTexC = mul(texCoord, matData.MatTransform).xy;
     
     return output;
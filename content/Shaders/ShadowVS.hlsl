@@ -10,9 +10,9 @@ struct VSOutput
     float4 oPosH : POSITION0;
 };
 
-VSOutput main(VSInput input)
+VSOutput main(VSInput input, uint instanceID : SV_InstanceID)
 {
     VSOutput output = (VSOutput) 0;
-    output.oPosH = mul(float4(input.iPosL, 1.0f), gWorld);
+    output.oPosH = mul(float4(input.iPosL, 1.0f), gObjectData[instanceID].World);
     return output;
 }
\ No newline at end of file
@@ -23,7 +23,7 @@ VSOutput VSMain(VSInput input)
     output.oPosL = input.iPosL;
 	
 	// Transform to world space.
-    float4 posW = mul(float4(input.iPosL, 1.0f), gWorld);
+    float4 posW = mul(float4(input.iPosL, 1.0f), gObjectData[0].World);
 
 	// Always center sky about camera.
     posW.xyz += gEyePos;
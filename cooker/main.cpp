@@ -0,0 +1,39 @@
+#include "file-system/DerivedDataCache.h"
+#include "file-system/TextureCooker.h"
+#include "subsystems/LogMacros.h"
+
+#include <spdlog/sinks/stdout_color_sinks.h>
+
+#include <filesystem>
+
+// EASTL leaves its allocation entry points to the application, the engine defines them in pch.h
+void *operator new[](size_t size, const char *, int, unsigned, const char *, int)
+{
+    return ::operator new[](size);
+}
+
+void *operator new[](size_t size, size_t, size_t, const char *, int, unsigned, const char *, int)
+{
+    return ::operator new[](size);
+}
+
+// BlainnTextureCook [content directory], Content in the working directory like the engine by default.
+// The cooked textures land in the DerivedDataCache next to it, the engine picks them up from there.
+int main(int argc, char **argv)
+{
+    const Blainn::Path contentDirectory =
+        std::filesystem::absolute(argc > 1 ? Blainn::Path(argv[1]) : std::filesystem::current_path() / "Content");
+
+    auto logger = spdlog::stdout_color_mt(BLAINN_DEFAULT_LOGGER_NAME);
+    logger->set_pattern("%^[%Y-%m-%d %H:%M:%S.%e] %v%$");
+
+    Blainn::DerivedDataCache::SetContentDirectory(contentDirectory);
+    const bool isCooked = Blainn::TextureCooker::CookDirectory(contentDirectory);
+
+    // saves the source hashes the cook computed
+    Blainn::DerivedDataCache::Flush();
+    Blainn::DerivedDataCache::LogStats();
+
+    spdlog::shutdown();
+    return isCooked ? 0 : 1;
+}
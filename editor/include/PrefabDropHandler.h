@@ -5,6 +5,7 @@
 #pragma once
 #include "Log.h"
 #include "MimeFormats.h"
+#include "subsystems/PrefabSubsystem.h"
 
 
 #include <QMimeData>
@@ -19,10 +20,15 @@ inline void HandlePrefabDrop(const QMimeData *data)
 
         auto prefabs = eastl::move(DecodePrefabData(data));
 
+        // parsed once per prefab, dropping it again only copies the template
         for (auto prefab : prefabs)
         {
-            YAML::Node prefabData = YAML::LoadFile(ToString(prefab.absolutePath));
-            Blainn::Engine::GetSceneManager().GetActiveScene()->CreatePrefabEntity(prefabData);
+            const auto *prefabTemplate =
+                Blainn::PrefabSubsystem::GetInstance().GetTemplate(ToString(prefab.relativePath));
+            if (!prefabTemplate) continue;
+
+            eastl::vector<Blainn::Entity> roots;
+            Blainn::Engine::GetSceneManager().GetActiveScene()->CreatePrefabEntities(*prefabTemplate, 1, roots);
         }
     }
 }
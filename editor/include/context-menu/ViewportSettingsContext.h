@@ -30,6 +30,7 @@ protected:
     void EnableVSync(bool value);
     void ShowDebugLines(bool value);
     void RenderDebugUI(bool value);
+    void RenderScriptUI(bool value);
     void ShowFrameTime(bool value);
     void EnableGizmo(bool value);
     void SetGizmoMode(bool value);
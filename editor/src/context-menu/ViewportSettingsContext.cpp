@@ -55,6 +55,10 @@ void ViewportSettingsContext::Initialize()
     renderDebugUIAction->setCheckable(true);
     renderDebugUIAction->setChecked(render.GetUIRenderer().ShouldRenderDebugUI);
 
+    QAction *renderScriptUIAction = m_viewportSettingsMenu->addAction("Render script ui");
+    renderScriptUIAction->setCheckable(true);
+    renderScriptUIAction->setChecked(render.GetUIRenderer().ShouldRenderScriptUI);
+
     QAction *frameTimeAction = m_viewportSettingsMenu->addAction("Show frame time");
     frameTimeAction->setCheckable(true);
     frameTimeAction->setChecked(render.GetUIRenderer().GetDebugUIRenderer().ShouldDrawFrameTime);
@@ -112,6 +116,7 @@ void ViewportSettingsContext::Initialize()
     connect(enablePickingAction, &QAction::toggled, this, &ViewportSettingsContext::EnablePicking);
     connect(debugPhysicsAction, &QAction::toggled, this, &ViewportSettingsContext::ShowDebugLines);
     connect(renderDebugUIAction, &QAction::toggled, this, &ViewportSettingsContext::RenderDebugUI);
+    connect(renderScriptUIAction, &QAction::toggled, this, &ViewportSettingsContext::RenderScriptUI);
     connect(frameTimeAction, &QAction::toggled, this, &ViewportSettingsContext::ShowFrameTime);
     connect(gridAction, &QAction::toggled, this, &ViewportSettingsContext::EnableWorldGrid);
     connect(gizmoAction, &QAction::toggled, this, &ViewportSettingsContext::EnableGizmo);
@@ -148,6 +153,7 @@ void ViewportSettingsContext::SaveValues()
         config["EnablePicking"] = Blainn::Engine::GetSelectionManager().EnablePicking;
         config["DebugLines"] = render.DebugEnabled();
         config["ShouldRenderDebugUI"] = render.GetUIRenderer().ShouldRenderDebugUI;
+        config["ShouldRenderScriptUI"] = render.GetUIRenderer().ShouldRenderScriptUI;
         config["ShouldDrawFrameTime"] = debugUIRenderer.ShouldDrawFrameTime;
         config["ShouldDrawWorldGrid"] = debugUIRenderer.ShouldDrawWorldGrid;
         config["ShouldDrawGizmo"] = debugUIRenderer.ShouldDrawGizmo;
@@ -176,6 +182,8 @@ void ViewportSettingsContext::RestoreValues()
         if (config["DebugLines"]) render.SetEnableDebug(config["DebugLines"].as<bool>());
         if (config["ShouldRenderDebugUI"])
             render.GetUIRenderer().ShouldRenderDebugUI = config["ShouldRenderDebugUI"].as<bool>();
+        if (config["ShouldRenderScriptUI"])
+            render.GetUIRenderer().ShouldRenderScriptUI = config["ShouldRenderScriptUI"].as<bool>();
         if (config["ShouldDrawFrameTime"])
             debugUIRenderer.ShouldDrawFrameTime = config["ShouldDrawFrameTime"].as<bool>();
         if (config["ShouldDrawWorldGrid"])
@@ -227,6 +235,11 @@ void ViewportSettingsContext::RenderDebugUI(bool value)
     Blainn::RenderSubsystem::GetInstance().GetUIRenderer().ShouldRenderDebugUI = value;
 }
 
+void ViewportSettingsContext::RenderScriptUI(bool value)
+{
+    Blainn::RenderSubsystem::GetInstance().GetUIRenderer().ShouldRenderScriptUI = value;
+}
+
 void ViewportSettingsContext::ShowFrameTime(bool value)
 {
     Blainn::RenderSubsystem::GetInstance().GetUIRenderer().GetDebugUIRenderer().ShouldDrawFrameTime = value;
@@ -30,6 +30,7 @@ import_model_dialog::import_model_dialog(const ImportAssetInfo &info, QWidget *p
     ui->Path->setText(info.originalPath);
     ui->ConvertToLH->setChecked(true);
     ui->CreateMaterials->setChecked(true);
+    ui->OptimizeMesh->setChecked(true);
 
     connect(ui->ConfirmButton, &QPushButton::clicked, this, &import_model_dialog::OnConfirm);
     connect(ui->CancelButton, &QPushButton::clicked, this, &import_model_dialog::OnCancel);
@@ -56,6 +57,7 @@ void import_model_dialog::OnConfirm()
     meta["ModelPath"] = ToString(dir.relativeFilePath(m_info.destinationPath));
     meta["ConvertToLH"] = m_importData.convertToLH;
     meta["CreateMaterials"] = m_importData.createMaterials;
+    meta["OptimizeMesh"] = ui->OptimizeMesh->isChecked();
 
     QFileInfo fileInfo(m_info.originalPath);
     Blainn::Path modelPath = Blainn::Path(ToString(m_info.destinationPath));
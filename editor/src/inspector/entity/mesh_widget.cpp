@@ -56,7 +56,7 @@ void mesh_widget::UpdatePath()
 
     const QString path =
         QString::fromStdString(Blainn::AssetManager::GetInstance()
-                                   .GetMeshPath(*m_entity.GetComponent<Blainn::MeshComponent>().MeshHandle)
+                                   .GetMeshPath(m_entity.GetComponent<Blainn::MeshComponent>().MeshHandle)
                                    .string());
     m_path_input->SetPath(path);
 }
@@ -68,7 +68,7 @@ void mesh_widget::UpdateMaterial()
 
     const QString path =
         QString::fromStdString(Blainn::AssetManager::GetInstance()
-                                   .GetMaterialPath(*m_entity.GetComponent<Blainn::MeshComponent>().MaterialHandle)
+                                   .GetMaterialPath(m_entity.GetComponent<Blainn::MeshComponent>().MaterialHandle)
                                    .string());
 
     m_material_input->SetPath(path);
@@ -31,7 +31,7 @@ void skybox_widget::UpdatePath()
 
     const QString path =
         QString::fromStdString(Blainn::AssetManager::GetInstance()
-                                   .GetTexturePath(*m_entity.GetComponent<Blainn::SkyboxComponent>().textureHandle)
+                                   .GetTexturePath(m_entity.GetComponent<Blainn::SkyboxComponent>().textureHandle)
                                    .string());
     m_texture_input->SetPath(path);
 }
@@ -11,6 +11,7 @@
 
 #include "SelectionManager.h"
 #include "scene/SceneManager.h"
+#include "scene/SceneSnapshot.h"
 
 namespace vgjs
 {
@@ -24,6 +25,10 @@ class Engine
 public:
     Engine() = delete;
     static void Init(Timeline<eastl::chrono::milliseconds> &globalTimeline);
+    /// @brief offline cook for a command line flag, called instead of Init. Brings up only the log and an
+    /// AssetLoader: no device, job system, physics or scene. False for an unknown flag. Textures are cooked by
+    /// the standalone BlainnTextureCook tool
+    static bool Cook(const eastl::string &command);
     static void InitRenderSubsystem(HWND windowHandle);
     static void InitAISubsystems();
     static void Destroy();
@@ -61,6 +66,11 @@ public:
     }
 
 private:
+    // puts the open scenes back as they were when play mode started, false if other scenes were opened since
+    static bool RestorePlayModeSnapshots();
+    // reopens the start scene from its snapshot with unsaved edits, used when scripts switched scenes during play
+    static void RebuildStartScene();
+
     static inline SelectionManager s_selectionManager = SelectionManager();
     static inline eastl::function<void(float)> s_renderFunc = nullptr;
     static inline eastl::shared_ptr<vgjs::JobSystem> s_JobSystemPtr = nullptr;
@@ -72,6 +82,8 @@ private:
     static inline bool s_playModePaused = false;
     static inline float s_deltaTime = 0.0f;
     static inline eastl::string s_startPlayModeSceneName;
+    static inline uuid s_startPlayModeSceneId;
+    static inline eastl::hash_map<uuid, SceneSnapshot> s_playModeSnapshots;
     static inline EngineConfig s_config;
 };
 } // namespace Blainn
\ No newline at end of file
@@ -24,6 +24,8 @@ namespace Blainn
 
         // Execute a command list.
         void ExecuteCommandList(ComPtr<ID3D12GraphicsCommandList2> cmdList);
+        // Execute closed command lists that are not owned by the queue, in one submission.
+        void ExecuteCommandLists(ID3D12CommandList *const *ppCommandLists, UINT count);
 
         UINT64 Signal();
         bool IsFenceComplete(UINT64 fenceValue);
@@ -35,6 +35,8 @@ namespace Blainn
         
         eastl::shared_ptr<SwapChain> CreateSwapChain(HWND window, DXGI_FORMAT backBufferFormat = DXGI_FORMAT_R10G10B10A2_UNORM);
         HRESULT CreateCommandAllocator(D3D12_COMMAND_LIST_TYPE commandListType, ComPtr<ID3D12CommandAllocator>&  commandAllocator);
+        // Created list is closed, reset it before recording.
+        HRESULT CreateCommandList(D3D12_COMMAND_LIST_TYPE commandListType, ID3D12CommandAllocator *pCommandAllocator, ComPtr<ID3D12GraphicsCommandList2>& commandList);
         
         HRESULT CreateDescriptorHeap(D3D12_DESCRIPTOR_HEAP_TYPE heapType, UINT numDescriptors,
                                      D3D12_DESCRIPTOR_HEAP_FLAGS flags = D3D12_DESCRIPTOR_HEAP_FLAG_NONE,
@@ -0,0 +1,84 @@
+#pragma once
+
+#include <EASTL/vector.h>
+#include <cstddef>
+#include <cstdint>
+
+namespace Blainn
+{
+/// @brief 64 bit draw sort key, fields from the most significant bits: pass, pipeline, material, mesh, depth.
+/// Sorting by it groups draws by state, items equal in everything but depth can be one instanced draw.
+struct DrawSortKey
+{
+    static constexpr uint32_t PassBits = 4u;
+    static constexpr uint32_t PipelineBits = 6u;
+    // as wide as Handle::kIndexBits, material handles are stored by index
+    static constexpr uint32_t MaterialBits = 20u;
+    static constexpr uint32_t MeshBits = 20u;
+    // 16k front to back buckets, enough for early z
+    static constexpr uint32_t DepthBits = 14u;
+    static_assert(PassBits + PipelineBits + MaterialBits + MeshBits + DepthBits == 64u);
+
+    /// @brief fields are masked to their width
+    static uint64_t Make(uint32_t pass, uint32_t pipeline, uint32_t material, uint32_t mesh, uint32_t depth);
+
+    /// @brief maps [0, farZ] to the depth field, front to back
+    static uint32_t QuantizeDepth(float viewDepth, float farZ);
+
+    /// @brief key without the depth field
+    static uint64_t GetBatchKey(uint64_t key)
+    {
+        return key >> DepthBits;
+    }
+    static uint32_t GetPipeline(uint64_t key)
+    {
+        return static_cast<uint32_t>(key >> (DepthBits + MeshBits + MaterialBits)) & ((1u << PipelineBits) - 1u);
+    }
+    static uint32_t GetMesh(uint64_t key)
+    {
+        return static_cast<uint32_t>(key >> DepthBits) & ((1u << MeshBits) - 1u);
+    }
+};
+
+/// @brief Sorts draw items by key and groups runs of equal state into instanced batches.
+/// Pure CPU, items reference caller data by index.
+class DrawList
+{
+public:
+    struct Item
+    {
+        uint64_t Key;
+        uint32_t Index;
+    };
+
+    /// @brief items [FirstItem, FirstItem + ItemCount) share the batch key
+    struct Batch
+    {
+        uint32_t FirstItem;
+        uint32_t ItemCount;
+    };
+
+    void Clear();
+    void Reserve(size_t count);
+    void Add(uint64_t key, uint32_t index);
+
+    /// @brief stable LSD radix sort over the key bytes, bytes equal in every item are skipped
+    void Sort();
+    /// @brief splits sorted items into runs of equal batch key of at most maxInstances items
+    void BuildBatches(uint32_t maxInstances = UINT32_MAX);
+
+    const eastl::vector<Item> &GetItems() const
+    {
+        return m_items;
+    }
+    const eastl::vector<Batch> &GetBatches() const
+    {
+        return m_batches;
+    }
+
+private:
+    eastl::vector<Item> m_items;
+    eastl::vector<Item> m_sortScratch;
+    eastl::vector<Batch> m_batches;
+};
+} // namespace Blainn
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "UploadBuffer.h"
+#include "LinearUploadBuffer.h"
 
 namespace Blainn
 {
@@ -8,18 +9,22 @@ namespace Blainn
 
     struct FrameResource
     {
-        FrameResource(Device& device, UINT passCount, UINT materialCount, UINT maxNumPointLights, UINT maxNumSpotLights);
+        FrameResource(Device& device, UINT passCount, UINT materialCount, UINT maxNumPointLights, UINT maxNumSpotLights, UINT64 uploadBufferSize, UINT commandListCount);
         FrameResource(const FrameResource &lhs) = delete;
         FrameResource &operator=(const FrameResource &lhs) = delete;
 
         ~FrameResource() noexcept;
         
-        ComPtr<ID3D12CommandAllocator> commandAllocator;
+        // One allocator per command list, so lists of a frame can be recorded on different threads.
+        eastl::vector<ComPtr<ID3D12CommandAllocator>> CommandAllocators;
+        eastl::vector<ComPtr<ID3D12GraphicsCommandList2>> CommandLists;
         
         eastl::unique_ptr<UploadBuffer<PassConstants>> PassCB = nullptr;
         eastl::unique_ptr<UploadBuffer<MaterialData>> MaterialSB = nullptr;
         eastl::unique_ptr<UploadBuffer<PointLightInstanceData>> PointLightSB = nullptr;
         eastl::unique_ptr<UploadBuffer<SpotLightInstanceData>> SpotLightSB = nullptr;
+        // Per draw data written every frame (object constants etc.), reset when the frame resource is reused.
+        eastl::unique_ptr<LinearUploadBuffer> FrameUploadBuffer = nullptr;
         
         // Fence value to mark commands up to this fence point. This lets us check if these frame resources are still in use by the GPU.
         UINT64 Fence = 0;
@@ -45,6 +45,22 @@
  */
 #define MaxPointLights 1024
 #define MaxSpotLights 1024
+// froxel grid for light culling, tiles across the screen and exponential depth slices. Sync with Common.hlsl
+#define LightClusterCountX 16u
+#define LightClusterCountY 9u
+#define LightClusterCountZ 24u
+// upload models as BlainnCompactVertex instead of BlainnVertex
+#define UseCompactVertexFormat 1
+// per frame resource, holds instance data of all draws: ObjectConstants per visible mesh and pass
+#define FrameUploadBufferSize (8u * 1024u * 1024u)
+// draw lists of a pass are split into at most this many command lists recorded in parallel
+#define MaxRecordingJobsPerPass 4u
+// smaller chunks of a draw list are not worth a command list of their own
+#define MinBatchesPerRecordingJob 64u
+// shadow and geometry pass jobs plus one list for the remaining passes, recorded on the main thread
+#define FrameCommandListCount (2u * MaxRecordingJobsPerPass + 1u)
+// coarsest mesh LOD whose simplification error projects to at most this many pixels is drawn
+#define LODErrorThresholdPixels 1.0f
 
 /*
  * Textures
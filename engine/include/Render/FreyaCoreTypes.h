@@ -115,6 +115,11 @@ namespace Blainn
 
 		XMFLOAT4 Ambient = { 0.0f, 0.0f, 0.0f, 1.0f };
 
+		// clusters per pixel and slice = log(viewZ) * ClusterDepthScale - ClusterDepthBias, see LightClusterGrid
+		XMFLOAT2 ClusterTileScale = { 0.0f, 0.0f };
+		float ClusterDepthScale = 0.0f;
+		float ClusterDepthBias = 0.0f;
+
 		/*XMFLOAT4 FogColor = { 0.7f, 0.7f, 0.7f, 1.0f };
 		float FogStart = 8.0f;
 		float FogRange = 18.0f;*/
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <EASTL/vector.h>
+#include <cstddef>
+#include <cstdint>
+
+namespace Blainn
+{
+/// @brief six planes (a, b, c, d) of a view volume, a point p is inside when a*p.x + b*p.y + c*p.z + d >= 0 for all.
+struct FrustumPlanes
+{
+    float Planes[6][4] = {};
+
+    /// @brief extracts normalized planes from a row vector view projection matrix (DirectXMath layout),
+    /// clip space z in [0, w] as in D3D. Works for perspective and orthographic projections.
+    static FrustumPlanes FromViewProjection(const float (&m)[4][4]);
+
+    /// @brief stops rejecting what lies before the near plane, for shadow casters that are clamped onto it
+    /// with depth clip disabled
+    void DisableNearPlane();
+};
+
+/// @brief Bounding spheres in structure of arrays layout, tested four at a time with SSE.
+/// Knows nothing about the scene, indices of the visible spheres are returned in insertion order.
+class FrustumCuller
+{
+public:
+    void Clear();
+    void Reserve(size_t count);
+    /// @brief returns index of the sphere
+    uint32_t AddSphere(float centerX, float centerY, float centerZ, float radius);
+    size_t GetCount() const
+    {
+        return m_count;
+    }
+
+    /// @brief appends indices of the spheres intersecting the frustum to outVisible
+    void Cull(const FrustumPlanes &frustum, eastl::vector<uint32_t> &outVisible) const;
+    /// @brief appends indices of the spheres intersecting any of the frustums, for views drawn in one pass
+    void CullAny(const FrustumPlanes *frustums, size_t frustumCount, eastl::vector<uint32_t> &outVisible) const;
+
+private:
+    // padded to a multiple of four with spheres that are outside of every frustum
+    eastl::vector<float> m_centerX;
+    eastl::vector<float> m_centerY;
+    eastl::vector<float> m_centerZ;
+    eastl::vector<float> m_radius;
+    size_t m_count = 0u;
+};
+} // namespace Blainn
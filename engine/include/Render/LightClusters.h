@@ -0,0 +1,89 @@
+#pragma once
+
+#include <EASTL/vector.h>
+#include <cstdint>
+
+namespace Blainn
+{
+/// @brief view space sphere bounding the influence of a light (x right, y up, z forward)
+struct LightBounds
+{
+    float X;
+    float Y;
+    float Z;
+    float Radius;
+};
+
+/// @brief froxel grid over the view frustum: uniform tiles in screen space, exponential slices in depth
+struct LightClusterGridDesc
+{
+    uint32_t CountX = 16u;
+    uint32_t CountY = 9u;
+    uint32_t CountZ = 24u;
+    // _11 and _22 of the projection matrix, x_ndc = x * ProjScaleX / z
+    float ProjScaleX = 1.0f;
+    float ProjScaleY = 1.0f;
+    float NearZ = 0.1f;
+    float FarZ = 1000.0f;
+};
+
+/// @brief lights of a cluster are LightIndices[Offset, Offset + PointCount + SpotCount), point lights first.
+/// Matches uint4 of gClusterGrid in shaders.
+struct LightCluster
+{
+    uint32_t Offset;
+    uint32_t PointCount;
+    uint32_t SpotCount;
+    uint32_t Pad;
+};
+
+/// @brief Assigns lights to the clusters their bounding sphere touches. Knows nothing about D3D,
+/// the result depends only on the input, lights of a cluster are listed in input order.
+class LightClusterGrid
+{
+public:
+    /// @brief clusters are stored slice by slice, rows top to bottom, see GetClusterIndex
+    void Build(const LightClusterGridDesc &desc, const LightBounds *pointLights, uint32_t pointCount,
+               const LightBounds *spotLights, uint32_t spotCount);
+
+    const LightClusterGridDesc &GetDesc() const
+    {
+        return m_desc;
+    }
+    const eastl::vector<LightCluster> &GetClusters() const
+    {
+        return m_clusters;
+    }
+    const eastl::vector<uint32_t> &GetLightIndices() const
+    {
+        return m_lightIndices;
+    }
+    /// @brief lights that touch at least one cluster of the last Build
+    uint32_t GetVisibleLightCount() const
+    {
+        return m_visibleLightCount;
+    }
+
+    uint32_t GetClusterIndex(uint32_t x, uint32_t y, uint32_t slice) const
+    {
+        return (slice * m_desc.CountY + y) * m_desc.CountX + x;
+    }
+    /// @brief slice = log(viewZ) * scale - bias, how shaders find the slice of a pixel
+    float GetDepthSliceScale() const;
+    float GetDepthSliceBias() const;
+
+private:
+    void BinLight(const LightBounds &light, uint32_t lightIndex);
+    uint32_t GetSlice(float viewZ) const;
+
+    LightClusterGridDesc m_desc;
+    // view depth of the slice boundaries, CountZ + 1 entries
+    eastl::vector<float> m_sliceDepths;
+
+    eastl::vector<LightCluster> m_clusters;
+    eastl::vector<uint32_t> m_lightIndices;
+    // (cluster << 32) | light index in binning order, spot lights have kSpotLightBit set
+    eastl::vector<uint64_t> m_entries;
+    uint32_t m_visibleLightCount = 0u;
+};
+} // namespace Blainn
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+
+namespace Blainn
+{
+/// @brief Bump allocator over a caller provided memory range.
+/// Knows nothing about D3D12, the range can be a mapped upload heap or plain CPU memory.
+class LinearAllocator
+{
+public:
+    struct Allocation
+    {
+        uint8_t *CpuAddress = nullptr;
+        uint64_t GpuAddress = 0u;
+        uint64_t Offset = 0u;
+
+        bool IsValid() const
+        {
+            return CpuAddress != nullptr;
+        }
+    };
+
+    LinearAllocator() = default;
+    /// @param gpuBase address the range is visible at on the GPU, may be 0 for CPU only ranges.
+    LinearAllocator(uint8_t *cpuBase, uint64_t gpuBase, uint64_t capacity);
+
+    /// @brief returns invalid allocation when the range is exhausted. alignment must be a power of two.
+    Allocation Allocate(uint64_t byteSize, uint64_t alignment);
+
+    template <typename T> Allocation Push(const T &data, uint64_t alignment = alignof(T))
+    {
+        Allocation allocation = Allocate(sizeof(T), alignment);
+        if (allocation.IsValid()) memcpy(allocation.CpuAddress, &data, sizeof(T));
+        return allocation;
+    }
+
+    /// @brief releases all allocations, memory must not be in use anymore.
+    void Reset();
+
+    uint64_t GetCapacity() const
+    {
+        return m_capacity;
+    }
+    uint64_t GetUsedBytes() const
+    {
+        return m_offset;
+    }
+    /// @brief highest usage since construction, used to size the range.
+    uint64_t GetPeakUsedBytes() const
+    {
+        return m_peakOffset;
+    }
+
+private:
+    uint8_t *m_cpuBase = nullptr;
+    uint64_t m_gpuBase = 0u;
+    uint64_t m_capacity = 0u;
+    uint64_t m_offset = 0u;
+    uint64_t m_peakOffset = 0u;
+};
+} // namespace Blainn
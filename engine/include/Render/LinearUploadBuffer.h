@@ -0,0 +1,55 @@
+#pragma once
+
+#include "Render/FreyaUtil.h"
+#include "Render/LinearAllocator.h"
+
+namespace Blainn
+{
+/// @brief Persistently mapped upload heap sub-allocated linearly, one per frame resource.
+/// Reset once the GPU is done with the owning frame, allocations live until then.
+class LinearUploadBuffer
+{
+public:
+    LinearUploadBuffer(ID3D12Device2 *device, uint64_t byteSize);
+    LinearUploadBuffer(const LinearUploadBuffer &rhs) = delete;
+    LinearUploadBuffer &operator=(const LinearUploadBuffer &rhs) = delete;
+    ~LinearUploadBuffer();
+
+    bool IsValid() const
+    {
+        return m_isValid;
+    }
+
+    ID3D12Resource *Get() const
+    {
+        return m_uploadBuffer.Get();
+    }
+
+    /// @brief copies data with constant buffer alignment, returns 0 when out of space.
+    template <typename T> D3D12_GPU_VIRTUAL_ADDRESS PushConstants(const T &data)
+    {
+        return Push(&data, sizeof(T), D3D12_CONSTANT_BUFFER_DATA_PLACEMENT_ALIGNMENT);
+    }
+
+    /// @brief copies count elements for use as a structured buffer, returns 0 when out of space.
+    template <typename T> D3D12_GPU_VIRTUAL_ADDRESS PushStructured(const T *data, uint32_t count)
+    {
+        return Push(data, sizeof(T) * count, 16u);
+    }
+
+    void Reset();
+
+    const LinearAllocator &GetAllocator() const
+    {
+        return m_allocator;
+    }
+
+private:
+    D3D12_GPU_VIRTUAL_ADDRESS Push(const void *data, uint64_t byteSize, uint64_t alignment);
+
+    ComPtr<ID3D12Resource> m_uploadBuffer;
+    LinearAllocator m_allocator;
+    bool m_isValid = false;
+    bool m_hasReportedOverflow = false;
+};
+} // namespace Blainn
@@ -22,13 +22,7 @@ namespace Blainn
 
             DeferredDirectional,
             
-            DeferredPointWithinFrustum,
-            DeferredPointIntersectsFarPlane,
-            DeferredPointFullQuad,
-            
-            DeferredSpotWithinFrustum,
-            DeferredSpotIntersectsFarPlane,
-            DeferredSpotFullQuad,
+            DeferredClusteredLights,
 
 
             Transparency,
@@ -11,17 +11,19 @@ namespace Blainn
     public:
         enum ERootParam : UINT
         {
-            PerObjectDataCB = 0,
+            PerObjectDataSB = 0,
             PerPassDataCB,
             MaterialsDataSB,
             PointLightsDataSB,
             SpotLightsDataSB,
+            ClusterGridSB,
+            ClusterLightIndicesSB,
             CascadedShadowMaps,
             GBufferTextures,
             SkyBox,
             Textures,
 
-            NumRootParameters = 9u
+            NumRootParameters = 11u
         };
 
     public:
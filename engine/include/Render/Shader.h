@@ -23,11 +23,7 @@ namespace Blainn
             DeferredDirVS,
             DeferredDirPS,
 
-            DeferredPointVS,
-            DeferredPointPS,
-            
-            DeferredSpotVS,
-            DeferredSpotPS,
+            DeferredClusteredLightsPS,
 
             SkyBoxVS,
             SkyBoxPS,
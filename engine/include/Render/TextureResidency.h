@@ -0,0 +1,86 @@
+#pragma once
+
+#include <EASTL/vector.h>
+#include <cstdint>
+
+namespace Blainn
+{
+/// @brief Decides which mip levels of streamed textures stay in VRAM. Knows nothing about D3D, textures are
+/// ids with the byte size of every mip level.
+///
+/// Residency of a texture is its most detailed resident mip, all coarser levels are resident too. Levels from
+/// the tail mip down are always resident so something can be drawn. Each finer level is a step with a priority:
+/// steps visible textures need come first, the ones farthest from the needed mip before the ones close to it,
+/// so coarse levels everywhere win over fine levels anywhere. Levels nobody needs this frame are kept behind
+/// them, most recently needed first. Steps are taken in priority order while they fit the budget, the rest
+/// is evicted. A texture holding finer levels than it needs is looked at as if its surface were half again as
+/// large, so a surface hovering at a mip boundary does not stream the same level in and out every frame.
+class TextureResidency
+{
+public:
+    /// @brief mipSizes has a byte size for every level, level 0 being the most detailed one
+    void AddTexture(uint32_t id, uint32_t width, uint32_t height, const uint64_t *mipSizes, uint32_t mipCount,
+                    uint32_t tailMip, uint32_t residentMip);
+    void RemoveTexture(uint32_t id);
+    bool HasTexture(uint32_t id) const;
+    /// @brief call when an upload of another mip range has finished
+    void SetResidentMip(uint32_t id, uint32_t mip);
+
+    /// @brief a surface of screenSize pixels samples the texture this frame, the largest request wins.
+    /// Unknown ids are ignored.
+    void Request(uint32_t id, float screenSize);
+
+    /// @brief picks the target mip of every texture for budget bytes and clears the requests of the frame
+    void Solve(uint64_t budget);
+
+    uint32_t GetTargetMip(uint32_t id) const;
+    uint32_t GetResidentMip(uint32_t id) const;
+    /// @brief textures whose target differs from their resident mip after the last Solve
+    const eastl::vector<uint32_t> &GetChangedTextures() const
+    {
+        return m_changedTextures;
+    }
+    /// @brief bytes of the targets of the last Solve, tails included
+    uint64_t GetTargetBytes() const
+    {
+        return m_targetBytes;
+    }
+    /// @brief bytes of the tails alone, more than the budget means everything stays at the tail
+    uint64_t GetTailBytes() const
+    {
+        return m_tailBytes;
+    }
+
+    /// @brief coarsest level that still has a texel per pixel of a surface of screenSize pixels
+    static uint32_t GetNeededMip(uint32_t width, uint32_t height, uint32_t tailMip, float screenSize);
+
+private:
+    struct Entry
+    {
+        eastl::vector<uint64_t> MipSizes;
+        uint32_t Width = 0u;
+        uint32_t Height = 0u;
+        uint32_t TailMip = 0u;
+        uint32_t ResidentMip = 0u;
+        uint32_t TargetMip = 0u;
+        float RequestedSize = 0.0f;
+        // Solve call of the last request, older ones are evicted first
+        uint32_t LastRequestFrame = 0u;
+        bool bIsUsed = false;
+    };
+
+    struct Step
+    {
+        uint64_t Priority;
+        uint32_t Id;
+        uint32_t Mip;
+    };
+
+    eastl::vector<Entry> m_entries;
+    eastl::vector<Step> m_steps;
+    eastl::vector<uint32_t> m_changedTextures;
+    uint64_t m_targetBytes = 0u;
+    uint64_t m_tailBytes = 0u;
+    uint32_t m_frame = 0u;
+};
+} // namespace Blainn
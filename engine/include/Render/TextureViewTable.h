@@ -0,0 +1,42 @@
+#pragma once
+
+#include "Render/FreyaUtil.h"
+
+#include <EASTL/vector.h>
+
+namespace Blainn
+{
+/// @brief Bindless texture views, one table per frame resource in the shader visible heap.
+/// Views are written to a CPU only heap and copied into the table of a frame when the frame starts, so replacing a
+/// view never touches a table the GPU may still be reading.
+class TextureViewTable
+{
+public:
+    TextureViewTable() = default;
+    TextureViewTable(const TextureViewTable &rhs) = delete;
+    TextureViewTable &operator=(const TextureViewTable &rhs) = delete;
+
+    /// @brief tables are placed back to back in shaderVisibleHeap from firstDescriptor on
+    void Init(ID3D12Device2 *device, ID3D12DescriptorHeap *shaderVisibleHeap, UINT firstDescriptor, UINT viewCount,
+              UINT tableCount);
+
+    /// @brief handle to write the view of slot to, every table picks it up the next time its frame starts
+    D3D12_CPU_DESCRIPTOR_HANDLE GetWriteHandle(UINT slot);
+    /// @brief copies the views written since the table was last used, the GPU must be done with the table
+    void CopyChangedViews(UINT table);
+
+    D3D12_GPU_DESCRIPTOR_HANDLE GetTable(UINT table) const;
+
+private:
+    ComPtr<ID3D12Device2> m_device;
+    ComPtr<ID3D12DescriptorHeap> m_stagingHeap;
+    ComPtr<ID3D12DescriptorHeap> m_shaderVisibleHeap;
+
+    UINT m_firstDescriptor = 0u;
+    UINT m_viewCount = 0u;
+    UINT m_descriptorSize = 0u;
+
+    // per table, slots written since the table was last copied
+    eastl::vector<eastl::vector<bool>> m_changedSlots;
+};
+} // namespace Blainn
@@ -33,6 +33,9 @@ public:
 
 public:
     bool ShouldRenderDebugUI = true;
+    // OnDrawUI of the scripts, they are not run at all while off. Toggled from the editor viewport settings,
+    // the game keeps it on as script UI is its HUD
+    bool ShouldRenderScriptUI = true;
 
 private:
 
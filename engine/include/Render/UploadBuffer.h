@@ -68,6 +68,23 @@ namespace Blainn{
             memcpy(&m_mappedData[elementIndex * m_elementByteSize], &data, sizeof(T));
         }
 
+        // Copies count consecutive elements starting at firstElementIndex.
+        void CopyData(int firstElementIndex, const T* data, uint32_t count)
+        {
+            if (!m_isValid)
+            {
+                BF_ERROR("Trying to write to an invalid buffer. ");
+                return;
+            }
+            if (m_isConstantBuffer)
+            {
+                for (uint32_t i = 0; i < count; ++i)
+                    memcpy(&m_mappedData[(firstElementIndex + i) * m_elementByteSize], &data[i], sizeof(T));
+                return;
+            }
+            memcpy(&m_mappedData[firstElementIndex * m_elementByteSize], data, sizeof(T) * count);
+        }
+
     private:
         ComPtr<ID3D12Resource> m_uploadBuffer; // either constant or vertex/index buffer
         BYTE* m_mappedData = nullptr;
@@ -3,16 +3,16 @@
 #include "Handles/Handle.h"
 #include "Render/Device.h"
 #include "Render/FreyaCoreTypes.h"
-#include "Render/UploadBuffer.h"
 
 namespace Blainn
 {
+class Model;
+
 struct MeshComponent
 {
-    MeshComponent();
+    MeshComponent() = default;
 
-    MeshComponent(const eastl::shared_ptr<MeshHandle> &meshHandle,
-                  const eastl::shared_ptr<MaterialHandle> &material = nullptr)
+    MeshComponent(const Blainn::MeshHandle &meshHandle, const Blainn::MaterialHandle &material = {})
         : MeshComponent()
     {
         MeshHandle = meshHandle;
@@ -21,33 +21,25 @@ struct MeshComponent
         else MaterialHandle = AssetManager::GetInstance().GetDefaultMaterialHandle();
     }
 
-    MeshComponent(eastl::shared_ptr<MeshHandle> &&meshHandle, eastl::shared_ptr<MaterialHandle> &&material)
+    MeshComponent(Blainn::MeshHandle &&meshHandle, Blainn::MaterialHandle &&material)
         : MeshComponent()
     {
         MeshHandle = eastl::move(meshHandle);
         MaterialHandle = eastl::move(material);
     }
 
-    MeshComponent(const MeshComponent &other)
-        : MeshHandle(other.MeshHandle)
-        , MaterialHandle(other.MaterialHandle)
-        , PerObjectCBData(other.PerObjectCBData)
-        , IsWalkable(other.IsWalkable)
-        , Enabled(other.Enabled)
-    {
-        auto &device = Device::GetInstance();
-        ObjectCB = eastl::make_unique<UploadBuffer<ObjectConstants>>(device.GetDevice2().Get(),
-                                                                     1u /*amount of meshes in model*/, TRUE);
-    }
-
-    void UpdateMeshCB(ObjectConstants &objectCBData);
-
-    eastl::shared_ptr<MeshHandle> MeshHandle;
-    eastl::shared_ptr<MaterialHandle> MaterialHandle;
-
-    eastl::unique_ptr<UploadBuffer<ObjectConstants>> ObjectCB = nullptr;
+    Blainn::MeshHandle MeshHandle;
+    Blainn::MaterialHandle MaterialHandle;
 
+    // instance data, copied into the instance buffer of every draw the mesh is part of
     ObjectConstants PerObjectCBData;
+    // level of detail picked for the main camera in the current frame, used by every pass
+    uint32_t LOD = 0u;
+
+    // world space bounds, refreshed together with the world matrix or when the model behind the handle changes
+    DirectX::BoundingBox WorldBoundingBox;
+    DirectX::BoundingSphere WorldBoundingSphere;
+    const Model *BoundsModel = nullptr;
 
     bool Enabled = true;
     // TODO: use layers in future
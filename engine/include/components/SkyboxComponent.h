@@ -9,14 +9,14 @@ struct SkyboxComponent
 {
     SkyboxComponent()
     {
-        textureHandle = eastl::make_shared<TextureHandle>(0);
+        textureHandle = AssetManager::GetDefaultTextureHandle();
     }
 
-    SkyboxComponent(eastl::shared_ptr<TextureHandle>& handle)
+    SkyboxComponent(const TextureHandle &handle)
     : textureHandle(handle)
     {
     }
 
-    eastl::shared_ptr<TextureHandle> textureHandle;
+    TextureHandle textureHandle;
 };
 } // namespace Blainn
\ No newline at end of file
@@ -0,0 +1,96 @@
+#pragma once
+
+#include "FilePath.h"
+
+#include <EASTL/functional.h>
+#include <EASTL/hash_map.h>
+#include <EASTL/string.h>
+#include <EASTL/vector.h>
+
+#include <fstream>
+#include <mutex>
+
+namespace Blainn
+{
+/// @brief Local store of data derived from sources: cooked meshes and textures, decoded mip chains, baked
+/// navmeshes. Entries are addressed by the hash of the source bytes, the settings and the processor version, so
+/// an entry is reused after a branch switch or a reimport that changed nothing and is never stale.
+///
+/// Lives in DerivedDataCache next to the content directory. Safe to call from job system workers. Needs nothing
+/// from the engine, the texture cook tool builds it on its own.
+class DerivedDataCache
+{
+public:
+    static constexpr uint64_t kHashSeed = 14695981039346656037ull;
+
+    struct Key
+    {
+        // subdirectory of the entry, statistics are kept per processor
+        eastl::string Processor;
+        uint64_t Hash = 0u;
+    };
+
+    /// @brief FNV-1a, chain calls by passing the previous result as seed
+    static uint64_t HashBytes(const void *bytes, size_t size, uint64_t seed = kHashSeed);
+
+    /// @brief key of data derived from a source file. Its bytes are hashed once per write time and size,
+    /// false if the source can't be read
+    static bool MakeKey(const Path &absoluteSourcePath, const char *processor, uint32_t processorVersion,
+                        uint64_t settingsHash, Key &outKey);
+    /// @brief key of data derived from bytes in memory
+    static Key MakeKey(const void *sourceBytes, size_t size, const char *processor, uint32_t processorVersion,
+                       uint64_t settingsHash);
+
+    /// @brief the engine passes its content directory on whenever it changes, tools once before any lookup
+    static void SetContentDirectory(const Path &contentDirectory);
+    static Path GetCacheDirectory();
+    static Path GetDataPath(const Key &key);
+
+    /// @brief true if the entry exists, counts a hit or a miss
+    static bool Find(const Key &key);
+    /// @brief Find and read the whole entry
+    static bool Read(const Key &key, eastl::vector<uint8_t> &outData);
+    /// @brief writer fills a temporary file that replaces the entry once complete, readers never see a partial
+    /// entry and concurrent writers of one key are fine
+    static bool Write(const Key &key, const eastl::function<bool(std::ofstream &)> &writer);
+    static bool Write(const Key &key, const void *data, size_t size);
+    /// @brief the entry was found but is unusable, it is deleted and its hit counted as a miss
+    static void Reject(const Key &key);
+
+    /// @brief saves the source hash index
+    static void Flush();
+    static void LogStats();
+
+private:
+    struct SourceStamp
+    {
+        int64_t WriteTime = 0;
+        uint64_t Size = 0u;
+        uint64_t Hash = 0u;
+    };
+
+    struct Stats
+    {
+        uint32_t Hits = 0u;
+        uint32_t Misses = 0u;
+        uint32_t Writes = 0u;
+        uint64_t BytesRead = 0u;
+        uint64_t BytesWritten = 0u;
+    };
+
+    static bool GetSourceHash(const Path &absoluteSourcePath, uint64_t &outHash);
+    // index of the current cache directory, the content directory may change after startup. m_mutex held
+    static void LoadIndexIfNeeded();
+    static void SaveIndex();
+    static void CountLookup(const Key &key, bool isHit);
+
+    inline static std::mutex m_mutex;
+    inline static Path m_contentDirectory;
+    inline static Path m_indexDirectory;
+    // absolute source path -> hash of its bytes at the stamped write time and size
+    inline static eastl::hash_map<eastl::string, SourceStamp> m_sourceHashes;
+    inline static bool m_bIsIndexDirty = false;
+    inline static uint32_t m_hashedSourceCount = 0u;
+    inline static eastl::hash_map<eastl::string, Stats> m_stats;
+};
+} // namespace Blainn
@@ -20,6 +20,11 @@ public:
 
     Path GetPath() const;
 
+    /// @brief reads the whole file into outData, false if it can't be opened or read
+    static bool ReadFileData(const Path &absolutePath, eastl::vector<uint8_t> &outData);
+    /// @brief last write time and size of a file, tells that it changed without reading it. False if it doesn't exist
+    static bool GetFileStamp(const Path &absolutePath, int64_t &outWriteTime, uint64_t &outSize);
+
 protected:
     Path m_path;
 };
@@ -4,16 +4,16 @@
 
 #pragma once
 #include "FileSystemObject.h"
+#include "handles/Handle.h"
 
 namespace Blainn
 {
-struct TextureHandle;
 enum class TextureType;
 
 class Material : public FileSystemObject
 {
 public:
-    Material() = default;
+    Material();
     Material(const Path &path, const eastl::string &shader);
     virtual ~Material() override;
 
@@ -21,12 +21,15 @@ public:
     virtual void Delete() override;
     virtual void Copy() override;
 
-    void SetTexture(const eastl::shared_ptr<TextureHandle> &textureHandle, TextureType type);
+    void SetTexture(const TextureHandle &textureHandle, TextureType type);
     TextureHandle &GetTextureHandle(TextureType type);
+    /// @brief index of the bound texture in the texture table, kInvalidTextureIndex if none is bound
+    uint32_t GetTextureIndex(TextureType type) const;
 
     void SetMaterialTransform(const Mat4 &matTransform)
     {
         m_materialTransform = matTransform;
+        MarkFramesDirty();
     }
 
     const Mat4 &GetMaterialTransform() const { return m_materialTransform; }
@@ -61,18 +64,22 @@ public:
 
     bool IsFramesDirty() const
     {
-        // TODO : replace with actual logic
-        return true; //NumFramesDirty > 0;
+        return NumFramesDirty > 0;
     }
+
+    inline static const uint32_t kInvalidTextureIndex = UINT32_MAX;
 private:
 
     Mat4 m_materialTransform = Mat4::Identity;
 
-    eastl::shared_ptr<TextureHandle> m_albedoTexture = nullptr;
-    eastl::shared_ptr<TextureHandle> m_normalTexture = nullptr;
-    eastl::shared_ptr<TextureHandle> m_metallicTexture = nullptr;
-    eastl::shared_ptr<TextureHandle> m_roughnessTexture = nullptr;
-    eastl::shared_ptr<TextureHandle> m_aoTexture = nullptr;
+    TextureHandle m_albedoTexture;
+    TextureHandle m_normalTexture;
+    TextureHandle m_metallicTexture;
+    TextureHandle m_roughnessTexture;
+    TextureHandle m_aoTexture;
+    // resolved once in SetTexture, indexed by TextureType
+    inline static const size_t kNumTextureTypes = 8;
+    eastl::array<uint32_t, kNumTextureTypes> m_textureIndices;
     eastl::string m_shader = "";
     Color m_albedoColor = Color(1, 1, 1, 1);
     float m_normalScale = 1.0f;
@@ -0,0 +1,26 @@
+#pragma once
+
+#include <EASTL/string.h>
+
+#include "aliases.h"
+
+namespace Blainn
+{
+/// @brief contents of a .mat file. Parsed on workers, turned into a Material on the main thread,
+/// where its textures can be requested from the AssetManager.
+struct MaterialDesc
+{
+    eastl::string ShaderPath;
+    // empty if the material has no texture of that type
+    Path AlbedoPath;
+    Path NormalPath;
+    Path MetallicPath;
+    Path RoughnessPath;
+    Path AOPath;
+
+    Color AlbedoColor = Color(1, 1, 1, 1);
+    float NormalScale = 1.0f;
+    float MetallicScale = 0.5f;
+    float RoughnessScale = 0.5f;
+};
+} // namespace Blainn
@@ -0,0 +1,109 @@
+#pragma once
+
+#include "aliases.h"
+#include "file-system/TextureType.h"
+
+#include <EASTL/hash_map.h>
+#include <EASTL/string.h>
+#include <EASTL/vector.h>
+
+namespace Blainn
+{
+struct MaterialDesc;
+
+/// @brief Every .mat of the project cooked into one binary file that is loaded with a single read. Textures are
+/// listed once and materials reference them by index, so a batch of materials resolves each texture once.
+///
+/// Records keep the write time and size of their .mat: a material edited after the cook is not found and is
+/// parsed from YAML as before.
+class MaterialTable
+{
+public:
+    // bump on any change to the file layout
+    static constexpr uint32_t kVersion = 1u;
+    static constexpr uint32_t kNoTexture = UINT32_MAX;
+    static constexpr size_t kSlotCount = 5u;
+    // texture slots of a record, in this order
+    static constexpr TextureType kSlotTypes[kSlotCount] = {TextureType::ALBEDO, TextureType::NORMAL,
+                                                           TextureType::METALLIC, TextureType::ROUGHNESS,
+                                                           TextureType::AO};
+
+    struct Record
+    {
+        uint32_t PathOffset;
+        uint32_t PathLength;
+        uint32_t ShaderOffset;
+        uint32_t ShaderLength;
+        // index in the texture list, kNoTexture for an empty slot
+        uint32_t Textures[kSlotCount];
+        float AlbedoColor[4];
+        float NormalScale;
+        float MetallicScale;
+        float RoughnessScale;
+        int64_t WriteTime;
+        uint64_t Size;
+    };
+
+    static Path GetTablePath();
+
+    /// @brief parses every .mat under directory and writes the table, replacing the previous one
+    static bool Cook(const Path &directory, uint32_t &outMaterialCount);
+
+    /// @brief reads the table in one go, false if there is none or it is of another version. Find loads it on
+    /// first use
+    bool Load();
+    bool IsLoaded() const
+    {
+        return m_bIsLoaded;
+    }
+
+    /// @brief record of the material if its .mat didn't change since the cook, nullptr otherwise
+    const Record *Find(const Path &relativePath);
+    /// @brief Find calls for materials added or edited since the cook, the table is worth cooking again
+    uint32_t GetMissCount() const
+    {
+        return m_missCount;
+    }
+    uint32_t GetMaterialCount() const
+    {
+        return static_cast<uint32_t>(m_records.size());
+    }
+
+    uint32_t GetTextureCount() const
+    {
+        return static_cast<uint32_t>(m_textures.size());
+    }
+    Path GetTexturePath(uint32_t index) const;
+    eastl::string GetShader(const Record &record) const;
+    /// @brief the record with its textures as paths
+    void GetDesc(const Record &record, MaterialDesc &outDesc) const;
+
+private:
+    struct FileHeader
+    {
+        uint32_t Magic;
+        uint32_t Version;
+        uint32_t TextureCount;
+        uint32_t MaterialCount;
+        uint32_t StringSize;
+    };
+
+    struct TextureRecord
+    {
+        uint32_t PathOffset;
+        uint32_t PathLength;
+    };
+
+    static eastl::string MakeKey(const Path &relativePath);
+    eastl::string GetString(uint32_t offset, uint32_t length) const;
+
+    eastl::vector<Record> m_records;
+    eastl::vector<TextureRecord> m_textures;
+    // every path and shader name of the table back to back
+    eastl::vector<char> m_strings;
+    eastl::hash_map<eastl::string, uint32_t> m_recordIndices;
+    Path m_loadedPath;
+    uint32_t m_missCount = 0u;
+    bool m_bIsLoaded = false;
+};
+} // namespace Blainn
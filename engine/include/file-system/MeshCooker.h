@@ -0,0 +1,41 @@
+#pragma once
+
+#include "aliases.h"
+
+namespace Blainn
+{
+class Model;
+
+/// @brief Reads and writes cooked models: merged vertex and index blobs with a submesh table,
+/// ready for upload without going through Assimp again. Cooked models are kept in the DerivedDataCache.
+class MeshCooker
+{
+public:
+    static inline const char *const processorName = "Mesh";
+    // bump on any change to the file layout, to BlainnVertex or to the import
+    static constexpr uint32_t kVersion = 5u;
+
+    /// @brief writes merged buffers of model, FinalizeMeshData must have been called.
+    /// importSettingsHash identifies the import options that changed the data, it is part of the cache key.
+    static bool Cook(const Model &model, const Path &absoluteSourcePath, uint64_t importSettingsHash);
+
+    /// @brief fills merged buffers of model, returns false if nothing was cooked from these source bytes
+    /// with these import settings.
+    static bool Load(const Path &absoluteSourcePath, Model &model, uint64_t importSettingsHash);
+
+private:
+    struct FileHeader
+    {
+        uint32_t Magic;
+        uint32_t Version;
+        uint32_t VertexStride;
+        uint32_t IndexStride;
+        uint32_t SubmeshCount;
+        uint32_t VertexCount;
+        uint32_t IndexCount;
+        uint32_t LODCount;
+        Vec3 BoundsCenter;
+        Vec3 BoundsExtents;
+    };
+};
+} // namespace Blainn
@@ -15,8 +15,29 @@ class Device;
 class Model : public FileSystemObject
 {
     friend class AssetLoader;
+    friend class MeshCooker;
 
 public:
+    /// @brief range of one source mesh inside the merged vertex and index buffers.
+    struct Submesh
+    {
+        uint32_t FirstVertex = 0u;
+        uint32_t VertexCount = 0u;
+        uint32_t FirstIndex = 0u;
+        uint32_t IndexCount = 0u;
+        Mat4 ParentMatrix = Mat4::Identity;
+    };
+
+    /// @brief index range of one level of detail, all levels share the vertex buffer.
+    struct LOD
+    {
+        uint32_t FirstIndex = 0u;
+        uint32_t IndexCount = 0u;
+        // largest distance the simplified surface moved, in model space
+        float Error = 0.0f;
+    };
+
+
     Model();
     Model(const Path &relativePath);
     Model(const Model &other, const Path &absolutPath);
@@ -27,22 +48,67 @@ public:
     virtual void Delete() override;
     virtual void Move() override;
 
-    eastl::vector<MeshData<>> &GetMeshes();
-    void SetMeshes(const eastl::vector<MeshData<>> &meshes);
+    /// @brief appends mesh to the merged buffers as a new submesh, indices are rebased.
+    void AddMesh(MeshData<> &&mesh);
+
+    /// @brief submesh data is written straight into the merged buffers between these calls
+    Submesh &BeginSubmesh(const Mat4 &parentMatrix);
+    void EndSubmesh(Submesh &submesh);
 
 public:
-    void CreateBufferResources();
+    /// @brief call once all submeshes are added, before cooking or creating GPU buffers.
+    void FinalizeMeshData();
+    const eastl::vector<Submesh> &GetSubmeshes() const
+    {
+        return m_submeshes;
+    }
+    /// @brief LOD 0 is the full mesh, it always exists after FinalizeMeshData.
+    const eastl::vector<LOD> &GetLODs() const
+    {
+        return m_lods;
+    }
+    /// @brief appends a simplified index list of every submesh as the next level, call after FinalizeMeshData.
+    void AddLOD(const eastl::vector<uint32_t> &indices, float error);
+    /// @brief picks the coarsest level whose error stays under maxErrorPixels on screen.
+    /// @param pixelsPerUnit screen pixels covered by one model space unit at the mesh's distance
+    uint32_t SelectLOD(float pixelsPerUnit, float maxErrorPixels) const;
+
+    /// @brief model space bounds of all submeshes.
+    const DirectX::BoundingBox &GetBounds() const
+    {
+        return m_bounds;
+    }
     uint32_t GetVerticesCount() const
     {
         return static_cast<uint32_t>(totalVertexCount);
     }
+    /// @brief index count of LOD 0, the merged index buffer also holds the other levels
     uint32_t GetIndicesCount() const
     {
         return static_cast<uint32_t>(totalIndexCount);
     }
 
+    /// @brief uploads on the direct queue, IsLoaded turns true once the copy is done
     void CreateGPUBuffers();
+    /// @brief records the upload into cmdList without executing it, the list may be a copy list
+    bool RecordGPUUpload(ID3D12GraphicsCommandList2 *cmdList);
+    /// @brief call once the list that recorded the upload has finished on the GPU
+    void MarkUploaded();
     void DisposeUploaders();
+    /// @brief bytes of the merged CPU buffers
+    size_t GetCPUDataSize() const
+    {
+        return allVertices.size() * sizeof(BlainnVertex) + allIndices.size() * sizeof(uint32_t);
+    }
+
+    /// @brief frees merged CPU buffers, GetAllVertices/GetAllIndices are empty afterwards.
+    void ReleaseCPUData();
+    /// @brief when false CPU buffers are released right after GPU upload.
+    /// The editor needs them for navmesh baking, standalone builds load baked navmeshes.
+    static void SetKeepCPUDataAfterUpload(bool keep)
+    {
+        s_keepCPUDataAfterUpload = keep;
+    }
 
     // TO DO: proper way: texture transoform matrix for every MeshData object
     const Mat4 &GetTextureTransform() const
@@ -112,6 +178,27 @@ private:
         }
     }
 
+    // picks 16 bit indices when every vertex is addressable with them
+    template <typename TVertex>
+    void CreateGPUBuffersWithIndexSelection(ID3D12GraphicsCommandList2 *pCommandList,
+                                            const eastl::vector<TVertex> &vertices)
+    {
+        if (vertices.size() <= eastl::numeric_limits<uint16_t>::max())
+        {
+            eastl::vector<uint16_t> shortIndices;
+            shortIndices.reserve(allIndices.size());
+            for (uint32_t index : allIndices)
+            {
+                shortIndices.push_back(static_cast<uint16_t>(index));
+            }
+            CreateGPUBuffers(pCommandList, vertices, shortIndices);
+        }
+        else
+        {
+            CreateGPUBuffers(pCommandList, vertices, allIndices);
+        }
+    }
+
 #pragma region VertexIndexBuffersViewStuff
 public:
     // uint64_t GetModelFrameValue() const { return m_frameValue; }
@@ -154,7 +241,11 @@ private:
     Microsoft::WRL::ComPtr<ID3D12Resource> IndexBufferUploader = nullptr;
 
 private:
-    eastl::vector<MeshData<>> m_meshes;
+    inline static bool s_keepCPUDataAfterUpload = true;
+
+    eastl::vector<Submesh> m_submeshes;
+    eastl::vector<LOD> m_lods;
+    DirectX::BoundingBox m_bounds;
 
     bool m_bBuffersCreated = true;
     bool m_bisLoaded = false;
@@ -9,12 +9,23 @@
 #include "FileSystemObject.h"
 #include "TextureType.h"
 
+namespace DirectX
+{
+class ScratchImage;
+}
+
 namespace Blainn
 {
     class Texture : public FileSystemObject
     {
     public:
-        Texture() = default;
+        // mips up to this size are always resident, see GetTailMip
+        static constexpr uint32_t kTailDimension = 64u;
+
+        Texture();
+        /// @brief empty texture for the streaming pipeline, filled by Decode and RecordUpload
+        Texture(const Path &path, TextureType type);
+        /// @brief loads the file and uploads it on the direct queue
         Texture(const Path &path, TextureType type, uint32_t index/*, bool IsCubeMap = false*/);
         virtual ~Texture() override;
 
@@ -30,17 +41,55 @@ namespace Blainn
         UINT GetDescriptorOffset() const { return m_descriptorHeapOffset; }
         bool IsInitialized() const { return m_bIsInitialized; }
 
+        // size of the full chain, known once decoded
+        uint32_t GetWidth() const { return m_width; }
+        uint32_t GetHeight() const { return m_height; }
+        uint32_t GetMipCount() const { return m_mipLevels; }
+        /// @brief VRAM bytes of every level of the full chain
+        const eastl::vector<uint64_t> &GetMipSizes() const { return m_mipSizes; }
+        /// @brief level of the full chain the resource starts at, coarser levels are resident too
+        uint32_t GetResidentMip() const { return m_residentMip; }
+        /// @brief coarsest level the resource may start at: the first one of kTailDimension or less,
+        /// block compressed levels must stay multiples of 4
+        uint32_t GetTailMip() const;
+        /// @brief CPU stage: RecordUpload creates the resource from mip on, clamped to the tail. Cubemaps are
+        /// always uploaded in full
+        void SetResidentMip(uint32_t mip);
+
         bool IsLoaded();
 
+        /// @brief CPU stage, safe on workers: takes the cooked texture or the decoded chain of an earlier run
+        /// from the DerivedDataCache, decodes the source image and caches the result otherwise
+        bool ReadAndDecode();
+        /// @brief CPU stage, safe on workers: decodes the source image and builds its mip chain
+        bool Decode(const void *fileData, size_t fileSize);
+        /// @brief bytes held by the decoded image until RecordUpload
+        size_t GetDecodedSize() const;
+        /// @brief creates the resource from the resident mip on and records the copy into cmdList. The decoded
+        /// image is released. A direct list gets the SRV at index right away, on a copy list the resource is left
+        /// in the COMMON state and the SRV waits for CreateView.
+        bool RecordUpload(ID3D12GraphicsCommandList2 *cmdList, uint32_t index);
+        /// @brief call once the list that recorded the upload has finished on the GPU
+        void MarkUploaded();
+        /// @brief writes the SRV of the descriptor slot given to RecordUpload. Frames pick it up when they start,
+        /// the previous texture of the slot lives until the frames submitted before are done. A cubemap view is
+        /// written in place, the GPU must be done with the previous one
+        void CreateView();
+
         void SetDescriptorOffset(UINT newOffset);
         void DisposeUploaders();
     private:
-        void Create(ID3D12GraphicsCommandList2 *cmdList, uint32_t index);
+        // takes the decoded chain and keeps its size for after the upload
+        void SetDecodedImage(eastl::unique_ptr<DirectX::ScratchImage> image);
+        bool IsValidResidentMip(uint32_t mip) const;
+        bool Create(ID3D12GraphicsCommandList2 *cmdList, uint32_t index);
         // Only dds files supported
-        void CreateCubemap(ID3D12GraphicsCommandList2 *cmdList, uint32_t index);
+        bool CreateCubemap(ID3D12GraphicsCommandList2 *cmdList);
     private:
         Microsoft::WRL::ComPtr<ID3D12Resource> m_resource = nullptr;
         Microsoft::WRL::ComPtr<ID3D12Resource> m_uploadResource = nullptr;
+        // mip chain between Decode and RecordUpload
+        eastl::unique_ptr<DirectX::ScratchImage> m_decodedImage;
         
         // cache handle (could be useful for default textures)
         CD3DX12_CPU_DESCRIPTOR_HANDLE localHandle = {};
@@ -48,6 +97,13 @@ namespace Blainn
         TextureType m_type = TextureType::NONE;
         UINT m_descriptorHeapOffset = 0u;
         UINT64 m_loadFenceValue = 0u;
+
+        uint32_t m_width = 0u;
+        uint32_t m_height = 0u;
+        uint32_t m_mipLevels = 0u;
+        uint32_t m_residentMip = 0u;
+        eastl::vector<uint64_t> m_mipSizes;
+        bool m_bIsBlockCompressed = false;
         
         bool m_bIsInitialized = false;
         bool m_bIsLoaded = false;
@@ -0,0 +1,54 @@
+#pragma once
+
+#include "FilePath.h"
+#include "file-system/TextureType.h"
+
+#include <cstdint>
+
+namespace DirectX
+{
+class ScratchImage;
+}
+
+namespace Blainn
+{
+/// @brief Reads and writes cooked textures: a DDS with the full mip chain, block compressed by texture type
+/// (BC7 albedo, BC5 normals, BC4 single channel maps, BC6H/BC7 cubemaps). Only the CPU paths of DirectXTex
+/// are used and PNG, JPG and BMP sources are decoded with stb_image, cooking needs no device, no WIC and no
+/// engine. Cooked textures are kept in the DerivedDataCache, the BlainnTextureCook tool fills it.
+class TextureCooker
+{
+public:
+    static inline const char *const processorName = "Texture";
+    // bump on any change to the file layout or to the format choice
+    static constexpr uint32_t kVersion = 2u;
+
+    /// @brief bytes a texture takes in VRAM with the runtime path and cooked
+    struct CookStats
+    {
+        uint64_t RuntimeSize = 0u;
+        uint64_t CookedSize = 0u;
+    };
+
+    /// @brief decodes the source, builds the mip chain, compresses it and writes the cooked file.
+    /// NONE picks CUBEMAP for cube sources and ALBEDO otherwise.
+    static bool Cook(const Path &absoluteSourcePath, TextureType type, CookStats &outStats);
+    /// @brief cooks every image under contentDirectory, the type is taken from the materials that reference it.
+    /// Logs VRAM size before and after, false if the directory can't be read
+    static bool CookDirectory(const Path &contentDirectory);
+
+    /// @brief reads the cooked texture, returns false if nothing was cooked from these source bytes for type
+    static bool Load(const Path &absoluteSourcePath, TextureType type, DirectX::ScratchImage &outImage);
+
+private:
+    struct FileHeader
+    {
+        uint32_t Magic;
+        uint32_t Version;
+        uint32_t Type;
+        uint32_t Format;
+        // DDS file that follows the header
+        uint64_t PayloadSize;
+    };
+};
+} // namespace Blainn
@@ -6,6 +6,7 @@
 
 #include "aliases.h"
 #include "AssetManager.h"
+#include "handles/HandleBase.h"
 
 namespace Blainn
 {
@@ -13,45 +14,62 @@ class Material;
 class Texture;
 class Model;
 
-struct Handle
+struct TextureHandle : RefCountedHandle<TextureHandle>
 {
-    Handle(const unsigned int index, AssetManager &manager = AssetManager::GetInstance());
-    virtual ~Handle();
+    TextureHandle() = default;
 
-    virtual unsigned int GetIndex() const;
-
-protected:
-    uuid id;
-    unsigned int m_index = 0;
-    AssetManager &m_manager;
-};
-
-
-struct TextureHandle : Handle
-{
-    TextureHandle(const unsigned int index, AssetManager &manager = AssetManager::GetInstance());
-    virtual ~TextureHandle() override;
     Texture &GetTexture() const;
+    /// @brief index in the texture table, the default texture while this one is loading
+    uint32_t GetIndex() const;
+
+    static void AddReference(const Handle &handle);
+    static void Release(const Handle &handle);
 
-    unsigned int GetIndex() const override;
+private:
+    friend class AssetManager;
+    TextureHandle(uint32_t index, uint32_t generation)
+        : RefCountedHandle(index, generation)
+    {
+    }
 };
 
 
-struct MaterialHandle : Handle
+struct MaterialHandle : RefCountedHandle<MaterialHandle>
 {
-    MaterialHandle(const unsigned int index, AssetManager &manager = AssetManager::GetInstance());
-    virtual ~MaterialHandle() override;
+    MaterialHandle() = default;
+
     Material &GetMaterial() const;
+    /// @brief index in the material buffer, the default material while textures of this one are loading
+    uint32_t GetIndex() const;
+
+    static void AddReference(const Handle &handle);
+    static void Release(const Handle &handle);
 
-    virtual unsigned int GetIndex() const override;
+private:
+    friend class AssetManager;
+    MaterialHandle(uint32_t index, uint32_t generation)
+        : RefCountedHandle(index, generation)
+    {
+    }
 };
 
-struct MeshHandle : Handle
+struct MeshHandle : RefCountedHandle<MeshHandle>
 {
-    MeshHandle(const unsigned int index, AssetManager &manager = AssetManager::GetInstance());
-    virtual ~MeshHandle() override;
+    MeshHandle() = default;
 
     Model &GetMesh() const;
+
+    static void AddReference(const Handle &handle);
+    static void Release(const Handle &handle);
+
+private:
+    friend class AssetManager;
+    MeshHandle(uint32_t index, uint32_t generation)
+        : RefCountedHandle(index, generation)
+    {
+    }
 };
 
+static_assert(sizeof(MeshHandle) == sizeof(uint32_t));
+
 } // namespace Blainn
@@ -0,0 +1,105 @@
+#pragma once
+
+#include <cstdint>
+
+// Handle and RefCountedHandle without the asset types, so code that only needs the reference counting does not pull
+// in AssetManager.
+namespace Blainn
+{
+/// @brief 32 bit reference to an asset slot of AssetManager: slot index and the generation of the slot.
+/// Default constructed handle is invalid.
+struct Handle
+{
+    static constexpr uint32_t kIndexBits = 20u;
+    static constexpr uint32_t kIndexMask = (1u << kIndexBits) - 1u;
+    static constexpr uint32_t kGenerationMask = (1u << (32u - kIndexBits)) - 1u;
+    static constexpr uint32_t kInvalidId = UINT32_MAX;
+
+    Handle() = default;
+
+    /// @brief slot of the asset, valid as long as the handle is
+    uint32_t GetIndex() const
+    {
+        return m_id & kIndexMask;
+    }
+    uint32_t GetGeneration() const
+    {
+        return m_id >> kIndexBits;
+    }
+    bool IsValid() const
+    {
+        return m_id != kInvalidId;
+    }
+    explicit operator bool() const
+    {
+        return IsValid();
+    }
+    bool operator==(const Handle &other) const = default;
+
+    /// @brief the slot still holds the asset the handle was made for. Slot generations count without bound,
+    /// handles keep their low bits, so a handle aliases again after 4096 reuses of its slot.
+    bool Matches(uint32_t slotGeneration) const
+    {
+        return IsValid() && (slotGeneration & kGenerationMask) == GetGeneration();
+    }
+
+protected:
+    Handle(uint32_t index, uint32_t generation)
+        : m_id(((generation & kGenerationMask) << kIndexBits) | (index & kIndexMask))
+    {
+    }
+
+    uint32_t m_id = kInvalidId;
+};
+
+/// @brief keeps the asset alive: copies add a reference, destruction releases it, moves transfer it.
+/// TDerived provides static AddReference(const Handle &) and Release(const Handle &).
+template <typename TDerived> struct RefCountedHandle : Handle
+{
+    RefCountedHandle() = default;
+
+    RefCountedHandle(const RefCountedHandle &other)
+        : Handle(other)
+    {
+        TDerived::AddReference(*this);
+    }
+
+    RefCountedHandle(RefCountedHandle &&other) noexcept
+        : Handle(other)
+    {
+        other.m_id = kInvalidId;
+    }
+
+    RefCountedHandle &operator=(const RefCountedHandle &other)
+    {
+        if (this == &other) return *this;
+
+        TDerived::AddReference(other);
+        TDerived::Release(*this);
+        m_id = other.m_id;
+        return *this;
+    }
+
+    RefCountedHandle &operator=(RefCountedHandle &&other) noexcept
+    {
+        if (this == &other) return *this;
+
+        TDerived::Release(*this);
+        m_id = other.m_id;
+        other.m_id = kInvalidId;
+        return *this;
+    }
+
+    ~RefCountedHandle()
+    {
+        TDerived::Release(*this);
+    }
+
+protected:
+    // takes over a reference already counted by AssetManager
+    RefCountedHandle(uint32_t index, uint32_t generation)
+        : Handle(index, generation)
+    {
+    }
+};
+} // namespace Blainn
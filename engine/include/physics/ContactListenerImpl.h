@@ -8,14 +8,23 @@
 #include <Jolt/Physics/StateRecorder.h>
 
 #include "aliases.h"
+#include "physics/PhysicsEvents.h"
+
+// contact state tracking validates the callback contract, it is too expensive for release builds
+#if defined(DEBUG) || defined(_DEBUG)
+#define BLAINN_TRACK_CONTACT_STATE
+#endif
 
 namespace Blainn
 {
 
-// Tests the contact listener callbacks
+// Collects contact events from jolt worker threads into per thread buffers.
+// Buffers are merged on the main thread after PhysicsSystem::Update with CollectEvents().
 class ContactListenerImpl : public JPH::ContactListener
 {
 public:
+    ContactListenerImpl();
+
     // See: ContactListener
     virtual JPH::ValidateResult OnContactValidate(const JPH::Body &inBody1, const JPH::Body &inBody2,
                                                   JPH::RVec3Arg inBaseOffset,
@@ -26,9 +35,15 @@ public:
                                     const JPH::ContactManifold &inManifold, JPH::ContactSettings &ioSettings) override;
     virtual void OnContactRemoved(const JPH::SubShapeIDPair &inSubShapePair) override;
 
+    /// @brief appends events of all threads to outEvents and clears the buffers.
+    /// Must not be called while PhysicsSystem::Update is running.
+    void CollectEvents(eastl::vector<PhysicsEvent> &outEvents);
+
+#ifdef BLAINN_TRACK_CONTACT_STATE
     // Saving / restoring state for replay
     void SaveState(JPH::StateRecorder &inStream) const;
     void RestoreState(JPH::StateRecorder &inStream);
+#endif
 
     // Draw the current contact state
     // void					DrawState();
@@ -40,11 +55,25 @@ public:
     }
 
 private:
+    using EventBuffer = eastl::vector<PhysicsEvent>;
+
+    // returns buffer owned by the calling thread, registers it on the first call from that thread
+    EventBuffer &GetThreadEventBuffer();
+    void PushEvent(PhysicsEventType eventType, JPH::BodyID bodyID1, JPH::BodyID bodyID2);
+
+    // taken only when a thread registers its buffer, not per callback
+    JPH::Mutex mBuffersMutex;
+    eastl::vector<eastl::unique_ptr<EventBuffer>> mBuffers;
+    // distinguishes listener instances for thread local buffer pointers
+    uint32_t mListenerId = 0;
+
+#ifdef BLAINN_TRACK_CONTACT_STATE
     // Map that keeps track of the current state of contacts based on the contact listener callbacks
     using StatePair = eastl::pair<JPH::RVec3, JPH::ContactPoints>;
     using StateMap = JPH::UnorderedMap<JPH::SubShapeIDPair, StatePair>;
     JPH::Mutex mStateMutex;
     StateMap mState;
+#endif
 
     ContactListener *mNext = nullptr;
 };
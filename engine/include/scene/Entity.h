@@ -91,6 +91,8 @@ public:
 
     template <typename T> void RemoveComponent();
     template <typename T> bool RemoveComponentIfExists();
+    // plain registry removal, components owned by a subsystem are destroyed through it
+    bool RemoveComponentIfExists(entt::id_type typeId);
 
 #pragma endregion
 
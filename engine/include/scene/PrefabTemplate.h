@@ -0,0 +1,77 @@
+#pragma once
+
+#include <entt/entt.hpp>
+
+#include "aliases.h"
+
+#include <EASTL/string.h>
+#include <EASTL/vector.h>
+
+namespace Blainn
+{
+/// @brief A prefab parsed once: its hierarchy flattened parents first, and every plain data component decoded into
+/// a prototype entity of a private registry. Instances copy those values instead of walking the YAML again.
+///
+/// Components that register with a subsystem when attached (physics, AI, scripting) have no decoded value, each
+/// instance runs their deserializer on the node kept here.
+class PrefabTemplate
+{
+public:
+    static constexpr uint32_t kNoParent = UINT32_MAX;
+
+    struct Node
+    {
+        eastl::string Tag;
+        // index in the node list, parents come before their children
+        uint32_t Parent = kNoParent;
+        entt::entity Prototype = entt::null;
+        // indices in g_componentRegistry, in registry order
+        eastl::vector<uint32_t> Components;
+        YAML::Node Source;
+    };
+
+    struct ComponentDelta
+    {
+        enum class Change : uint8_t
+        {
+            Added,
+            Changed,
+            Removed
+        };
+
+        uint32_t Node = 0u;
+        // index in g_componentRegistry
+        uint32_t Component = 0u;
+        Change Kind = Change::Changed;
+        // top level keys of the component that differ, empty if it isn't a map
+        eastl::vector<eastl::string> Fields;
+    };
+
+    PrefabTemplate() = default;
+    PrefabTemplate(const PrefabTemplate &other) = delete;
+    PrefabTemplate &operator=(const PrefabTemplate &other) = delete;
+
+    /// @brief decodes the Entities of a prefab file, false if it has none
+    bool Build(const YAML::Node &prefabNode);
+
+    /// @brief components that differ between two versions of a prefab, node by node. Without a previous version
+    /// every component counts as changed. False if the hierarchy changed, nodes don't match up then
+    static bool Diff(const PrefabTemplate *previous, const PrefabTemplate &current,
+                     eastl::vector<ComponentDelta> &outDeltas);
+
+    const eastl::vector<Node> &GetNodes() const
+    {
+        return m_nodes;
+    }
+    const entt::registry &GetComponents() const
+    {
+        return m_components;
+    }
+
+private:
+    void AddNode(const YAML::Node &node, uint32_t parent);
+
+    eastl::vector<Node> m_nodes;
+    entt::registry m_components;
+};
+} // namespace Blainn
@@ -21,6 +21,8 @@ namespace Blainn
 struct MeshComponent;
 class SceneManager;
 class AssetManager;
+class PrefabTemplate;
+class SceneSnapshot;
 
 using EntityMap = eastl::unordered_map<uuid, Entity>;
 
@@ -30,6 +32,8 @@ public:
     Scene(const eastl::string_view &name = "UntitledScene", uuid uid = Rand::getRandomUUID(),
           bool isEditorScene = false) noexcept;
     Scene(const YAML::Node &config);
+    /// @brief rebuilds every entity of the snapshot, the scene as it was when the snapshot was captured
+    Scene(const eastl::string_view &name, uuid uid, SceneSnapshot &snapshot);
     ~Scene();
 
     void StartPlayMode()
@@ -80,9 +84,13 @@ public:
                                    bool shouldSort = true, bool onSceneChanged = false, bool createdByEditor = false);
     void CreateEntities(const YAML::Node &entitiesNode, bool onSceneChanged = false, bool createdByEditor = false);
     Entity CreatePrefabEntity(const YAML::Node &prefabNode);
+    /// @brief count copies of a parsed prefab, outRoots gets the first root entity of each
+    void CreatePrefabEntities(const PrefabTemplate &prefab, size_t count, eastl::vector<Entity> &outRoots);
 
     void LoadNavMeshData(const YAML::Node &node);
     void SubmitToDestroyEntity(Entity entity, bool sceneChanged = false);
+    // removes one component, through its subsystem if one owns it
+    static void DestroyComponent(Entity entity, entt::id_type typeId);
 
 
     Entity GetEntityWithUUID(const uuid &id) const;
@@ -107,6 +115,8 @@ public:
     void ConvertToLocalSpace(Entity entity);
     void ConvertToWorldSpace(Entity entity);
     Mat4 GetWorldSpaceTransformMatrix(Entity entity);
+    // true if the transform of entity or of any of its parents changed in the last frames
+    bool IsWorldSpaceTransformFramesDirty(Entity entity);
     void SetFromWorldSpaceTransformMatrix(Entity entity, Mat4 worldTransform);
     TransformComponent GetWorldSpaceTransform(Entity entity);
 
@@ -156,6 +166,7 @@ private:
 
     friend class Entity;
     friend class SceneManager;
+    friend class SceneSnapshot;
     friend class AssetManager;
 };
 } // namespace Blainn
@@ -0,0 +1,40 @@
+#pragma once
+
+#include "aliases.h"
+#include "file-system/TextureType.h"
+
+#include <EASTL/vector.h>
+
+namespace YAML
+{
+class Node;
+class Emitter;
+} // namespace YAML
+
+namespace Blainn
+{
+class Scene;
+
+/// @brief Manifest of the assets a scene references: meshes and materials of its entities, textures of those
+/// materials and of skyboxes. Saved with the scene, so opening it can queue every load at once instead of
+/// discovering textures only when their material is published.
+struct SceneDependencies
+{
+    struct TextureEntry
+    {
+        Path RelativePath;
+        TextureType Type = TextureType::NONE;
+    };
+
+    eastl::vector<Path> Meshes;
+    eastl::vector<Path> Materials;
+    eastl::vector<TextureEntry> Textures;
+
+    /// @brief assets of the entities of a live scene, textures are read from the material files
+    static SceneDependencies Collect(Scene &scene);
+    /// @brief the manifest saved with the scene, collected from its entities if it was saved without one
+    static SceneDependencies FromSceneNode(const YAML::Node &scene);
+
+    void Serialize(YAML::Emitter &out) const;
+};
+} // namespace Blainn
@@ -28,6 +28,8 @@ public:
 
     eastl::shared_ptr<Scene> OpenScene(const YAML::Node &config, SceneLoadType loadType = Single);
     eastl::shared_ptr<Scene> OpenScene(const Path &relativePath, SceneLoadType loadType = Single);
+    eastl::shared_ptr<Scene> OpenScene(const eastl::string &name, const uuid &id, SceneSnapshot &snapshot,
+                                       SceneLoadType loadType = Single);
     // TODO: open by name, by id (make included scenes map in editor)
 
     void UpdateScenes();
@@ -92,6 +94,7 @@ public:
     void SubmitToDestroyEntity(Entity entity);
 
     Mat4 GetWorldSpaceTransformMatrix(Entity entity);
+    bool IsWorldSpaceTransformFramesDirty(Entity entity);
     TransformComponent GetWorldSpaceTransform(Entity entity);
     void SetFromWorldSpaceTransformMatrix(Entity entity, Mat4 worldTransform);
     void ConvertToLocalSpace(Entity entity);
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <entt/entt.hpp>
+
+#include "aliases.h"
+#include "scene/BasicComponents.h"
+
+#include <EASTL/hash_map.h>
+#include <EASTL/string.h>
+#include <EASTL/vector.h>
+
+namespace Blainn
+{
+class Entity;
+class Scene;
+
+/// @brief The entities of a scene copied aside in memory when play mode starts, put back when it ends. Plain data
+/// components are copied as values, components that register with a subsystem (physics, AI, scripting) as the
+/// YAML of just those components, which is only parsed for the entities that have to rebuild them.
+///
+/// Restoring destroys the entities created during play and rebuilds the ones destroyed, every other entity gets its
+/// components back in place and keeps its physics body.
+class SceneSnapshot
+{
+public:
+    void Capture(Scene &scene);
+    void Restore(Scene &scene);
+
+    /// @brief false once a restore had to rebuild physics bodies, the saved body states don't match them then
+    bool AreBodiesKept() const
+    {
+        return m_bAreBodiesKept;
+    }
+
+private:
+    struct EntityRecord
+    {
+        uuid ID;
+        eastl::string Tag;
+        RelationshipComponent Relationship;
+        entt::entity Values = entt::null;
+        // indices in g_componentRegistry, in registry order
+        eastl::vector<uint32_t> Components;
+        // YAML of the components without a value, empty if there are none
+        eastl::string SubsystemComponents;
+    };
+
+    void RestoreValues(Scene &scene, Entity entity, const EntityRecord &record, bool isRebuilt);
+    void RestoreSubsystemComponents(Entity entity, const EntityRecord &record, bool isRebuilt);
+
+    eastl::vector<EntityRecord> m_entities;
+    eastl::hash_map<uuid, uint32_t> m_indices;
+    // plain data components of every entity
+    entt::registry m_values;
+    bool m_bAreBodiesKept = true;
+};
+} // namespace Blainn
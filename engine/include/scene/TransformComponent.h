@@ -23,13 +23,13 @@ private:
     Vec3 EulerRotation{0.f, 0.f, 0.f};
     Quat Rotation{0.f, 0.f, 0.f, 1.f};
 
+public:
+    // for a transform copied back from aside, its value changed without a setter
     void MarkFramesDirty()
     {
         NumFramesDirty = kNumFramesMarkDirty;
     };
 
-
-public:
     TransformComponent() = default;
     TransformComponent(const TransformComponent &) = default;
 
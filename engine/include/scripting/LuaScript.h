@@ -34,6 +34,10 @@ public:
     bool OnCollisionEndedCall(const eastl::shared_ptr<PhysicsEvent> &physicsEvent);
     bool OnDrawUI();
 
+    /// @brief functions are already bound to the script environment, used for batched calls
+    const sol::protected_function &GetOnUpdateFunction() const;
+    const sol::protected_function &GetOnDrawUIFunction() const;
+
     template <typename... Args> bool CustomCall(eastl::string_view functionName = "", Args &&...args)
     {
         if (!m_isLoaded)
@@ -49,7 +53,6 @@ public:
                      m_scriptPath.string().c_str());
             return false;
         }
-        sol::set_environment(m_environment, customFunc);
         sol::protected_function_result result = customFunc(std::forward<Args>(args)...);
         if (!result.valid())
         {
@@ -3,7 +3,9 @@
 //
 
 #pragma once
+#include "file-system/MaterialTable.h"
 #include "file-system/Texture.h"
+#include "subsystems/AssetStreamer.h"
 #include "VertexTypes.h"
 
 namespace std::filesystem
@@ -20,6 +22,7 @@ namespace Blainn
 {
     class Model;
     class Material;
+    struct TextureHandle;
 
     template<typename TVertex, typename TIndex>
     struct MeshData;
@@ -36,20 +39,54 @@ namespace Blainn
         void Init();
         void Destroy();
 
-        eastl::shared_ptr<Model> ImportModel(const Path &relativePath, const ImportMeshData &data);
         eastl::shared_ptr<Texture> LoadTexture(const Path &path, TextureType type, uint32_t index);
         eastl::shared_ptr<Material> LoadMaterial(const Path &relativePath);
 
+        /// @brief fills merged buffers of model from the DerivedDataCache, cooks it first on a miss.
+        /// Touches no shared state, safe on workers.
+        bool LoadModelData(const Path &relativePath, const ImportMeshData &data, Model &model);
+        /// @brief parses the contents of a .mat file, safe on workers
+        static bool ParseMaterial(const Path &relativePath, const eastl::vector<uint8_t> &fileData,
+                                  MaterialDesc &outDesc);
+        /// @brief main thread: builds the material and requests its textures from the AssetManager
+        eastl::shared_ptr<Material> CreateMaterial(const Path &relativePath, const MaterialDesc &desc,
+                                                   StreamPriority texturePriority = StreamPriority::Normal);
+        /// @brief main thread: builds a cooked material, resolveTexture turns a texture index of the table and
+        /// the slot it fills into a handle
+        eastl::shared_ptr<Material> CreateMaterial(
+            const Path &relativePath, const MaterialTable::Record &record,
+            const eastl::function<TextureHandle(uint32_t, TextureType)> &resolveTexture);
+        MaterialTable &GetMaterialTable()
+        {
+            return m_materialTable;
+        }
+
+        /// @brief imports every model under directory with Assimp, cooks it and loads the cooked file back,
+        /// logging both timings. Needs no GPU.
+        void CookModels(const Path &directory);
+        /// @brief cooks every .mat under directory into the MaterialTable and loads it back, logging both timings
+        /// against parsing the YAML files. Needs no GPU.
+        void CookMaterials(const Path &directory);
+
     private:
         AssetLoader(const AssetLoader &) = delete;
         AssetLoader &operator=(const AssetLoader &) = delete;
         AssetLoader(const AssetLoader &&) = delete;
         AssetLoader &operator=(const AssetLoader &&) = delete;
 
+        bool ImportModelWithAssimp(const Path &relativePath, const Path &absolutePath, const ImportMeshData &data,
+                                   Model &model);
+
+        /// @brief reorders every submesh for the post-transform cache, overdraw and vertex fetch in place
+        void OptimizeModel(const Path &relativePath, Model &model);
+        /// @brief appends a simplified level for every error target of data, levels that barely reduce are skipped
+        void GenerateLODs(const Path &relativePath, const ImportMeshData &data, Model &model);
+        static uint64_t GetImportSettingsHash(const ImportMeshData &data);
+
         void ProcessNode(const Path &path, const aiNode &node, const aiScene &scene, const Mat4 &parentMatrix, Model &model);
 
-        MeshData<BlainnVertex, uint32_t> ProcessMesh(const Path &path, const aiMesh &mesh, const aiScene &scene, const aiNode &node,
-                            const Mat4 &parentMatrix, Model &model);
+        void ProcessMesh(const Path &path, const aiMesh &mesh, const aiScene &scene, const aiNode &node,
+                         const Mat4 &parentMatrix, Model &model);
 
         void ResetTextureOffsetsTable();
 
@@ -60,5 +97,6 @@ namespace Blainn
         static Vec2 GetTextCoords(const aiMesh &mesh, const unsigned int meshIndex);
 
         eastl::unordered_map<TextureType, UINT> m_texturesOffsetsTable;
+        MaterialTable m_materialTable;
     };
 } // namespace Blainn
\ No newline at end of file
@@ -5,15 +5,19 @@
 #pragma once
 
 #include "AssetLoader.h"
+#include "AssetStreamer.h"
 #include "FreeListVector.h"
+#include "Render/TextureResidency.h"
 #include "helpers.h"
 
 namespace Blainn
 {
+struct Handle;
 struct MaterialHandle;
 struct TextureHandle;
 struct MeshHandle;
 struct ImportMeshData;
+struct SceneDependencies;
 
 #ifndef MAX_TEX_OF_TYPE
 #define MAX_TEX_OF_TYPE 128
@@ -32,10 +36,13 @@ class AssetManager
 {
     friend class RenderSubsystem;
 
-    struct AssetData
+    /// @brief asset with the count of handles referencing it, unloaded when the count drops to zero
+    template <typename T> struct AssetSlot
     {
-        int index;
-        int refCount;
+        eastl::shared_ptr<T> Asset;
+        // key in the path table, erased together with the slot
+        eastl::string Path;
+        uint32_t RefCount = 0u;
     };
 
     // To load default diffuse texture and cubemap at init time
@@ -50,30 +57,61 @@ public:
 
     void Init();
     void Destroy();
+    /// @brief once per frame on the main thread: advances streaming and publishes finished loads into their slots,
+    /// load callbacks run from here
+    void Update();
+
+    /// @brief true while loads are queued, decoding or uploading
+    bool IsStreaming() const;
+    /// @brief blocks until every queued load, and the textures of loaded materials, is published
+    void FlushStreaming();
+    /// @brief bytes of file data, decoded data and upload heaps that loads in flight may hold at once
+    void SetStreamingMemoryBudget(uint64_t bytes);
+    /// @brief VRAM the mips of streamed textures may take, the lowest priority mips are evicted to stay in it
+    void SetTextureMemoryBudget(uint64_t bytes);
+    /// @brief textures of the material cover screenSize pixels this frame, the renderer calls it for visible
+    /// meshes. Their mips are streamed in or out on the next Update
+    void RequestTextureMips(const MaterialHandle &material, float screenSize);
+    /// @brief queues every asset of a scene at once with Critical priority, entities created afterwards find them in
+    /// flight. They are held until streaming is idle, FlushStreaming is the barrier for all of them
+    void PreloadScene(const SceneDependencies &dependencies);
 
 
     bool HasMesh(const Path &relativePath);
-    eastl::shared_ptr<MeshHandle> GetMesh(const Path &relativePath);
-    static eastl::shared_ptr<MeshHandle> GetDefaultMesh(uint32_t index = 0u);
-    eastl::shared_ptr<MeshHandle> LoadMesh(const Path &relativePath, const ImportMeshData &data);
+    MeshHandle GetMesh(const Path &relativePath);
+    static MeshHandle GetDefaultMesh(uint32_t index = 0u);
+    /// @brief returns at once, the handle resolves to the default mesh until the load is published
+    MeshHandle LoadMesh(const Path &relativePath, const ImportMeshData &data,
+                        StreamPriority priority = StreamPriority::Normal, const AssetLoadedCallback &onLoaded = {});
     Model &GetMeshByIndex(unsigned int index);
     Model &GetMeshByHandle(const MeshHandle &handle);
     Path GetMeshPath(const MeshHandle &handle);
 
     bool HasTexture(const Path &path);
-    eastl::shared_ptr<TextureHandle> GetTexture(const Path &path);
-    eastl::shared_ptr<TextureHandle> LoadTexture(const Path &relativePath, const TextureType type);
+    TextureHandle GetTexture(const Path &path);
+    TextureHandle LoadTexture(const Path &relativePath, const TextureType type,
+                              StreamPriority priority = StreamPriority::Normal,
+                              const AssetLoadedCallback &onLoaded = {});
+    static TextureHandle GetDefaultTextureHandle();
     Texture &GetTextureByIndex(unsigned int index);
     Texture &GetTextureByHandle(const TextureHandle &handle);
     Path GetTexturePath(const TextureHandle &handle);
 
     bool HasMaterial(const Path &relativePath);
-    eastl::shared_ptr<MaterialHandle> GetMaterial(const Path &path);
-    eastl::shared_ptr<MaterialHandle> LoadMaterial(const Path &path, AssetData data = {-1, 0});
+    MaterialHandle GetMaterial(const Path &path);
+    /// @brief a material found in the MaterialTable is built at once and onLoaded runs before returning, only
+    /// its textures stream. Others are parsed from YAML on a worker
+    MaterialHandle LoadMaterial(const Path &path, StreamPriority priority = StreamPriority::Normal,
+                                const AssetLoadedCallback &onLoaded = {});
+    /// @brief LoadMaterial for many paths, loaded ones are shared. Textures of the cooked materials in the batch
+    /// are resolved once each
+    void LoadMaterials(const eastl::vector<Path> &paths, StreamPriority priority,
+                       eastl::vector<MaterialHandle> &outHandles);
+    /// @brief reloads the material in place, handles to it stay valid
     void UpdateMaterial(const Path &relativePath);
     Material &GetMaterialByIndex(unsigned int index);
     Material &GetMaterialByHandle(const MaterialHandle &handle);
-    static eastl::shared_ptr<MaterialHandle> GetDefaultMaterialHandle();
+    static MaterialHandle GetDefaultMaterialHandle();
     Path GetMaterialPath(const MaterialHandle &handle);
 
     void ResetTextures();
@@ -87,34 +125,82 @@ private:
     friend struct MeshHandle;
     friend struct MaterialHandle;
     friend struct TextureHandle;
-    friend struct Handle;
 
-    void AddTextureWhenLoaded(const Path &path, const unsigned int index, const TextureType type);
-    void AddMaterialWhenLoaded(const Path &relativePath, const unsigned int index);
-    void AddMeshWhenLoaded(const Path &relativePath, const unsigned int index, const ImportMeshData data);
+    // false once the slot of the job was erased, its result is dropped
+    bool IsStreamJobCurrent(const StreamJob &job) const;
+    // swaps finished assets into their slots and runs the load callbacks
+    void PublishStreamJobs(AssetStreamer::JobList &jobs);
+    // solves texture residency for the requests of the last frame and streams the mip ranges that changed
+    void StreamTextureMips();
+    // drops replaced textures once the frames submitted before their swap are done with them
+    void ReleaseRetiredTextures();
+    void ReleaseScenePreload();
+
+    // resolvedTextures maps texture indices of the table to handles, shared by a batch
+    MaterialHandle CreateCookedMaterial(const Path &relativePath, const MaterialTable::Record &record,
+                                        StreamPriority priority,
+                                        eastl::hash_map<uint32_t, TextureHandle> &resolvedTextures);
+    // slot with a placeholder and a decode job for the .mat
+    MaterialHandle StreamMaterial(const Path &relativePath, StreamPriority priority,
+                                  const AssetLoadedCallback &onLoaded);
 
     Texture &GetDefaultTexture(uint32_t index = 0u);
     Material &GetDefaultMaterial();
     Model &GetDefaultModel(uint32_t index = 0u);
 
-    void IncreaseTextureRefCount(const unsigned int index);
-    void IncreaseMaterialRefCount(const unsigned int index);
-    void IncreaseMeshRefCount(const unsigned int index);
-    void DecreaseTextureRefCount(const unsigned int index);
-    void DecreaseMaterialRefCount(const unsigned int index);
-    void DecreaseMeshRefCount(const unsigned int index);
+    // asset of a handle, nullptr if the handle is invalid or its slot was erased
+    Texture *FindTexture(const Handle &handle);
+    Material *FindMaterial(const Handle &handle);
+    Model *FindMesh(const Handle &handle);
+
+    // new handle to a slot, counts the reference
+    TextureHandle AcquireTexture(uint32_t index);
+    MaterialHandle AcquireMaterial(uint32_t index);
+    MeshHandle AcquireMesh(uint32_t index);
+
+    // O(1), handles of erased slots are ignored
+    void IncreaseTextureRefCount(const Handle &handle);
+    void IncreaseMaterialRefCount(const Handle &handle);
+    void IncreaseMeshRefCount(const Handle &handle);
+    void DecreaseTextureRefCount(const Handle &handle);
+    void DecreaseMaterialRefCount(const Handle &handle);
+    void DecreaseMeshRefCount(const Handle &handle);
 
 private:
     inline static eastl::unique_ptr<AssetLoader> m_loader;
 
-    eastl::hash_map<eastl::string, AssetData> m_materialPaths;
-    FreeListVector<eastl::shared_ptr<Material>> m_materials;
+    // path -> slot index. Materials hold texture handles, so textures are declared first and outlive them
+    eastl::hash_map<eastl::string, uint32_t> m_texturePaths;
+    FreeListVector<AssetSlot<Texture>> m_textures;
+
+    eastl::hash_map<eastl::string, uint32_t> m_materialPaths;
+    FreeListVector<AssetSlot<Material>> m_materials;
+
+    eastl::hash_map<eastl::string, uint32_t> m_meshPaths;
+    FreeListVector<AssetSlot<Model>> m_meshes;
 
-    eastl::hash_map<eastl::string, AssetData> m_texturePaths;
-    FreeListVector<eastl::shared_ptr<Texture>> m_textures;
+    // workers never see the slots above, finished loads come back through Update
+    eastl::unique_ptr<AssetStreamer> m_streamer;
+
+    static constexpr uint64_t kDefaultTextureMemoryBudget = 512ull * 1024ull * 1024ull;
+    // ids are texture slots, cubemaps and the sync loaded default are always resident in full
+    TextureResidency m_textureResidency;
+    // slots with a mip range in flight, one at a time per texture
+    eastl::hash_set<uint32_t> m_texturesStreamingMips;
+    uint64_t m_textureMemoryBudget = kDefaultTextureMemoryBudget;
+
+    struct RetiredTexture
+    {
+        eastl::shared_ptr<Texture> Asset;
+        // signaled on the direct queue after the last frame that may still read the texture
+        uint64_t FenceValue = 0u;
+    };
+    eastl::vector<RetiredTexture> m_retiredTextures;
 
-    eastl::hash_map<eastl::string, AssetData> m_meshPaths;
-    FreeListVector<eastl::shared_ptr<Model>> m_meshes;
+    // references of the last scene preload, declared after the slots they point to
+    eastl::vector<MeshHandle> m_preloadedMeshes;
+    eastl::vector<TextureHandle> m_preloadedTextures;
+    eastl::vector<MaterialHandle> m_preloadedMaterials;
 };
 
 } // namespace Blainn
\ No newline at end of file
@@ -0,0 +1,158 @@
+#pragma once
+
+#include <EASTL/array.h>
+#include <EASTL/deque.h>
+#include <EASTL/functional.h>
+#include <EASTL/shared_ptr.h>
+#include <EASTL/unique_ptr.h>
+#include <EASTL/vector.h>
+
+#include <mutex>
+
+#include "ImportAssetData.h"
+#include "Render/DXHelpers.h"
+#include "aliases.h"
+#include "file-system/MaterialDesc.h"
+#include "file-system/TextureType.h"
+#include "helpers.h"
+
+namespace Blainn
+{
+class AssetLoader;
+class CommandQueue;
+class Model;
+class Texture;
+
+/// @brief order in which queued loads are started, a higher class always goes first
+enum class StreamPriority : uint8_t
+{
+    Critical = 0, // blocks the level being opened
+    High,
+    Normal,
+    Low, // prefetch
+    Count
+};
+
+enum class StreamAssetType : uint8_t
+{
+    Texture,
+    Material,
+    Mesh
+};
+
+/// @brief runs on the main thread when the asset is published, false if loading failed or the slot is gone
+using AssetLoadedCallback = eastl::function<void(bool isLoaded)>;
+
+/// @brief one asset on its way through the pipeline. The worker stage writes only the decoded results,
+/// the rest is touched on the main thread.
+struct StreamJob
+{
+    // ResidentMip of a first load: only the tail mips, the rest is streamed in by residency
+    static constexpr uint32_t kTailMip = UINT32_MAX;
+
+    StreamAssetType Type = StreamAssetType::Texture;
+    StreamPriority Priority = StreamPriority::Normal;
+    Path RelativePath;
+    // slot the asset is published into, the job is stale once the slot generation changed
+    uint32_t Index = 0u;
+    uint32_t Generation = 0u;
+    TextureType TextureKind = TextureType::NONE;
+    // most detailed texture mip uploaded, clamped to the tail of the texture
+    uint32_t ResidentMip = kTailMip;
+    ImportMeshData MeshData;
+    eastl::vector<AssetLoadedCallback> Callbacks;
+
+    // decoded results, empty if the stage failed
+    eastl::shared_ptr<Texture> LoadedTexture;
+    eastl::shared_ptr<Model> LoadedMesh;
+    MaterialDesc LoadedMaterial;
+    bool bIsDecoded = false;
+
+    // charged against the memory budget from dispatch until the job leaves the streamer
+    uint64_t MemoryCost = 0u;
+    uint64_t DecodedSize = 0u;
+};
+
+/// @brief Loads assets in stages: file read and decode on job system workers, GPU upload batched on the copy
+/// queue and tracked by its fence. Finished jobs are handed back from Update on the main thread, so only the
+/// owner of the asset slots ever writes them.
+class AssetStreamer
+{
+public:
+    using JobList = eastl::vector<eastl::unique_ptr<StreamJob>>;
+    /// @brief false if the slot of the job was erased meanwhile, such jobs are not decoded or uploaded
+    using JobFilter = eastl::function<bool(const StreamJob &)>;
+
+    static constexpr uint64_t kDefaultMemoryBudget = 256ull * 1024ull * 1024ull;
+
+    AssetStreamer(AssetLoader &loader, JobFilter isJobCurrent);
+    ~AssetStreamer();
+    NO_COPY_NO_MOVE(AssetStreamer);
+
+    void Enqueue(eastl::unique_ptr<StreamJob> job);
+
+    /// @brief main thread, once per frame: publishes finished uploads, batches decoded jobs into one copy list
+    /// and starts queued jobs while the budget allows. Jobs that left the pipeline are appended to outFinished.
+    void Update(JobList &outFinished);
+    /// @brief blocks until every queued job has finished
+    void Flush(JobList &outFinished);
+    /// @brief drops queued jobs and waits for the running ones, their results are discarded
+    void Shutdown();
+
+    bool IsIdle() const;
+    uint32_t GetPendingJobCount() const;
+
+    void SetMemoryBudget(uint64_t bytes)
+    {
+        m_memoryBudget = bytes;
+    }
+    uint64_t GetMemoryBudget() const
+    {
+        return m_memoryBudget;
+    }
+    uint64_t GetBytesInFlight() const
+    {
+        return m_bytesInFlight;
+    }
+
+private:
+    struct UploadBatch
+    {
+        UINT64 FenceValue = 0u;
+        // reset only after the fence, the list is owned by the copy queue
+        ComPtr<ID3D12CommandAllocator> CommandAllocator;
+        JobList Jobs;
+    };
+
+    // worker stage: reads the file and decodes it, touches nothing but job
+    void RunWorkerStages(StreamJob &job);
+    void DecodeTexture(StreamJob &job);
+    void DecodeMaterial(StreamJob &job);
+    void DecodeMesh(StreamJob &job);
+
+    void PublishUploaded(JobList &outFinished);
+    void SubmitDecoded(JobList &outFinished);
+    void DispatchQueued(JobList &outFinished);
+    void Finish(eastl::unique_ptr<StreamJob> job, JobList &outFinished);
+    // decoded jobs handed back by the workers
+    void TakeDecoded(eastl::vector<StreamJob *> &outJobs);
+
+    static uint64_t EstimateMemoryCost(const StreamJob &job);
+
+    AssetLoader &m_loader;
+    JobFilter m_isJobCurrent;
+    eastl::shared_ptr<CommandQueue> m_copyQueue;
+
+    eastl::array<eastl::deque<eastl::unique_ptr<StreamJob>>, static_cast<size_t>(StreamPriority::Count)> m_queues;
+    eastl::deque<UploadBatch> m_uploadBatches;
+
+    // workers own their job until they push it here
+    std::mutex m_decodedMutex;
+    eastl::vector<StreamJob *> m_decoded;
+
+    // main thread only
+    uint32_t m_workersInFlight = 0u;
+    uint64_t m_bytesInFlight = 0u;
+    uint64_t m_memoryBudget = kDefaultMemoryBudget;
+};
+} // namespace Blainn
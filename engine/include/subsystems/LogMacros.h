@@ -0,0 +1,47 @@
+#pragma once
+
+#include "spdlog/spdlog.h"
+
+// the macros alone, for code that is also built into tools without the engine
+
+#define BLAINN_DEFAULT_LOGGER_NAME "BLAINN"
+
+#if defined(_DEBUG) || defined(BLAINN_HAS_CONSOLE)
+#define BF_TRACE(...)                                                                                                  \
+    if (spdlog::get(BLAINN_DEFAULT_LOGGER_NAME) != nullptr)                                                            \
+    {                                                                                                                  \
+        spdlog::get(BLAINN_DEFAULT_LOGGER_NAME)->trace(__VA_ARGS__);                                                   \
+    }
+#define BF_DEBUG(...)                                                                                                  \
+    if (spdlog::get(BLAINN_DEFAULT_LOGGER_NAME) != nullptr)                                                            \
+    {                                                                                                                  \
+        spdlog::get(BLAINN_DEFAULT_LOGGER_NAME)->debug(__VA_ARGS__);                                                   \
+    }
+#define BF_INFO(...)                                                                                                   \
+    if (spdlog::get(BLAINN_DEFAULT_LOGGER_NAME) != nullptr)                                                            \
+    {                                                                                                                  \
+        spdlog::get(BLAINN_DEFAULT_LOGGER_NAME)->info(__VA_ARGS__);                                                    \
+    }
+#define BF_WARN(...)                                                                                                   \
+    if (spdlog::get(BLAINN_DEFAULT_LOGGER_NAME) != nullptr)                                                            \
+    {                                                                                                                  \
+        spdlog::get(BLAINN_DEFAULT_LOGGER_NAME)->warn(__VA_ARGS__);                                                    \
+    }
+#define BF_ERROR(...)                                                                                                  \
+    if (spdlog::get(BLAINN_DEFAULT_LOGGER_NAME) != nullptr)                                                            \
+    {                                                                                                                  \
+        spdlog::get(BLAINN_DEFAULT_LOGGER_NAME)->error(__VA_ARGS__);                                                   \
+    }
+#define BF_FATAL(...)                                                                                                  \
+    if (spdlog::get(BLAINN_DEFAULT_LOGGER_NAME) != nullptr)                                                            \
+    {                                                                                                                  \
+        spdlog::get(BLAINN_DEFAULT_LOGGER_NAME)->critical(__VA_ARGS__);                                                \
+    }
+#else
+#define BF_TRACE(...) ;
+#define BF_DEBUG(...) ;
+#define BF_INFO(...) ;
+#define BF_WARN(...) ;
+#define BF_ERROR(...) ;
+#define BF_FATAL(...) ;
+#endif
@@ -7,6 +7,9 @@
 #include <Jolt/Physics/Body/BodyFilter.h>
 #include <Jolt/Physics/Body/BodyID.h>
 #include <Jolt/Physics/PhysicsSystem.h>
+#include <Jolt/Physics/StateRecorderImpl.h>
+
+#include <eventpp/eventdispatcher.h>
 
 #include "components/PhysicsComponent.h"
 #include "physics/BodyGetter.h"
@@ -47,6 +50,14 @@ public:
     static void UpdateBodyInJolt(const uuid &entityUuid);
     static void StopSimulation();
 
+    /// @brief keeps the state of every body in memory, taken when play mode starts
+    static void SaveBodyStates();
+    /// @brief puts the bodies back to the saved state. Every saved body must still exist, bodies destroyed and
+    /// rebuilt since have new ids, ResetBodies is for that case
+    static bool RestoreBodyStates();
+    /// @brief moves bodies back to their transforms and stops them
+    static void ResetBodies();
+
     /// @brief recreates physics component if already exists
     static void CreateAttachPhysicsComponent(PhysicsComponentSettings &settings);
     static bool HasPhysicsComponent(Entity entity);
@@ -54,6 +65,9 @@ public:
 
     static JPH::BodyID GetBodyId(Entity entity);
     static eastl::optional<Entity> GetEntityByBodyId(JPH::BodyID bodyId);
+    /// @brief lock free, safe to call from jolt worker threads during Update()
+    /// @return nullptr if body is not connected to an entity
+    static const uuid *TryGetEntityIdByBodyId(JPH::BodyID bodyId);
 
     /// @brief does not check entity or component exist! You are warned.
     static PhysicsComponent &GetPhysicsComponentByBodyId(JPH::BodyID bodyId);
@@ -78,6 +92,13 @@ public:
                                                eastl::function<void(const eastl::shared_ptr<PhysicsEvent> &)> listener);
     static void RemoveEventListener(const PhysicsEventType eventType, const PhysicsEventHandle &handle);
 
+    /// @brief listener is called only for events where entityId is one of the two colliding entities
+    static PhysicsEventHandle AddEntityEventListener(
+        const uuid &entityId, const PhysicsEventType eventType,
+        eastl::function<void(const eastl::shared_ptr<PhysicsEvent> &)> listener);
+    static void RemoveEntityEventListener(const uuid &entityId, const PhysicsEventType eventType,
+                                          const PhysicsEventHandle &handle);
+
     // TODO: hide somehow?
     static JPH::PhysicsSystem &GetPhysicsSystem();
 
@@ -85,11 +106,26 @@ private:
     PhysicsSubsystem() = delete;
 
     static void ProcessEvents();
+    static void ConnectBodyToEntity(JPH::BodyID bodyId, const uuid &entityId);
+    static void DisconnectBody(JPH::BodyID bodyId);
+    static void DispatchEntityEvent(const eastl::shared_ptr<PhysicsEvent> &physicsEvent);
+    static void DispatchEntityEvent(const uuid &entityId, const eastl::shared_ptr<PhysicsEvent> &physicsEvent);
 
 
     inline static eventpp::EventQueue<PhysicsEventType, void(const eastl::shared_ptr<PhysicsEvent> &),
                                       PhysicsEventPolicy>
         s_physicsEventQueue;
+    // contact events of the last Update merged from all jolt threads, reused between updates
+    inline static eastl::vector<PhysicsEvent> s_collectedEvents{};
+
+    using EntityPhysicsEventDispatcher =
+        eventpp::EventDispatcher<PhysicsEventType, void(const eastl::shared_ptr<PhysicsEvent> &), PhysicsEventPolicy>;
+
+    // per entity subscribers, so an event reaches only the two entities involved instead of every script
+    inline static eastl::unordered_map<uuid, EntityPhysicsEventDispatcher> s_entityEventDispatchers{};
+    // dispatchers can not be erased while one of them is being invoked, empty ones are collected after dispatch
+    inline static bool s_isDispatchingEntityEvents = false;
+    inline static eastl::vector<uuid> s_emptyEntityDispatchers{};
 
     inline static const int physicsUpdateFrequency = 60;
     inline static const int physicsUpdateSubsteps = 1;
@@ -99,7 +135,15 @@ private:
 
     inline static bool m_isInitialized = false;
 
-    inline static eastl::unordered_map<JPH::BodyID, uuid> m_bodyEntityConnections{};
+    struct BodyEntityConnection
+    {
+        JPH::BodyID bodyId; // invalid when slot is free, sequence number rejects stale ids
+        uuid entityId;
+    };
+
+    // indexed by BodyID::GetIndex(). Written only on the main thread outside of jolt Update,
+    // so contact callbacks can read it without locking
+    inline static eastl::vector<BodyEntityConnection> m_bodyEntityConnections{};
 
     inline static constexpr uint32_t m_maxConcurrentJobs = 8;
     inline static eastl::unique_ptr<JPH::JobSystemSingleThreaded> m_joltJobSystem = nullptr;
@@ -111,12 +155,12 @@ private:
     inline static eastl::unique_ptr<ObjectVsBroadPhaseLayerFilterImpl> m_objectVsBroadPhaseLayerFilter = nullptr;
     inline static eastl::unique_ptr<ObjectLayerPairFilterImpl> m_objectVsObjectLayerFilter = nullptr;
     inline static eastl::unique_ptr<ContactListenerImpl> m_contactListener = nullptr;
+    inline static eastl::unique_ptr<JPH::StateRecorderImpl> m_savedBodyStates = nullptr;
 
     inline static constexpr uint32_t cNumBodies = 10240;
     inline static constexpr uint32_t cNumBodyMutexes = 0; // Autodetect
     inline static constexpr uint32_t cMaxBodyPairs = 65536;
     inline static constexpr uint32_t cMaxContactConstraints = 20480;
 
-    friend class ContactListenerImpl;
 };
 } // namespace Blainn
@@ -3,7 +3,12 @@
 //
 
 #pragma once
+#include "helpers.h"
 #include "scene/Entity.h"
+#include "scene/PrefabTemplate.h"
+
+#include <EASTL/hash_map.h>
+#include <EASTL/unique_ptr.h>
 
 namespace Blainn
 {
@@ -14,11 +19,44 @@ namespace Blainn
 class PrefabSubsystem
 {
 public:
+    NO_COPY_NO_MOVE(PrefabSubsystem);
+
+    struct Placement
+    {
+        Vec3 Position = Vec3::Zero;
+        Quat Rotation = Quat::Identity;
+        Vec3 Scale = Vec3::One;
+    };
+
+    static PrefabSubsystem &GetInstance();
+
+    // templates hold asset handles, cleared before the asset manager
+    void Destroy();
+
+    /// @brief applies what changed in the prefab file to its instances in the open scenes: only changed components,
+    /// and on instance roots only fields that are not overridden. Instances keep their placement
     void UpdatePrefabRefs(const Path &relativePath);
 
-    Entity CreateEntityFromPrefab(const Path &relativePath, const Scene &scene, const Vec3 &position,
+    /// @brief the prefab parsed on first use and kept until its file changes, nullptr if it can't be read
+    const PrefabTemplate *GetTemplate(const Path &relativePath);
+
+    Entity CreateEntityFromPrefab(const Path &relativePath, Scene &scene, const Vec3 &position,
                                   const Quat &rotation, const Vec3 &scale);
+    /// @brief one instance per placement, outRoots gets the root of each. The prefab is parsed at most once and
+    /// every component is copied into all instances at a time
+    void CreateEntitiesFromPrefab(const Path &relativePath, Scene &scene, const eastl::vector<Placement> &placements,
+                                  eastl::vector<Entity> &outRoots);
 
 private:
+    PrefabSubsystem() = default;
+
+    struct CachedTemplate
+    {
+        eastl::unique_ptr<PrefabTemplate> Template;
+        int64_t WriteTime = 0;
+        uint64_t Size = 0u;
+    };
+
+    eastl::hash_map<eastl::string, CachedTemplate> m_templates;
 };
 } // namespace Blainn
\ No newline at end of file
@@ -8,10 +8,14 @@
 #include "Render/Camera.h"
 #include "Render/GBuffer.h"
 #include "Render/CascadeShadowMap.h"
+#include "Render/DrawList.h"
+#include "Render/FrustumCuller.h"
+#include "Render/LightClusters.h"
 #include "Render/RootSignature.h"
 #include "Render/Shader.h"
 #include "Render/PipelineStateObject.h"
 #include "Render/RenderTarget.h"
+#include "Render/TextureViewTable.h"
 
 namespace Blainn
 {
@@ -20,6 +24,9 @@ const int gNumFrameResources = 3;
 class DebugRenderer;
 class Device;
 struct FrameResource;
+struct MeshComponent;
+class Model;
+struct PassRecordingState;
 class RootSignature;
 class SelectionManager;
 class UIRenderer;
@@ -118,11 +125,24 @@ public:
         return m_aspectRatio;
     }
 
+    TextureViewTable &GetTextureViews()
+    {
+        return m_textureViews;
+    }
+
     uuid GetUUIDAt(uint32_t x, uint32_t y);
 
 private:
-    // Record all the commands we need to render the scene into the command list.
+    // Record the passes that are not split into jobs: lighting, forward, debug and UI.
     void PopulateCommandList(ID3D12GraphicsCommandList2 *pCommandList);
+    /// @brief records pass jobs on the job system and the rest of the frame on the calling thread,
+    /// returns how many command lists of the current frame resource were recorded
+    uint32_t RecordCommandLists();
+    /// @brief records jobs until none are left, called by workers and the main thread
+    void RecordPassJobs(PassRecordingState &state);
+    void RecordPassJob(uint32_t jobIndex);
+    /// @brief binds root signature and descriptor heaps, every command list starts without them
+    void BeginCommandList(ID3D12GraphicsCommandList2 *pCommandList);
     void InitializeWindow();
     void InitializeImGui();
 
@@ -151,7 +171,25 @@ private:
 
 private:
     void UpdateObjectsCB(float deltaTime);
+    /// @brief recomputes world bounds of mesh from PerObjectCBData.World
+    void UpdateMeshBounds(MeshComponent &mesh) const;
+    /// @brief LOD of mesh for the main camera, world bounds must be up to date
+    uint32_t SelectMeshLOD(const MeshComponent &mesh, const Vec3 &cameraPosition, float projectionScale) const;
+    /// @brief fills visible lists of the camera and of the shadow cascades, once per frame
+    void CullRenderables();
+    /// @brief reports the on-screen size of camera visible meshes to texture residency
+    void RequestTextureMips();
+    /// @brief sorts visible meshes of the shadow and geometry passes into batches
+    void BuildDrawLists();
+    /// @brief sorts visibleRenderables into drawList for pass drawn with pipeline,
+    /// returns address of the instance data of all items in draw order
+    D3D12_GPU_VIRTUAL_ADDRESS BuildDrawList(EPassType pass, PipelineStateObject::EPsoType pipeline,
+                                            const eastl::vector<uint32_t> &visibleRenderables, DrawList &drawList);
+    /// @brief splits batches of drawList into recording jobs of pass
+    void AddPassRecordingJobs(EPassType pass, const DrawList &drawList);
     void UpdateLightsBuffers(float deltaTime);
+    /// @brief bins the lights written by UpdateLightsBuffers into the camera froxels and uploads the grid
+    void UpdateLightClusters();
     void UpdateMaterialBuffer(float deltaTime);
     void UpdateShadowTransform(float deltaTime);
 
@@ -162,16 +200,26 @@ private:
 
 private:
 #pragma region Shadows
-    void RenderDepthOnlyPass(ID3D12GraphicsCommandList2 *pCommandList);
+    struct PassRecordingJob
+    {
+        EPassType Pass;
+        uint32_t FirstBatch;
+        uint32_t BatchCount;
+        // the first job of a pass transitions and clears its targets, the last one transitions them back
+        bool IsFirst;
+        bool IsLast;
+    };
+
+    void RenderDepthOnlyPass(ID3D12GraphicsCommandList2 *pCommandList, const PassRecordingJob &job);
 #pragma endregion Shadows
 
 #pragma region DeferredShading
-    void RenderGeometryPass(ID3D12GraphicsCommandList2 *pCommandList);
+    void RenderGeometryPass(ID3D12GraphicsCommandList2 *pCommandList, const PassRecordingJob &job);
 
     void RenderLightingPass(ID3D12GraphicsCommandList2 *pCommandList);
     void DeferredDirectionalLightPass(ID3D12GraphicsCommandList2 *pCommandList);
-    void DeferredPointLightPass(ID3D12GraphicsCommandList2 *pCommandList);
-    void DeferredSpotLightPass(ID3D12GraphicsCommandList2 *pCommandList);
+    /// @brief one full screen pass over the point and spot lights of the pixel's cluster
+    void DeferredClusteredLightPass(ID3D12GraphicsCommandList2 *pCommandList);
 
     void RenderForwardPasses(ID3D12GraphicsCommandList2 *pCommandList);
     void RenderTransparencyPass(ID3D12GraphicsCommandList2 *pCommandList);
@@ -188,7 +236,10 @@ private:
 
     // For drawing specific meshes
     void DrawMesh(ID3D12GraphicsCommandList2 *pCommandList, const Model &mesh);
-    void DrawMeshes(ID3D12GraphicsCommandList2 *pCommandList);
+    /// @brief one instanced draw per batch in [firstBatch, firstBatch + batchCount), binds pipeline and buffers
+    /// only when they change. Reads only data prepared by BuildDrawLists, so chunks can be recorded in parallel.
+    void DrawMeshes(ID3D12GraphicsCommandList2 *pCommandList, const DrawList &drawList,
+                    D3D12_GPU_VIRTUAL_ADDRESS instanceData, uint32_t firstBatch, uint32_t batchCount);
     void DrawInstancedMesh(ID3D12GraphicsCommandList2 *pCommandList, const Model &mesh, const UINT numInstances);
 
     void DrawQuad(ID3D12GraphicsCommandList2 *pCommandList);
@@ -249,10 +300,17 @@ private:
     PassConstants m_shadowPassCBData;
     PassConstants m_geometryPassCBData;
     PassConstants m_deferredPassCBData;
-    MaterialData m_perMaterialSBData;
+    // consecutive dirty materials, written to the material buffer as one range
+    eastl::vector<MaterialData> m_dirtyMaterialsSBData;
 
     UINT m_pointLightsCount = 0u;
     UINT m_spotLightsCount = 0u;
+    // view space bounds, indexed like the light buffers
+    eastl::vector<LightBounds> m_pointLightBounds;
+    eastl::vector<LightBounds> m_spotLightBounds;
+    LightClusterGrid m_lightClusters;
+    D3D12_GPU_VIRTUAL_ADDRESS m_clusterGridData = 0u;
+    D3D12_GPU_VIRTUAL_ADDRESS m_clusterLightIndicesData = 0u;
 
     ComPtr<ID3D12DescriptorHeap> m_rtvHeap;
     ComPtr<ID3D12DescriptorHeap> m_dsvHeap;
@@ -272,6 +330,27 @@ private:
     Camera *m_camera;
     eastl::shared_ptr<Camera> m_editorCamera;
 
+#pragma region Culling
+    // meshes with object constants this frame, culler spheres use the same indices
+    eastl::vector<MeshComponent *> m_renderables;
+    FrustumCuller m_culler;
+    eastl::array<FrustumPlanes, MaxCascades> m_cascadeFrustums;
+    eastl::vector<uint32_t> m_cameraVisibleRenderables;
+    // union over the cascades, all of them are rendered in one pass
+    eastl::vector<uint32_t> m_shadowVisibleRenderables;
+
+    DrawList m_geometryDrawList;
+    DrawList m_shadowDrawList;
+    D3D12_GPU_VIRTUAL_ADDRESS m_geometryInstanceData = 0u;
+    D3D12_GPU_VIRTUAL_ADDRESS m_shadowInstanceData = 0u;
+    // mesh field of the sort keys without the LOD bits, ids are handed out per frame in first use order
+    eastl::unordered_map<const Model *, uint32_t> m_drawMeshIds;
+    eastl::vector<const Model *> m_drawModels;
+    eastl::vector<ObjectConstants> m_instanceScratch;
+    // in submission order, job i records into command list i of the current frame resource
+    eastl::vector<PassRecordingJob> m_recordingJobs;
+#pragma endregion Culling
+
 #pragma region DeferredShading
     eastl::unique_ptr<GBuffer> m_GBuffer;
     UINT m_GBufferTexturesSrvHeapStartIndex = 0u;
@@ -285,6 +364,8 @@ private:
 #pragma region Textures
     UINT m_skyCubeSrvHeapStartIndex = 0u;
     UINT m_texturesSrvHeapStartIndex = 0u;
+    // one table per frame resource from m_texturesSrvHeapStartIndex on
+    TextureViewTable m_textureViews;
 #pragma endregion Textures
 
     // TODO
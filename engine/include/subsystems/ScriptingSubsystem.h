@@ -29,6 +29,14 @@ public:
 
     static sol::state &GetLuaState();
 
+    /// @brief Returns factory compiled from the script file. Compiled once per path and modification time.
+    /// factory(env) executes the script top level with env as its _ENV and shares function prototypes
+    /// between instances. Invalid function if the script could not be compiled
+    static sol::protected_function GetCompiledScript(const Path &scriptPath);
+
+    /// @brief Creates per instance script environment. Globals are reached through one shared metatable
+    static sol::environment CreateScriptEnvironment();
+
     static sol::object GetValueFromScript(const uuid &scriptUuid, const eastl::string &valueName);
     static void SetValueInScript(const uuid &scriptUuid, const eastl::string &valueName, const sol::object &value);
 
@@ -83,8 +91,51 @@ private:
 
     inline static eastl::unordered_map<uuid, Entity> m_scriptEntityConnections = eastl::unordered_map<uuid, Entity>{};
 
+    struct CompiledScript
+    {
+        std::filesystem::file_time_type writeTime;
+        sol::protected_function factory;
+    };
+
+    // keyed by absolute script path
+    inline static eastl::unordered_map<eastl::string, CompiledScript> s_compiledScripts{};
+    inline static sol::table s_environmentMetatable{};
+
     static void RegisterBlainnTypes();
 
+    // Scripts loaded from the same file are ticked by one lua call that loops over their callbacks,
+    // instead of one C++ to Lua transition per script. Scripts without the callback are not in the batch.
+    struct ScriptBatch
+    {
+        sol::table callbacks;                        // lua array, callbacks[i + 1] belongs to scriptIds[i]
+        eastl::vector<uuid> scriptIds;
+        eastl::unordered_map<uuid, uint32_t> slots;  // script id -> index in scriptIds
+    };
+
+    struct SceneScriptBatches
+    {
+        // keyed by script path. Batches are never erased while scripts run, so pointers to them stay valid
+        eastl::unordered_map<eastl::string, ScriptBatch> onUpdate;
+        eastl::unordered_map<eastl::string, ScriptBatch> onDrawUI;
+    };
+
+    static void AddToBatches(const LuaScript &script, const uuid &sceneId);
+    static void RemoveFromBatches(const LuaScript &script, const uuid &sceneId);
+    static void AddToBatch(ScriptBatch &batch, const uuid &scriptId, const sol::protected_function &callback);
+    static void RemoveFromBatch(ScriptBatch &batch, const uuid &scriptId);
+    static void RunBatches(eastl::unordered_map<eastl::string, ScriptBatch> &batches, const char *callbackName,
+                           float deltaTimeMs);
+
+    inline static eastl::unordered_map<uuid, SceneScriptBatches> s_sceneScriptBatches{};
+    inline static eastl::vector<eastl::pair<const eastl::string *, ScriptBatch *>> s_batchesToRun{};
+    inline static sol::protected_function s_batchRunner{};
+    // a script unloaded while its batch loops only clears its callback, the slot is compacted after the run so
+    // no other script of the batch moves and skips the frame
+    inline static bool s_isRunningBatches = false;
+    inline static eastl::vector<eastl::pair<ScriptBatch *, uuid>> s_deferredRemovals{};
+    // scenes whose scripts were all unloaded while batches ran, their batches are erased after the run
+    inline static eastl::vector<uuid> s_deferredSceneErases{};
+
 #ifdef BLAINN_TEST_LUA_SCRIPTS
     inline static Entity m_scriptTestEntity{};
     inline static uuid m_scriptTestUuid1{};
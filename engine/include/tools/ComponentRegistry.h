@@ -18,6 +18,14 @@ struct ComponentMeta
     eastl::function<bool(const YAML::Node &)> hasComponent;
     eastl::function<void(Entity &, const YAML::Node &)> deserializer;
     eastl::function<void(Entity &, YAML::Emitter &)> serializer;
+    // plain data components only: decode a node into a prefab template and copy the value into count instances.
+    // Empty for components that register with a subsystem, instances run the deserializer instead
+    eastl::function<void(entt::registry &, entt::entity, const YAML::Node &)> decodeTemplate;
+    // copies the component of a live entity aside, for a scene snapshot
+    eastl::function<void(Entity &, entt::registry &, entt::entity)> captureTemplate;
+    eastl::function<void(const entt::registry &, entt::entity, Entity *, size_t)> instantiateTemplate;
+    // same, over the component instances already have. Kept in place, so subsystems keep their registration
+    eastl::function<void(const entt::registry &, entt::entity, Entity *, size_t)> assignTemplate;
 };
 
 inline eastl::vector<eastl::pair<entt::id_type, ComponentMeta>> g_componentRegistry;
@@ -31,16 +39,44 @@ void RegisterComponent(const char *name, eastl::function<bool(const YAML::Node &
                                      ComponentMeta{name, hasFn, deserializeFn, serializeFn});
 }
 
+// the component is whatever decodeFn returns, so a prefab template can decode it once and copy it per instance
+template <typename ComponentType>
+void RegisterDataComponent(const char *name, eastl::function<bool(const YAML::Node &)> hasFn,
+                           ComponentType (*decodeFn)(const YAML::Node &),
+                           eastl::function<void(Entity &, YAML::Emitter &)> serializeFn)
+{
+    ComponentMeta meta{name, hasFn,
+                       [decodeFn](Entity &e, const YAML::Node &node) { e.AddComponent<ComponentType>(decodeFn(node)); },
+                       serializeFn};
+    meta.decodeTemplate = [decodeFn](entt::registry &registry, entt::entity prototype, const YAML::Node &node)
+    { registry.emplace<ComponentType>(prototype, decodeFn(node)); };
+    meta.captureTemplate = [](Entity &e, entt::registry &registry, entt::entity prototype)
+    { registry.emplace<ComponentType>(prototype, e.GetComponent<ComponentType>()); };
+    meta.instantiateTemplate = [](const entt::registry &registry, entt::entity prototype, Entity *instances,
+                                  size_t count)
+    {
+        const ComponentType &value = registry.get<ComponentType>(prototype);
+        for (size_t i = 0; i < count; ++i)
+            instances[i].AddComponent<ComponentType>(value);
+    };
+    meta.assignTemplate = [](const entt::registry &registry, entt::entity prototype, Entity *instances, size_t count)
+    {
+        const ComponentType &value = registry.get<ComponentType>(prototype);
+        for (size_t i = 0; i < count; ++i)
+            instances[i].GetComponent<ComponentType>() = value;
+    };
+
+    g_componentRegistry.emplace_back(entt::type_hash<ComponentType>::value(), eastl::move(meta));
+}
+
 inline void InitializeComponentRegistry()
 {
     RegisterComponent<TagComponent>(
         "TagComponent", HasTag, [](Entity &e, const YAML::Node &node)
         { e.GetComponent<TagComponent>().Tag = eastl::move(GetTag(node["TagComponent"])); },
         [](Entity &e, YAML::Emitter &out) { Serializer::Tag(e, out); });
-    RegisterComponent<TransformComponent>(
-        "TransformComponent", HasTransform,
-        [](Entity &e, const YAML::Node &node) { e.AddComponent<TransformComponent>(eastl::move(GetTransform(node))); },
-        [](Entity &e, YAML::Emitter &out) { Serializer::Transform(e, out); });
+    RegisterDataComponent<TransformComponent>("TransformComponent", HasTransform, GetTransform,
+                                              [](Entity &e, YAML::Emitter &out) { Serializer::Transform(e, out); });
 
     RegisterComponent<RelationshipComponent>(
         "RelationshipComponent", HasRelationship,
@@ -59,43 +95,31 @@ inline void InitializeComponentRegistry()
         },
         [](Entity &e, YAML::Emitter &out) { Serializer::Relationship(e, out); });
 
-    RegisterComponent<DirectionalLightComponent>(
-        "DirectionalLightComponent", HasDirectionalLight, [](Entity &e, const YAML::Node &node)
-        { e.AddComponent<DirectionalLightComponent>(eastl::move(GetDirectionalLight(node))); },
+    RegisterDataComponent<DirectionalLightComponent>(
+        "DirectionalLightComponent", HasDirectionalLight, GetDirectionalLight,
         [](Entity &e, YAML::Emitter &out) { Serializer::DirectionalLight(e, out); });
 
-    RegisterComponent<PointLightComponent>(
-        "PointLightComponent", HasPointLight, [](Entity &e, const YAML::Node &node)
-        { e.AddComponent<PointLightComponent>(eastl::move(GetPointLight(node))); },
-        [](Entity &e, YAML::Emitter &out) { Serializer::PointLight(e, out); });
+    RegisterDataComponent<PointLightComponent>("PointLightComponent", HasPointLight, GetPointLight,
+                                               [](Entity &e, YAML::Emitter &out) { Serializer::PointLight(e, out); });
 
-    RegisterComponent<SpotLightComponent>(
-        "SpotLightComponent", HasSpotLight,
-        [](Entity &e, const YAML::Node &node) { e.AddComponent<SpotLightComponent>(eastl::move(GetSpotLight(node))); },
-        [](Entity &e, YAML::Emitter &out) { Serializer::SpotLight(e, out); });
+    RegisterDataComponent<SpotLightComponent>("SpotLightComponent", HasSpotLight, GetSpotLight,
+                                              [](Entity &e, YAML::Emitter &out) { Serializer::SpotLight(e, out); });
 
     RegisterComponent<PhysicsComponent>(
         "PhysicsComponent", HasPhysics, [](Entity &e, const YAML::Node &node) { GetPhysics(node, e); },
         [](Entity &e, YAML::Emitter &out) { Serializer::Physics(e, out); });
 
-    RegisterComponent<MeshComponent>(
-        "MeshComponent", HasMesh,
-        [](Entity &e, const YAML::Node &node) { e.AddComponent<MeshComponent>(eastl::move(GetMesh(node))); },
-        [](Entity &e, YAML::Emitter &out) { Serializer::Mesh(e, out); });
+    RegisterDataComponent<MeshComponent>("MeshComponent", HasMesh, GetMesh,
+                                         [](Entity &e, YAML::Emitter &out) { Serializer::Mesh(e, out); });
 
-    RegisterComponent<CameraComponent>(
-        "CameraComponent", HasCamera,
-        [](Entity &e, const YAML::Node &node) { e.AddComponent<CameraComponent>(eastl::move(GetCamera(node))); },
-        [](Entity &e, YAML::Emitter &out) { Serializer::Camera(e, out); });
+    RegisterDataComponent<CameraComponent>("CameraComponent", HasCamera, GetCamera,
+                                           [](Entity &e, YAML::Emitter &out) { Serializer::Camera(e, out); });
 
-    RegisterComponent<SkyboxComponent>(
-        "SkyboxComponent", HasSkybox,
-        [](Entity &e, const YAML::Node &node) { e.AddComponent<SkyboxComponent>(eastl::move(GetSkybox(node))); },
-        [](Entity &e, YAML::Emitter &out) { Serializer::Skybox(e, out); });
+    RegisterDataComponent<SkyboxComponent>("SkyboxComponent", HasSkybox, GetSkybox,
+                                           [](Entity &e, YAML::Emitter &out) { Serializer::Skybox(e, out); });
 
-    RegisterComponent<NavmeshVolumeComponent>(
-        "NavmeshVolumeComponent", HasNavMeshVolume, [](Entity &e, const YAML::Node &node)
-        { e.AddComponent<NavmeshVolumeComponent>(eastl::move(GetNavMeshVolume(node))); },
+    RegisterDataComponent<NavmeshVolumeComponent>(
+        "NavmeshVolumeComponent", HasNavMeshVolume, GetNavMeshVolume,
         [](Entity &e, YAML::Emitter &out) { Serializer::NavMeshVolume(e, out); });
 
     RegisterComponent<ScriptingComponent>(
@@ -107,19 +131,13 @@ inline void InitializeComponentRegistry()
         "AIControllerComponent", HasAIController, [](Entity &e, const YAML::Node &node) { GetAIController(node, e); },
         [](Entity &e, YAML::Emitter &out) { Serializer::AIController(e, out); });
 
-    RegisterComponent<StimulusComponent>(
-        "StimulusComponent", HasStimulus,
-        [](Entity &e, const YAML::Node &node) { e.AddComponent<StimulusComponent>(eastl::move(GetStimulus(node))); },
-        [](Entity &e, YAML::Emitter &out) { Serializer::Stimulus(e, out); });
+    RegisterDataComponent<StimulusComponent>("StimulusComponent", HasStimulus, GetStimulus,
+                                             [](Entity &e, YAML::Emitter &out) { Serializer::Stimulus(e, out); });
 
-    RegisterComponent<PerceptionComponent>(
-        "PerceptionComponent", HasPerception, [](Entity &e, const YAML::Node &node)
-        { e.AddComponent<PerceptionComponent>(eastl::move(GetPerception(node))); },
-        [](Entity &e, YAML::Emitter &out) { Serializer::Perception(e, out); });
+    RegisterDataComponent<PerceptionComponent>("PerceptionComponent", HasPerception, GetPerception,
+                                               [](Entity &e, YAML::Emitter &out) { Serializer::Perception(e, out); });
 
-    RegisterComponent<PrefabComponent>(
-        "PrefabComponent", HasPrefab,
-        [](Entity &e, const YAML::Node &node) { e.AddComponent<PrefabComponent>(eastl::move(GetPrefab(node))); },
-        [](Entity &e, YAML::Emitter &out) { Serializer::Prefab(e, out); });
+    RegisterDataComponent<PrefabComponent>("PrefabComponent", HasPrefab, GetPrefab,
+                                           [](Entity &e, YAML::Emitter &out) { Serializer::Prefab(e, out); });
 }
 } // namespace Blainn
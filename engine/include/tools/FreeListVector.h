@@ -3,7 +3,12 @@
 
 #pragma once
 
-#include <pch.h>
+#include <EASTL/algorithm.h>
+#include <EASTL/deque.h>
+#include <EASTL/vector.h>
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
 
 namespace Blainn
 {
@@ -13,7 +18,8 @@ namespace Blainn
  * @details Vector can look like [10, 13, 5, 4, empty, 3, empty, 12].
  * Deque will contain indexes of all empty items - 4 and 6 in this case.
  * This container designed for Asset Manager to prevent vector defragmentation after assets being deleted.
- * @tparam T items class
+ * Erased items are reset to T(), every slot has a generation that is bumped on erase to detect stale indices.
+ * @tparam T items class, default constructible
  */
 template <typename T> class FreeListVector
 {
@@ -30,6 +36,7 @@ public:
     void erase(eastl::vector<T>::iterator it);
 
     bool is_occupied(size_t index);
+    uint32_t generation(size_t index) const;
     size_t next_free_index() const;
     size_t size() const;
     size_t actual_size() const;
@@ -61,6 +68,7 @@ public:
 
 private:
     eastl::vector<T> m_data;
+    eastl::vector<uint32_t> m_generations;
     eastl::deque<unsigned int> m_freeList;
 };
 
@@ -68,6 +76,7 @@ private:
 template <typename T>
 FreeListVector<T>::FreeListVector(unsigned int count)
     : m_data(count)
+    , m_generations(count, 0u)
 {
 }
 
@@ -75,6 +84,7 @@ FreeListVector<T>::FreeListVector(unsigned int count)
 template <typename T>
 FreeListVector<T>::FreeListVector(unsigned int count, const T &value)
     : m_data(count, value)
+    , m_generations(count, 0u)
 {
 }
 
@@ -82,6 +92,7 @@ FreeListVector<T>::FreeListVector(unsigned int count, const T &value)
 template <typename T>
 FreeListVector<T>::FreeListVector(std::initializer_list<T> init)
     : m_data(init)
+    , m_generations(m_data.size(), 0u)
 {
 }
 
@@ -92,11 +103,13 @@ template <typename T> template <typename... Args> size_t FreeListVector<T>::empl
     {
         size_t freeIndex = m_freeList.front();
         m_freeList.pop_front();
-        new (&m_data[freeIndex]) T(eastl::forward<Args>(args)...);
+        m_data[freeIndex] = T(eastl::forward<Args>(args)...);
         return freeIndex;
     }
 
     m_data.emplace_back(eastl::forward<Args>(args)...);
+    // generations outlive clear(), a slot recreated after it keeps counting
+    if (m_generations.size() < m_data.size()) m_generations.push_back(0u);
     return m_data.size() - 1;
 }
 
@@ -117,7 +130,8 @@ template <typename T> void FreeListVector<T>::erase(size_t index)
 {
     if (index < m_data.size())
     {
-        m_data[index].~T();
+        m_data[index] = T();
+        ++m_generations[index];
         m_freeList.push_back(static_cast<unsigned int>(index));
     }
 }
@@ -141,6 +155,15 @@ template <typename T> bool FreeListVector<T>::is_occupied(size_t index)
 }
 
 
+/**
+ * @return generation of the slot, changes every time the item in it is erased
+ */
+template <typename T> uint32_t FreeListVector<T>::generation(size_t index) const
+{
+    return index < m_generations.size() ? m_generations[index] : 0u;
+}
+
+
 template <typename T> size_t FreeListVector<T>::next_free_index() const
 {
     if (!m_freeList.empty()) return m_freeList.front();
@@ -182,7 +205,7 @@ template <typename T> bool FreeListVector<T>::empty() const
 template <typename T> void FreeListVector<T>::clear()
 {
     for (size_t i = 0; i < m_data.size(); ++i)
-        if (is_occupied(i)) m_data[i].~T();
+        ++m_generations[i];
 
     m_data.clear();
     m_freeList.clear();
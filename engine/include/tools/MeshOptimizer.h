@@ -0,0 +1,53 @@
+#pragma once
+
+#include <EASTL/vector.h>
+#include <cstddef>
+#include <cstdint>
+
+namespace Blainn
+{
+/**
+ * @brief CPU only reordering of indexed triangle lists, used by the model import.
+ * @details All functions work on one mesh with indices in [0, vertexCount).
+ * Recommended order: OptimizeVertexCache, OptimizeOverdraw, OptimizeVertexFetch.
+ */
+class MeshOptimizer
+{
+public:
+    struct VertexCacheStatistics
+    {
+        // average cache miss ratio, transformed vertices per triangle. 0.5 is the best case for large meshes, 3 the worst
+        float ACMR = 0.0f;
+        // average transform to vertex ratio, 1 is optimal
+        float ATVR = 0.0f;
+    };
+
+    /// @brief simulates a FIFO post-transform cache of cacheSize entries
+    static VertexCacheStatistics AnalyzeVertexCache(const uint32_t *indices, size_t indexCount, size_t vertexCount,
+                                                    uint32_t cacheSize = 16u);
+
+    /// @brief reorders triangles for post-transform cache hits (Tom Forsyth, "Linear-Speed Vertex Cache Optimisation")
+    static void OptimizeVertexCache(uint32_t *indices, size_t indexCount, size_t vertexCount);
+
+    /// @brief reorders clusters of the cache optimized order so outward facing ones are drawn first.
+    /// Clusters are split only where the cache restarts anyway, so ACMR is kept.
+    static void OptimizeOverdraw(uint32_t *indices, size_t indexCount, const float *positions, size_t vertexCount,
+                                 size_t positionStride);
+
+    /// @brief reorders vertices in order of first use and remaps indices.
+    /// Unreferenced vertices are kept after the referenced ones, returns the referenced count.
+    static size_t OptimizeVertexFetch(void *vertices, uint32_t *indices, size_t indexCount, size_t vertexCount,
+                                      size_t vertexStride);
+
+    /// @brief quadric edge collapse simplification, writes a reduced index list that reuses the input vertices.
+    /// Stops at targetIndexCount or when the next collapse would move the surface further than targetError,
+    /// both in mesh units. Border vertices are never moved, attribute seam vertices only along their seam so both
+    /// sides keep their own vertices.
+    /// @param destination has room for indexCount indices
+    /// @param outResultError largest error of the applied collapses, in mesh units
+    /// @return index count written to destination
+    static size_t Simplify(uint32_t *destination, const uint32_t *indices, size_t indexCount, const float *positions,
+                           size_t vertexCount, size_t positionStride, size_t targetIndexCount, float targetError,
+                           float *outResultError = nullptr);
+};
+} // namespace Blainn
@@ -11,18 +11,22 @@
 
 #include <windowsx.h>
 
+#include <chrono>
+
 #include "Input/InputSubsystem.h"
 #include "Input/KeyboardEvents.h"
 #include "Input/MouseEvents.h"
 #include "Navigation/NavigationSubsystem.h"
 #include "Render/UI/UIRenderer.h"
 #include "aliases.h"
+#include "file-system/DerivedDataCache.h"
 #include "scene/Scene.h"
 #include "subsystems/AISubsystem.h"
 #include "subsystems/AssetManager.h"
 #include "subsystems/Log.h"
 #include "subsystems/PerceptionSubsystem.h"
 #include "subsystems/PhysicsSubsystem.h"
+#include "subsystems/PrefabSubsystem.h"
 #include "subsystems/RenderSubsystem.h"
 #include "subsystems/ScriptingSubsystem.h"
 #include "tools/Profiler.h"
@@ -63,6 +67,36 @@ void Engine::Init(Timeline<eastl::chrono::milliseconds> &globalTimeline)
 #endif
 }
 
+bool Engine::Cook(const eastl::string &command)
+{
+    Log::Init();
+    SetDefaultContentDirectory();
+
+    AssetLoader loader;
+    loader.Init();
+
+    bool isKnownCommand = true;
+    if (command == "--cook-meshes")
+    {
+        // reports Assimp import vs cooked load times
+        loader.CookModels(GetContentDirectory());
+    }
+    else if (command == "--cook-materials")
+    {
+        loader.CookMaterials(GetContentDirectory());
+    }
+    else
+    {
+        BF_ERROR("Engine Cook: unknown command {0}", command.c_str());
+        isKnownCommand = false;
+    }
+
+    // saves the source hashes the cook computed
+    loader.Destroy();
+    Log::Destroy();
+    return isKnownCommand;
+}
+
 void Engine::InitAISubsystem()
 {
     PerceptionSubsystem::Settings perceptionSettings;
@@ -125,6 +159,9 @@ void Engine::Destroy()
     AISubsystem::GetInstance().Destroy();
     PerceptionSubsystem::GetInstance().Destroy();
     ScriptingSubsystem::Destroy();
+    PrefabSubsystem::GetInstance().Destroy();
+    // snapshot values hold asset handles too
+    s_playModeSnapshots.clear();
     AssetManager::GetInstance().Destroy();
 
     RenderSubsystem::GetInstance().Destroy();
@@ -148,6 +185,9 @@ void Engine::Update(float deltaTime)
 
     Input::ProcessEvents();
 
+    // streamed assets are published before anything reads them this frame
+    AssetManager::GetInstance().Update();
+
     float playModeDelta = s_playModeTimeline.Tick() / 1000.0f;
 
     if (s_isPlayMode && !s_playModePaused)
@@ -188,7 +228,14 @@ void Engine::StartPlayMode()
     if (s_isPlayMode) return;
     if (!s_sceneManager.GetActiveScene()) return;
 
-    s_sceneManager.GetActiveScene()->SaveScene();
+    // the one barrier for everything the scene open queued, play mode never starts on placeholders
+    AssetManager::GetInstance().FlushStreaming();
+
+    // kept in memory instead of saving the scene, EscapePlayMode puts it back without a reload
+    s_playModeSnapshots.clear();
+    for (auto &scene : s_sceneManager.GetActiveScenes())
+        s_playModeSnapshots[scene->GetSceneID()].Capture(*scene);
+    PhysicsSubsystem::SaveBodyStates();
 
     InitScenePlayMode();
 }
@@ -215,13 +262,69 @@ void Engine::EscapePlayMode()
         s_sceneManager.EndPlayMode();
     }
 
-    AssetManager::GetInstance().OpenScene(s_startPlayModeSceneName.c_str());
+    if (!RestorePlayModeSnapshots())
+    {
+        BF_WARN("Scenes were opened during play mode, rebuilding {0} from its snapshot",
+                s_startPlayModeSceneName.c_str());
+        RebuildStartScene();
+    }
+    s_playModeSnapshots.clear();
 
     s_isPlayMode = false;
     AssetManager::GetInstance().ResetTextures();
 }
 
 
+bool Engine::RestorePlayModeSnapshots()
+{
+    BLAINN_PROFILE_FUNC();
+    using Clock = std::chrono::steady_clock;
+    const auto start = Clock::now();
+
+    auto &scenes = s_sceneManager.GetActiveScenes();
+    bool isSameScenes = scenes.size() == s_playModeSnapshots.size();
+    for (auto &scene : scenes)
+        isSameScenes = isSameScenes && s_playModeSnapshots.find(scene->GetSceneID()) != s_playModeSnapshots.end();
+    if (!isSameScenes) return false;
+
+    // no script runs while entities are put back
+    for (auto &scene : scenes)
+        ScriptingSubsystem::UnloadAllScripts(*scene);
+
+    bool areBodiesKept = true;
+    for (auto &scene : scenes)
+    {
+        SceneSnapshot &snapshot = s_playModeSnapshots[scene->GetSceneID()];
+        snapshot.Restore(*scene);
+        areBodiesKept = areBodiesKept && snapshot.AreBodiesKept();
+    }
+
+    // saved body ids only match while no body was rebuilt
+    if (!areBodiesKept || !PhysicsSubsystem::RestoreBodyStates()) PhysicsSubsystem::ResetBodies();
+    PhysicsSubsystem::StopSimulation();
+
+    BF_INFO("Play mode state restored in {0:.2f} ms",
+            std::chrono::duration<double, std::milli>(Clock::now() - start).count());
+    return true;
+}
+
+
+void Engine::RebuildStartScene()
+{
+    BLAINN_PROFILE_FUNC();
+
+    // the snapshot holds asset handles of its components, nothing it uses is unloaded in between
+    NavigationSubsystem::ClearNavMesh();
+    s_sceneManager.CloseScenes();
+    s_sceneManager.OpenScene(s_startPlayModeSceneName, s_startPlayModeSceneId,
+                             s_playModeSnapshots[s_startPlayModeSceneId]);
+
+    // every body is new, the saved states belong to the closed scenes
+    PhysicsSubsystem::ResetBodies();
+    PhysicsSubsystem::StopSimulation();
+}
+
+
 bool Engine::IsPlayMode()
 {
     return s_isPlayMode;
@@ -239,7 +342,11 @@ void Engine::InitScenePlayMode()
 
     s_sceneManager.StartPlayMode();
 
-    if (s_sceneManager.GetActiveScene()) s_startPlayModeSceneName = s_sceneManager.GetActiveScene()->GetName();
+    if (s_sceneManager.GetActiveScene())
+    {
+        s_startPlayModeSceneName = s_sceneManager.GetActiveScene()->GetName();
+        s_startPlayModeSceneId = s_sceneManager.GetActiveScene()->GetSceneID();
+    }
 
     s_playModeTimeline.Reset();
     s_playModeTimeline.Start();
@@ -280,6 +387,7 @@ Path &Engine::GetContentDirectory()
 void Engine::SetContentDirectory(const Path &contentDirectory)
 {
     s_contentDirectory = contentDirectory;
+    DerivedDataCache::SetContentDirectory(contentDirectory);
 }
 
 
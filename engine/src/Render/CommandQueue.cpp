@@ -155,6 +155,12 @@ void Blainn::CommandQueue::ExecuteCommandList(ComPtr<ID3D12GraphicsCommandList2>
     }
 }
 
+void Blainn::CommandQueue::ExecuteCommandLists(ID3D12CommandList *const *ppCommandLists, UINT count)
+{
+    BLAINN_PROFILE_FUNC();
+    m_commandQueue->ExecuteCommandLists(count, ppCommandLists);
+}
+
 ComPtr<ID3D12CommandQueue> Blainn::CommandQueue::GetCommandQueue() const
 {
     return m_commandQueue;
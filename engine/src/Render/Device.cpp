@@ -181,6 +181,14 @@ HRESULT Blainn::Device::CreateCommandAllocator(D3D12_COMMAND_LIST_TYPE commandLi
     return m_device->CreateCommandAllocator(commandListType, IID_PPV_ARGS(commandAllocator.GetAddressOf()));
 }
 
+HRESULT Blainn::Device::CreateCommandList(D3D12_COMMAND_LIST_TYPE commandListType, ID3D12CommandAllocator *pCommandAllocator, ComPtr<ID3D12GraphicsCommandList2>& commandList)
+{
+    HRESULT hr = m_device->CreateCommandList(0u, commandListType, pCommandAllocator, nullptr, IID_PPV_ARGS(commandList.GetAddressOf()));
+    if (FAILED(hr)) return hr;
+
+    return commandList->Close();
+}
+
 HRESULT Blainn::Device::CreateDescriptorHeap(D3D12_DESCRIPTOR_HEAP_TYPE heapType, UINT numDescriptors,
                                              ComPtr<ID3D12DescriptorHeap> &descriptorHeap,
                                              D3D12_DESCRIPTOR_HEAP_FLAGS flags/* = D3D12_DESCRIPTOR_HEAP_FLAG_NONE*/, UINT nodeMask/*= 0u*/)
@@ -0,0 +1,101 @@
+#include "Render/DrawList.h"
+
+namespace Blainn
+{
+namespace
+{
+constexpr uint64_t FieldMask(uint32_t bits)
+{
+    return (uint64_t(1) << bits) - 1u;
+}
+} // namespace
+
+uint64_t DrawSortKey::Make(uint32_t pass, uint32_t pipeline, uint32_t material, uint32_t mesh, uint32_t depth)
+{
+    uint64_t key = pass & FieldMask(PassBits);
+    key = (key << PipelineBits) | (pipeline & FieldMask(PipelineBits));
+    key = (key << MaterialBits) | (material & FieldMask(MaterialBits));
+    key = (key << MeshBits) | (mesh & FieldMask(MeshBits));
+    key = (key << DepthBits) | (depth & FieldMask(DepthBits));
+    return key;
+}
+
+uint32_t DrawSortKey::QuantizeDepth(float viewDepth, float farZ)
+{
+    if (!(viewDepth > 0.0f) || !(farZ > 0.0f)) return 0u;
+
+    const float maxValue = static_cast<float>(FieldMask(DepthBits));
+    const float normalized = viewDepth < farZ ? viewDepth / farZ : 1.0f;
+    return static_cast<uint32_t>(normalized * maxValue);
+}
+
+void DrawList::Clear()
+{
+    m_items.clear();
+    m_batches.clear();
+}
+
+void DrawList::Reserve(size_t count)
+{
+    m_items.reserve(count);
+    m_sortScratch.reserve(count);
+}
+
+void DrawList::Add(uint64_t key, uint32_t index)
+{
+    m_items.push_back({key, index});
+}
+
+void DrawList::Sort()
+{
+    if (m_items.size() < 2u) return;
+
+    // bytes that are the same in every key do not change the order
+    uint64_t keyOr = 0u;
+    uint64_t keyAnd = ~uint64_t(0);
+    for (const Item &item : m_items)
+    {
+        keyOr |= item.Key;
+        keyAnd &= item.Key;
+    }
+    const uint64_t varyingBits = keyOr ^ keyAnd;
+
+    m_sortScratch.resize(m_items.size());
+    for (uint32_t shift = 0u; shift < 64u; shift += 8u)
+    {
+        if (((varyingBits >> shift) & 0xffu) == 0u) continue;
+
+        uint32_t offsets[256] = {};
+        for (const Item &item : m_items)
+            ++offsets[(item.Key >> shift) & 0xffu];
+
+        uint32_t sum = 0u;
+        for (uint32_t &offset : offsets)
+        {
+            const uint32_t count = offset;
+            offset = sum;
+            sum += count;
+        }
+
+        for (const Item &item : m_items)
+            m_sortScratch[offsets[(item.Key >> shift) & 0xffu]++] = item;
+        m_items.swap(m_sortScratch);
+    }
+}
+
+void DrawList::BuildBatches(uint32_t maxInstances)
+{
+    m_batches.clear();
+    if (maxInstances == 0u) return;
+
+    for (uint32_t i = 0u; i < m_items.size(); ++i)
+    {
+        const bool startsBatch = m_batches.empty()
+                                 || m_batches.back().ItemCount == maxInstances
+                                 || DrawSortKey::GetBatchKey(m_items[i].Key)
+                                        != DrawSortKey::GetBatchKey(m_items[i - 1u].Key);
+        if (startsBatch) m_batches.push_back({i, 0u});
+        ++m_batches.back().ItemCount;
+    }
+}
+} // namespace Blainn
@@ -1,14 +1,21 @@
 #include "Render/FrameResource.h"
 #include "Render/Device.h"
 
-Blainn::FrameResource::FrameResource(Device &device, UINT passCount, UINT materialCount, UINT maxNumPointLights, UINT maxNumSpotLights)
+Blainn::FrameResource::FrameResource(Device &device, UINT passCount, UINT materialCount, UINT maxNumPointLights, UINT maxNumSpotLights, UINT64 uploadBufferSize, UINT commandListCount)
 {
-    ThrowIfFailed(device.CreateCommandAllocator(D3D12_COMMAND_LIST_TYPE_DIRECT, commandAllocator));
+    CommandAllocators.resize(commandListCount);
+    CommandLists.resize(commandListCount);
+    for (UINT i = 0; i < commandListCount; i++)
+    {
+        ThrowIfFailed(device.CreateCommandAllocator(D3D12_COMMAND_LIST_TYPE_DIRECT, CommandAllocators[i]));
+        ThrowIfFailed(device.CreateCommandList(D3D12_COMMAND_LIST_TYPE_DIRECT, CommandAllocators[i].Get(), CommandLists[i]));
+    }
 
     PassCB = eastl::make_unique<UploadBuffer<PassConstants>>(device.GetDevice2().Get(), passCount, TRUE);
     MaterialSB = eastl::make_unique<UploadBuffer<MaterialData>>(device.GetDevice2().Get(), materialCount, FALSE);                 // Structured buffer 
     PointLightSB = eastl::make_unique<UploadBuffer<PointLightInstanceData>>(device.GetDevice2().Get(), maxNumPointLights, FALSE); // Structured buffer
     SpotLightSB = eastl::make_unique<UploadBuffer<SpotLightInstanceData>>(device.GetDevice2().Get(), maxNumSpotLights, FALSE);    // Structured buffer
+    FrameUploadBuffer = eastl::make_unique<LinearUploadBuffer>(device.GetDevice2().Get(), uploadBufferSize);
 }
 
 Blainn::FrameResource::~FrameResource()
@@ -40,6 +40,14 @@ ComPtr<ID3D12Resource> Blainn::FreyaUtil::CreateDefaultBuffer(ID3D12Device* devi
     subResourceData.RowPitch = byteSize;                    // For buffers the size of the data we are copying in bytes.
     subResourceData.SlicePitch = subResourceData.RowPitch;  // For buffers the size of the data we are copying in bytes.
 
+    // Copy lists only know copy states. Buffers are promoted to COPY_DEST there, decay back to COMMON
+    // once the copy is done and get promoted to whatever state the direct queue reads them in.
+    if (cmdList->GetType() == D3D12_COMMAND_LIST_TYPE_COPY)
+    {
+        UpdateSubresources<1>(cmdList, defaultBuffer.Get(), uploadBuffer.Get(), 0, 0u, 1u, &subResourceData);
+        return defaultBuffer;
+    }
+
     auto transition = CD3DX12_RESOURCE_BARRIER::Transition(defaultBuffer.Get(), D3D12_RESOURCE_STATE_COMMON, D3D12_RESOURCE_STATE_COPY_DEST);
     // Schedule to copy the data to the default buffer resource. At a high level, the helper function UpdateSubresources will copy the CPU memory
     // into the intermediate upload heap. Then, using ID3D12CommandList::CopySubresourceRegion, the intermediate upload heap data will be copied to mBuffer.
@@ -0,0 +1,152 @@
+#include "Render/FrustumCuller.h"
+
+#include <cfloat>
+#include <cmath>
+
+#if defined(_M_X64) || defined(_M_AMD64) || defined(__SSE2__)
+#define BLAINN_CULLING_SSE
+#include <emmintrin.h>
+#endif
+
+namespace Blainn
+{
+namespace
+{
+// padding spheres: -radius is +FLT_MAX, so every plane rejects them
+constexpr float kPaddingRadius = -FLT_MAX;
+
+#ifdef BLAINN_CULLING_SSE
+// lanes set where the four spheres intersect the frustum
+__m128 IntersectMask(const FrustumPlanes &frustum, __m128 x, __m128 y, __m128 z, __m128 negRadius)
+{
+    __m128 outside = _mm_setzero_ps();
+    for (const auto &plane : frustum.Planes)
+    {
+        __m128 distance = _mm_add_ps(_mm_mul_ps(x, _mm_set1_ps(plane[0])), _mm_mul_ps(y, _mm_set1_ps(plane[1])));
+        distance = _mm_add_ps(distance, _mm_mul_ps(z, _mm_set1_ps(plane[2])));
+        distance = _mm_add_ps(distance, _mm_set1_ps(plane[3]));
+        outside = _mm_or_ps(outside, _mm_cmplt_ps(distance, negRadius));
+    }
+    return _mm_andnot_ps(outside, _mm_castsi128_ps(_mm_set1_epi32(-1)));
+}
+#else
+bool Intersects(const FrustumPlanes &frustum, float x, float y, float z, float radius)
+{
+    for (const auto &plane : frustum.Planes)
+    {
+        if (plane[0] * x + plane[1] * y + plane[2] * z + plane[3] < -radius) return false;
+    }
+    return true;
+}
+#endif
+} // namespace
+
+FrustumPlanes FrustumPlanes::FromViewProjection(const float (&m)[4][4])
+{
+    // clip = p * m, every clip coordinate is a dot product with a column of m
+    FrustumPlanes frustum;
+    for (int r = 0; r < 4; ++r)
+    {
+        frustum.Planes[0][r] = m[r][3] + m[r][0]; // left   w + x >= 0
+        frustum.Planes[1][r] = m[r][3] - m[r][0]; // right  w - x >= 0
+        frustum.Planes[2][r] = m[r][3] + m[r][1]; // bottom w + y >= 0
+        frustum.Planes[3][r] = m[r][3] - m[r][1]; // top    w - y >= 0
+        frustum.Planes[4][r] = m[r][2];           // near   z >= 0
+        frustum.Planes[5][r] = m[r][3] - m[r][2]; // far    w - z >= 0
+    }
+
+    for (auto &plane : frustum.Planes)
+    {
+        const float length = sqrtf(plane[0] * plane[0] + plane[1] * plane[1] + plane[2] * plane[2]);
+        if (length <= 0.0f) continue;
+        for (float &value : plane)
+            value /= length;
+    }
+    return frustum;
+}
+
+void FrustumPlanes::DisableNearPlane()
+{
+    // a zero plane only rejects the padding spheres
+    for (float &value : Planes[4])
+        value = 0.0f;
+}
+
+void FrustumCuller::Clear()
+{
+    m_centerX.clear();
+    m_centerY.clear();
+    m_centerZ.clear();
+    m_radius.clear();
+    m_count = 0u;
+}
+
+void FrustumCuller::Reserve(size_t count)
+{
+    const size_t padded = (count + 3u) & ~size_t(3u);
+    m_centerX.reserve(padded);
+    m_centerY.reserve(padded);
+    m_centerZ.reserve(padded);
+    m_radius.reserve(padded);
+}
+
+uint32_t FrustumCuller::AddSphere(float centerX, float centerY, float centerZ, float radius)
+{
+    if (m_count % 4u == 0u)
+    {
+        // start a new block of four
+        m_centerX.resize(m_count + 4u, 0.0f);
+        m_centerY.resize(m_count + 4u, 0.0f);
+        m_centerZ.resize(m_count + 4u, 0.0f);
+        m_radius.resize(m_count + 4u, kPaddingRadius);
+    }
+
+    m_centerX[m_count] = centerX;
+    m_centerY[m_count] = centerY;
+    m_centerZ[m_count] = centerZ;
+    m_radius[m_count] = radius;
+    return static_cast<uint32_t>(m_count++);
+}
+
+void FrustumCuller::Cull(const FrustumPlanes &frustum, eastl::vector<uint32_t> &outVisible) const
+{
+    CullAny(&frustum, 1u, outVisible);
+}
+
+void FrustumCuller::CullAny(const FrustumPlanes *frustums, size_t frustumCount,
+                            eastl::vector<uint32_t> &outVisible) const
+{
+    for (size_t block = 0u; block < m_count; block += 4u)
+    {
+#ifdef BLAINN_CULLING_SSE
+        const __m128 x = _mm_loadu_ps(&m_centerX[block]);
+        const __m128 y = _mm_loadu_ps(&m_centerY[block]);
+        const __m128 z = _mm_loadu_ps(&m_centerZ[block]);
+        const __m128 negRadius = _mm_sub_ps(_mm_setzero_ps(), _mm_loadu_ps(&m_radius[block]));
+
+        __m128 visible = _mm_setzero_ps();
+        for (size_t f = 0u; f < frustumCount; ++f)
+            visible = _mm_or_ps(visible, IntersectMask(frustums[f], x, y, z, negRadius));
+
+        const int mask = _mm_movemask_ps(visible);
+        for (uint32_t lane = 0u; lane < 4u; ++lane)
+        {
+            if (mask & (1 << lane)) outVisible.push_back(static_cast<uint32_t>(block) + lane);
+        }
+#else
+        const size_t blockEnd = block + 4u < m_count ? block + 4u : m_count;
+        for (size_t i = block; i < blockEnd; ++i)
+        {
+            for (size_t f = 0u; f < frustumCount; ++f)
+            {
+                if (Intersects(frustums[f], m_centerX[i], m_centerY[i], m_centerZ[i], m_radius[i]))
+                {
+                    outVisible.push_back(static_cast<uint32_t>(i));
+                    break;
+                }
+            }
+        }
+#endif
+    }
+}
+} // namespace Blainn
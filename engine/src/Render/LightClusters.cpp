@@ -0,0 +1,161 @@
+#include "Render/LightClusters.h"
+
+#include <EASTL/algorithm.h>
+#include <cmath>
+
+namespace Blainn
+{
+namespace
+{
+constexpr uint32_t kSpotLightBit = 1u << 31u;
+
+// index of the tile an ndc coordinate falls into, counted from ndc -1
+uint32_t NdcToTile(float ndc, uint32_t tileCount)
+{
+    const float tile = floorf((ndc * 0.5f + 0.5f) * static_cast<float>(tileCount));
+    return static_cast<uint32_t>(eastl::clamp(tile, 0.0f, static_cast<float>(tileCount - 1u)));
+}
+
+// distance from value to [rangeMin, rangeMax], 0 inside
+float DistanceToRange(float value, float rangeMin, float rangeMax)
+{
+    return eastl::max(rangeMin - value, 0.0f) + eastl::max(value - rangeMax, 0.0f);
+}
+} // namespace
+
+void LightClusterGrid::Build(const LightClusterGridDesc &desc, const LightBounds *pointLights, uint32_t pointCount,
+                             const LightBounds *spotLights, uint32_t spotCount)
+{
+    m_desc = desc;
+    const uint32_t clusterCount = desc.CountX * desc.CountY * desc.CountZ;
+
+    m_sliceDepths.resize(desc.CountZ + 1u);
+    for (uint32_t slice = 0; slice <= desc.CountZ; ++slice)
+    {
+        const float t = static_cast<float>(slice) / static_cast<float>(desc.CountZ);
+        m_sliceDepths[slice] = desc.NearZ * powf(desc.FarZ / desc.NearZ, t);
+    }
+
+    m_entries.clear();
+    m_visibleLightCount = 0u;
+    // points first, so they come first in every cluster
+    for (uint32_t i = 0; i < pointCount; ++i)
+        BinLight(pointLights[i], i);
+    for (uint32_t i = 0; i < spotCount; ++i)
+        BinLight(spotLights[i], i | kSpotLightBit);
+
+    // counting sort by cluster, keeps binning order inside a cluster
+    m_clusters.assign(clusterCount, LightCluster{0u, 0u, 0u, 0u});
+    for (uint64_t entry : m_entries)
+    {
+        auto &cluster = m_clusters[static_cast<uint32_t>(entry >> 32u)];
+        if (static_cast<uint32_t>(entry) & kSpotLightBit)
+            ++cluster.SpotCount;
+        else
+            ++cluster.PointCount;
+    }
+
+    uint32_t offset = 0u;
+    for (auto &cluster : m_clusters)
+    {
+        cluster.Offset = offset;
+        offset += cluster.PointCount + cluster.SpotCount;
+    }
+
+    // Pad counts written lights while filling
+    m_lightIndices.resize(m_entries.size());
+    for (uint64_t entry : m_entries)
+    {
+        auto &cluster = m_clusters[static_cast<uint32_t>(entry >> 32u)];
+        m_lightIndices[cluster.Offset + cluster.Pad++] = static_cast<uint32_t>(entry) & ~kSpotLightBit;
+    }
+    for (auto &cluster : m_clusters)
+        cluster.Pad = 0u;
+}
+
+float LightClusterGrid::GetDepthSliceScale() const
+{
+    return static_cast<float>(m_desc.CountZ) / logf(m_desc.FarZ / m_desc.NearZ);
+}
+
+float LightClusterGrid::GetDepthSliceBias() const
+{
+    return GetDepthSliceScale() * logf(m_desc.NearZ);
+}
+
+uint32_t LightClusterGrid::GetSlice(float viewZ) const
+{
+    const float slice = floorf(logf(viewZ) * GetDepthSliceScale() - GetDepthSliceBias());
+    return static_cast<uint32_t>(eastl::clamp(slice, 0.0f, static_cast<float>(m_desc.CountZ - 1u)));
+}
+
+void LightClusterGrid::BinLight(const LightBounds &light, uint32_t lightIndex)
+{
+    if (!(light.Radius > 0.0f)) return;
+
+    float zMin = light.Z - light.Radius;
+    float zMax = light.Z + light.Radius;
+    if (zMax < m_desc.NearZ || zMin > m_desc.FarZ) return;
+    zMin = eastl::max(zMin, m_desc.NearZ);
+    zMax = eastl::min(zMax, m_desc.FarZ);
+
+    // x / z and y / z are monotonic in each coordinate over the bounding box, its projection is spanned by corners
+    const float left = light.X - light.Radius;
+    const float right = light.X + light.Radius;
+    const float bottom = light.Y - light.Radius;
+    const float top = light.Y + light.Radius;
+    const float ndcLeft = eastl::min(left / zMin, left / zMax) * m_desc.ProjScaleX;
+    const float ndcRight = eastl::max(right / zMin, right / zMax) * m_desc.ProjScaleX;
+    const float ndcBottom = eastl::min(bottom / zMin, bottom / zMax) * m_desc.ProjScaleY;
+    const float ndcTop = eastl::max(top / zMin, top / zMax) * m_desc.ProjScaleY;
+    if (ndcRight < -1.0f || ndcLeft > 1.0f || ndcTop < -1.0f || ndcBottom > 1.0f) return;
+
+    const uint32_t firstX = NdcToTile(ndcLeft, m_desc.CountX);
+    const uint32_t lastX = NdcToTile(ndcRight, m_desc.CountX);
+    // rows are counted from the top of the screen, like SV_Position
+    const uint32_t firstY = NdcToTile(-ndcTop, m_desc.CountY);
+    const uint32_t lastY = NdcToTile(-ndcBottom, m_desc.CountY);
+    const uint32_t firstSlice = GetSlice(zMin);
+    const uint32_t lastSlice = GetSlice(zMax);
+
+    const float tileNdcX = 2.0f / static_cast<float>(m_desc.CountX);
+    const float tileNdcY = 2.0f / static_cast<float>(m_desc.CountY);
+    const float radiusSq = light.Radius * light.Radius;
+    bool isVisible = false;
+
+    // exact sphere test against the view space box of every candidate cluster
+    for (uint32_t slice = firstSlice; slice <= lastSlice; ++slice)
+    {
+        const float sliceNear = m_sliceDepths[slice];
+        const float sliceFar = m_sliceDepths[slice + 1u];
+        const float dz = DistanceToRange(light.Z, sliceNear, sliceFar);
+
+        for (uint32_t y = firstY; y <= lastY; ++y)
+        {
+            const float ndcRowTop = 1.0f - tileNdcY * static_cast<float>(y);
+            const float ndcRowBottom = ndcRowTop - tileNdcY;
+            const float rowMin = eastl::min(ndcRowBottom * sliceNear, ndcRowBottom * sliceFar) / m_desc.ProjScaleY;
+            const float rowMax = eastl::max(ndcRowTop * sliceNear, ndcRowTop * sliceFar) / m_desc.ProjScaleY;
+            const float dy = DistanceToRange(light.Y, rowMin, rowMax);
+
+            for (uint32_t x = firstX; x <= lastX; ++x)
+            {
+                const float ndcColumnLeft = tileNdcX * static_cast<float>(x) - 1.0f;
+                const float ndcColumnRight = ndcColumnLeft + tileNdcX;
+                const float columnMin =
+                    eastl::min(ndcColumnLeft * sliceNear, ndcColumnLeft * sliceFar) / m_desc.ProjScaleX;
+                const float columnMax =
+                    eastl::max(ndcColumnRight * sliceNear, ndcColumnRight * sliceFar) / m_desc.ProjScaleX;
+                const float dx = DistanceToRange(light.X, columnMin, columnMax);
+
+                if (dx * dx + dy * dy + dz * dz > radiusSq) continue;
+
+                m_entries.push_back((static_cast<uint64_t>(GetClusterIndex(x, y, slice)) << 32u) | lightIndex);
+                isVisible = true;
+            }
+        }
+    }
+
+    if (isVisible) ++m_visibleLightCount;
+}
+} // namespace Blainn
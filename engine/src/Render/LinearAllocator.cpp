@@ -0,0 +1,29 @@
+#include "Render/LinearAllocator.h"
+
+namespace Blainn
+{
+LinearAllocator::LinearAllocator(uint8_t *cpuBase, uint64_t gpuBase, uint64_t capacity)
+    : m_cpuBase(cpuBase)
+    , m_gpuBase(gpuBase)
+    , m_capacity(cpuBase ? capacity : 0u)
+{
+}
+
+LinearAllocator::Allocation LinearAllocator::Allocate(uint64_t byteSize, uint64_t alignment)
+{
+    // compared as remaining space, sizes and alignments near UINT64_MAX must not wrap into a valid range
+    if (alignment - 1u > m_capacity - m_offset) return {};
+    const uint64_t alignedOffset = (m_offset + alignment - 1u) & ~(alignment - 1u);
+    if (byteSize > m_capacity - alignedOffset) return {};
+
+    m_offset = alignedOffset + byteSize;
+    if (m_offset > m_peakOffset) m_peakOffset = m_offset;
+
+    return {m_cpuBase + alignedOffset, m_gpuBase + alignedOffset, alignedOffset};
+}
+
+void LinearAllocator::Reset()
+{
+    m_offset = 0u;
+}
+} // namespace Blainn
@@ -0,0 +1,56 @@
+#include "Render/LinearUploadBuffer.h"
+
+namespace Blainn
+{
+LinearUploadBuffer::LinearUploadBuffer(ID3D12Device2 *device, uint64_t byteSize)
+{
+    auto uploadHeap = CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_UPLOAD);
+    auto buffer = CD3DX12_RESOURCE_DESC::Buffer(byteSize);
+
+    if (FAILED(device->CreateCommittedResource(&uploadHeap, D3D12_HEAP_FLAG_NONE, &buffer,
+                                               D3D12_RESOURCE_STATE_GENERIC_READ, nullptr,
+                                               IID_PPV_ARGS(&m_uploadBuffer))))
+    {
+        BF_ERROR("Failed to create linear upload buffer.");
+        return;
+    }
+
+    uint8_t *mappedData = nullptr;
+    if (FAILED(m_uploadBuffer->Map(0, nullptr, reinterpret_cast<void **>(&mappedData))))
+    {
+        BF_ERROR("Failed to map linear upload buffer.");
+        return;
+    }
+
+    m_allocator = LinearAllocator(mappedData, m_uploadBuffer->GetGPUVirtualAddress(), byteSize);
+    m_isValid = true;
+}
+
+LinearUploadBuffer::~LinearUploadBuffer()
+{
+    if (m_isValid) m_uploadBuffer->Unmap(0, nullptr);
+}
+
+void LinearUploadBuffer::Reset()
+{
+    m_allocator.Reset();
+}
+
+D3D12_GPU_VIRTUAL_ADDRESS LinearUploadBuffer::Push(const void *data, uint64_t byteSize, uint64_t alignment)
+{
+    auto allocation = m_allocator.Allocate(byteSize, alignment);
+    if (!allocation.IsValid())
+    {
+        if (!m_hasReportedOverflow)
+        {
+            BF_ERROR("Linear upload buffer is out of space ({0} bytes), increase FrameUploadBufferSize.",
+                     m_allocator.GetCapacity());
+            m_hasReportedOverflow = true;
+        }
+        return 0u;
+    }
+
+    memcpy(allocation.CpuAddress, data, byteSize);
+    return allocation.GpuAddress;
+}
+} // namespace Blainn
@@ -0,0 +1,161 @@
+#include "Render/TextureResidency.h"
+
+#include <EASTL/algorithm.h>
+#include <EASTL/sort.h>
+#include <cmath>
+#include <cstring>
+
+namespace Blainn
+{
+namespace
+{
+constexpr uint64_t kNeededStepBit = 1ull << 63u;
+// resident levels are dropped only once the surface is this much smaller than the size that needed them
+constexpr float kResidentSizeBias = 1.5f;
+
+// positive floats order like their bits
+uint32_t FloatKey(float value)
+{
+    uint32_t bits = 0u;
+    std::memcpy(&bits, &value, sizeof(bits));
+    return bits;
+}
+} // namespace
+
+void TextureResidency::AddTexture(uint32_t id, uint32_t width, uint32_t height, const uint64_t *mipSizes,
+                                  uint32_t mipCount, uint32_t tailMip, uint32_t residentMip)
+{
+    if (mipCount == 0u) return;
+    if (id >= m_entries.size()) m_entries.resize(id + 1u);
+
+    Entry &entry = m_entries[id];
+    entry = Entry();
+    entry.MipSizes.assign(mipSizes, mipSizes + mipCount);
+    entry.Width = width;
+    entry.Height = height;
+    entry.TailMip = eastl::min(tailMip, mipCount - 1u);
+    entry.ResidentMip = eastl::min(residentMip, entry.TailMip);
+    entry.TargetMip = entry.ResidentMip;
+    entry.LastRequestFrame = m_frame;
+    entry.bIsUsed = true;
+}
+
+void TextureResidency::RemoveTexture(uint32_t id)
+{
+    if (HasTexture(id)) m_entries[id] = Entry();
+}
+
+bool TextureResidency::HasTexture(uint32_t id) const
+{
+    return id < m_entries.size() && m_entries[id].bIsUsed;
+}
+
+void TextureResidency::SetResidentMip(uint32_t id, uint32_t mip)
+{
+    if (!HasTexture(id)) return;
+    m_entries[id].ResidentMip = eastl::min(mip, m_entries[id].TailMip);
+}
+
+void TextureResidency::Request(uint32_t id, float screenSize)
+{
+    if (!HasTexture(id)) return;
+    m_entries[id].RequestedSize = eastl::max(m_entries[id].RequestedSize, screenSize);
+}
+
+void TextureResidency::Solve(uint64_t budget)
+{
+    ++m_frame;
+    m_steps.clear();
+    m_changedTextures.clear();
+    m_tailBytes = 0u;
+
+    for (uint32_t id = 0; id < static_cast<uint32_t>(m_entries.size()); ++id)
+    {
+        Entry &entry = m_entries[id];
+        if (!entry.bIsUsed) continue;
+
+        for (uint32_t mip = entry.TailMip; mip < entry.MipSizes.size(); ++mip)
+            m_tailBytes += entry.MipSizes[mip];
+        entry.TargetMip = entry.TailMip;
+
+        const bool isRequested = entry.RequestedSize > 0.0f;
+        if (isRequested) entry.LastRequestFrame = m_frame;
+        uint32_t neededMip =
+            isRequested ? GetNeededMip(entry.Width, entry.Height, entry.TailMip, entry.RequestedSize) : entry.TailMip;
+        if (isRequested && entry.ResidentMip < neededMip)
+        {
+            // the biased size also breaks ties, a resident level is not handed to a surface of about the same size
+            entry.RequestedSize *= kResidentSizeBias;
+            const uint32_t biasedMip = GetNeededMip(entry.Width, entry.Height, entry.TailMip, entry.RequestedSize);
+            neededMip = eastl::max(entry.ResidentMip, biasedMip);
+        }
+
+        for (uint32_t mip = 0; mip < entry.TailMip; ++mip)
+        {
+            uint64_t priority = 0u;
+            if (mip >= neededMip)
+            {
+                // farthest from the needed mip first, larger surfaces break ties
+                priority = kNeededStepBit | (static_cast<uint64_t>(mip - neededMip) << 32u)
+                           | FloatKey(entry.RequestedSize);
+            }
+            else if (mip >= entry.ResidentMip)
+            {
+                // resident but not needed: kept while the budget allows, coarse levels of recent textures first
+                priority = (static_cast<uint64_t>(entry.LastRequestFrame) << 8u) | mip;
+            }
+            else
+            {
+                continue;
+            }
+            m_steps.push_back({priority, id, mip});
+        }
+
+        entry.RequestedSize = 0.0f;
+    }
+
+    eastl::sort(m_steps.begin(), m_steps.end(),
+                [](const Step &a, const Step &b) { return a.Priority > b.Priority; });
+
+    uint64_t available = budget > m_tailBytes ? budget - m_tailBytes : 0u;
+    m_targetBytes = m_tailBytes;
+    for (const Step &step : m_steps)
+    {
+        Entry &entry = m_entries[step.Id];
+        // a level needs the next coarser one, a step skipped for budget ends the texture here
+        if (step.Mip + 1u != entry.TargetMip) continue;
+
+        const uint64_t size = entry.MipSizes[step.Mip];
+        if (size > available) continue;
+
+        available -= size;
+        m_targetBytes += size;
+        entry.TargetMip = step.Mip;
+    }
+
+    for (uint32_t id = 0; id < static_cast<uint32_t>(m_entries.size()); ++id)
+        if (m_entries[id].bIsUsed && m_entries[id].TargetMip != m_entries[id].ResidentMip)
+            m_changedTextures.push_back(id);
+}
+
+uint32_t TextureResidency::GetTargetMip(uint32_t id) const
+{
+    return HasTexture(id) ? m_entries[id].TargetMip : 0u;
+}
+
+uint32_t TextureResidency::GetResidentMip(uint32_t id) const
+{
+    return HasTexture(id) ? m_entries[id].ResidentMip : 0u;
+}
+
+uint32_t TextureResidency::GetNeededMip(uint32_t width, uint32_t height, uint32_t tailMip, float screenSize)
+{
+    if (screenSize <= 0.0f) return tailMip;
+
+    const float texelsPerPixel = static_cast<float>(eastl::max(width, height)) / screenSize;
+    if (texelsPerPixel <= 1.0f) return 0u;
+
+    const auto mip = static_cast<uint32_t>(floorf(log2f(texelsPerPixel)));
+    return eastl::min(mip, tailMip);
+}
+} // namespace Blainn
@@ -0,0 +1,69 @@
+#include "Render/TextureViewTable.h"
+
+namespace Blainn
+{
+void TextureViewTable::Init(ID3D12Device2 *device, ID3D12DescriptorHeap *shaderVisibleHeap, UINT firstDescriptor,
+                            UINT viewCount, UINT tableCount)
+{
+    m_device = device;
+    m_shaderVisibleHeap = shaderVisibleHeap;
+    m_firstDescriptor = firstDescriptor;
+    m_viewCount = viewCount;
+    m_descriptorSize = device->GetDescriptorHandleIncrementSize(D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV);
+
+    assert(firstDescriptor + viewCount * tableCount <= shaderVisibleHeap->GetDesc().NumDescriptors);
+
+    // copy source, has to stay CPU only
+    D3D12_DESCRIPTOR_HEAP_DESC heapDesc = {};
+    heapDesc.Type = D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV;
+    heapDesc.NumDescriptors = viewCount;
+    heapDesc.Flags = D3D12_DESCRIPTOR_HEAP_FLAG_NONE;
+    ThrowIfFailed(device->CreateDescriptorHeap(&heapDesc, IID_PPV_ARGS(&m_stagingHeap)));
+
+    m_changedSlots.assign(tableCount, eastl::vector<bool>(viewCount, false));
+}
+
+D3D12_CPU_DESCRIPTOR_HANDLE TextureViewTable::GetWriteHandle(UINT slot)
+{
+    assert(slot < m_viewCount);
+
+    for (auto &changedSlots : m_changedSlots)
+        changedSlots[slot] = true;
+
+    return CD3DX12_CPU_DESCRIPTOR_HANDLE(m_stagingHeap->GetCPUDescriptorHandleForHeapStart(), slot, m_descriptorSize);
+}
+
+void TextureViewTable::CopyChangedViews(UINT table)
+{
+    auto &changedSlots = m_changedSlots[table];
+    const auto srcStart = m_stagingHeap->GetCPUDescriptorHandleForHeapStart();
+    const auto dstStart = m_shaderVisibleHeap->GetCPUDescriptorHandleForHeapStart();
+    const UINT tableStart = m_firstDescriptor + table * m_viewCount;
+
+    // consecutive changed slots are copied as one range
+    for (UINT slot = 0u; slot < m_viewCount;)
+    {
+        if (!changedSlots[slot])
+        {
+            ++slot;
+            continue;
+        }
+
+        UINT rangeEnd = slot;
+        while (rangeEnd < m_viewCount && changedSlots[rangeEnd])
+            changedSlots[rangeEnd++] = false;
+
+        m_device->CopyDescriptorsSimple(rangeEnd - slot,
+                                        CD3DX12_CPU_DESCRIPTOR_HANDLE(dstStart, tableStart + slot, m_descriptorSize),
+                                        CD3DX12_CPU_DESCRIPTOR_HANDLE(srcStart, slot, m_descriptorSize),
+                                        D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV);
+        slot = rangeEnd;
+    }
+}
+
+D3D12_GPU_DESCRIPTOR_HANDLE TextureViewTable::GetTable(UINT table) const
+{
+    return CD3DX12_GPU_DESCRIPTOR_HANDLE(m_shaderVisibleHeap->GetGPUDescriptorHandleForHeapStart(),
+                                         m_firstDescriptor + table * m_viewCount, m_descriptorSize);
+}
+} // namespace Blainn
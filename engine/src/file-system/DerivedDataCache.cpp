@@ -0,0 +1,339 @@
+#include "file-system/DerivedDataCache.h"
+
+#include "subsystems/LogMacros.h"
+#include "tools/Profiler.h"
+
+#include <yaml-cpp/yaml.h>
+
+#include <cstdio>
+#include <thread>
+
+namespace Blainn
+{
+namespace
+{
+constexpr uint32_t kIndexVersion = 1u;
+constexpr size_t kHashChunkSize = 1u << 20u;
+const char *const kIndexFileName = "SourceHashes.yaml";
+
+eastl::string ToHex(uint64_t value)
+{
+    char text[17];
+    std::snprintf(text, sizeof(text), "%016llx", static_cast<unsigned long long>(value));
+    return text;
+}
+
+uint64_t GetFileSize(const Path &path)
+{
+    std::error_code error;
+    const uintmax_t size = std::filesystem::file_size(path, error);
+    return error ? 0u : static_cast<uint64_t>(size);
+}
+
+// FileSystemObject has the same helpers but pulls in the engine
+bool ReadFileData(const Path &path, eastl::vector<uint8_t> &outData)
+{
+    std::ifstream file(path, std::ios::binary | std::ios::ate);
+    if (!file) return false;
+
+    const std::streamsize size = file.tellg();
+    if (size < 0) return false;
+
+    outData.resize(static_cast<size_t>(size));
+    file.seekg(0, std::ios::beg);
+    return size == 0 || static_cast<bool>(file.read(reinterpret_cast<char *>(outData.data()), size));
+}
+
+bool GetFileStamp(const Path &path, int64_t &outWriteTime, uint64_t &outSize)
+{
+    std::error_code error;
+    const auto writeTime = std::filesystem::last_write_time(path, error);
+    if (error) return false;
+
+    outWriteTime = static_cast<int64_t>(writeTime.time_since_epoch().count());
+    outSize = GetFileSize(path);
+    return true;
+}
+} // namespace
+
+uint64_t DerivedDataCache::HashBytes(const void *bytes, size_t size, uint64_t seed /*= kHashSeed*/)
+{
+    uint64_t hash = seed;
+    for (size_t i = 0; i < size; ++i)
+    {
+        hash ^= static_cast<const uint8_t *>(bytes)[i];
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+bool DerivedDataCache::MakeKey(const Path &absoluteSourcePath, const char *processor, uint32_t processorVersion,
+                               uint64_t settingsHash, Key &outKey)
+{
+    uint64_t sourceHash = 0u;
+    if (!GetSourceHash(absoluteSourcePath, sourceHash)) return false;
+
+    outKey = MakeKey(&sourceHash, sizeof(sourceHash), processor, processorVersion, settingsHash);
+    return true;
+}
+
+DerivedDataCache::Key DerivedDataCache::MakeKey(const void *sourceBytes, size_t size, const char *processor,
+                                                uint32_t processorVersion, uint64_t settingsHash)
+{
+    Key key;
+    key.Processor = processor;
+    key.Hash = HashBytes(sourceBytes, size);
+    key.Hash = HashBytes(&processorVersion, sizeof(processorVersion), key.Hash);
+    key.Hash = HashBytes(&settingsHash, sizeof(settingsHash), key.Hash);
+    key.Hash = HashBytes(key.Processor.data(), key.Processor.size(), key.Hash);
+    return key;
+}
+
+void DerivedDataCache::SetContentDirectory(const Path &contentDirectory)
+{
+    m_contentDirectory = contentDirectory;
+}
+
+Path DerivedDataCache::GetCacheDirectory()
+{
+    // next to the content directory, so it belongs to the project but is not content
+    return m_contentDirectory.parent_path() / "DerivedDataCache";
+}
+
+Path DerivedDataCache::GetDataPath(const Key &key)
+{
+    const eastl::string name = ToHex(key.Hash);
+    // two levels keep directories small
+    return GetCacheDirectory() / key.Processor.c_str() / name.substr(0, 2).c_str() / name.c_str();
+}
+
+bool DerivedDataCache::Find(const Key &key)
+{
+    std::error_code error;
+    const bool isHit = std::filesystem::is_regular_file(GetDataPath(key), error);
+    CountLookup(key, isHit);
+    return isHit;
+}
+
+bool DerivedDataCache::Read(const Key &key, eastl::vector<uint8_t> &outData)
+{
+    if (!Find(key)) return false;
+
+    if (!ReadFileData(GetDataPath(key), outData))
+    {
+        Reject(key);
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_stats[key.Processor].BytesRead += outData.size();
+    return true;
+}
+
+bool DerivedDataCache::Write(const Key &key, const eastl::function<bool(std::ofstream &)> &writer)
+{
+    BLAINN_PROFILE_FUNC();
+
+    const Path dataPath = GetDataPath(key);
+    std::error_code error;
+    std::filesystem::create_directories(dataPath.parent_path(), error);
+
+    // unique per thread, the rename publishes the entry at once
+    const Path tempPath =
+        Path(dataPath.string() + "." + ToHex(std::hash<std::thread::id>{}(std::this_thread::get_id())).c_str()
+             + ".tmp");
+    {
+        std::ofstream file(tempPath, std::ios::binary | std::ios::trunc);
+        if (!file)
+        {
+            BF_ERROR("DerivedDataCache: can't open {0} for writing", tempPath.string());
+            return false;
+        }
+
+        if (!writer(file) || !file)
+        {
+            BF_ERROR("DerivedDataCache: failed to write {0}", dataPath.string());
+            file.close();
+            std::filesystem::remove(tempPath, error);
+            return false;
+        }
+    }
+
+    const uint64_t size = GetFileSize(tempPath);
+    std::filesystem::rename(tempPath, dataPath, error);
+    if (error)
+    {
+        // another writer of the same key won, the entries are equal
+        std::filesystem::remove(tempPath, error);
+        if (!std::filesystem::is_regular_file(dataPath, error)) return false;
+    }
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    Stats &stats = m_stats[key.Processor];
+    ++stats.Writes;
+    stats.BytesWritten += size;
+    return true;
+}
+
+bool DerivedDataCache::Write(const Key &key, const void *data, size_t size)
+{
+    return Write(key,
+                 [data, size](std::ofstream &file)
+                 {
+                     file.write(static_cast<const char *>(data), static_cast<std::streamsize>(size));
+                     return true;
+                 });
+}
+
+void DerivedDataCache::Reject(const Key &key)
+{
+    BF_WARN("DerivedDataCache: {0} entry {1} is unusable, it will be rebuilt", key.Processor.c_str(),
+            ToHex(key.Hash).c_str());
+
+    std::error_code error;
+    std::filesystem::remove(GetDataPath(key), error);
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    Stats &stats = m_stats[key.Processor];
+    if (stats.Hits > 0u) --stats.Hits;
+    ++stats.Misses;
+}
+
+void DerivedDataCache::Flush()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    SaveIndex();
+}
+
+void DerivedDataCache::LogStats()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    uint32_t hits = 0u;
+    uint32_t misses = 0u;
+    for (const auto &[processor, stats] : m_stats)
+    {
+        BF_INFO("DerivedDataCache {0}: {1} hits, {2} misses, {3} writes, {4} KiB read, {5} KiB written",
+                processor.c_str(), stats.Hits, stats.Misses, stats.Writes, stats.BytesRead / 1024u,
+                stats.BytesWritten / 1024u);
+        hits += stats.Hits;
+        misses += stats.Misses;
+    }
+
+    const uint32_t lookups = hits + misses;
+    BF_INFO("DerivedDataCache: {0} of {1} lookups hit ({2:.1f}%), {3} sources hashed", hits, lookups,
+            lookups ? 100.0 * hits / lookups : 0.0, m_hashedSourceCount);
+}
+
+bool DerivedDataCache::GetSourceHash(const Path &absoluteSourcePath, uint64_t &outHash)
+{
+    SourceStamp stamp;
+    if (!GetFileStamp(absoluteSourcePath, stamp.WriteTime, stamp.Size)) return false;
+
+    const eastl::string pathKey = absoluteSourcePath.lexically_normal().string().c_str();
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        LoadIndexIfNeeded();
+        if (auto it = m_sourceHashes.find(pathKey);
+            it != m_sourceHashes.end() && it->second.WriteTime == stamp.WriteTime && it->second.Size == stamp.Size)
+        {
+            outHash = it->second.Hash;
+            return true;
+        }
+    }
+
+    // hashed outside the lock, workers hash different files at once
+    BLAINN_PROFILE_SCOPE_DYNAMIC("DerivedDataCache hash source");
+    std::ifstream file(absoluteSourcePath, std::ios::binary);
+    if (!file) return false;
+
+    stamp.Hash = kHashSeed;
+    eastl::vector<char> chunk(kHashChunkSize);
+    while (file)
+    {
+        file.read(chunk.data(), static_cast<std::streamsize>(chunk.size()));
+        stamp.Hash = HashBytes(chunk.data(), static_cast<size_t>(file.gcount()), stamp.Hash);
+    }
+    if (!file.eof()) return false;
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_sourceHashes[pathKey] = stamp;
+    m_bIsIndexDirty = true;
+    ++m_hashedSourceCount;
+
+    outHash = stamp.Hash;
+    return true;
+}
+
+void DerivedDataCache::LoadIndexIfNeeded()
+{
+    const Path directory = GetCacheDirectory();
+    if (directory == m_indexDirectory) return;
+
+    SaveIndex();
+    m_sourceHashes.clear();
+    m_indexDirectory = directory;
+
+    const Path indexPath = directory / kIndexFileName;
+    if (!std::filesystem::exists(indexPath)) return;
+
+    try
+    {
+        YAML::Node index = YAML::LoadFile(indexPath.string());
+        if (!index["Version"] || index["Version"].as<uint32_t>() != kIndexVersion) return;
+
+        for (const auto &source : index["Sources"])
+        {
+            SourceStamp stamp;
+            stamp.WriteTime = source["WriteTime"].as<int64_t>();
+            stamp.Size = source["Size"].as<uint64_t>();
+            stamp.Hash = std::stoull(source["Hash"].as<std::string>(), nullptr, 16);
+            m_sourceHashes[source["Path"].as<std::string>().c_str()] = stamp;
+        }
+    }
+    catch (const std::exception &e)
+    {
+        // only costs rehashing the sources
+        BF_WARN("DerivedDataCache: source hash index is unreadable, sources are hashed again: {0}", e.what());
+        m_sourceHashes.clear();
+    }
+}
+
+void DerivedDataCache::SaveIndex()
+{
+    if (!m_bIsIndexDirty || m_indexDirectory.empty()) return;
+
+    YAML::Node index;
+    index["Version"] = kIndexVersion;
+    for (const auto &[path, stamp] : m_sourceHashes)
+    {
+        YAML::Node source;
+        source["Path"] = path.c_str();
+        source["WriteTime"] = stamp.WriteTime;
+        source["Size"] = stamp.Size;
+        source["Hash"] = ToHex(stamp.Hash).c_str();
+        index["Sources"].push_back(source);
+    }
+
+    std::error_code error;
+    std::filesystem::create_directories(m_indexDirectory, error);
+    std::ofstream file(m_indexDirectory / kIndexFileName, std::ios::trunc);
+    file << index;
+    if (!file)
+    {
+        BF_WARN("DerivedDataCache: failed to save the source hash index");
+        return;
+    }
+    m_bIsIndexDirty = false;
+}
+
+void DerivedDataCache::CountLookup(const Key &key, bool isHit)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    Stats &stats = m_stats[key.Processor];
+    if (isHit)
+        ++stats.Hits;
+    else
+        ++stats.Misses;
+}
+} // namespace Blainn
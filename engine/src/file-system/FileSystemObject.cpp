@@ -6,6 +6,8 @@
 
 #include "Engine.h"
 
+#include <fstream>
+
 namespace Blainn
 {
 
@@ -42,4 +44,32 @@ std::filesystem::path FileSystemObject::GetPath() const
     return m_path;
 }
 
+
+bool FileSystemObject::ReadFileData(const Path &absolutePath, eastl::vector<uint8_t> &outData)
+{
+    std::ifstream file(absolutePath, std::ios::binary | std::ios::ate);
+    if (!file) return false;
+
+    const std::streamsize size = file.tellg();
+    if (size < 0) return false;
+
+    outData.resize(static_cast<size_t>(size));
+    file.seekg(0, std::ios::beg);
+    return size == 0 || static_cast<bool>(file.read(reinterpret_cast<char *>(outData.data()), size));
+}
+
+
+bool FileSystemObject::GetFileStamp(const Path &absolutePath, int64_t &outWriteTime, uint64_t &outSize)
+{
+    std::error_code error;
+    const auto writeTime = std::filesystem::last_write_time(absolutePath, error);
+    if (error) return false;
+    const auto size = std::filesystem::file_size(absolutePath, error);
+    if (error) return false;
+
+    outWriteTime = static_cast<int64_t>(writeTime.time_since_epoch().count());
+    outSize = static_cast<uint64_t>(size);
+    return true;
+}
+
 } // namespace Blainn
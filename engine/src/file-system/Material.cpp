@@ -9,10 +9,17 @@
 #include "handles/Handle.h"
 
 
+Blainn::Material::Material()
+{
+    m_textureIndices.fill(kInvalidTextureIndex);
+}
+
+
 Blainn::Material::Material(const Path &path, const eastl::string &shader)
     : FileSystemObject(path)
     , m_shader(shader)
 {
+    m_textureIndices.fill(kInvalidTextureIndex);
 }
 
 
@@ -39,7 +46,7 @@ void Blainn::Material::Copy()
 }
 
 
-void Blainn::Material::SetTexture(const eastl::shared_ptr<TextureHandle> &textureHandle, TextureType type)
+void Blainn::Material::SetTexture(const TextureHandle &textureHandle, TextureType type)
 {
     switch (type)
     {
@@ -83,8 +90,22 @@ void Blainn::Material::SetTexture(const eastl::shared_ptr<TextureHandle> &textur
 
     default:
         BF_ERROR("Fuck you!");
-        break;
+        return;
     }
+
+    // slot index, not TextureHandle::GetIndex: that one is the default texture until loading finishes and
+    // the material is not drawn before its textures are loaded anyway
+    if (static_cast<size_t>(type) < kNumTextureTypes)
+        m_textureIndices[static_cast<size_t>(type)] =
+            textureHandle ? textureHandle.Handle::GetIndex() : kInvalidTextureIndex;
+    MarkFramesDirty();
+}
+
+
+uint32_t Blainn::Material::GetTextureIndex(TextureType type) const
+{
+    if (static_cast<size_t>(type) >= kNumTextureTypes) return kInvalidTextureIndex;
+    return m_textureIndices[static_cast<size_t>(type)];
 }
 
 
@@ -98,19 +119,19 @@ Blainn::TextureHandle &Blainn::Material::GetTextureHandle(TextureType type)
         throw std::runtime_error("Invalid texture type: NONE");
 
     case TextureType::ALBEDO:
-        return *m_albedoTexture;
+        return m_albedoTexture;
 
     case TextureType::NORMAL:
-        return *m_normalTexture;
+        return m_normalTexture;
 
     case TextureType::METALLIC:
-        return *m_metallicTexture;
+        return m_metallicTexture;
 
     case TextureType::ROUGHNESS:
-        return *m_roughnessTexture;
+        return m_roughnessTexture;
 
     case TextureType::AO:
-        return *m_aoTexture;
+        return m_aoTexture;
 
     // Cubemap is not the part of object's material
     /*case TextureType::CUBEMAP:
@@ -119,7 +140,7 @@ Blainn::TextureHandle &Blainn::Material::GetTextureHandle(TextureType type)
 
     case TextureType::OTHER:
         BF_WARN("There is no texture handle for this texture type (OTHER).");
-        return *m_albedoTexture;
+        return m_albedoTexture;
 
     default:
         throw std::runtime_error("Invalid texture type: default");
@@ -130,24 +151,28 @@ Blainn::TextureHandle &Blainn::Material::GetTextureHandle(TextureType type)
 void Blainn::Material::SetAlbedoColor(const Color &color)
 {
     m_albedoColor = color;
+    MarkFramesDirty();
 }
 
 
 void Blainn::Material::SetNormalScale(float scale)
 {
     m_normalScale = scale;
+    MarkFramesDirty();
 }
 
 
 void Blainn::Material::SetRoughnessScale(float roughness)
 {
     m_roughnessScale = roughness;
+    MarkFramesDirty();
 }
 
 
 void Blainn::Material::SetMetallicScale(float metallic)
 {
     m_metallicScale = metallic;
+    MarkFramesDirty();
 }
 
 
@@ -159,27 +184,27 @@ bool Blainn::Material::AreTexturesLoaded()
     bool result = true;
     if (HasTexture(TextureType::ALBEDO))
     {
-        auto texIndex = m_albedoTexture->GetIndex();
+        auto texIndex = m_albedoTexture.Handle::GetIndex();
         result &= AssetManager::GetInstance().GetTextureByIndex(texIndex).IsLoaded();
     }
     if (HasTexture(TextureType::AO))
     {
-        auto texIndex = m_aoTexture->GetIndex();
+        auto texIndex = m_aoTexture.Handle::GetIndex();
         result &= AssetManager::GetInstance().GetTextureByIndex(texIndex).IsLoaded();
     }
     if (HasTexture(TextureType::METALLIC))
     {
-        auto texIndex = m_metallicTexture->GetIndex();
+        auto texIndex = m_metallicTexture.Handle::GetIndex();
         result &= AssetManager::GetInstance().GetTextureByIndex(texIndex).IsLoaded();
     }
     if (HasTexture(TextureType::NORMAL))
     {
-        auto texIndex = m_normalTexture->GetIndex();
+        auto texIndex = m_normalTexture.Handle::GetIndex();
         result &= AssetManager::GetInstance().GetTextureByIndex(texIndex).IsLoaded();
     }
     if (HasTexture(TextureType::ROUGHNESS))
     {
-        auto texIndex = m_roughnessTexture->GetIndex();
+        auto texIndex = m_roughnessTexture.Handle::GetIndex();
         result &= AssetManager::GetInstance().GetTextureByIndex(texIndex).IsLoaded();
     }
 
@@ -204,15 +229,15 @@ BOOL Blainn::Material::HasTexture(const TextureType type) const
     switch (type)
     {
     case TextureType::ALBEDO:
-        return m_albedoTexture != nullptr;
+        return m_albedoTexture.IsValid();
     case TextureType::NORMAL:
-        return m_normalTexture != nullptr;
+        return m_normalTexture.IsValid();
     case TextureType::METALLIC:
-        return m_metallicTexture != nullptr;
+        return m_metallicTexture.IsValid();
     case TextureType::ROUGHNESS:
-        return m_roughnessTexture != nullptr;
+        return m_roughnessTexture.IsValid();
     case TextureType::AO:
-        return m_aoTexture != nullptr;
+        return m_aoTexture.IsValid();
     default:
         return FALSE;
     }
@@ -0,0 +1,258 @@
+#include "pch.h"
+
+#include "file-system/MaterialTable.h"
+
+#include "Engine.h"
+#include "file-system/DerivedDataCache.h"
+#include "file-system/FileSystemObject.h"
+#include "file-system/MaterialDesc.h"
+#include "subsystems/AssetLoader.h"
+
+#include <cstring>
+#include <fstream>
+
+namespace Blainn
+{
+namespace
+{
+constexpr uint32_t kMagic = 0x544D4642u; // "BFMT"
+
+template <typename T> bool ReadArray(const eastl::vector<uint8_t> &data, size_t &offset, eastl::vector<T> &outArray,
+                                     size_t count)
+{
+    if (data.size() - offset < sizeof(T) * count) return false;
+
+    outArray.resize(count);
+    if (count > 0u) std::memcpy(outArray.data(), data.data() + offset, sizeof(T) * count);
+    offset += sizeof(T) * count;
+    return true;
+}
+
+// checked once on load, GetDesc and GetTexturePath index the texture list without checks
+bool AreTextureIndicesValid(const eastl::vector<MaterialTable::Record> &records, size_t textureCount)
+{
+    for (const MaterialTable::Record &record : records)
+        for (const uint32_t texture : record.Textures)
+            if (texture != MaterialTable::kNoTexture && texture >= textureCount) return false;
+    return true;
+}
+} // namespace
+
+
+Path MaterialTable::GetTablePath()
+{
+    return DerivedDataCache::GetCacheDirectory() / "MaterialTable.bin";
+}
+
+
+bool MaterialTable::Cook(const Path &directory, uint32_t &outMaterialCount)
+{
+    BLAINN_PROFILE_FUNC();
+    outMaterialCount = 0u;
+
+    eastl::vector<Record> records;
+    eastl::vector<TextureRecord> textures;
+    eastl::vector<char> strings;
+    eastl::hash_map<eastl::string, uint32_t> textureIndices;
+
+    const auto addString = [&strings](const std::string &text, uint32_t &outOffset, uint32_t &outLength)
+    {
+        outOffset = static_cast<uint32_t>(strings.size());
+        outLength = static_cast<uint32_t>(text.size());
+        strings.insert(strings.end(), text.begin(), text.end());
+    };
+
+    std::error_code error;
+    for (const auto &entry : std::filesystem::recursive_directory_iterator(
+             directory, std::filesystem::directory_options::skip_permission_denied, error))
+    {
+        if (!entry.is_regular_file() || entry.path().extension() != ".mat") continue;
+
+        const Path relativePath = std::filesystem::relative(entry.path(), Engine::GetContentDirectory());
+        Record record = {};
+        eastl::vector<uint8_t> fileData;
+        MaterialDesc desc;
+        if (!FileSystemObject::GetFileStamp(entry.path(), record.WriteTime, record.Size)
+            || !FileSystemObject::ReadFileData(entry.path(), fileData)
+            || !AssetLoader::ParseMaterial(relativePath, fileData, desc))
+            continue;
+
+        addString(MakeKey(relativePath).c_str(), record.PathOffset, record.PathLength);
+        addString(desc.ShaderPath.c_str(), record.ShaderOffset, record.ShaderLength);
+
+        const Path *slotPaths[kSlotCount] = {&desc.AlbedoPath, &desc.NormalPath, &desc.MetallicPath,
+                                             &desc.RoughnessPath, &desc.AOPath};
+        for (size_t slot = 0; slot < kSlotCount; ++slot)
+        {
+            record.Textures[slot] = kNoTexture;
+            if (slotPaths[slot]->empty()) continue;
+
+            const eastl::string key = MakeKey(*slotPaths[slot]);
+            auto [it, isNew] = textureIndices.insert({key, static_cast<uint32_t>(textures.size())});
+            if (isNew)
+            {
+                TextureRecord texture = {};
+                addString(slotPaths[slot]->string(), texture.PathOffset, texture.PathLength);
+                textures.push_back(texture);
+            }
+            record.Textures[slot] = it->second;
+        }
+
+        record.AlbedoColor[0] = desc.AlbedoColor.x;
+        record.AlbedoColor[1] = desc.AlbedoColor.y;
+        record.AlbedoColor[2] = desc.AlbedoColor.z;
+        record.AlbedoColor[3] = desc.AlbedoColor.w;
+        record.NormalScale = desc.NormalScale;
+        record.MetallicScale = desc.MetallicScale;
+        record.RoughnessScale = desc.RoughnessScale;
+        records.push_back(record);
+    }
+
+    FileHeader header = {};
+    header.Magic = kMagic;
+    header.Version = kVersion;
+    header.TextureCount = static_cast<uint32_t>(textures.size());
+    header.MaterialCount = static_cast<uint32_t>(records.size());
+    header.StringSize = static_cast<uint32_t>(strings.size());
+
+    // written aside and renamed, a reader never sees half a table
+    const Path tablePath = GetTablePath();
+    const Path tempPath = Path(tablePath.string() + ".tmp");
+    std::filesystem::create_directories(tablePath.parent_path(), error);
+    {
+        std::ofstream file(tempPath, std::ios::binary | std::ios::trunc);
+        file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+        file.write(reinterpret_cast<const char *>(textures.data()), sizeof(TextureRecord) * textures.size());
+        file.write(reinterpret_cast<const char *>(records.data()), sizeof(Record) * records.size());
+        file.write(strings.data(), static_cast<std::streamsize>(strings.size()));
+        if (!file)
+        {
+            BF_ERROR("MaterialTable: failed to write {0}", tempPath.string());
+            return false;
+        }
+    }
+
+    std::filesystem::rename(tempPath, tablePath, error);
+    if (error)
+    {
+        BF_ERROR("MaterialTable: failed to replace {0}: {1}", tablePath.string(), error.message());
+        std::filesystem::remove(tempPath, error);
+        return false;
+    }
+
+    outMaterialCount = header.MaterialCount;
+    return true;
+}
+
+
+bool MaterialTable::Load()
+{
+    BLAINN_PROFILE_FUNC();
+
+    m_records.clear();
+    m_textures.clear();
+    m_strings.clear();
+    m_recordIndices.clear();
+    m_missCount = 0u;
+    m_bIsLoaded = false;
+    // a missing table is not looked for again until the project changes
+    m_loadedPath = GetTablePath();
+
+    eastl::vector<uint8_t> data;
+    if (!FileSystemObject::ReadFileData(m_loadedPath, data)) return false;
+
+    FileHeader header = {};
+    if (data.size() < sizeof(header)) return false;
+    std::memcpy(&header, data.data(), sizeof(header));
+    if (header.Magic != kMagic || header.Version != kVersion) return false;
+
+    size_t offset = sizeof(header);
+    if (!ReadArray(data, offset, m_textures, header.TextureCount)
+        || !ReadArray(data, offset, m_records, header.MaterialCount)
+        || !ReadArray(data, offset, m_strings, header.StringSize)
+        || !AreTextureIndicesValid(m_records, m_textures.size()))
+    {
+        BF_WARN("MaterialTable: {0} is truncated or corrupt, materials are parsed from YAML", m_loadedPath.string());
+        m_records.clear();
+        m_textures.clear();
+        m_strings.clear();
+        return false;
+    }
+
+    m_recordIndices.reserve(m_records.size());
+    for (uint32_t i = 0; i < static_cast<uint32_t>(m_records.size()); ++i)
+        m_recordIndices[GetString(m_records[i].PathOffset, m_records[i].PathLength)] = i;
+
+    m_bIsLoaded = true;
+    return true;
+}
+
+
+const MaterialTable::Record *MaterialTable::Find(const Path &relativePath)
+{
+    // the content directory may change after startup
+    if (m_loadedPath != GetTablePath()) Load();
+
+    auto it = m_recordIndices.find(MakeKey(relativePath));
+    if (it == m_recordIndices.end())
+    {
+        ++m_missCount;
+        return nullptr;
+    }
+
+    // a stat instead of a parse, an edited .mat goes the YAML way until the next cook
+    const Record &record = m_records[it->second];
+    int64_t writeTime = 0;
+    uint64_t size = 0u;
+    if (!FileSystemObject::GetFileStamp(Engine::GetContentDirectory() / relativePath, writeTime, size)
+        || writeTime != record.WriteTime || size != record.Size)
+    {
+        ++m_missCount;
+        return nullptr;
+    }
+
+    return &record;
+}
+
+
+Path MaterialTable::GetTexturePath(uint32_t index) const
+{
+    return GetString(m_textures[index].PathOffset, m_textures[index].PathLength).c_str();
+}
+
+
+eastl::string MaterialTable::GetShader(const Record &record) const
+{
+    return GetString(record.ShaderOffset, record.ShaderLength);
+}
+
+
+void MaterialTable::GetDesc(const Record &record, MaterialDesc &outDesc) const
+{
+    Path *slotPaths[kSlotCount] = {&outDesc.AlbedoPath, &outDesc.NormalPath, &outDesc.MetallicPath,
+                                   &outDesc.RoughnessPath, &outDesc.AOPath};
+    for (size_t slot = 0; slot < kSlotCount; ++slot)
+        *slotPaths[slot] = record.Textures[slot] != kNoTexture ? GetTexturePath(record.Textures[slot]) : Path();
+
+    outDesc.ShaderPath = GetShader(record);
+    outDesc.AlbedoColor =
+        Color(record.AlbedoColor[0], record.AlbedoColor[1], record.AlbedoColor[2], record.AlbedoColor[3]);
+    outDesc.NormalScale = record.NormalScale;
+    outDesc.MetallicScale = record.MetallicScale;
+    outDesc.RoughnessScale = record.RoughnessScale;
+}
+
+
+eastl::string MaterialTable::MakeKey(const Path &relativePath)
+{
+    // scenes and materials may spell a path with either separator
+    return ToEASTLString(relativePath.lexically_normal().generic_string());
+}
+
+
+eastl::string MaterialTable::GetString(uint32_t offset, uint32_t length) const
+{
+    if (static_cast<size_t>(offset) + length > m_strings.size()) return {};
+    return eastl::string(m_strings.data() + offset, length);
+}
+} // namespace Blainn
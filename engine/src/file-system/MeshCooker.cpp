@@ -0,0 +1,99 @@
+#include "file-system/MeshCooker.h"
+
+#include "file-system/DerivedDataCache.h"
+#include "file-system/Model.h"
+
+#include <fstream>
+
+namespace Blainn
+{
+namespace
+{
+constexpr uint32_t kMagic = 0x534D4642u; // "BFMS"
+}
+
+bool MeshCooker::Cook(const Model &model, const Path &absoluteSourcePath, uint64_t importSettingsHash)
+{
+    BLAINN_PROFILE_FUNC();
+
+    DerivedDataCache::Key key;
+    if (!DerivedDataCache::MakeKey(absoluteSourcePath, processorName, kVersion, importSettingsHash, key)) return false;
+
+    FileHeader header = {};
+    header.Magic = kMagic;
+    header.Version = kVersion;
+    header.VertexStride = sizeof(BlainnVertex);
+    header.IndexStride = sizeof(uint32_t);
+    header.SubmeshCount = static_cast<uint32_t>(model.m_submeshes.size());
+    header.VertexCount = static_cast<uint32_t>(model.allVertices.size());
+    header.IndexCount = static_cast<uint32_t>(model.allIndices.size());
+    header.LODCount = static_cast<uint32_t>(model.m_lods.size());
+    header.BoundsCenter = model.m_bounds.Center;
+    header.BoundsExtents = model.m_bounds.Extents;
+
+    return DerivedDataCache::Write(
+        key,
+        [&](std::ofstream &file)
+        {
+            file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+            file.write(reinterpret_cast<const char *>(model.m_submeshes.data()),
+                       sizeof(Model::Submesh) * model.m_submeshes.size());
+            file.write(reinterpret_cast<const char *>(model.m_lods.data()),
+                       sizeof(Model::LOD) * model.m_lods.size());
+            file.write(reinterpret_cast<const char *>(model.allVertices.data()),
+                       sizeof(BlainnVertex) * model.allVertices.size());
+            file.write(reinterpret_cast<const char *>(model.allIndices.data()),
+                       sizeof(uint32_t) * model.allIndices.size());
+            return true;
+        });
+}
+
+bool MeshCooker::Load(const Path &absoluteSourcePath, Model &model, uint64_t importSettingsHash)
+{
+    BLAINN_PROFILE_FUNC();
+
+    DerivedDataCache::Key key;
+    if (!DerivedDataCache::MakeKey(absoluteSourcePath, processorName, kVersion, importSettingsHash, key)
+        || !DerivedDataCache::Find(key))
+        return false;
+
+    std::ifstream file(DerivedDataCache::GetDataPath(key), std::ios::binary);
+    FileHeader header = {};
+    if (!file.read(reinterpret_cast<char *>(&header), sizeof(header)) || header.Magic != kMagic
+        || header.Version != kVersion || header.VertexStride != sizeof(BlainnVertex)
+        || header.IndexStride != sizeof(uint32_t) || header.LODCount == 0u)
+    {
+        // open files can't be deleted on Windows
+        file.close();
+        DerivedDataCache::Reject(key);
+        return false;
+    }
+
+    // read straight into the buffers that are uploaded, no intermediate copies
+    model.m_submeshes.resize(header.SubmeshCount);
+    model.m_lods.resize(header.LODCount);
+    model.allVertices.resize(header.VertexCount);
+    model.allIndices.resize(header.IndexCount);
+
+    file.read(reinterpret_cast<char *>(model.m_submeshes.data()), sizeof(Model::Submesh) * header.SubmeshCount);
+    file.read(reinterpret_cast<char *>(model.m_lods.data()), sizeof(Model::LOD) * header.LODCount);
+    file.read(reinterpret_cast<char *>(model.allVertices.data()), sizeof(BlainnVertex) * header.VertexCount);
+    file.read(reinterpret_cast<char *>(model.allIndices.data()), sizeof(uint32_t) * header.IndexCount);
+
+    if (!file)
+    {
+        file.close();
+        DerivedDataCache::Reject(key);
+        model.m_submeshes.clear();
+        model.m_lods.clear();
+        model.allVertices.clear();
+        model.allIndices.clear();
+        return false;
+    }
+
+    model.totalVertexCount = header.VertexCount;
+    model.totalIndexCount = model.m_lods[0].IndexCount;
+    model.m_bounds = DirectX::BoundingBox(header.BoundsCenter, header.BoundsExtents);
+    return true;
+}
+} // namespace Blainn
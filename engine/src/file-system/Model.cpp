@@ -10,26 +10,38 @@ namespace Blainn
 {
 Model::Model()
     {
-        m_meshes.reserve(4);
+        m_submeshes.reserve(4);
     }
     
     Model::Model(const Path &relativePath)
         : FileSystemObject(relativePath)
     {
-        m_meshes.reserve(4);
+        m_submeshes.reserve(4);
     }
 
     Model::Model(const Model &other, const Path &absolutPath)
         : FileSystemObject(absolutPath)
     {
-        m_meshes = other.m_meshes;
+        allVertices = other.allVertices;
+        allIndices = other.allIndices;
+        m_submeshes = other.m_submeshes;
+        m_lods = other.m_lods;
+        m_bounds = other.m_bounds;
+        totalVertexCount = other.totalVertexCount;
+        totalIndexCount = other.totalIndexCount;
     }
 
 
     Model::Model(Model &&other, const Path &absolutPath) noexcept
         : FileSystemObject(absolutPath)
     {
-        m_meshes = std::move(other.m_meshes);
+        allVertices = eastl::move(other.allVertices);
+        allIndices = eastl::move(other.allIndices);
+        m_submeshes = eastl::move(other.m_submeshes);
+        m_lods = eastl::move(other.m_lods);
+        m_bounds = other.m_bounds;
+        totalVertexCount = other.totalVertexCount;
+        totalIndexCount = other.totalIndexCount;
     }
 
 
@@ -56,43 +68,78 @@ Model::Model()
     }
 
 
-    eastl::vector<MeshData<>> &Model::GetMeshes()
+    Model::Submesh &Model::BeginSubmesh(const Mat4 &parentMatrix)
     {
-        return m_meshes;
+        Submesh &submesh = m_submeshes.push_back();
+        submesh.FirstVertex = static_cast<uint32_t>(allVertices.size());
+        submesh.FirstIndex = static_cast<uint32_t>(allIndices.size());
+        submesh.ParentMatrix = parentMatrix;
+        return submesh;
     }
 
-
-    void Model::SetMeshes(const eastl::vector<MeshData<>> &meshes)
+    void Model::EndSubmesh(Submesh &submesh)
     {
-        m_meshes = meshes;
+        submesh.VertexCount = static_cast<uint32_t>(allVertices.size()) - submesh.FirstVertex;
+        submesh.IndexCount = static_cast<uint32_t>(allIndices.size()) - submesh.FirstIndex;
     }
 
-    void Model::CreateBufferResources()
+    void Model::AddMesh(MeshData<> &&mesh)
     {
-        for (auto &mesh : GetMeshes())
+        Submesh &submesh = BeginSubmesh(mesh.parentMatrix);
+
+        if (allVertices.empty() && allIndices.empty())
         {
-            totalVertexCount += mesh.vertices.size();
-            totalIndexCount += mesh.indices.size();
+            // first mesh needs no rebasing, take its storage as is
+            allVertices = eastl::move(mesh.vertices);
+            allIndices = eastl::move(mesh.indices);
+        }
+        else
+        {
+            allVertices.insert(allVertices.end(), mesh.vertices.begin(), mesh.vertices.end());
+            allIndices.reserve(allIndices.size() + mesh.indices.size());
+            for (uint32_t index : mesh.indices)
+            {
+                allIndices.push_back(index + submesh.FirstVertex);
+            }
         }
 
-        allVertices.reserve(totalVertexCount);
-        allIndices.reserve(totalIndexCount);
+        EndSubmesh(submesh);
+    }
+
+    void Model::FinalizeMeshData()
+    {
+        totalVertexCount = allVertices.size();
+        totalIndexCount = allIndices.size();
+
+        m_lods.clear();
+        m_lods.push_back({0u, static_cast<uint32_t>(totalIndexCount), 0.0f});
 
-        uint32_t indexValueOffsetPerMesh = 0;
-        for (auto &mesh : GetMeshes())
+        if (!allVertices.empty())
         {
-            allVertices.insert(allVertices.end(), mesh.vertices.begin(), mesh.vertices.end());
-            
-            auto tempCurrentMeshIndices = mesh.indices;
-            eastl::for_each(tempCurrentMeshIndices.begin(), tempCurrentMeshIndices.end(), [&indexValueOffsetPerMesh](uint32_t &value)
-                {
-                    value += indexValueOffsetPerMesh;
-                });
+            DirectX::BoundingBox::CreateFromPoints(m_bounds, allVertices.size(), &allVertices[0].position,
+                                                   sizeof(BlainnVertex));
+        }
+    }
 
-            allIndices.insert(allIndices.end(), tempCurrentMeshIndices.begin(), tempCurrentMeshIndices.end());
+    void Model::AddLOD(const eastl::vector<uint32_t> &indices, float error)
+    {
+        LOD &lod = m_lods.push_back();
+        lod.FirstIndex = static_cast<uint32_t>(allIndices.size());
+        lod.IndexCount = static_cast<uint32_t>(indices.size());
+        lod.Error = error;
+        allIndices.insert(allIndices.end(), indices.begin(), indices.end());
+    }
 
-            indexValueOffsetPerMesh += static_cast<uint32_t>(mesh.vertices.size());
+    uint32_t Model::SelectLOD(float pixelsPerUnit, float maxErrorPixels) const
+    {
+        // levels are ordered by increasing error
+        uint32_t selected = 0u;
+        for (uint32_t i = 1u; i < m_lods.size(); ++i)
+        {
+            if (m_lods[i].Error * pixelsPerUnit > maxErrorPixels) break;
+            selected = i;
         }
+        return selected;
     }
 
     void Model::CreateGPUBuffers()
@@ -103,16 +150,48 @@ Model::Model()
         ThrowIfFailed(cmdAlloc->Reset());
         auto cmdList = cmdQueue->GetCommandList(cmdAlloc.Get());
 
+        if (!RecordGPUUpload(cmdList.Get()))
+            return;
+
+        cmdQueue->ExecuteCommandList(cmdList.Get());
+        m_loadFenceValue = cmdQueue->Signal();
+    }
+
+    bool Model::RecordGPUUpload(ID3D12GraphicsCommandList2 *cmdList)
+    {
         m_bisLoaded = false;
         m_bBuffersCreated = true;
         m_loadFenceValue = 0u;
 
-        CreateGPUBuffers(cmdList.Get(), allVertices, allIndices);
+#if UseCompactVertexFormat
+        eastl::vector<BlainnCompactVertex> compactVertices;
+        compactVertices.reserve(allVertices.size());
+        for (const auto &vertex : allVertices)
+        {
+            compactVertices.emplace_back(vertex);
+        }
+        CreateGPUBuffersWithIndexSelection(cmdList, compactVertices);
+#else
+        CreateGPUBuffersWithIndexSelection(cmdList, allVertices);
+#endif
         if (!BuffersCreated())
-            return;
+            return false;
 
-        cmdQueue->ExecuteCommandList(cmdList.Get());
-        m_loadFenceValue = cmdQueue->Signal();
+        // data is already copied into the upload heaps
+        if (!s_keepCPUDataAfterUpload) ReleaseCPUData();
+        return true;
+    }
+
+    void Model::MarkUploaded()
+    {
+        m_bisLoaded = BuffersCreated();
+        DisposeUploaders();
+    }
+
+    void Model::ReleaseCPUData()
+    {
+        eastl::vector<BlainnVertex>().swap(allVertices);
+        eastl::vector<uint32_t>().swap(allIndices);
     }
 
     bool Model::IsLoaded()
@@ -3,29 +3,52 @@
 //
 
 #include "Engine.h"
+#include "file-system/DerivedDataCache.h"
 #include "file-system/Texture.h"
+#include "file-system/TextureCooker.h"
 #include "file-system/TextureType.h"
 
 #include "Render/Device.h"
 #include "Render/CommandQueue.h"
+#include "subsystems/RenderSubsystem.h"
 // d3d12.h must be included before DirectXTex to allow support of Direct3D 12
 #include <DirectXTex/DirectXTex/DirectXTex.h>
 
 namespace Blainn
 {
-Texture::Texture(const Path &path, TextureType type, uint32_t index/*, bool IsCubeMap*/)
+namespace
+{
+// copy queues can't transition to shader states: the resource starts in COMMON, decays back to it after the copy
+// and the direct queue promotes it on first read
+bool IsCopyList(ID3D12GraphicsCommandList2 *cmdList)
+{
+    return cmdList->GetType() == D3D12_COMMAND_LIST_TYPE_COPY;
+}
+
+// uncooked textures keep their decoded chain in the cache, bump on any change to Decode
+const char *const kDecodedProcessorName = "TextureMips";
+constexpr uint32_t kDecodedVersion = 1u;
+} // namespace
+
+Texture::Texture() = default;
+
+Texture::Texture(const Path &path, TextureType type)
     : FileSystemObject(path)
     , m_type(type)
+{
+}
+
+Texture::Texture(const Path &path, TextureType type, uint32_t index/*, bool IsCubeMap*/)
+    : Texture(path, type)
     {
+        if (!ReadAndDecode())
+            return;
+
         const auto& cmdQueue = Device::GetInstance().GetCommandQueue();
         const auto& cmdAlloc = cmdQueue->GetCommandAllocator();
         const auto& cmdList = cmdQueue->GetCommandList(cmdAlloc.Get());
 
-        [[likely]]
-        if (!(type == TextureType::CUBEMAP))
-            Create(cmdList.Get(), index);
-        else
-            CreateCubemap(cmdList.Get(), index);
+        RecordUpload(cmdList.Get(), index);
 
         cmdQueue->ExecuteCommandList(cmdList);
         if (m_bIsInitialized)
@@ -80,35 +103,201 @@ Texture::Texture(const Path &path, TextureType type, uint32_t index/*, bool IsCu
         return m_bIsLoaded;
     }
 
-    void Texture::Create(ID3D12GraphicsCommandList2 *cmdList, uint32_t index)
+    bool Texture::ReadAndDecode()
     {
-        // Gpu stuff
-        auto& device = Device::GetInstance();
-        auto comDevice = device.GetDevice2();
+        const Path absolutePath = Engine::GetContentDirectory() / m_path;
+
+        // cooked textures carry the mip chain and block compression, nothing is left to do here
+        auto image = eastl::make_unique<ScratchImage>();
+        if (TextureCooker::Load(absolutePath, m_type, *image))
+        {
+            SetDecodedImage(eastl::move(image));
+            return true;
+        }
 
-        ScratchImage image;
-        ScratchImage mipChain;
+        // decoded by an earlier run, skips the decode and the mip generation
+        DerivedDataCache::Key key;
+        const bool hasKey = DerivedDataCache::MakeKey(absolutePath, kDecodedProcessorName, kDecodedVersion,
+                                                      static_cast<uint64_t>(m_type), key);
+        eastl::vector<uint8_t> fileData;
+        if (hasKey && DerivedDataCache::Read(key, fileData))
+        {
+            if (SUCCEEDED(LoadFromDDSMemory(fileData.data(), fileData.size(), DDS_FLAGS_NONE, nullptr, *image)))
+            {
+                SetDecodedImage(eastl::move(image));
+                return true;
+            }
+            DerivedDataCache::Reject(key);
+        }
 
-        if (FAILED(LoadFromWICFile((Engine::GetContentDirectory() / m_path).wstring().c_str(), WIC_FLAGS_FORCE_RGB, nullptr, image)))
+        if (!ReadFileData(absolutePath, fileData))
         {
-            BF_ERROR("Failed to load texture: {}", (char*)m_path.u8string().c_str());
-            return;
+            BF_ERROR("Failed to read texture: {}", (char*)m_path.u8string().c_str());
+            return false;
+        }
+        if (!Decode(fileData.data(), fileData.size()))
+            return false;
+
+        Blob decoded;
+        if (hasKey && SUCCEEDED(SaveToDDSMemory(m_decodedImage->GetImages(), m_decodedImage->GetImageCount(),
+                                                m_decodedImage->GetMetadata(), DDS_FLAGS_NONE, decoded)))
+            DerivedDataCache::Write(key, decoded.GetBufferPointer(), decoded.GetBufferSize());
+        return true;
+    }
+
+    bool Texture::Decode(const void *fileData, size_t fileSize)
+    {
+        BLAINN_PROFILE_FUNC();
+        auto image = eastl::make_unique<ScratchImage>();
+
+        [[likely]]
+        if (!(m_type == TextureType::CUBEMAP))
+        {
+            if (FAILED(LoadFromWICMemory(fileData, fileSize, WIC_FLAGS_FORCE_RGB, nullptr, *image)))
+            {
+                BF_ERROR("Failed to load texture: {}", (char*)m_path.u8string().c_str());
+                return false;
+            }
+
+            auto mipChain = eastl::make_unique<ScratchImage>();
+            if (FAILED(GenerateMipMaps(*image->GetImages(), TEX_FILTER_BOX, 0, *mipChain)))
+            {
+                BF_ERROR("Failed to generate mip map: {}", (char*)m_path.u8string().c_str());
+                return false;
+            }
+            SetDecodedImage(eastl::move(mipChain));
+            return true;
+        }
+
+        if (!(m_path.extension() == ".dds"))
+        {
+            BF_ERROR("Cubemap has to be a dds file");
+            return false;
+        }
+
+        if (FAILED(LoadFromDDSMemory(fileData, fileSize, DDS_FLAGS_FORCE_RGB, nullptr, *image)))
+        {
+            BF_ERROR("Failed to load cubemap: {}", (char*)m_path.u8string().c_str());
+            return false;
+        }
+
+        const TexMetadata &metadata = image->GetMetadata();
+        if (metadata.arraySize != 6)
+        {
+            BF_ERROR("Cubemap must have 6 textures!\n");
+            return false;
         }
 
-        if (FAILED(GenerateMipMaps(*image.GetImages(), TEX_FILTER_BOX, 0, mipChain)))
+        if (metadata.mipLevels == 1)
+        {
+            // every face gets its own chain
+            auto mipChain = eastl::make_unique<ScratchImage>();
+            if (FAILED(GenerateMipMaps(image->GetImages(), image->GetImageCount(), metadata, TEX_FILTER_DEFAULT, 0,
+                                       *mipChain)))
+            {
+                BF_ERROR("Failed to generate mip map: {}", (char*)m_path.u8string().c_str());
+                return false;
+            }
+            image = eastl::move(mipChain);
+        }
+
+        SetDecodedImage(eastl::move(image));
+        return true;
+    }
+
+    void Texture::SetDecodedImage(eastl::unique_ptr<ScratchImage> image)
+    {
+        const TexMetadata &metadata = image->GetMetadata();
+        m_width = static_cast<uint32_t>(metadata.width);
+        m_height = static_cast<uint32_t>(metadata.height);
+        m_mipLevels = static_cast<uint32_t>(metadata.mipLevels);
+        m_bIsBlockCompressed = IsCompressed(metadata.format);
+
+        m_mipSizes.resize(m_mipLevels);
+        for (uint32_t mip = 0; mip < m_mipLevels; ++mip)
         {
-            BF_ERROR("Failed to generate mip map: {}", (char*)m_path.u8string().c_str());
+            uint64_t size = 0u;
+            for (size_t item = 0; item < metadata.arraySize; ++item)
+                size += image->GetImage(mip, item, 0)->slicePitch;
+            m_mipSizes[mip] = size;
         }
 
-        // create resource
-        const auto &chainBase = *mipChain.GetImages();
+        m_decodedImage = eastl::move(image);
+    }
+
+    bool Texture::IsValidResidentMip(uint32_t mip) const
+    {
+        if (mip >= m_mipLevels) return false;
+        if (!m_bIsBlockCompressed) return true;
+
+        // mip 0 of a block compressed resource must be whole blocks
+        return eastl::max(m_width >> mip, 1u) % 4u == 0u && eastl::max(m_height >> mip, 1u) % 4u == 0u;
+    }
+
+    uint32_t Texture::GetTailMip() const
+    {
+        if (m_type == TextureType::CUBEMAP) return 0u;
+
+        uint32_t tailMip = 0u;
+        while (eastl::max(m_width >> tailMip, m_height >> tailMip) > kTailDimension && IsValidResidentMip(tailMip + 1u))
+            ++tailMip;
+        return tailMip;
+    }
+
+    void Texture::SetResidentMip(uint32_t mip)
+    {
+        m_residentMip = eastl::min(mip, GetTailMip());
+    }
+
+    size_t Texture::GetDecodedSize() const
+    {
+        return m_decodedImage ? m_decodedImage->GetPixelsSize() : 0u;
+    }
+
+    bool Texture::RecordUpload(ID3D12GraphicsCommandList2 *cmdList, uint32_t index)
+    {
+        if (!m_decodedImage)
+            return false;
+
+        // pixels are copied into the upload buffer while recording
+        [[likely]]
+        if (!(m_type == TextureType::CUBEMAP))
+            Create(cmdList, index);
+        else
+            CreateCubemap(cmdList);
+
+        // commands of a direct list run before anything drawn after them on the same queue
+        if (m_bIsInitialized && !IsCopyList(cmdList))
+            CreateView();
+
+        m_decodedImage.reset();
+        return m_bIsInitialized;
+    }
+
+    void Texture::MarkUploaded()
+    {
+        m_bIsLoaded = m_bIsInitialized;
+        DisposeUploaders();
+    }
+
+    bool Texture::Create(ID3D12GraphicsCommandList2 *cmdList, uint32_t index)
+    {
+        // Gpu stuff
+        auto& device = Device::GetInstance();
+        auto comDevice = device.GetDevice2();
+        const bool isCopyList = IsCopyList(cmdList);
+
+        // create resource, mips finer than the resident one stay on disk
+        const ScratchImage &mipChain = *m_decodedImage;
+        const uint32_t mipCount = m_mipLevels - m_residentMip;
+        const auto &chainBase = *mipChain.GetImage(m_residentMip, 0, 0);
 
         D3D12_RESOURCE_DESC texDesc = {};
         texDesc.Dimension = D3D12_RESOURCE_DIMENSION_TEXTURE2D;
         texDesc.Width = (UINT)chainBase.width;
         texDesc.Height = (UINT)chainBase.height;
         texDesc.DepthOrArraySize = (UINT16)1u;
-        texDesc.MipLevels = (UINT16)mipChain.GetImageCount();
+        texDesc.MipLevels = (UINT16)mipCount;
         texDesc.Format = chainBase.format;
         texDesc.SampleDesc.Count = 1u;
         texDesc.SampleDesc.Quality = 0u;
@@ -119,20 +308,21 @@ Texture::Texture(const Path &path, TextureType type, uint32_t index/*, bool IsCu
         CD3DX12_HEAP_PROPERTIES heapProps{D3D12_HEAP_TYPE_DEFAULT};
 
         if (FAILED(comDevice->CreateCommittedResource(&heapProps, D3D12_HEAP_FLAG_NONE, &texDesc,
-                                                      D3D12_RESOURCE_STATE_COPY_DEST, nullptr,
-                                                      IID_PPV_ARGS(&m_resource))))
+                                                      isCopyList ? D3D12_RESOURCE_STATE_COMMON
+                                                                 : D3D12_RESOURCE_STATE_COPY_DEST,
+                                                      nullptr, IID_PPV_ARGS(&m_resource))))
         {
             BF_ERROR("Failed to create texture: {}", (char*)m_path.u8string().c_str());
-            return;
+            return false;
         }
         std::wstring name = m_path.wstring() + L" texture";
         m_resource->SetName(name.c_str());
 
         // collect subresource data
-        eastl::vector<D3D12_SUBRESOURCE_DATA> subresources((int)mipChain.GetImageCount());
-        for (int i = 0; i < (int)mipChain.GetImageCount(); i++)
+        eastl::vector<D3D12_SUBRESOURCE_DATA> subresources(mipCount);
+        for (uint32_t i = 0; i < mipCount; i++)
         {
-            const auto img = mipChain.GetImage(i, 0, 0);
+            const auto img = mipChain.GetImage(m_residentMip + i, 0, 0);
             auto &subresource = subresources[i];
             subresource.pData = img->pixels;
             subresource.RowPitch = (LONG_PTR)img->rowPitch;
@@ -150,7 +340,7 @@ Texture::Texture(const Path &path, TextureType type, uint32_t index/*, bool IsCu
         {
             BF_ERROR("Failed to create upload buffer for: {}", (char*)m_path.u8string().c_str());
             m_resource = nullptr;
-            return;
+            return false;
         }
         std::wstring uploadname = m_path.wstring() + L" upload buffer";
         m_uploadResource->SetName(uploadname.c_str());
@@ -159,66 +349,28 @@ Texture::Texture(const Path &path, TextureType type, uint32_t index/*, bool IsCu
         UpdateSubresources(cmdList, m_resource.Get(), m_uploadResource.Get(), (UINT64)0u, 0u,
                            static_cast<uint32_t>(subresources.size()), subresources.data());
 
-        CD3DX12_RESOURCE_BARRIER barrier = CD3DX12_RESOURCE_BARRIER::Transition(
-            m_resource.Get(), D3D12_RESOURCE_STATE_COPY_DEST, D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE);
-        cmdList->ResourceBarrier(1u, &barrier);
-
-        D3D12_SHADER_RESOURCE_VIEW_DESC srvDesc = {};
-        ZeroMemory(&srvDesc, sizeof(srvDesc));
-        srvDesc.Format = m_resource->GetDesc().Format;
-        srvDesc.ViewDimension = D3D12_SRV_DIMENSION_TEXTURE2D;
-        srvDesc.Shader4ComponentMapping = D3D12_DEFAULT_SHADER_4_COMPONENT_MAPPING;
-        srvDesc.Texture2D.MostDetailedMip = 0u;
-        srvDesc.Texture2D.MipLevels = m_resource->GetDesc().MipLevels;
-        srvDesc.Texture2D.PlaneSlice = 0;
-        srvDesc.Texture2D.ResourceMinLODClamp = 0.0f;
+        if (!isCopyList)
+        {
+            CD3DX12_RESOURCE_BARRIER barrier = CD3DX12_RESOURCE_BARRIER::Transition(
+                m_resource.Get(), D3D12_RESOURCE_STATE_COPY_DEST, D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE);
+            cmdList->ResourceBarrier(1u, &barrier);
+        }
 
         UINT texturePlacementOffset = TextureSrvHeapStartIndex /*+ (static_cast<UINT>(m_type) - 1u) * MAX_TEX_OF_TYPE*/ + index;//textureTableOffset;
         m_descriptorHeapOffset = texturePlacementOffset;
 
-        auto srvCpuStart = device.GetDescriptorHeap()->GetCPUDescriptorHandleForHeapStart();
-        auto cbvSrvUavDescriptorSize = device.GetDescriptorHandleIncrementSize();
-
-        localHandle = CD3DX12_CPU_DESCRIPTOR_HANDLE(srvCpuStart, texturePlacementOffset, cbvSrvUavDescriptorSize);
-        device.CreateShaderResourceView(m_resource.Get(), &srvDesc, localHandle);
-
         m_bIsInitialized = true;
+        return true;
     }
 
-    void Texture::CreateCubemap(ID3D12GraphicsCommandList2 *cmdList, uint32_t index)
+    bool Texture::CreateCubemap(ID3D12GraphicsCommandList2 *cmdList)
     {
-        (void)index;
-        //assert(m_path.extension() == ".dds");
-        if (!(m_path.extension() == ".dds"))
-        {
-            BF_ERROR("Cubemap has to be a dds file");
-            return;
-        }
         // Gpu stuff
         auto& device = Device::GetInstance();
         const auto& comDevice = device.GetDevice2();
+        const bool isCopyList = IsCopyList(cmdList);
 
-        ScratchImage image;
-        ThrowIfFailed(LoadFromDDSFile((Engine::GetContentDirectory() / m_path).wstring().c_str(), DDS_FLAGS_FORCE_RGB, nullptr, image));
-
-        const TexMetadata &metadata = image.GetMetadata();
-
-        if (metadata.arraySize != 6)
-        {
-            BF_ERROR("Cubemap must have 6 textures!\n");
-            return;
-        }
-
-        ScratchImage mipChain;
-        if (metadata.mipLevels == 1)
-        {
-            ThrowIfFailed(GenerateMipMaps(*image.GetImages(), TEX_FILTER_DEFAULT, 0, mipChain));
-        }
-        else
-        {
-            mipChain = std::move(image);
-        }
-
+        const ScratchImage &mipChain = *m_decodedImage;
         const TexMetadata &mipMetadata = mipChain.GetMetadata();
 
         D3D12_RESOURCE_DESC texDesc = {};
@@ -236,13 +388,15 @@ Texture::Texture(const Path &path, TextureType type, uint32_t index/*, bool IsCu
 
         CD3DX12_HEAP_PROPERTIES heapProps(D3D12_HEAP_TYPE_DEFAULT);
 
-        ThrowIfFailed(comDevice->CreateCommittedResource(&heapProps, D3D12_HEAP_FLAG_NONE, &texDesc, D3D12_RESOURCE_STATE_COPY_DEST, nullptr,
-                                                         IID_PPV_ARGS(&m_resource)));
+        ThrowIfFailed(comDevice->CreateCommittedResource(&heapProps, D3D12_HEAP_FLAG_NONE, &texDesc,
+                                                         isCopyList ? D3D12_RESOURCE_STATE_COMMON
+                                                                    : D3D12_RESOURCE_STATE_COPY_DEST,
+                                                         nullptr, IID_PPV_ARGS(&m_resource)));
 
         std::vector<D3D12_SUBRESOURCE_DATA> subresources;
         for (int face = 0; face < 6; ++face)
         {
-            for (int mip = 0; mip < (int)metadata.mipLevels; ++mip)
+            for (int mip = 0; mip < (int)mipMetadata.mipLevels; ++mip)
             {
                 const Image *img = mipChain.GetImage(mip, face, 0);
                 D3D12_SUBRESOURCE_DATA s = {};
@@ -264,26 +418,56 @@ Texture::Texture(const Path &path, TextureType type, uint32_t index/*, bool IsCu
 
         UpdateSubresources(cmdList, m_resource.Get(), m_uploadResource.Get(), (UINT64)0u, 0u, static_cast<UINT>(subresources.size()), subresources.data());
 
-        CD3DX12_RESOURCE_BARRIER barrier = CD3DX12_RESOURCE_BARRIER::Transition(m_resource.Get(), D3D12_RESOURCE_STATE_COPY_DEST, D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE);
+        if (!isCopyList)
+        {
+            CD3DX12_RESOURCE_BARRIER barrier = CD3DX12_RESOURCE_BARRIER::Transition(m_resource.Get(), D3D12_RESOURCE_STATE_COPY_DEST, D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE);
+            cmdList->ResourceBarrier(1, &barrier);
+        }
+
+        // index for CubeMap is always constant and defined at init time
+        m_descriptorHeapOffset = SkyboxSrvHeapStartIndex;
+
+        m_bIsInitialized = true;
+        return true;
+    }
+
+    void Texture::CreateView()
+    {
+        if (!m_bIsInitialized)
+            return;
 
-        cmdList->ResourceBarrier(1, &barrier);
+        auto& device = Device::GetInstance();
+        const D3D12_RESOURCE_DESC resourceDesc = m_resource->GetDesc();
 
         D3D12_SHADER_RESOURCE_VIEW_DESC srvDesc = {};
-        srvDesc.Format = mipMetadata.format;
-        srvDesc.ViewDimension = D3D12_SRV_DIMENSION_TEXTURECUBE;
+        srvDesc.Format = resourceDesc.Format;
         srvDesc.Shader4ComponentMapping = D3D12_DEFAULT_SHADER_4_COMPONENT_MAPPING;
-        srvDesc.TextureCube.MipLevels = static_cast<UINT>(mipMetadata.mipLevels);
-        srvDesc.TextureCube.MostDetailedMip = 0;
-        srvDesc.TextureCube.ResourceMinLODClamp = 0.0f;
-
-        auto srvCpuStart = device.GetDescriptorHeap()->GetCPUDescriptorHandleForHeapStart();
-        auto cbvSrvUavDescriptorSize = device.GetDescriptorHandleIncrementSize();
 
-        localHandle = CD3DX12_CPU_DESCRIPTOR_HANDLE(srvCpuStart, SkyboxSrvHeapStartIndex, cbvSrvUavDescriptorSize);
-        // index for CubeMap is always constant and defined at init time
+        [[likely]]
+        if (!(m_type == TextureType::CUBEMAP))
+        {
+            srvDesc.ViewDimension = D3D12_SRV_DIMENSION_TEXTURE2D;
+            srvDesc.Texture2D.MostDetailedMip = 0u;
+            srvDesc.Texture2D.MipLevels = resourceDesc.MipLevels;
+            srvDesc.Texture2D.PlaneSlice = 0;
+            srvDesc.Texture2D.ResourceMinLODClamp = 0.0f;
+
+            // frames copy the view into their own table once the GPU is done with it
+            localHandle = CD3DX12_CPU_DESCRIPTOR_HANDLE(RenderSubsystem::GetInstance().GetTextureViews().GetWriteHandle(
+                m_descriptorHeapOffset - TextureSrvHeapStartIndex));
+        }
+        else
+        {
+            srvDesc.ViewDimension = D3D12_SRV_DIMENSION_TEXTURECUBE;
+            srvDesc.TextureCube.MipLevels = resourceDesc.MipLevels;
+            srvDesc.TextureCube.MostDetailedMip = 0;
+            srvDesc.TextureCube.ResourceMinLODClamp = 0.0f;
+
+            auto srvCpuStart = device.GetDescriptorHeap()->GetCPUDescriptorHandleForHeapStart();
+            auto cbvSrvUavDescriptorSize = device.GetDescriptorHandleIncrementSize();
+            localHandle = CD3DX12_CPU_DESCRIPTOR_HANDLE(srvCpuStart, m_descriptorHeapOffset, cbvSrvUavDescriptorSize);
+        }
         device.CreateShaderResourceView(m_resource.Get(), &srvDesc, localHandle);
-
-        m_bIsInitialized = true;
     }
 
     void Texture::DisposeUploaders()
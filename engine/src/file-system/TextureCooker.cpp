@@ -0,0 +1,337 @@
+#include "file-system/TextureCooker.h"
+
+#include "file-system/DerivedDataCache.h"
+#include "subsystems/LogMacros.h"
+#include "tools/Profiler.h"
+
+// only the CPU side of DirectXTex, without d3d12.h it leaves the device helpers out
+#include <DirectXTex/DirectXTex/DirectXTex.h>
+
+#define STB_IMAGE_IMPLEMENTATION
+#define STBI_ONLY_PNG
+#define STBI_ONLY_JPEG
+#define STBI_ONLY_BMP
+#ifdef _MSC_VER
+#pragma warning(push, 0)
+#endif
+#include <stb/stb_image.h>
+#ifdef _MSC_VER
+#pragma warning(pop)
+#endif
+
+#include <EASTL/algorithm.h>
+#include <EASTL/array.h>
+#include <EASTL/unordered_map.h>
+#include <EASTL/vector.h>
+#include <yaml-cpp/yaml.h>
+
+#include <chrono>
+#include <cstring>
+#include <fstream>
+
+namespace Blainn
+{
+namespace
+{
+constexpr uint32_t kMagic = 0x58544642u; // "BFTX"
+
+// everything cooked is decoded the same on every host, tiff sources are left to the runtime decoder
+const eastl::array<std::string, 7> kSourceFormats = {".png", ".jpg", ".jpeg", ".bmp", ".tga", ".dds", ".hdr"};
+
+std::string ToLower(std::string text)
+{
+    eastl::transform(text.begin(), text.end(), text.begin(),
+                     [](char c) { return static_cast<char>(::tolower(static_cast<unsigned char>(c))); });
+    return text;
+}
+
+// RGBA like WIC_FLAGS_FORCE_RGB gave, 16 bit PNGs keep their precision
+bool LoadWithStb(const Path &absolutePath, DirectX::ScratchImage &outImage)
+{
+    std::ifstream file(absolutePath, std::ios::binary | std::ios::ate);
+    const std::streamsize fileSize = file ? static_cast<std::streamsize>(file.tellg()) : 0;
+    if (fileSize <= 0) return false;
+
+    eastl::vector<uint8_t> fileData(static_cast<size_t>(fileSize));
+    file.seekg(0, std::ios::beg);
+    if (!file.read(reinterpret_cast<char *>(fileData.data()), fileSize)) return false;
+
+    const auto *bytes = fileData.data();
+    const int size = static_cast<int>(fileData.size());
+    const bool is16Bit = stbi_is_16_bit_from_memory(bytes, size) != 0;
+
+    int width = 0;
+    int height = 0;
+    int channels = 0;
+    void *pixels = is16Bit ? static_cast<void *>(stbi_load_16_from_memory(bytes, size, &width, &height, &channels, 4))
+                           : static_cast<void *>(stbi_load_from_memory(bytes, size, &width, &height, &channels, 4));
+    if (!pixels) return false;
+
+    const DXGI_FORMAT format = is16Bit ? DXGI_FORMAT_R16G16B16A16_UNORM : DXGI_FORMAT_R8G8B8A8_UNORM;
+    const bool isCreated =
+        SUCCEEDED(outImage.Initialize2D(format, static_cast<size_t>(width), static_cast<size_t>(height), 1u, 1u));
+    if (isCreated)
+    {
+        const DirectX::Image &image = *outImage.GetImage(0u, 0u, 0u);
+        const size_t rowSize = static_cast<size_t>(width) * 4u * (is16Bit ? 2u : 1u);
+        for (size_t row = 0u; row < static_cast<size_t>(height); ++row)
+            std::memcpy(image.pixels + row * image.rowPitch, static_cast<const uint8_t *>(pixels) + row * rowSize,
+                        rowSize);
+    }
+
+    stbi_image_free(pixels);
+    return isCreated;
+}
+
+bool LoadSource(const Path &absolutePath, DirectX::ScratchImage &outImage)
+{
+    const std::string extension = ToLower(absolutePath.extension().string());
+    const std::wstring path = absolutePath.wstring();
+    if (extension == ".dds")
+        return SUCCEEDED(DirectX::LoadFromDDSFile(path.c_str(), DirectX::DDS_FLAGS_FORCE_RGB, nullptr, outImage));
+    if (extension == ".tga") return SUCCEEDED(DirectX::LoadFromTGAFile(path.c_str(), nullptr, outImage));
+    if (extension == ".hdr") return SUCCEEDED(DirectX::LoadFromHDRFile(path.c_str(), nullptr, outImage));
+
+    return LoadWithStb(absolutePath, outImage);
+}
+
+// the texture slots of a .mat file, keys as AssetLoader::ParseMaterial reads them
+void CollectMaterialTextureTypes(const Path &materialPath, eastl::unordered_map<eastl::string, TextureType> &outTypes)
+{
+    static const eastl::pair<const char *, TextureType> slots[] = {{"AlbedoPath", TextureType::ALBEDO},
+                                                                   {"NormalPath", TextureType::NORMAL},
+                                                                   {"MetallicPath", TextureType::METALLIC},
+                                                                   {"RoughnessPath", TextureType::ROUGHNESS},
+                                                                   {"AOPath", TextureType::AO}};
+    try
+    {
+        const YAML::Node material = YAML::LoadFile(materialPath.string());
+        for (const auto &[key, type] : slots)
+        {
+            if (!material[key]) continue;
+
+            const Path texturePath = material[key].as<std::string>();
+            if (!texturePath.empty()) outTypes[texturePath.lexically_normal().string().c_str()] = type;
+        }
+    }
+    catch (const std::exception &e)
+    {
+        BF_WARN("TextureCooker: can't read the texture slots of {0}: {1}", materialPath.string(), e.what());
+    }
+}
+
+DXGI_FORMAT GetCookedFormat(TextureType type, const DirectX::ScratchImage &image)
+{
+    switch (type)
+    {
+    case TextureType::ALBEDO:
+        return DXGI_FORMAT_BC7_UNORM;
+    case TextureType::NORMAL:
+        // z is rebuilt in the shader
+        return DXGI_FORMAT_BC5_UNORM;
+    case TextureType::METALLIC:
+    case TextureType::ROUGHNESS:
+    case TextureType::AO:
+        return DXGI_FORMAT_BC4_UNORM;
+    case TextureType::CUBEMAP:
+        return DirectX::FormatDataType(image.GetMetadata().format) == DirectX::FORMAT_TYPE_FLOAT
+                   ? DXGI_FORMAT_BC6H_UF16
+                   : DXGI_FORMAT_BC7_UNORM;
+    default:
+        return image.IsAlphaAllOpaque() ? DXGI_FORMAT_BC1_UNORM : DXGI_FORMAT_BC3_UNORM;
+    }
+}
+} // namespace
+
+bool TextureCooker::Cook(const Path &absoluteSourcePath, TextureType type, CookStats &outStats)
+{
+    BLAINN_PROFILE_FUNC();
+    using namespace DirectX;
+
+    FileHeader header = {};
+    header.Magic = kMagic;
+    header.Version = kVersion;
+
+    ScratchImage source;
+    if (!LoadSource(absoluteSourcePath, source))
+    {
+        BF_ERROR("TextureCooker: can't decode {0}", absoluteSourcePath.string());
+        return false;
+    }
+
+    // compressed sources are expanded, they are compressed again in the format of their type
+    if (IsCompressed(source.GetMetadata().format))
+    {
+        ScratchImage decompressed;
+        if (FAILED(Decompress(source.GetImages(), source.GetImageCount(), source.GetMetadata(), DXGI_FORMAT_UNKNOWN,
+                              decompressed)))
+        {
+            BF_ERROR("TextureCooker: can't decompress {0}", absoluteSourcePath.string());
+            return false;
+        }
+        source = eastl::move(decompressed);
+    }
+
+    const TexMetadata &metadata = source.GetMetadata();
+    if (type == TextureType::NONE) type = metadata.IsCubemap() ? TextureType::CUBEMAP : TextureType::ALBEDO;
+    if (type == TextureType::CUBEMAP && !(metadata.IsCubemap() && metadata.arraySize == 6))
+    {
+        BF_ERROR("TextureCooker: {0} is used as a cubemap but has no 6 faces", absoluteSourcePath.string());
+        return false;
+    }
+
+    // sources with their own chain keep it, like at runtime
+    ScratchImage mipChain;
+    if (metadata.mipLevels == 1)
+    {
+        if (FAILED(GenerateMipMaps(source.GetImages(), source.GetImageCount(), metadata, TEX_FILTER_DEFAULT, 0,
+                                   mipChain)))
+        {
+            BF_ERROR("TextureCooker: can't generate mips of {0}", absoluteSourcePath.string());
+            return false;
+        }
+    }
+    else
+    {
+        mipChain = eastl::move(source);
+    }
+
+    ScratchImage compressed;
+    const ScratchImage *cooked = &mipChain;
+    const TexMetadata &chainMetadata = mipChain.GetMetadata();
+    if (chainMetadata.width % 4u != 0u || chainMetadata.height % 4u != 0u)
+    {
+        BF_WARN("TextureCooker: {0} is {1}x{2}, block compression needs multiples of 4, it is cooked uncompressed",
+                absoluteSourcePath.string(), chainMetadata.width, chainMetadata.height);
+    }
+    else
+    {
+        const DXGI_FORMAT format = GetCookedFormat(type, mipChain);
+        const TEX_COMPRESS_FLAGS flags = format == DXGI_FORMAT_BC7_UNORM ? TEX_COMPRESS_BC7_QUICK : TEX_COMPRESS_DEFAULT;
+        if (FAILED(Compress(mipChain.GetImages(), mipChain.GetImageCount(), chainMetadata, format, flags,
+                            TEX_THRESHOLD_DEFAULT, compressed)))
+        {
+            BF_ERROR("TextureCooker: can't compress {0}", absoluteSourcePath.string());
+            return false;
+        }
+        cooked = &compressed;
+    }
+
+    Blob payload;
+    if (FAILED(SaveToDDSMemory(cooked->GetImages(), cooked->GetImageCount(), cooked->GetMetadata(), DDS_FLAGS_NONE,
+                               payload)))
+    {
+        BF_ERROR("TextureCooker: can't encode {0}", absoluteSourcePath.string());
+        return false;
+    }
+
+    header.Type = static_cast<uint32_t>(type);
+    header.Format = static_cast<uint32_t>(cooked->GetMetadata().format);
+    header.PayloadSize = payload.GetBufferSize();
+
+    // keyed by the type the texture was cooked for, NONE resolves above
+    DerivedDataCache::Key key;
+    if (!DerivedDataCache::MakeKey(absoluteSourcePath, processorName, kVersion, static_cast<uint64_t>(type), key))
+        return false;
+
+    const bool isWritten = DerivedDataCache::Write(
+        key,
+        [&header, &payload](std::ofstream &file)
+        {
+            file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+            file.write(reinterpret_cast<const char *>(payload.GetBufferPointer()),
+                       static_cast<std::streamsize>(payload.GetBufferSize()));
+            return true;
+        });
+    if (!isWritten) return false;
+
+    outStats.RuntimeSize = mipChain.GetPixelsSize();
+    outStats.CookedSize = cooked->GetPixelsSize();
+    return true;
+}
+
+bool TextureCooker::Load(const Path &absoluteSourcePath, TextureType type, DirectX::ScratchImage &outImage)
+{
+    BLAINN_PROFILE_FUNC();
+
+    DerivedDataCache::Key key;
+    eastl::vector<uint8_t> cookedData;
+    if (!DerivedDataCache::MakeKey(absoluteSourcePath, processorName, kVersion, static_cast<uint64_t>(type), key)
+        || !DerivedDataCache::Read(key, cookedData))
+        return false;
+
+    FileHeader header = {};
+    if (cookedData.size() >= sizeof(header)) std::memcpy(&header, cookedData.data(), sizeof(header));
+
+    if (header.Magic != kMagic || header.Version != kVersion || header.Type != static_cast<uint32_t>(type)
+        || header.PayloadSize != cookedData.size() - sizeof(header)
+        || FAILED(DirectX::LoadFromDDSMemory(cookedData.data() + sizeof(header), header.PayloadSize,
+                                             DirectX::DDS_FLAGS_NONE, nullptr, outImage)))
+    {
+        DerivedDataCache::Reject(key);
+        return false;
+    }
+    return true;
+}
+
+bool TextureCooker::CookDirectory(const Path &contentDirectory)
+{
+    using Clock = std::chrono::steady_clock;
+
+    std::error_code error;
+    if (!std::filesystem::is_directory(contentDirectory, error))
+    {
+        BF_ERROR("TextureCooker: {0} is not a directory", contentDirectory.string());
+        return false;
+    }
+
+    // a texture is compressed by the slot it fills in a material, unreferenced ones are taken as albedo or cubemap
+    eastl::unordered_map<eastl::string, TextureType> textureTypes;
+    for (const auto &entry : std::filesystem::recursive_directory_iterator(
+             contentDirectory, std::filesystem::directory_options::skip_permission_denied, error))
+    {
+        if (entry.is_regular_file() && ToLower(entry.path().extension().string()) == ".mat")
+            CollectMaterialTextureTypes(entry.path(), textureTypes);
+    }
+
+    size_t cookedCount = 0u;
+    uint64_t totalRuntimeSize = 0u;
+    uint64_t totalCookedSize = 0u;
+    double totalCookMs = 0.0;
+
+    for (const auto &entry : std::filesystem::recursive_directory_iterator(
+             contentDirectory, std::filesystem::directory_options::skip_permission_denied, error))
+    {
+        if (!entry.is_regular_file()) continue;
+
+        const std::string extension = ToLower(entry.path().extension().string());
+        if (eastl::find(kSourceFormats.begin(), kSourceFormats.end(), extension) == kSourceFormats.end()) continue;
+
+        const Path &absolutePath = entry.path();
+        const Path relativePath = std::filesystem::relative(absolutePath, contentDirectory);
+
+        TextureType type = TextureType::NONE;
+        if (auto it = textureTypes.find(relativePath.lexically_normal().string().c_str()); it != textureTypes.end())
+            type = it->second;
+
+        auto cookStart = Clock::now();
+        CookStats stats;
+        if (!Cook(absolutePath, type, stats)) continue;
+        double cookMs = std::chrono::duration<double, std::milli>(Clock::now() - cookStart).count();
+
+        BF_INFO("Cooked {0}: {1} KiB -> {2} KiB in VRAM, {3:.2f} ms", relativePath.string(),
+                stats.RuntimeSize / 1024u, stats.CookedSize / 1024u, cookMs);
+
+        ++cookedCount;
+        totalRuntimeSize += stats.RuntimeSize;
+        totalCookedSize += stats.CookedSize;
+        totalCookMs += cookMs;
+    }
+
+    const double savedPercent =
+        totalRuntimeSize ? 100.0 * static_cast<double>(totalRuntimeSize - totalCookedSize) / totalRuntimeSize : 0.0;
+    BF_INFO("Cooked {0} textures in {1:.2f} ms: {2} KiB -> {3} KiB in VRAM, {4:.1f}% saved", cookedCount, totalCookMs,
+            totalRuntimeSize / 1024u, totalCookedSize / 1024u, savedPercent);
+    return true;
+}
+} // namespace Blainn
@@ -5,98 +5,74 @@
 #include "handles/Handle.h"
 
 #include "AssetManager.h"
-#include "random.h"
 #include "file-system/Material.h"
+#include "file-system/Model.h"
 
 
-Blainn::Handle::Handle(const unsigned int index, AssetManager &manager)
-    : id(Rand::getRandomUUID())
-    , m_index(index)
-    , m_manager(manager)
-{
-}
-
-
-Blainn::Handle::~Handle()
+Blainn::Texture &Blainn::TextureHandle::GetTexture() const
 {
+    auto &manager = AssetManager::GetInstance();
+    if (Texture *texture = manager.FindTexture(*this); texture && texture->IsLoaded()) return *texture;
+    return manager.GetDefaultTexture();
 }
 
-
-unsigned int Blainn::Handle::GetIndex() const
+uint32_t Blainn::TextureHandle::GetIndex() const
 {
-    return m_index;
+    if (Texture *texture = AssetManager::GetInstance().FindTexture(*this); texture && texture->IsLoaded())
+        return Handle::GetIndex();
+    return 0;
 }
 
-
-Blainn::TextureHandle::TextureHandle(const unsigned int index, AssetManager &manager)
-    : Handle(index, manager)
+void Blainn::TextureHandle::AddReference(const Handle &handle)
 {
-    manager.IncreaseTextureRefCount(index);
+    if (handle) AssetManager::GetInstance().IncreaseTextureRefCount(handle);
 }
 
-
-Blainn::TextureHandle::~TextureHandle()
+void Blainn::TextureHandle::Release(const Handle &handle)
 {
-    m_manager.DecreaseTextureRefCount(m_index);
+    if (handle) AssetManager::GetInstance().DecreaseTextureRefCount(handle);
 }
 
 
-Blainn::Texture &Blainn::TextureHandle::GetTexture() const
+Blainn::Material &Blainn::MaterialHandle::GetMaterial() const
 {
-    if (AssetManager::GetInstance().GetTextureByIndex(m_index).IsLoaded())
-        return AssetManager::GetInstance().GetTextureByIndex(m_index);
-    return AssetManager::GetInstance().GetTextureByIndex(0);
+    auto &manager = AssetManager::GetInstance();
+    if (Material *material = manager.FindMaterial(*this); material && material->AreTexturesLoaded())
+        return *material;
+    return manager.GetDefaultMaterial();
 }
 
-unsigned int Blainn::TextureHandle::GetIndex() const
+uint32_t Blainn::MaterialHandle::GetIndex() const
 {
-    if (AssetManager::GetInstance().GetTextureByIndex(m_index).IsLoaded())
-        return m_index;
+    if (Material *material = AssetManager::GetInstance().FindMaterial(*this); material && material->AreTexturesLoaded())
+        return Handle::GetIndex();
     return 0;
 }
 
-
-Blainn::MaterialHandle::MaterialHandle(const unsigned int index, AssetManager &manager)
-    : Handle(index, manager)
+void Blainn::MaterialHandle::AddReference(const Handle &handle)
 {
-    manager.IncreaseMaterialRefCount(index);
+    if (handle) AssetManager::GetInstance().IncreaseMaterialRefCount(handle);
 }
 
-
-Blainn::MaterialHandle::~MaterialHandle()
+void Blainn::MaterialHandle::Release(const Handle &handle)
 {
-    m_manager.DecreaseMaterialRefCount(m_index);
+    if (handle) AssetManager::GetInstance().DecreaseMaterialRefCount(handle);
 }
 
 
-Blainn::Material &Blainn::MaterialHandle::GetMaterial() const
-{
-    if (AssetManager::GetInstance().GetMaterialByIndex(m_index).AreTexturesLoaded())
-        return AssetManager::GetInstance().GetMaterialByIndex(m_index);
-    return AssetManager::GetInstance().GetMaterialByIndex(0);
-}
-
-unsigned int Blainn::MaterialHandle::GetIndex() const
+Blainn::Model &Blainn::MeshHandle::GetMesh() const
 {
-    if (AssetManager::GetInstance().GetMaterialByIndex(m_index).AreTexturesLoaded())
-        return m_index;
-    return 0;
+    auto &manager = AssetManager::GetInstance();
+    if (Model *model = manager.FindMesh(*this); model && model->IsLoaded()) return *model;
+    return manager.GetDefaultModel();
 }
 
-
-Blainn::MeshHandle::MeshHandle(const unsigned int index, AssetManager &manager)
-    : Handle(index, manager)
+void Blainn::MeshHandle::AddReference(const Handle &handle)
 {
-    manager.IncreaseMeshRefCount(index);
+    if (handle) AssetManager::GetInstance().IncreaseMeshRefCount(handle);
 }
 
-Blainn::MeshHandle::~MeshHandle()
+void Blainn::MeshHandle::Release(const Handle &handle)
 {
-    m_manager.DecreaseMeshRefCount(m_index);
+    if (handle) AssetManager::GetInstance().DecreaseMeshRefCount(handle);
 }
-
-
-Blainn::Model &Blainn::MeshHandle::GetMesh() const
-{
-    return AssetManager::GetInstance().GetMeshByIndex(m_index);
-}
\ No newline at end of file
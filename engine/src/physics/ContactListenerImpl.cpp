@@ -5,8 +5,23 @@
 
 #include "subsystems/PhysicsSubsystem.h"
 
+#include <atomic>
+
 using namespace Blainn;
 
+namespace
+{
+std::atomic<uint32_t> s_nextListenerId{1};
+
+thread_local uint32_t t_bufferListenerId = 0;
+thread_local eastl::vector<PhysicsEvent> *t_eventBuffer = nullptr;
+} // namespace
+
+ContactListenerImpl::ContactListenerImpl()
+    : mListenerId(s_nextListenerId.fetch_add(1, std::memory_order_relaxed))
+{
+}
+
 JPH::ValidateResult ContactListenerImpl::OnContactValidate(const JPH::Body &inBody1, const JPH::Body &inBody2,
                                                            JPH::RVec3Arg inBaseOffset,
                                                            const JPH::CollideShapeResult &inCollisionResult)
@@ -35,6 +50,7 @@ void ContactListenerImpl::OnContactAdded(const JPH::Body &inBody1, const JPH::Bo
     JPH::BodyID bodyID1 = inBody1.GetID();
     JPH::BodyID bodyID2 = inBody2.GetID();
 
+#ifdef BLAINN_TRACK_CONTACT_STATE
     // Expect bodies to be sorted
     if (!(bodyID1 < bodyID2)) JPH_BREAKPOINT;
 
@@ -45,20 +61,9 @@ void ContactListenerImpl::OnContactAdded(const JPH::Body &inBody1, const JPH::Bo
         if (mState.find(key) != mState.end()) JPH_BREAKPOINT; // Added contact that already existed
         mState[key] = StatePair(inManifold.mBaseOffset, inManifold.mRelativeContactPointsOn1);
     }
+#endif
 
-    if (PhysicsSubsystem::m_bodyEntityConnections.contains(bodyID1)
-        && PhysicsSubsystem::m_bodyEntityConnections.contains(bodyID2))
-    {
-        PhysicsEvent event{.eventType = PhysicsEventType::CollisionStarted,
-                           .entity1 = PhysicsSubsystem::m_bodyEntityConnections[bodyID1],
-                           .entity2 = PhysicsSubsystem::m_bodyEntityConnections[bodyID2]};
-
-        PhysicsSubsystem::s_physicsEventQueue.enqueue(eastl::make_shared<PhysicsEvent>(eastl::move(event)));
-    }
-    else
-    {
-        BF_ERROR("INTERNAL ERROR collision added invalid entity id");
-    }
+    PushEvent(PhysicsEventType::CollisionStarted, bodyID1, bodyID2);
 
     if (mNext != nullptr) mNext->OnContactAdded(inBody1, inBody2, inManifold, ioSettings);
 }
@@ -68,6 +73,7 @@ void ContactListenerImpl::OnContactPersisted(const JPH::Body &inBody1, const JPH
 {
     // BF_INFO("PHYSICS ON CONTACT PERSISTED");
 
+#ifdef BLAINN_TRACK_CONTACT_STATE
     // Expect bodies to be sorted
     if (!(inBody1.GetID() < inBody2.GetID())) JPH_BREAKPOINT;
 
@@ -79,6 +85,7 @@ void ContactListenerImpl::OnContactPersisted(const JPH::Body &inBody1, const JPH
         if (i != mState.end()) i->second = StatePair(inManifold.mBaseOffset, inManifold.mRelativeContactPointsOn1);
         else JPH_BREAKPOINT; // Persisted contact that didn't exist
     }
+#endif
 
     if (mNext != nullptr) mNext->OnContactPersisted(inBody1, inBody2, inManifold, ioSettings);
 }
@@ -90,6 +97,7 @@ void ContactListenerImpl::OnContactRemoved(const JPH::SubShapeIDPair &inSubShape
     JPH::BodyID bodyID1 = inSubShapePair.GetBody1ID();
     JPH::BodyID bodyID2 = inSubShapePair.GetBody2ID();
 
+#ifdef BLAINN_TRACK_CONTACT_STATE
     // Expect bodies to be sorted
     if (!(bodyID1 < bodyID2)) JPH_BREAKPOINT;
 
@@ -100,24 +108,49 @@ void ContactListenerImpl::OnContactRemoved(const JPH::SubShapeIDPair &inSubShape
         if (i != mState.end()) mState.erase(i);
         else JPH_BREAKPOINT; // Removed contact that didn't exist
     }
+#endif
 
-    if (PhysicsSubsystem::m_bodyEntityConnections.contains(bodyID1)
-        && PhysicsSubsystem::m_bodyEntityConnections.contains(bodyID2))
-    {
-        PhysicsEvent event{.eventType = PhysicsEventType::CollisionEnded,
-                           .entity1 = PhysicsSubsystem::m_bodyEntityConnections[bodyID1],
-                           .entity2 = PhysicsSubsystem::m_bodyEntityConnections[bodyID2]};
+    PushEvent(PhysicsEventType::CollisionEnded, bodyID1, bodyID2);
 
-        PhysicsSubsystem::s_physicsEventQueue.enqueue(eastl::make_shared<PhysicsEvent>(eastl::move(event)));
+    if (mNext != nullptr) mNext->OnContactRemoved(inSubShapePair);
+}
+
+void ContactListenerImpl::CollectEvents(eastl::vector<PhysicsEvent> &outEvents)
+{
+    std::lock_guard lock(mBuffersMutex);
+    for (eastl::unique_ptr<EventBuffer> &buffer : mBuffers)
+    {
+        outEvents.insert(outEvents.end(), buffer->begin(), buffer->end());
+        buffer->clear();
     }
-    else
+}
+
+ContactListenerImpl::EventBuffer &ContactListenerImpl::GetThreadEventBuffer()
+{
+    if (t_bufferListenerId == mListenerId) [[likely]]
+        return *t_eventBuffer;
+
+    std::lock_guard lock(mBuffersMutex);
+    mBuffers.push_back(eastl::make_unique<EventBuffer>());
+    t_eventBuffer = mBuffers.back().get();
+    t_bufferListenerId = mListenerId;
+    return *t_eventBuffer;
+}
+
+void ContactListenerImpl::PushEvent(PhysicsEventType eventType, JPH::BodyID bodyID1, JPH::BodyID bodyID2)
+{
+    const uuid *entity1 = PhysicsSubsystem::TryGetEntityIdByBodyId(bodyID1);
+    const uuid *entity2 = PhysicsSubsystem::TryGetEntityIdByBodyId(bodyID2);
+    if (!entity1 || !entity2)
     {
-        BF_ERROR("INTERNAL ERROR collision ended invalid entity id");
+        BF_ERROR("INTERNAL ERROR collision event with invalid entity id");
+        return;
     }
 
-    if (mNext != nullptr) mNext->OnContactRemoved(inSubShapePair);
+    GetThreadEventBuffer().push_back(PhysicsEvent{.eventType = eventType, .entity1 = *entity1, .entity2 = *entity2});
 }
 
+#ifdef BLAINN_TRACK_CONTACT_STATE
 void ContactListenerImpl::SaveState(JPH::StateRecorder &inStream) const
 {
     // Write length
@@ -197,3 +230,4 @@ void ContactListenerImpl::RestoreState(JPH::StateRecorder &inStream)
         mState[key] = sp;
     }
 }
+#endif
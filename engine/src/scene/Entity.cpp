@@ -37,6 +37,17 @@ bool Entity::HasComponent(entt::id_type typeId)
 }
 
 
+bool Entity::RemoveComponentIfExists(entt::id_type typeId)
+{
+    if (!m_Scene || !m_Scene->m_Registry.valid(m_EntityHandle)) return false;
+
+    auto *storage = m_Scene->m_Registry.storage(typeId);
+    if (!storage) return false;
+
+    return storage->remove(m_EntityHandle);
+}
+
+
 Entity Entity::GetParent() const
 {
     return m_Scene->TryGetEntityWithUUID(GetParentUUID());
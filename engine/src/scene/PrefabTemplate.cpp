@@ -0,0 +1,157 @@
+#include "pch.h"
+
+#include "scene/PrefabTemplate.h"
+
+#include "tools/ComponentRegistry.h"
+
+namespace Blainn
+{
+namespace
+{
+uint32_t FindComponent(entt::id_type typeId)
+{
+    for (uint32_t i = 0; i < static_cast<uint32_t>(g_componentRegistry.size()); ++i)
+        if (g_componentRegistry[i].first == typeId) return i;
+    return UINT32_MAX;
+}
+
+bool Contains(const eastl::vector<uint32_t> &components, uint32_t component)
+{
+    return eastl::find(components.begin(), components.end(), component) != components.end();
+}
+
+bool IsSame(const YAML::Node &lhs, const YAML::Node &rhs)
+{
+    return YAML::Dump(lhs) == YAML::Dump(rhs);
+}
+
+void GetFields(const YAML::Node &component, eastl::vector<eastl::string> &outFields)
+{
+    if (!component.IsMap()) return;
+    for (const auto &field : component)
+        outFields.push_back(field.first.as<std::string>().c_str());
+}
+
+void DiffFields(const YAML::Node &previous, const YAML::Node &current, eastl::vector<eastl::string> &outFields)
+{
+    if (!previous.IsMap() || !current.IsMap()) return;
+
+    for (const auto &field : current)
+    {
+        const std::string key = field.first.as<std::string>();
+        if (!previous[key] || !IsSame(previous[key], field.second)) outFields.push_back(key.c_str());
+    }
+    for (const auto &field : previous)
+    {
+        const std::string key = field.first.as<std::string>();
+        if (!current[key]) outFields.push_back(key.c_str());
+    }
+}
+} // namespace
+
+
+bool PrefabTemplate::Build(const YAML::Node &prefabNode)
+{
+    BLAINN_PROFILE_FUNC();
+
+    m_nodes.clear();
+    m_components.clear();
+
+    if (!prefabNode || !prefabNode["Entities"] || !prefabNode["Entities"].IsSequence()
+        || prefabNode["Entities"].size() == 0)
+    {
+        BF_WARN("Invalid or empty prefab entities node");
+        return false;
+    }
+
+    for (const auto &entityNode : prefabNode["Entities"])
+        AddNode(entityNode, kNoParent);
+
+    return true;
+}
+
+
+void PrefabTemplate::AddNode(const YAML::Node &node, uint32_t parent)
+{
+    const uint32_t index = static_cast<uint32_t>(m_nodes.size());
+    Node &templateNode = m_nodes.push_back();
+    templateNode.Tag = HasTag(node) ? GetTag(node["TagComponent"]) : GetTag(node);
+    templateNode.Parent = parent;
+    templateNode.Prototype = m_components.create();
+    templateNode.Source = node;
+
+    for (uint32_t i = 0; i < static_cast<uint32_t>(g_componentRegistry.size()); ++i)
+    {
+        const auto &[typeId, meta] = g_componentRegistry[i];
+        // the tag is set on creation, relationships are rebuilt from the node hierarchy
+        if (typeId == entt::type_hash<TagComponent>::value()
+            || typeId == entt::type_hash<RelationshipComponent>::value() || !meta.hasComponent(node))
+            continue;
+
+        if (meta.decodeTemplate) meta.decodeTemplate(m_components, templateNode.Prototype, node);
+        templateNode.Components.push_back(i);
+    }
+
+    // templateNode is not used past here, children grow m_nodes
+    if (node["RelationshipComponent"] && node["RelationshipComponent"]["Entities"]
+        && node["RelationshipComponent"]["Entities"].IsSequence())
+    {
+        for (const auto &childNode : node["RelationshipComponent"]["Entities"])
+            AddNode(childNode, index);
+    }
+}
+
+
+bool PrefabTemplate::Diff(const PrefabTemplate *previous, const PrefabTemplate &current,
+                          eastl::vector<ComponentDelta> &outDeltas)
+{
+    BLAINN_PROFILE_FUNC();
+
+    outDeltas.clear();
+    const auto &nodes = current.m_nodes;
+    if (previous)
+    {
+        if (previous->m_nodes.size() != nodes.size()) return false;
+        for (size_t i = 0; i < nodes.size(); ++i)
+            if (previous->m_nodes[i].Parent != nodes[i].Parent) return false;
+    }
+
+    using Change = ComponentDelta::Change;
+    const uint32_t tagComponent = FindComponent(entt::type_hash<TagComponent>::value());
+    for (uint32_t nodeIndex = 0; nodeIndex < static_cast<uint32_t>(nodes.size()); ++nodeIndex)
+    {
+        const Node &node = nodes[nodeIndex];
+        const Node *old = previous ? &previous->m_nodes[nodeIndex] : nullptr;
+
+        if (!old || old->Tag != node.Tag) outDeltas.push_back({nodeIndex, tagComponent, Change::Changed, {"Tag"}});
+
+        // sources are compared as text, a prefab edit is rare enough
+        for (uint32_t component : node.Components)
+        {
+            const char *name = g_componentRegistry[component].second.name.c_str();
+            const YAML::Node value = node.Source[name];
+
+            ComponentDelta delta{nodeIndex, component, Change::Changed, {}};
+            if (!old || !Contains(old->Components, component))
+            {
+                if (old) delta.Kind = Change::Added;
+                GetFields(value, delta.Fields);
+            }
+            else
+            {
+                const YAML::Node oldValue = old->Source[name];
+                if (IsSame(oldValue, value)) continue;
+                DiffFields(oldValue, value, delta.Fields);
+            }
+            outDeltas.push_back(eastl::move(delta));
+        }
+
+        if (!old) continue;
+        for (uint32_t component : old->Components)
+            if (!Contains(node.Components, component))
+                outDeltas.push_back({nodeIndex, component, Change::Removed, {}});
+    }
+
+    return true;
+}
+} // namespace Blainn
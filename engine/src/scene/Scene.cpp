@@ -25,6 +25,9 @@
 #include "Render/RuntimeCamera.h"
 #include "Render/EditorCamera.h"
 #include "components/PrefabComponent.h"
+#include "scene/PrefabTemplate.h"
+#include "scene/SceneDependencies.h"
+#include "scene/SceneSnapshot.h"
 #include "subsystems/AISubsystem.h"
 #include "subsystems/PerceptionSubsystem.h"
 
@@ -55,6 +58,20 @@ Scene::Scene(const YAML::Node &config)
 }
 
 
+Scene::Scene(const eastl::string_view &name, uuid uid, SceneSnapshot &snapshot)
+    : m_SceneID(uid)
+    , m_Name(name)
+{
+    s_sceneEventQueue.enqueue(eastl::make_shared<SceneChangedEvent>(m_Name));
+
+    snapshot.Restore(*this);
+
+    // not an unsaved edit, a bake writes the nav mesh path straight into the scene file
+    const Path absolutePath = Engine::GetContentDirectory() / std::string(m_Name.c_str());
+    if (std::filesystem::exists(absolutePath)) LoadNavMeshData(YAML::LoadFile(absolutePath.string()));
+}
+
+
 Scene::~Scene()
 {
     eastl::function<void()> fn;
@@ -170,6 +187,7 @@ void Scene::SaveScene()
 
     out << YAML::EndSeq; // Entities
 
+    SceneDependencies::Collect(*this).Serialize(out);
     Serializer::ExistingNavMeshData(absolutePath, out);
 
     out << YAML::EndMap; // Root
@@ -337,58 +355,58 @@ void Scene::CreateEntities(const YAML::Node &entitiesNode, bool onSceneChanged,
 
 Entity Scene::CreatePrefabEntity(const YAML::Node &prefabNode)
 {
-    if (!prefabNode)
-    {
-        BF_WARN("Invalid or empty prefab entities node");
-        return {};
-    }
+    PrefabTemplate prefab;
+    if (!prefab.Build(prefabNode)) return {};
 
-    auto &entitiesNode = prefabNode["Entities"];
+    eastl::vector<Entity> roots;
+    CreatePrefabEntities(prefab, 1, roots);
+    return roots.front();
+}
 
-    std::function<Entity(const YAML::Node &, Entity)> createRecursive = [&](const YAML::Node &node,
-                                                                            Entity parent) -> Entity
-    {
-        Entity entity = CreateEntity(GetTag(node), false, false);
+void Scene::CreatePrefabEntities(const PrefabTemplate &prefab, size_t count, eastl::vector<Entity> &outRoots)
+{
+    BLAINN_PROFILE_FUNC();
 
-        for (const auto &[typeId, meta] : g_componentRegistry)
-        {
-            if (typeId == entt::type_hash<RelationshipComponent>::value()) continue;
-            if (meta.hasComponent(node))
-            {
-                meta.deserializer(entity, node);
-            }
-        }
+    const auto &nodes = prefab.GetNodes();
+    outRoots.clear();
+    if (nodes.empty() || count == 0) return;
 
-        if (parent)
-        {
-            entity.SetParent(parent);
-        }
+    // instances of a node are contiguous, a component is copied into all of them in one go
+    eastl::vector<Entity> entities(nodes.size() * count);
+    for (size_t nodeIndex = 0; nodeIndex < nodes.size(); ++nodeIndex)
+    {
+        const PrefabTemplate::Node &node = nodes[nodeIndex];
+        Entity *instances = entities.data() + nodeIndex * count;
 
-        if (node["RelationshipComponent"] && node["RelationshipComponent"]["Entities"])
+        for (size_t i = 0; i < count; ++i)
+            instances[i] = CreateEntityWithID(Rand::getRandomUUID(), node.Tag.empty() ? "Untagged" : node.Tag, false);
+
+        for (uint32_t componentIndex : node.Components)
         {
-            const auto &childrenNodes = node["RelationshipComponent"]["Entities"];
-            if (childrenNodes.IsSequence())
+            const ComponentMeta &meta = g_componentRegistry[componentIndex].second;
+            if (meta.instantiateTemplate)
             {
-                for (const auto &childNode : childrenNodes)
-                {
-                    createRecursive(childNode, entity);
-                }
+                meta.instantiateTemplate(prefab.GetComponents(), node.Prototype, instances, count);
+                continue;
             }
-        }
 
-        return entity;
-    };
+            for (size_t i = 0; i < count; ++i)
+                meta.deserializer(instances[i], node.Source);
+        }
 
-    Entity root = createRecursive(entitiesNode[0], Entity{});
+        if (node.Parent == PrefabTemplate::kNoParent) continue;
 
-    for (size_t i = 1; i < entitiesNode.size(); ++i)
-    {
-        createRecursive(entitiesNode[i], Entity{});
+        const Entity *parents = entities.data() + node.Parent * count;
+        for (size_t i = 0; i < count; ++i)
+            instances[i].SetParent(parents[i]);
     }
 
     SortEntities();
 
-    return root;
+    // the first root of each instance, like CreatePrefabEntity returns
+    outRoots.reserve(count);
+    for (size_t i = 0; i < count; ++i)
+        outRoots.push_back(entities[i]);
 }
 
 
@@ -463,6 +481,33 @@ void Scene::DestroyEntityInternal(Entity entity, bool sceneChanged, bool exclude
     SortEntities();
 }
 
+
+void Scene::DestroyComponent(Entity entity, entt::id_type typeId)
+{
+    if (typeId == entt::type_hash<PhysicsComponent>::value())
+        PhysicsSubsystem::DestroyPhysicsComponent(entity);
+    else if (typeId == entt::type_hash<ScriptingComponent>::value())
+        ScriptingSubsystem::DestroyScriptingComponent(entity);
+    else if (typeId == entt::type_hash<AIControllerComponent>::value())
+        AISubsystem::GetInstance().DestroyAIControllerComponent(entity);
+    else if (typeId == entt::type_hash<PerceptionComponent>::value())
+        PerceptionSubsystem::GetInstance().DestroyPerceptionComponent(entity);
+    else if (typeId == entt::type_hash<StimulusComponent>::value())
+        PerceptionSubsystem::GetInstance().DestroyStimulusComponent(entity);
+    else if (typeId == entt::type_hash<CameraComponent>::value())
+        RenderSubsystem::GetInstance().DestroyCameraComponent(entity);
+    else if (typeId == entt::type_hash<DirectionalLightComponent>::value())
+        RenderSubsystem::GetInstance().DestroyDirectionalLightComponent(entity);
+    else if (typeId == entt::type_hash<PointLightComponent>::value())
+        RenderSubsystem::GetInstance().DestroyPointLightComponent(entity);
+    else if (typeId == entt::type_hash<SpotLightComponent>::value())
+        RenderSubsystem::GetInstance().DestroySpotLightComponent(entity);
+    else if (typeId == entt::type_hash<SkyboxComponent>::value())
+        RenderSubsystem::GetInstance().DestroySkyboxComponent(entity);
+    else
+        entity.RemoveComponentIfExists(typeId);
+}
+
 void Scene::DestroyEntityInternal(const uuid &entityID, bool sceneChanged, bool excludeChildren, bool first)
 {
     const auto it = m_EntityIdMap.find(entityID);
@@ -557,17 +602,17 @@ void Blainn::Scene::CreateAttachMeshComponent(Entity entity, const Path &path, c
         return;
     }
 
-    eastl::shared_ptr<MeshHandle> handlePtr;
+    MeshHandle handle;
     AssetManager &assetManagerInstance = AssetManager::GetInstance();
     if (assetManagerInstance.HasMesh(path))
     {
-        handlePtr = assetManagerInstance.GetMesh(path);
+        handle = assetManagerInstance.GetMesh(path);
     }
     else
     {
-        handlePtr = assetManagerInstance.LoadMesh(path, data);
+        handle = assetManagerInstance.LoadMesh(path, data);
     }
-    entity.AddComponent<MeshComponent>(eastl::move(handlePtr));
+    entity.AddComponent<MeshComponent>(eastl::move(handle));
 }
 
 
@@ -799,6 +844,15 @@ Mat4 Scene::GetWorldSpaceTransformMatrix(Entity entity)
     return Mat4();
 }
 
+bool Scene::IsWorldSpaceTransformFramesDirty(Entity entity)
+{
+    for (Entity current = entity; current; current = TryGetEntityWithUUID(current.GetParentUUID()))
+    {
+        if (auto *transformComp = current.Transform(); transformComp && transformComp->IsFramesDirty()) return true;
+    }
+    return false;
+}
+
 void Blainn::Scene::SetFromWorldSpaceTransformMatrix(Entity entity, Mat4 worldTransform)
 {
     Entity parent = TryGetEntityWithUUID(entity.GetParentUUID());
@@ -0,0 +1,172 @@
+#include "pch.h"
+
+#include "scene/SceneDependencies.h"
+
+#include "Engine.h"
+#include "components/MeshComponent.h"
+#include "components/SkyboxComponent.h"
+#include "file-system/FileSystemObject.h"
+#include "file-system/MaterialDesc.h"
+#include "handles/Handle.h"
+#include "scene/Scene.h"
+#include "subsystems/AssetLoader.h"
+#include "subsystems/AssetManager.h"
+
+namespace Blainn
+{
+namespace
+{
+// dedupes by path and skips files that don't exist, like the component parsers do
+class DependencyCollector
+{
+public:
+    void AddMesh(const Path &relativePath)
+    {
+        if (Accept(relativePath)) m_dependencies.Meshes.push_back(relativePath);
+    }
+
+    void AddMaterial(const Path &relativePath)
+    {
+        if (Accept(relativePath)) m_dependencies.Materials.push_back(relativePath);
+    }
+
+    void AddTexture(const Path &relativePath, TextureType type)
+    {
+        if (Accept(relativePath)) m_dependencies.Textures.push_back({relativePath, type});
+    }
+
+    // textures of the materials are what the scene would otherwise discover last
+    SceneDependencies Finish()
+    {
+        for (const Path &material : m_dependencies.Materials)
+            AddMaterialTextures(material);
+
+        return eastl::move(m_dependencies);
+    }
+
+private:
+    bool Accept(const Path &relativePath)
+    {
+        if (relativePath.empty()) return false;
+        if (!m_paths.insert(ToEASTLString(relativePath.string())).second) return false;
+        return std::filesystem::is_regular_file(Engine::GetContentDirectory() / relativePath);
+    }
+
+    void AddMaterialTextures(const Path &relativePath)
+    {
+        eastl::vector<uint8_t> fileData;
+        MaterialDesc desc;
+        if (!FileSystemObject::ReadFileData(Engine::GetContentDirectory() / relativePath, fileData)
+            || !AssetLoader::ParseMaterial(relativePath, fileData, desc))
+            return;
+
+        AddTexture(desc.AlbedoPath, TextureType::ALBEDO);
+        AddTexture(desc.NormalPath, TextureType::NORMAL);
+        AddTexture(desc.MetallicPath, TextureType::METALLIC);
+        AddTexture(desc.RoughnessPath, TextureType::ROUGHNESS);
+        AddTexture(desc.AOPath, TextureType::AO);
+    }
+
+    eastl::hash_set<eastl::string> m_paths;
+    SceneDependencies m_dependencies;
+};
+
+Path GetPath(const YAML::Node &node)
+{
+    return node ? Path(node.as<std::string>()) : Path();
+}
+} // namespace
+
+
+SceneDependencies SceneDependencies::Collect(Scene &scene)
+{
+    BLAINN_PROFILE_FUNC();
+
+    AssetManager &manager = AssetManager::GetInstance();
+    DependencyCollector collector;
+
+    for (auto [entity, mesh] : scene.GetAllEntitiesWith<MeshComponent>().each())
+    {
+        collector.AddMesh(manager.GetMeshPath(mesh.MeshHandle));
+        collector.AddMaterial(manager.GetMaterialPath(mesh.MaterialHandle));
+    }
+
+    for (auto [entity, skybox] : scene.GetAllEntitiesWith<SkyboxComponent>().each())
+        collector.AddTexture(manager.GetTexturePath(skybox.textureHandle), TextureType::CUBEMAP);
+
+    return collector.Finish();
+}
+
+
+SceneDependencies SceneDependencies::FromSceneNode(const YAML::Node &scene)
+{
+    BLAINN_PROFILE_FUNC();
+
+    SceneDependencies dependencies;
+    if (!scene || !scene.IsMap()) return dependencies;
+
+    try
+    {
+        if (const YAML::Node manifest = scene["Dependencies"])
+        {
+            for (const auto &mesh : manifest["Meshes"])
+                dependencies.Meshes.push_back(mesh.as<std::string>());
+            for (const auto &material : manifest["Materials"])
+                dependencies.Materials.push_back(material.as<std::string>());
+            for (const auto &texture : manifest["Textures"])
+                dependencies.Textures.push_back({texture["Path"].as<std::string>(),
+                                                 static_cast<TextureType>(texture["Type"].as<int>())});
+            return dependencies;
+        }
+
+        // saved before the manifest existed, the next save writes it
+        DependencyCollector collector;
+        for (const auto &entity : scene["Entities"])
+        {
+            if (const YAML::Node mesh = entity["MeshComponent"])
+            {
+                collector.AddMesh(GetPath(mesh["Path"]));
+                collector.AddMaterial(GetPath(mesh["Material"]));
+            }
+            if (const YAML::Node skybox = entity["SkyboxComponent"])
+                collector.AddTexture(GetPath(skybox["Path"]), TextureType::CUBEMAP);
+        }
+        return collector.Finish();
+    }
+    catch (const YAML::Exception &e)
+    {
+        // only costs the preload, the entities still load their assets
+        BF_WARN("SceneDependencies: malformed dependencies, assets are loaded as entities are created: {0}",
+                e.what());
+        return {};
+    }
+}
+
+
+void SceneDependencies::Serialize(YAML::Emitter &out) const
+{
+    out << YAML::Key << "Dependencies" << YAML::Value << YAML::BeginMap;
+
+    out << YAML::Key << "Meshes" << YAML::Value << YAML::BeginSeq;
+    for (const Path &mesh : Meshes)
+        out << mesh.string();
+    out << YAML::EndSeq;
+
+    out << YAML::Key << "Materials" << YAML::Value << YAML::BeginSeq;
+    for (const Path &material : Materials)
+        out << material.string();
+    out << YAML::EndSeq;
+
+    out << YAML::Key << "Textures" << YAML::Value << YAML::BeginSeq;
+    for (const TextureEntry &texture : Textures)
+    {
+        out << YAML::BeginMap;
+        out << YAML::Key << "Path" << YAML::Value << texture.RelativePath.string();
+        out << YAML::Key << "Type" << YAML::Value << static_cast<int>(texture.Type);
+        out << YAML::EndMap;
+    }
+    out << YAML::EndSeq;
+
+    out << YAML::EndMap;
+}
+} // namespace Blainn
@@ -51,6 +51,16 @@ eastl::shared_ptr<Scene> SceneManager::OpenScene(const YAML::Node &config, Scene
 }
 
 
+eastl::shared_ptr<Scene> SceneManager::OpenScene(const eastl::string &name, const uuid &id, SceneSnapshot &snapshot,
+                                                SceneLoadType loadType)
+{
+    auto scenePtr = eastl::make_shared<Scene>(name, id, snapshot);
+    HandleLoadType(loadType, scenePtr);
+    RebuildAllScenesList();
+    return scenePtr;
+}
+
+
 void SceneManager::HandleLoadType(SceneLoadType loadType, eastl::shared_ptr<Scene> scenePtr)
 {
     switch (loadType)
@@ -365,6 +375,12 @@ Mat4 SceneManager::GetWorldSpaceTransformMatrix(Entity entity)
 }
 
 
+bool SceneManager::IsWorldSpaceTransformFramesDirty(Entity entity)
+{
+    return GetScene(entity.GetSceneUUID())->IsWorldSpaceTransformFramesDirty(entity);
+}
+
+
 TransformComponent SceneManager::GetWorldSpaceTransform(Entity entity)
 {
     return GetScene(entity.GetSceneUUID())->GetWorldSpaceTransform(entity);
@@ -0,0 +1,180 @@
+#include "pch.h"
+
+#include "scene/SceneSnapshot.h"
+
+#include "scene/Scene.h"
+#include "tools/ComponentRegistry.h"
+
+namespace Blainn
+{
+namespace
+{
+bool IsHierarchyComponent(entt::id_type typeId)
+{
+    return typeId == entt::type_hash<TagComponent>::value()
+           || typeId == entt::type_hash<RelationshipComponent>::value();
+}
+} // namespace
+
+
+void SceneSnapshot::Capture(Scene &scene)
+{
+    BLAINN_PROFILE_FUNC();
+
+    m_entities.clear();
+    m_indices.clear();
+    m_values.clear();
+    m_bAreBodiesKept = true;
+
+    const auto view = scene.m_Registry.view<IDComponent>();
+    m_entities.reserve(view.size());
+
+    eastl::vector<uint32_t> subsystemComponents;
+    for (auto [handle, id] : view.each())
+    {
+        Entity entity{handle, &scene};
+        m_indices[id.ID] = static_cast<uint32_t>(m_entities.size());
+
+        EntityRecord &record = m_entities.push_back();
+        record.ID = id.ID;
+        record.Values = m_values.create();
+        if (const TagComponent *tag = entity.TryGetComponent<TagComponent>()) record.Tag = tag->Tag;
+        if (const RelationshipComponent *relationship = entity.TryGetComponent<RelationshipComponent>())
+            record.Relationship = *relationship;
+
+        subsystemComponents.clear();
+        for (uint32_t i = 0; i < static_cast<uint32_t>(g_componentRegistry.size()); ++i)
+        {
+            const auto &[typeId, meta] = g_componentRegistry[i];
+            if (IsHierarchyComponent(typeId) || !entity.HasComponent(typeId)) continue;
+
+            record.Components.push_back(i);
+            if (meta.captureTemplate)
+                meta.captureTemplate(entity, m_values, record.Values);
+            else
+                subsystemComponents.push_back(i);
+        }
+
+        if (subsystemComponents.empty()) continue;
+
+        YAML::Emitter out;
+        out << YAML::BeginMap;
+        for (uint32_t component : subsystemComponents)
+            g_componentRegistry[component].second.serializer(entity, out);
+        out << YAML::EndMap;
+        record.SubsystemComponents = out.c_str();
+    }
+
+    // copies are put back without setters, the renderer has to see them as changed
+    for (auto [handle, transform] : m_values.view<TransformComponent>().each())
+        transform.MarkFramesDirty();
+}
+
+
+void SceneSnapshot::Restore(Scene &scene)
+{
+    BLAINN_PROFILE_FUNC();
+
+    // entities that existed before play may have become their children, those stay
+    eastl::vector<Entity> created;
+    for (auto [handle, id] : scene.m_Registry.view<IDComponent>().each())
+        if (m_indices.find(id.ID) == m_indices.end()) created.push_back(Entity{handle, &scene});
+    for (Entity entity : created)
+        scene.DestroyEntityInternal(entity, false, true);
+
+    // entities destroyed during play come back with their ids, every entity exists before components that look
+    // at the hierarchy are rebuilt
+    eastl::vector<Entity> entities;
+    eastl::vector<bool> rebuilt;
+    entities.reserve(m_entities.size());
+    rebuilt.reserve(m_entities.size());
+    for (const EntityRecord &record : m_entities)
+    {
+        Entity entity = scene.TryGetEntityWithUUID(record.ID);
+        rebuilt.push_back(!entity);
+        if (!entity) entity = scene.CreateEntityWithID(record.ID, record.Tag, false);
+        entities.push_back(entity);
+    }
+
+    for (size_t i = 0; i < m_entities.size(); ++i)
+        RestoreValues(scene, entities[i], m_entities[i], rebuilt[i]);
+    for (size_t i = 0; i < m_entities.size(); ++i)
+        if (!m_entities[i].SubsystemComponents.empty())
+            RestoreSubsystemComponents(entities[i], m_entities[i], rebuilt[i]);
+
+    if (!created.empty() || eastl::find(rebuilt.begin(), rebuilt.end(), true) != rebuilt.end())
+        BF_INFO("Scene {0}: {1} entities created and {2} destroyed in play mode", scene.GetName().c_str(),
+                created.size(), eastl::count(rebuilt.begin(), rebuilt.end(), true));
+}
+
+
+void SceneSnapshot::RestoreValues(Scene &scene, Entity entity, const EntityRecord &record, bool isRebuilt)
+{
+    if (TagComponent *tag = entity.TryGetComponent<TagComponent>())
+        tag->Tag = record.Tag;
+    else if (!record.Tag.empty())
+        entity.AddComponent<TagComponent>(record.Tag);
+
+    RelationshipComponent &relationship = entity.HasComponent<RelationshipComponent>()
+                                              ? entity.GetComponent<RelationshipComponent>()
+                                              : entity.AddComponent<RelationshipComponent>();
+    const bool isReparented = !isRebuilt && relationship.ParentHandle != record.Relationship.ParentHandle;
+    relationship.ParentHandle = record.Relationship.ParentHandle;
+    relationship.Children = record.Relationship.Children;
+    if (isReparented) scene.ReportEntityReparent(entity);
+
+    // both lists are in registry order
+    size_t next = 0;
+    for (uint32_t i = 0; i < static_cast<uint32_t>(g_componentRegistry.size()); ++i)
+    {
+        const auto &[typeId, meta] = g_componentRegistry[i];
+        if (IsHierarchyComponent(typeId)) continue;
+
+        const bool wasThere = next < record.Components.size() && record.Components[next] == i;
+        if (wasThere) ++next;
+
+        if (!wasThere)
+        {
+            // added during play
+            if (!entity.HasComponent(typeId)) continue;
+            if (typeId == entt::type_hash<PhysicsComponent>::value()) m_bAreBodiesKept = false;
+            Scene::DestroyComponent(entity, typeId);
+            continue;
+        }
+
+        if (!meta.captureTemplate) continue;
+        if (entity.HasComponent(typeId))
+            meta.assignTemplate(m_values, record.Values, &entity, 1u);
+        else
+            meta.instantiateTemplate(m_values, record.Values, &entity, 1u);
+    }
+}
+
+
+void SceneSnapshot::RestoreSubsystemComponents(Entity entity, const EntityRecord &record, bool isRebuilt)
+{
+    YAML::Node node;
+    bool isParsed = false;
+    for (uint32_t component : record.Components)
+    {
+        const auto &[typeId, meta] = g_componentRegistry[component];
+        if (meta.captureTemplate) continue;
+
+        if (typeId == entt::type_hash<PhysicsComponent>::value())
+        {
+            // the body stays, its state comes back with the rest of the physics system
+            if (!isRebuilt && entity.HasComponent(typeId)) continue;
+            m_bAreBodiesKept = false;
+        }
+
+        // scripts and AI controllers start over, like a reopened scene
+        Scene::DestroyComponent(entity, typeId);
+        if (!isParsed)
+        {
+            node = YAML::Load(record.SubsystemComponents.c_str());
+            isParsed = true;
+        }
+        meta.deserializer(entity, node);
+    }
+}
+} // namespace Blainn
@@ -22,26 +22,17 @@ bool LuaScript::Load(const Path &scriptPath, const Entity &owningEntity)
 {
     m_scriptPath = scriptPath;
 
-    sol::state &lua = ScriptingSubsystem::GetLuaState();
+    // compiled once per file, every instance only gets its own environment and closures
+    sol::protected_function scriptFactory = ScriptingSubsystem::GetCompiledScript(scriptPath);
+    if (!scriptFactory.valid()) return false;
 
-    m_environment = sol::environment(lua, sol::create, lua.globals());
+    m_environment = ScriptingSubsystem::CreateScriptEnvironment();
     m_owningEntityId = owningEntity.GetUUID();
     m_environment["OwningEntityID"] = m_owningEntityId.str();
     m_environment["OwningEntity"] = owningEntity;
 
-    sol::load_result script = lua.load_file(scriptPath.string());
-    if (!script.valid())
-    {
-        sol::error err = script;
-        BF_ERROR("Failed to load Lua script: {}\nError: {}", m_scriptPath.string(), err.what());
-        return false;
-    }
-
-    sol::protected_function scriptAsFunc = script.get<sol::protected_function>();
-
-    sol::set_environment(m_environment, scriptAsFunc);
-    // load lua functions to environment
-    sol::protected_function_result result = script();
+    // load lua functions to environment, they capture it as their _ENV
+    sol::protected_function_result result = scriptFactory(m_environment);
     if (!result.valid())
     {
         sol::error err = result;
@@ -56,27 +47,19 @@ bool LuaScript::Load(const Path &scriptPath, const Entity &owningEntity)
     m_onCollisionEnded = m_environment["OnCollisionEnded"];
     m_onDrawUI = m_environment["OnDrawUI"];
 
-    if (m_onStart.valid()) sol::set_environment(m_environment, m_onStart);
-    if (m_onUpdate.valid()) sol::set_environment(m_environment, m_onUpdate);
-    if (m_onDestroy.valid()) sol::set_environment(m_environment, m_onDestroy);
-
     if (m_onCollisionStarted.valid())
     {
-        sol::set_environment(m_environment, m_onCollisionStarted);
-        m_onCollisionStartedHandle = PhysicsSubsystem::AddEventListener(
-            PhysicsEventType::CollisionStarted,
+        m_onCollisionStartedHandle = PhysicsSubsystem::AddEntityEventListener(
+            m_owningEntityId, PhysicsEventType::CollisionStarted,
             [this](const eastl::shared_ptr<PhysicsEvent> &physicsEvent) { OnCollisionStartedCall(physicsEvent); });
     }
     if (m_onCollisionEnded.valid())
     {
-        sol::set_environment(m_environment, m_onCollisionEnded);
-        m_onCollisionEndedHandle = PhysicsSubsystem::AddEventListener(
-            PhysicsEventType::CollisionEnded,
+        m_onCollisionEndedHandle = PhysicsSubsystem::AddEntityEventListener(
+            m_owningEntityId, PhysicsEventType::CollisionEnded,
             [this](const eastl::shared_ptr<PhysicsEvent> &physicsEvent) { OnCollisionEndedCall(physicsEvent); });
     }
 
-    if (m_onDrawUI.valid()) sol::set_environment(m_environment, m_onDrawUI);
-
     m_isLoaded = true;
     return true;
 }
@@ -164,7 +147,6 @@ bool LuaScript::OnDestroyCall()
 bool Blainn::LuaScript::OnCollisionStartedCall(const eastl::shared_ptr<PhysicsEvent> &physicsEvent)
 {
     if (!m_onCollisionStarted.valid()) return false;
-    if (physicsEvent->entity1 != m_owningEntityId && physicsEvent->entity2 != m_owningEntityId) return false;
 
     sol::state_view sv(ScriptingSubsystem::GetLuaState());
     sol::table tbl = sv.create_table();
@@ -179,7 +161,6 @@ bool Blainn::LuaScript::OnCollisionStartedCall(const eastl::shared_ptr<PhysicsEv
 bool Blainn::LuaScript::OnCollisionEndedCall(const eastl::shared_ptr<PhysicsEvent> &physicsEvent)
 {
     if (!m_onCollisionEnded.valid()) return false;
-    if (physicsEvent->entity1 != m_owningEntityId && physicsEvent->entity2 != m_owningEntityId) return false;
 
     sol::state_view sv(ScriptingSubsystem::GetLuaState());
     sol::table tbl = sv.create_table();
@@ -195,15 +176,27 @@ void Blainn::LuaScript::RemovePhysicsEventListeners()
 {
     if (m_onCollisionStarted.valid())
     {
-        PhysicsSubsystem::RemoveEventListener(PhysicsEventType::CollisionStarted, m_onCollisionStartedHandle);
+        PhysicsSubsystem::RemoveEntityEventListener(m_owningEntityId, PhysicsEventType::CollisionStarted,
+                                                    m_onCollisionStartedHandle);
     }
 
     if (m_onCollisionEnded.valid())
     {
-        PhysicsSubsystem::RemoveEventListener(PhysicsEventType::CollisionEnded, m_onCollisionEndedHandle);
+        PhysicsSubsystem::RemoveEntityEventListener(m_owningEntityId, PhysicsEventType::CollisionEnded,
+                                                    m_onCollisionEndedHandle);
     }
 }
 
+const sol::protected_function &LuaScript::GetOnUpdateFunction() const
+{
+    return m_onUpdate;
+}
+
+const sol::protected_function &LuaScript::GetOnDrawUIFunction() const
+{
+    return m_onDrawUI;
+}
+
 bool LuaScript::OnDrawUI()
 {
     if (!m_onDrawUI.valid()) return false;
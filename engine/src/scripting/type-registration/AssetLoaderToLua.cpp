@@ -62,7 +62,7 @@ void Blainn::RegisterAssetLoaderTypes(sol::state &luaState)
 
     // File-system types
     sol::usertype<Model> ModelType = luaState.new_usertype<Model>("Model", sol::no_constructor);
-    ModelType["GetMeshCount"] = [](Model &m) { return (int)m.GetMeshes().size(); };
+    ModelType["GetMeshCount"] = [](Model &m) { return (int)m.GetSubmeshes().size(); };
 
     sol::usertype<Material> MaterialType = luaState.new_usertype<Material>("Material", sol::no_constructor);
     MaterialType["GetShader"] = [](Material &m) { return std::string(m.GetShader().c_str()); };
@@ -41,7 +41,7 @@ void Blainn::RegisterAssetManagerTypes(sol::state &luaState)
 
     // File system types
     sol::usertype<Model> ModelType = luaState.new_usertype<Model>("Model", sol::no_constructor);
-    ModelType.set_function("GetMeshesCount", [](Model &m) { return (int)m.GetMeshes().size(); });
+    ModelType.set_function("GetMeshesCount", [](Model &m) { return (int)m.GetSubmeshes().size(); });
 
     sol::usertype<Texture> TextureTypeLua = luaState.new_usertype<Texture>("Texture", sol::no_constructor);
     TextureTypeLua.set_function("GetPath",  [](Texture &t) { return t.GetPath().string(); });
@@ -59,7 +59,7 @@ void Blainn::RegisterAssetManagerTypes(sol::state &luaState)
             Path p(relativePath);
             auto handle = AssetManager::GetInstance().LoadMesh(p, data);
             if (!handle) return 0u;
-            return handle->GetIndex();
+            return handle.GetIndex();
         });
 
     manager.set_function("HasMesh",
@@ -76,7 +76,7 @@ void Blainn::RegisterAssetManagerTypes(sol::state &luaState)
             Path p(path);
             auto t = AssetManager::GetInstance().LoadTexture(p, type);
             if (!t) return 0u;
-            return t->GetIndex();
+            return t.GetIndex();
         });
 
     manager.set_function("LoadMaterial",
@@ -85,7 +85,7 @@ void Blainn::RegisterAssetManagerTypes(sol::state &luaState)
             Path p(path);
             auto m = AssetManager::GetInstance().LoadMaterial(p);
             if (!m) return 0u;
-            return m->GetIndex();
+            return m.GetIndex();
         });
 
     manager.set_function("GetMeshPathByIndex",
@@ -70,10 +70,10 @@ void Blainn::RegisterComponentTypes(sol::state &luaState)
     TransformComponentType.set_function("GetRightVector",   &TransformComponent::GetRightVector);
 
     sol::usertype<MeshComponent> MeshComponentType = luaState.new_usertype<MeshComponent>(
-        "MeshComponent", sol::constructors<MeshComponent(const eastl::shared_ptr<MeshHandle> &),
-                                           MeshComponent(eastl::shared_ptr<MeshHandle> &&)>());
+        "MeshComponent", sol::constructors<MeshComponent(const MeshHandle &),
+                                           MeshComponent(MeshHandle &&)>());
     MeshComponentType.set_function("GetHandleIndex",
-        [](MeshComponent &m) { return m.MeshHandle ? m.MeshHandle->GetIndex() : 0u; });
+        [](MeshComponent &m) { return m.MeshHandle ? m.MeshHandle.GetIndex() : 0u; });
 
     sol::usertype<ScriptingComponent> ScriptingComponentType =
         luaState.new_usertype<ScriptingComponent>("ScriptingComponent", sol::constructors<ScriptingComponent()>());
@@ -9,14 +9,18 @@
 #include "AssetManager.h"
 #include "Engine.h"
 #include "ImportAssetData.h"
+#include "file-system/DerivedDataCache.h"
 #include "file-system/Material.h"
+#include "file-system/MeshCooker.h"
 #include "file-system/Model.h"
 #include "file-system/Texture.h"
+#include "tools/MeshOptimizer.h"
 
 #include <assimp/Importer.hpp>
 #include <assimp/postprocess.h>
 #include <assimp/scene.h>
 
+#include <chrono>
 #include <filesystem>
 
 namespace Blainn
@@ -34,21 +38,49 @@ void AssetLoader::Init()
 void AssetLoader::Destroy()
 {
     BF_INFO("AssetLoader Destroy");
+
+    // materials added or edited since the last cook were parsed from YAML, the next run finds them cooked
+    if (m_materialTable.GetMissCount() > 0u)
+    {
+        uint32_t materialCount = 0u;
+        if (MaterialTable::Cook(Engine::GetContentDirectory(), materialCount))
+            BF_INFO("AssetLoader: {0} materials were not cooked, the material table of {1} is rebuilt",
+                    m_materialTable.GetMissCount(), materialCount);
+    }
+
+    DerivedDataCache::Flush();
+    DerivedDataCache::LogStats();
 }
 
 
-eastl::shared_ptr<Model> AssetLoader::ImportModel(const Path &relativePath, const ImportMeshData &data)
+bool AssetLoader::LoadModelData(const Path &relativePath, const ImportMeshData &data, Model &model)
 {
-    (void)data;
-    assert(relativePath.is_relative());
-
     Path absolutePath = Engine::GetContentDirectory() / relativePath;
+    if (MeshCooker::Load(absolutePath, model, GetImportSettingsHash(data))) return true;
+
+    if (!ImportModelWithAssimp(relativePath, absolutePath, data, model)) return false;
+
+    MeshCooker::Cook(model, absolutePath, GetImportSettingsHash(data));
+    return true;
+}
+
+uint64_t AssetLoader::GetImportSettingsHash(const ImportMeshData &data)
+{
+    // options that change the cooked data
+    const uint8_t optimize = data.optimizeMesh ? 1u : 0u;
+    uint64_t hash = DerivedDataCache::HashBytes(&optimize, sizeof(optimize));
+    return DerivedDataCache::HashBytes(data.lodErrors.data(), data.lodErrors.size() * sizeof(float), hash);
+}
+
+bool AssetLoader::ImportModelWithAssimp(const Path &relativePath, const Path &absolutePath,
+                                        const ImportMeshData &data, Model &model)
+{
+    BLAINN_PROFILE_FUNC();
     if (absolutePath.empty())
     {
         BF_ERROR("AssetLoader ImportModel: path is empty");
     }
 
-    Model model = Model(relativePath);
     Assimp::Importer importer;
     const aiScene *scene = importer.ReadFile(absolutePath.string(),
                                              aiProcess_Triangulate | aiProcess_GenNormals | aiProcess_CalcTangentSpace
@@ -57,16 +89,196 @@ eastl::shared_ptr<Model> AssetLoader::ImportModel(const Path &relativePath, cons
     if (!scene || scene->mFlags & AI_SCENE_FLAGS_INCOMPLETE || !scene->mRootNode)
     {
         BF_ERROR("AssetLoader ImportModel: error loading model " + std::string(importer.GetErrorString()));
-        return eastl::make_shared<Model>(AssetManager::GetDefaultMesh()->GetMesh());
+        return false;
+    }
+
+    // exact unless a mesh is referenced by several nodes
+    size_t vertexCount = 0u;
+    size_t indexCount = 0u;
+    for (unsigned int i = 0; i < scene->mNumMeshes; ++i)
+    {
+        vertexCount += scene->mMeshes[i]->mNumVertices;
+        indexCount += scene->mMeshes[i]->mNumFaces * 3u;
     }
+    model.allVertices.reserve(vertexCount);
+    model.allIndices.reserve(indexCount);
 
     ProcessNode(relativePath, *scene->mRootNode, *scene, Mat4::Identity, model);
 
-    // to merge together all meshes of the model
-    model.CreateBufferResources();
-    model.CreateGPUBuffers();
+    if (data.optimizeMesh) OptimizeModel(relativePath, model);
+
+    model.FinalizeMeshData();
+    GenerateLODs(relativePath, data, model);
+    return true;
+}
+
+void AssetLoader::OptimizeModel(const Path &relativePath, Model &model)
+{
+    BLAINN_PROFILE_FUNC();
+    if (model.allIndices.empty()) return;
+
+    auto before = MeshOptimizer::AnalyzeVertexCache(model.allIndices.data(), model.allIndices.size(),
+                                                    model.allVertices.size());
+
+    for (const Model::Submesh &submesh : model.GetSubmeshes())
+    {
+        if (submesh.IndexCount == 0u) continue;
+
+        // optimizer works on submesh local indices, vertex ranges of the submeshes stay the same
+        uint32_t *indices = model.allIndices.data() + submesh.FirstIndex;
+        BlainnVertex *vertices = model.allVertices.data() + submesh.FirstVertex;
+        for (uint32_t i = 0; i < submesh.IndexCount; ++i)
+            indices[i] -= submesh.FirstVertex;
+
+        MeshOptimizer::OptimizeVertexCache(indices, submesh.IndexCount, submesh.VertexCount);
+        MeshOptimizer::OptimizeOverdraw(indices, submesh.IndexCount, &vertices->position.x, submesh.VertexCount,
+                                        sizeof(BlainnVertex));
+        MeshOptimizer::OptimizeVertexFetch(vertices, indices, submesh.IndexCount, submesh.VertexCount,
+                                           sizeof(BlainnVertex));
+
+        for (uint32_t i = 0; i < submesh.IndexCount; ++i)
+            indices[i] += submesh.FirstVertex;
+    }
 
-    return eastl::make_shared<Model>(model);
+    auto after = MeshOptimizer::AnalyzeVertexCache(model.allIndices.data(), model.allIndices.size(),
+                                                   model.allVertices.size());
+    BF_INFO("Optimized {0}: ACMR {1:.3f} -> {2:.3f}, ATVR {3:.3f} -> {4:.3f}", relativePath.string(), before.ACMR,
+            after.ACMR, before.ATVR, after.ATVR);
+}
+
+void AssetLoader::GenerateLODs(const Path &relativePath, const ImportMeshData &data, Model &model)
+{
+    BLAINN_PROFILE_FUNC();
+    const auto &bounds = model.GetBounds();
+    const float modelSize = 2.0f * eastl::max(bounds.Extents.x, eastl::max(bounds.Extents.y, bounds.Extents.z));
+    if (modelSize <= 0.0f) return;
+
+    eastl::vector<uint32_t> lodIndices;
+    eastl::vector<uint32_t> localIndices;
+    eastl::vector<uint32_t> simplified;
+
+    for (float relativeError : data.lodErrors)
+    {
+        lodIndices.clear();
+        float lodError = 0.0f;
+
+        // every level is simplified from LOD 0, so errors do not accumulate
+        for (const Model::Submesh &submesh : model.GetSubmeshes())
+        {
+            if (submesh.IndexCount == 0u) continue;
+
+            localIndices.resize(submesh.IndexCount);
+            for (uint32_t i = 0; i < submesh.IndexCount; ++i)
+                localIndices[i] = model.allIndices[submesh.FirstIndex + i] - submesh.FirstVertex;
+
+            float submeshError = 0.0f;
+            simplified.resize(localIndices.size());
+            const size_t count = MeshOptimizer::Simplify(
+                simplified.data(), localIndices.data(), localIndices.size(),
+                &model.allVertices[submesh.FirstVertex].position.x, submesh.VertexCount, sizeof(BlainnVertex), 0u,
+                relativeError * modelSize, &submeshError);
+            if (data.optimizeMesh) MeshOptimizer::OptimizeVertexCache(simplified.data(), count, submesh.VertexCount);
+
+            for (size_t i = 0; i < count; ++i)
+                lodIndices.push_back(simplified[i] + submesh.FirstVertex);
+            lodError = eastl::max(lodError, submeshError);
+        }
+
+        // a level that saves little is not worth the switch
+        const uint32_t previousCount = model.GetLODs().back().IndexCount;
+        if (lodIndices.empty()) continue;
+        if (lodIndices.size() > previousCount * 3u / 4u)
+        {
+            // borders, seam corners and the error bound stop the simplifier, the mesh keeps fewer levels
+            BF_WARN("{0}: LOD for error {1:.4f} skipped, simplified to {2} of {3} triangles", relativePath.string(),
+                    relativeError, lodIndices.size() / 3u, previousCount / 3u);
+            continue;
+        }
+
+        model.AddLOD(lodIndices, lodError);
+        BF_INFO("{0} LOD {1}: {2} triangles, error {3:.4f}", relativePath.string(), model.GetLODs().size() - 1u,
+                lodIndices.size() / 3u, lodError);
+    }
+}
+
+void AssetLoader::CookModels(const Path &directory)
+{
+    using Clock = std::chrono::steady_clock;
+    static const eastl::array<std::string, 4> modelFormats = {".obj", ".gltf", ".glb", ".fbx"};
+
+    size_t cookedCount = 0u;
+    double totalImportMs = 0.0;
+    double totalLoadMs = 0.0;
+
+    std::error_code error;
+    for (const auto &entry : std::filesystem::recursive_directory_iterator(
+             directory, std::filesystem::directory_options::skip_permission_denied, error))
+    {
+        if (!entry.is_regular_file()) continue;
+
+        std::string extension = entry.path().extension().string();
+        eastl::transform(extension.begin(), extension.end(), extension.begin(),
+                         [](char c) { return static_cast<char>(::tolower(static_cast<unsigned char>(c))); });
+        if (eastl::find(modelFormats.begin(), modelFormats.end(), extension) == modelFormats.end()) continue;
+
+        const Path &absolutePath = entry.path();
+        const Path relativePath = std::filesystem::relative(absolutePath, Engine::GetContentDirectory());
+
+        // models without a meta file are cooked with the default import options
+        ImportMeshData data = {};
+        if (std::filesystem::exists(absolutePath.string() + metaFormat))
+            data = ImportMeshData::GetMeshData(absolutePath);
+
+        auto importStart = Clock::now();
+        Model importedModel(relativePath);
+        if (!ImportModelWithAssimp(relativePath, absolutePath, data, importedModel)) continue;
+        if (!MeshCooker::Cook(importedModel, absolutePath, GetImportSettingsHash(data))) continue;
+        double importMs = std::chrono::duration<double, std::milli>(Clock::now() - importStart).count();
+
+        auto loadStart = Clock::now();
+        Model cookedModel(relativePath);
+        if (!MeshCooker::Load(absolutePath, cookedModel, GetImportSettingsHash(data)))
+        {
+            BF_ERROR("AssetLoader CookModels: can't load cooked {0}", relativePath.string());
+            continue;
+        }
+        double loadMs = std::chrono::duration<double, std::milli>(Clock::now() - loadStart).count();
+
+        BF_INFO("Cooked {0}: {1} vertices, {2} indices, import + cook {3:.2f} ms, cooked load {4:.2f} ms",
+                relativePath.string(), cookedModel.GetVerticesCount(), cookedModel.GetIndicesCount(), importMs,
+                loadMs);
+
+        ++cookedCount;
+        totalImportMs += importMs;
+        totalLoadMs += loadMs;
+    }
+
+    BF_INFO("Cooked {0} models: import + cook {1:.2f} ms, cooked load {2:.2f} ms", cookedCount, totalImportMs,
+            totalLoadMs);
+}
+
+void AssetLoader::CookMaterials(const Path &directory)
+{
+    using Clock = std::chrono::steady_clock;
+
+    // the cook reads and parses every .mat, about what loading them all from YAML costs
+    auto cookStart = Clock::now();
+    uint32_t materialCount = 0u;
+    if (!MaterialTable::Cook(directory, materialCount)) return;
+    const double cookMs = std::chrono::duration<double, std::milli>(Clock::now() - cookStart).count();
+
+    auto loadStart = Clock::now();
+    if (!m_materialTable.Load())
+    {
+        BF_ERROR("AssetLoader CookMaterials: can't load the cooked material table");
+        return;
+    }
+    const double loadMs = std::chrono::duration<double, std::milli>(Clock::now() - loadStart).count();
+
+    std::error_code error;
+    BF_INFO("Cooked {0} materials with {1} textures into {2} KiB: cook {3:.2f} ms, table load {4:.2f} ms",
+            materialCount, m_materialTable.GetTextureCount(),
+            std::filesystem::file_size(MaterialTable::GetTablePath(), error) / 1024u, cookMs, loadMs);
 }
 
 void AssetLoader::ProcessNode(const Path &path, const aiNode &node, const aiScene &scene, const Mat4 &parentMatrix,
@@ -78,7 +290,7 @@ void AssetLoader::ProcessNode(const Path &path, const aiNode &node, const aiScen
     {
         unsigned int meshIndex = node.mMeshes[i];
         auto mesh = scene.mMeshes[meshIndex];
-        model.GetMeshes().emplace_back(ProcessMesh(path, *mesh, scene, node, nodeTransform, model));
+        ProcessMesh(path, *mesh, scene, node, nodeTransform, model);
     }
 
     for (size_t i = 0; i < node.mNumChildren; ++i)
@@ -88,15 +300,14 @@ void AssetLoader::ProcessNode(const Path &path, const aiNode &node, const aiScen
 }
 
 
-MeshData<> AssetLoader::ProcessMesh(const Path &path, const aiMesh &mesh, const aiScene &scene, const aiNode &node,
-                                    const Mat4 &parentMatrix, Model &model)
+void AssetLoader::ProcessMesh(const Path &path, const aiMesh &mesh, const aiScene &scene, const aiNode &node,
+                              const Mat4 &parentMatrix, Model &model)
 {
     (void)path;
     (void)scene;
     (void)node;
-    (void)model;
-    MeshData<> result_mesh = MeshData<>();
-    result_mesh.parentMatrix = parentMatrix;
+    // written straight into the merged buffers, indices rebased to the submesh start
+    Model::Submesh &submesh = model.BeginSubmesh(parentMatrix);
 
     for (unsigned int i = 0; i < mesh.mNumVertices; ++i)
     {
@@ -120,7 +331,7 @@ MeshData<> AssetLoader::ProcessMesh(const Path &path, const aiMesh &mesh, const
 
         if (mesh.HasTextureCoords(0)) vertex.texCoord = GetTextCoords(mesh, i);
 
-        result_mesh.vertices.emplace_back(vertex);
+        model.allVertices.emplace_back(vertex);
     }
 
     for (unsigned int i = 0; i < mesh.mNumFaces; ++i)
@@ -129,13 +340,13 @@ MeshData<> AssetLoader::ProcessMesh(const Path &path, const aiMesh &mesh, const
 
         for (unsigned int j = 0; j < face.mNumIndices; ++j)
         {
-            result_mesh.indices.push_back(face.mIndices[j]);
+            model.allIndices.push_back(submesh.FirstVertex + face.mIndices[j]);
         }
     }
 
 
+    model.EndSubmesh(submesh);
     // TODO: get material
-    return result_mesh;
 }
 
 
@@ -190,48 +401,100 @@ eastl::shared_ptr<Material> AssetLoader::LoadMaterial(const Path &relativePath)
 {
     assert(relativePath.is_relative());
 
-    auto absolutePath = Engine::GetContentDirectory() / relativePath;
-    YAML::Node config = YAML::LoadFile(absolutePath.string());
+    MaterialDesc desc;
+    eastl::vector<uint8_t> fileData;
+    if (const MaterialTable::Record *record = m_materialTable.Find(relativePath))
+    {
+        m_materialTable.GetDesc(*record, desc);
+    }
+    else if (!FileSystemObject::ReadFileData(Engine::GetContentDirectory() / relativePath, fileData))
+    {
+        BF_ERROR("AssetLoader LoadMaterial: failed to read {0}", relativePath.string());
+    }
+    else
+    {
+        ParseMaterial(relativePath, fileData, desc);
+    }
 
-    auto shaderPath = config["ShaderPath"].as<std::string>();
-    auto albedo = config["AlbedoPath"].as<std::string>();
-    auto normal = config["NormalPath"].as<std::string>();
-    auto metallic = config["MetallicPath"].as<std::string>();
-    auto roughness = config["RoughnessPath"].as<std::string>();
-    auto ambient = config["AOPath"].as<std::string>();
+    return CreateMaterial(relativePath, desc);
+}
+
+bool AssetLoader::ParseMaterial(const Path &relativePath, const eastl::vector<uint8_t> &fileData, MaterialDesc &outDesc)
+{
+    try
+    {
+        YAML::Node config = YAML::Load(std::string(reinterpret_cast<const char *>(fileData.data()), fileData.size()));
+
+        outDesc.ShaderPath = ToEASTLString(config["ShaderPath"].as<std::string>());
+        // TextureCooker::CookDirectory reads the texture keys on its own
+        outDesc.AlbedoPath = config["AlbedoPath"].as<std::string>();
+        outDesc.NormalPath = config["NormalPath"].as<std::string>();
+        outDesc.MetallicPath = config["MetallicPath"].as<std::string>();
+        outDesc.RoughnessPath = config["RoughnessPath"].as<std::string>();
+        outDesc.AOPath = config["AOPath"].as<std::string>();
+
+        outDesc.AlbedoColor = HexToColor(config["AlbedoColor"].as<std::string>());
+        outDesc.NormalScale = config["NormalScale"].as<float>();
+        outDesc.MetallicScale = config["MetallicScale"].as<float>();
+        outDesc.RoughnessScale = config["RoughnessScale"].as<float>();
+    }
+    catch (const YAML::Exception &e)
+    {
+        BF_ERROR("AssetLoader ParseMaterial: {0} is malformed: {1}", relativePath.string(), e.what());
+        return false;
+    }
 
-    auto albedoColor = config["AlbedoColor"].as<std::string>();
-    auto normalScale = config["NormalScale"].as<float>();
-    auto metallicScale = config["MetallicScale"].as<float>();
-    auto roughnessScale = config["RoughnessScale"].as<float>();
+    return true;
+}
 
-    auto material = eastl::make_shared<Material>(relativePath, ToEASTLString(shaderPath));
+eastl::shared_ptr<Material> AssetLoader::CreateMaterial(const Path &relativePath, const MaterialDesc &desc,
+                                                        StreamPriority texturePriority)
+{
+    auto material = eastl::make_shared<Material>(relativePath, desc.ShaderPath);
     auto &manager = AssetManager::GetInstance();
 
-    if (!albedo.empty())
-        if (manager.HasTexture(albedo)) material->SetTexture(manager.GetTexture(albedo), TextureType::ALBEDO);
-        else material->SetTexture(manager.LoadTexture(albedo, TextureType::ALBEDO), TextureType::ALBEDO);
+    const auto setTexture = [&](const Path &texturePath, TextureType type)
+    {
+        if (texturePath.empty()) return;
+
+        if (manager.HasTexture(texturePath)) material->SetTexture(manager.GetTexture(texturePath), type);
+        else material->SetTexture(manager.LoadTexture(texturePath, type, texturePriority), type);
+    };
+
+    setTexture(desc.AlbedoPath, TextureType::ALBEDO);
+    setTexture(desc.NormalPath, TextureType::NORMAL);
+    setTexture(desc.MetallicPath, TextureType::METALLIC);
+    setTexture(desc.RoughnessPath, TextureType::ROUGHNESS);
+    setTexture(desc.AOPath, TextureType::AO);
+
+    material->SetAlbedoColor(desc.AlbedoColor);
+    material->SetNormalScale(desc.NormalScale);
+    material->SetMetallicScale(desc.MetallicScale);
+    material->SetRoughnessScale(desc.RoughnessScale);
 
-    if (!normal.empty())
-        if (manager.HasTexture(normal)) material->SetTexture(manager.GetTexture(normal), TextureType::NORMAL);
-        else material->SetTexture(manager.LoadTexture(normal, TextureType::NORMAL), TextureType::NORMAL);
+    return material;
+}
 
-    if (!metallic.empty())
-        if (manager.HasTexture(metallic)) material->SetTexture(manager.GetTexture(metallic), TextureType::METALLIC);
-        else material->SetTexture(manager.LoadTexture(metallic, TextureType::METALLIC), TextureType::METALLIC);
+eastl::shared_ptr<Material> AssetLoader::CreateMaterial(
+    const Path &relativePath, const MaterialTable::Record &record,
+    const eastl::function<TextureHandle(uint32_t, TextureType)> &resolveTexture)
+{
+    auto material = eastl::make_shared<Material>(relativePath, m_materialTable.GetShader(record));
 
-    if (!roughness.empty())
-        if (manager.HasTexture(roughness)) material->SetTexture(manager.GetTexture(roughness), TextureType::ROUGHNESS);
-        else material->SetTexture(manager.LoadTexture(roughness, TextureType::ROUGHNESS), TextureType::ROUGHNESS);
+    // no path lookups, the caller resolves each texture of the table once
+    for (size_t slot = 0; slot < MaterialTable::kSlotCount; ++slot)
+    {
+        if (record.Textures[slot] == MaterialTable::kNoTexture) continue;
 
-    if (!ambient.empty())
-        if (manager.HasTexture(ambient)) material->SetTexture(manager.GetTexture(ambient), TextureType::AO);
-        else material->SetTexture(manager.LoadTexture(ambient, TextureType::AO), TextureType::AO);
+        const TextureType type = MaterialTable::kSlotTypes[slot];
+        material->SetTexture(resolveTexture(record.Textures[slot], type), type);
+    }
 
-    material->SetAlbedoColor(HexToColor(albedoColor));
-    material->SetNormalScale(normalScale);
-    material->SetMetallicScale(metallicScale);
-    material->SetRoughnessScale(roughnessScale);
+    material->SetAlbedoColor(
+        Color(record.AlbedoColor[0], record.AlbedoColor[1], record.AlbedoColor[2], record.AlbedoColor[3]));
+    material->SetNormalScale(record.NormalScale);
+    material->SetMetallicScale(record.MetallicScale);
+    material->SetRoughnessScale(record.RoughnessScale);
 
     return material;
 }
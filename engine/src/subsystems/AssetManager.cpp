@@ -6,18 +6,17 @@
 
 #include "Engine.h"
 #include "ImportAssetData.h"
-#pragma warning(push)
-#pragma warning(disable : 4100)
-#include "VGJS.h"
-#pragma warning(pop)
 #include "File-System/Material.h"
 #include "File-System/Model.h"
 #include "File-System/Texture.h"
+#include "handles/Handle.h"
 
+#include "Render/CommandQueue.h"
 #include "Render/PrebuiltEngineMeshes.h"
 
 #include "Navigation/NavigationSubsystem.h"
 
+#include "scene/SceneDependencies.h"
 #include "scene/SceneManager.h"
 #include "scene/SceneManagerTemplates.h"
 #include "scene/Scene.h"
@@ -27,6 +26,39 @@ namespace Blainn
 const Path relativeDefaultDiffuseTexturePath = "Textures/Default.dds";
 const Path relativeDefaultMaterialPath = "Materials/Default.mat";
 
+namespace
+{
+eastl::unique_ptr<StreamJob> MakeStreamJob(StreamAssetType type, const Path &relativePath, uint32_t index,
+                                           uint32_t generation, StreamPriority priority,
+                                           const AssetLoadedCallback &onLoaded)
+{
+    auto job = eastl::make_unique<StreamJob>();
+    job->Type = type;
+    job->Priority = priority;
+    job->RelativePath = relativePath;
+    job->Index = index;
+    job->Generation = generation;
+    if (onLoaded) job->Callbacks.push_back(onLoaded);
+    return job;
+}
+
+// slot the handle was made for, nullptr for invalid handles and erased slots
+template <typename TSlot> TSlot *FindSlot(FreeListVector<TSlot> &slots, const Handle &handle)
+{
+    if (!handle.IsValid() || handle.GetIndex() >= slots.size()) return nullptr;
+    if (!handle.Matches(slots.generation(handle.GetIndex()))) return nullptr;
+
+    return &slots[handle.GetIndex()];
+}
+
+template <typename TSlot> void ErasePath(eastl::hash_map<eastl::string, uint32_t> &paths, const TSlot &slot,
+                                         uint32_t index)
+{
+    // the path may have been loaded again into another slot
+    if (auto it = paths.find(slot.Path); it != paths.end() && it->second == index) paths.erase(it);
+}
+} // namespace
+
 AssetManager &AssetManager::GetInstance()
 {
     static AssetManager instance;
@@ -43,6 +75,8 @@ void AssetManager::Init()
 
     m_loader = eastl::make_unique<AssetLoader>();
     m_loader->Init();
+    m_streamer = eastl::make_unique<AssetStreamer>(*m_loader,
+                                                   [this](const StreamJob &job) { return IsStreamJobCurrent(job); });
 
     m_textures.reserve(MAX_TEXTURES);
     m_materials.reserve(MAX_MATERIALS);
@@ -55,115 +89,217 @@ void AssetManager::Init()
 
 void AssetManager::LoadDefaultTextures()
 {
-    m_textures.emplace(m_loader->LoadTexture(relativeDefaultDiffuseTexturePath, TextureType::ALBEDO, 0u));
-    m_texturePaths[ToEASTLString(relativeDefaultDiffuseTexturePath.string())] = {0, 1};
+    // the manager holds a reference to engine defaults, they are never unloaded
+    const eastl::string path = ToEASTLString(relativeDefaultDiffuseTexturePath.string());
+    m_textures.emplace(
+        AssetSlot<Texture>{m_loader->LoadTexture(relativeDefaultDiffuseTexturePath, TextureType::ALBEDO, 0u), path, 1u});
+    m_texturePaths[path] = 0u;
 }
 
 void AssetManager::LoadDefaultMaterials()
 {
     Material material = Material(relativeDefaultMaterialPath, "");
     material.SetTexture(GetTexture(relativeDefaultDiffuseTexturePath), TextureType::ALBEDO);
-    
-    m_materialPaths[ToEASTLString(relativeDefaultMaterialPath.string())] = {0, 1};
-    m_materials.emplace(eastl::make_shared<Material>(eastl::move(material)));
+
+    const eastl::string path = ToEASTLString(relativeDefaultMaterialPath.string());
+    m_materialPaths[path] = 0u;
+    m_materials.emplace(AssetSlot<Material>{eastl::make_shared<Material>(eastl::move(material)), path, 1u});
 }
 
 void AssetManager::LoadPrebuiltMeshes()
 {
-    // could be rewritten with a lambda i suppose
-    Model model;
-#pragma region Box
-    model = Model{};
-    model.SetMeshes({PrebuiltEngineMeshes::CreateBox(1.f, 1.f, 1.f)});
-    model.CreateBufferResources();
-    model.CreateGPUBuffers();
-    m_meshes.emplace(eastl::make_shared<Model>(model));
-#pragma endregion Box
-#pragma region Sphere
-    model = Model{};
-    model.SetMeshes({PrebuiltEngineMeshes::CreateSphere(1.0f, 16u, 16u)});
-    model.CreateBufferResources();
-    model.CreateGPUBuffers();
-    m_meshes.emplace(eastl::make_shared<Model>(model));
-#pragma endregion Sphere
-#pragma region Cone
-    model = Model{};
-    model.SetMeshes({PrebuiltEngineMeshes::CreateCylinder(1, 0, 1, 16)});
-    model.CreateBufferResources();
-    model.CreateGPUBuffers();
-    m_meshes.emplace(eastl::make_shared<Model>(model));
-#pragma endregion Cone
-#pragma region Grid
-    model = Model{};
-    model.SetMeshes({PrebuiltEngineMeshes::CreateGrid(50.0f, 50.0f, 20u, 20u)});
-    model.CreateBufferResources();
-    model.CreateGPUBuffers();
-    m_meshes.emplace(eastl::make_shared<Model>(model));
-#pragma endregion Grid
+    // built in place, merged buffers are never copied
+    auto addPrebuiltModel = [this](MeshData<> &&meshData)
+    {
+        auto model = eastl::make_shared<Model>();
+        model->AddMesh(eastl::move(meshData));
+        model->FinalizeMeshData();
+        model->CreateGPUBuffers();
+        m_meshes.emplace(AssetSlot<Model>{eastl::move(model), "", 1u});
+    };
+
+    addPrebuiltModel(PrebuiltEngineMeshes::CreateBox(1.f, 1.f, 1.f));
+    addPrebuiltModel(PrebuiltEngineMeshes::CreateSphere(1.0f, 16u, 16u));
+    addPrebuiltModel(PrebuiltEngineMeshes::CreateCylinder(1, 0, 1, 16));
+    addPrebuiltModel(PrebuiltEngineMeshes::CreateGrid(50.0f, 50.0f, 20u, 20u));
 }
 
 void AssetManager::Destroy()
 {
     BF_INFO("AssetManager Destroy");
+    ReleaseScenePreload();
+    // workers may still hold jobs, they finish before the loader goes away
+    m_streamer->Shutdown();
+    m_streamer.reset();
+
+    if (!m_retiredTextures.empty()) Device::GetInstance().Flush();
+    m_retiredTextures.clear();
+
     m_loader->Destroy();
 }
 
 
-bool AssetManager::HasMesh(const Path &relativePath)
+void AssetManager::Update()
 {
-    return m_meshPaths.contains(ToEASTLString(relativePath.string()));
+    AssetStreamer::JobList finished;
+    m_streamer->Update(finished);
+    PublishStreamJobs(finished);
+    StreamTextureMips();
+    ReleaseRetiredTextures();
+
+    // materials published by now hold their textures, entities the rest
+    if (!IsStreaming()) ReleaseScenePreload();
+}
+
+
+bool AssetManager::IsStreaming() const
+{
+    return !m_streamer->IsIdle();
+}
+
+
+void AssetManager::FlushStreaming()
+{
+    // publishing a material queues its textures, so flush until publishing adds nothing
+    AssetStreamer::JobList finished;
+    while (IsStreaming())
+    {
+        m_streamer->Flush(finished);
+        PublishStreamJobs(finished);
+        finished.clear();
+    }
+
+    ReleaseScenePreload();
+}
+
+
+void AssetManager::SetStreamingMemoryBudget(uint64_t bytes)
+{
+    m_streamer->SetMemoryBudget(bytes);
+}
+
+
+void AssetManager::SetTextureMemoryBudget(uint64_t bytes)
+{
+    m_textureMemoryBudget = bytes;
+}
+
+
+void AssetManager::RequestTextureMips(const MaterialHandle &material, float screenSize)
+{
+    const Material *found = FindMaterial(material);
+    if (!found) return;
+
+    // unbound types have kInvalidTextureIndex, residency ignores ids it doesn't know
+    const TextureType types[] = {TextureType::ALBEDO, TextureType::NORMAL, TextureType::METALLIC,
+                                 TextureType::ROUGHNESS, TextureType::AO};
+    for (TextureType type : types)
+        m_textureResidency.Request(found->GetTextureIndex(type), screenSize);
 }
 
 
-eastl::shared_ptr<MeshHandle> AssetManager::GetMesh(const Path &relativePath)
+void AssetManager::PreloadScene(const SceneDependencies &dependencies)
 {
-    eastl::string pathStr = relativePath.string().c_str();
-    if (auto it = m_meshPaths.find(pathStr); it != m_meshPaths.end())
+    BLAINN_PROFILE_FUNC();
+
+    // an earlier preload still in flight is kept, both are released together
+    const auto isFile = [](const Path &relativePath)
+    { return std::filesystem::is_regular_file(Engine::GetContentDirectory() / relativePath); };
+
+    // assets that are already loaded are referenced too, so closing the previous scene doesn't unload them
+    for (const Path &path : dependencies.Meshes)
     {
-        return eastl::make_shared<MeshHandle>(it->second.index);
+        if (HasMesh(path)) m_preloadedMeshes.push_back(GetMesh(path));
+        else if (isFile(path))
+        {
+            const ImportMeshData data = ImportMeshData::GetMeshData(Engine::GetContentDirectory() / path);
+            m_preloadedMeshes.push_back(LoadMesh(path, data, StreamPriority::Critical));
+        }
     }
 
+    // textures go before the materials, publishing a material finds its textures in flight
+    for (const auto &[path, type] : dependencies.Textures)
+    {
+        if (HasTexture(path)) m_preloadedTextures.push_back(GetTexture(path));
+        else if (isFile(path)) m_preloadedTextures.push_back(LoadTexture(path, type, StreamPriority::Critical));
+    }
+
+    // cooked materials are built here in one batch and find their textures in flight
+    eastl::vector<Path> materials;
+    for (const Path &path : dependencies.Materials)
+        if (HasMaterial(path) || isFile(path)) materials.push_back(path);
+    LoadMaterials(materials, StreamPriority::Critical, m_preloadedMaterials);
+
+    BF_INFO("AssetManager: preloading {0} meshes, {1} textures and {2} materials", m_preloadedMeshes.size(),
+            m_preloadedTextures.size(), m_preloadedMaterials.size());
+}
+
+
+bool AssetManager::HasMesh(const Path &relativePath)
+{
+    return m_meshPaths.contains(ToEASTLString(relativePath.string()));
+}
+
+
+MeshHandle AssetManager::GetMesh(const Path &relativePath)
+{
+    if (auto it = m_meshPaths.find(ToEASTLString(relativePath.string())); it != m_meshPaths.end())
+        return AcquireMesh(it->second);
+
     BF_ERROR("This model isn't imported yet. You should import it first. {0}", relativePath.string());
 
     return GetDefaultMesh();
 }
 
 
-eastl::shared_ptr<MeshHandle> AssetManager::GetDefaultMesh(uint32_t index /* = 0u*/)
+MeshHandle AssetManager::GetDefaultMesh(uint32_t index /* = 0u*/)
 {
-    return eastl::make_shared<MeshHandle>(index);
+    return GetInstance().AcquireMesh(index);
 }
 
 
-eastl::shared_ptr<MeshHandle> AssetManager::LoadMesh(const Path &relativePath, const ImportMeshData &data)
+MeshHandle AssetManager::LoadMesh(const Path &relativePath, const ImportMeshData &data,
+                                  StreamPriority priority /*= StreamPriority::Normal*/,
+                                  const AssetLoadedCallback &onLoaded /*= {}*/)
 {
-    int index = static_cast<int>(m_meshes.emplace(eastl::make_shared<Model>(GetDefaultModel(), relativePath)));
-    m_meshPaths[ToEASTLString(relativePath.string())] = AssetData{index, 1};
-    vgjs::schedule([=]() { AddMeshWhenLoaded(relativePath, index, data); });
+    assert(relativePath.is_relative());
 
-    return eastl::make_shared<MeshHandle>(index);
+    const eastl::string path = ToEASTLString(relativePath.string());
+    // an empty model until the stream publishes, meshes that aren't loaded draw the default one
+    const auto index =
+        static_cast<uint32_t>(m_meshes.emplace(AssetSlot<Model>{eastl::make_shared<Model>(relativePath), path}));
+    m_meshPaths[path] = index;
+
+    auto job = MakeStreamJob(StreamAssetType::Mesh, relativePath, index, m_meshes.generation(index), priority,
+                             onLoaded);
+    job->MeshData = data;
+    m_streamer->Enqueue(eastl::move(job));
+
+    return AcquireMesh(index);
 }
 
 
 Model &AssetManager::GetMeshByIndex(const unsigned int index)
 {
-    if (index >= m_meshes.size()) return GetDefaultMesh()->GetMesh();
+    if (index >= m_meshes.size()) return GetDefaultModel();
 
-    if (m_meshes[index]->IsLoaded()) return *m_meshes[index];
+    const auto &model = m_meshes[index].Asset;
+    if (model && model->IsLoaded()) return *model;
 
-    return GetDefaultMesh()->GetMesh();
+    return GetDefaultModel();
 }
 
 
 Model &AssetManager::GetMeshByHandle(const MeshHandle &handle)
 {
-    return GetMeshByIndex(handle.GetIndex());
+    return handle.GetMesh();
 }
 
 
 Path AssetManager::GetMeshPath(const MeshHandle &handle)
 {
-    return m_meshes[handle.GetIndex()]->GetPath();
+    if (Model *model = FindMesh(handle)) return model->GetPath();
+    return {};
 }
 
 
@@ -174,90 +310,168 @@ bool AssetManager::HasTexture(const Path &path)
 }
 
 
-eastl::shared_ptr<TextureHandle> AssetManager::GetTexture(const Path &path)
+TextureHandle AssetManager::GetTexture(const Path &path)
 {
     if (auto it = m_texturePaths.find(ToEASTLString(path.string())); it != m_texturePaths.end())
-        return eastl::make_shared<TextureHandle>(it->second.index);
+        return AcquireTexture(it->second);
 
     BF_ERROR("Texture doesn't exist. You should load it first. Texture - {0}", path.string());
-    return eastl::make_shared<TextureHandle>(0);
+    return AcquireTexture(0u);
 }
 
 
-eastl::shared_ptr<TextureHandle> AssetManager::LoadTexture(const Path &relativePath, const TextureType type)
+TextureHandle AssetManager::LoadTexture(const Path &relativePath, const TextureType type,
+                                        StreamPriority priority /*= StreamPriority::Normal*/,
+                                        const AssetLoadedCallback &onLoaded /*= {}*/)
 {
     assert(relativePath.is_relative());
 
-    int index = static_cast<int>(m_textures.push_back(eastl::make_shared<Texture>()));
-    m_texturePaths[ToEASTLString(relativePath.string())] = AssetData{index, 1};
+    const eastl::string path = ToEASTLString(relativePath.string());
+    const auto index = static_cast<uint32_t>(
+        m_textures.emplace(AssetSlot<Texture>{eastl::make_shared<Texture>(relativePath, type), path}));
+    m_texturePaths[path] = index;
+
+    auto job = MakeStreamJob(StreamAssetType::Texture, relativePath, index, m_textures.generation(index), priority,
+                             onLoaded);
+    job->TextureKind = type;
+    m_streamer->Enqueue(eastl::move(job));
 
-    vgjs::schedule([=]() { AddTextureWhenLoaded(relativePath, index, type); });
-    return eastl::make_shared<TextureHandle>(index);
+    return AcquireTexture(index);
 }
 
 
-eastl::shared_ptr<MaterialHandle> AssetManager::GetMaterial(const Path &path)
+TextureHandle AssetManager::GetDefaultTextureHandle()
+{
+    return GetInstance().AcquireTexture(0u);
+}
+
+
+MaterialHandle AssetManager::GetMaterial(const Path &path)
 {
     if (auto it = m_materialPaths.find(ToEASTLString(path.string())); it != m_materialPaths.end())
-        return eastl::make_shared<MaterialHandle>(it->second.index);
+        return AcquireMaterial(it->second);
 
     BF_ERROR("Material doesn't exist. You should load it first. Path - {0}", path.string());
-    return eastl::make_shared<MaterialHandle>(0);
+    return AcquireMaterial(0u);
 }
 
 
-eastl::shared_ptr<MaterialHandle> AssetManager::LoadMaterial(const Path &path, AssetData data)
+MaterialHandle AssetManager::LoadMaterial(const Path &path, StreamPriority priority /*= StreamPriority::Normal*/,
+                                          const AssetLoadedCallback &onLoaded /*= {}*/)
 {
     assert(path.is_relative() && "the path is not relative");
 
-    int index = data.index == -1 ? static_cast<int>(m_materials.emplace(eastl::make_shared<Material>())) : data.index;
-    int count = data.refCount == 0 ? 1 : data.refCount;
-    m_materialPaths[ToEASTLString(path.string())] = AssetData{index, count};
-    vgjs::schedule([=]() { AddMaterialWhenLoaded(path, index); });
+    const MaterialTable::Record *record = m_loader->GetMaterialTable().Find(path);
+    if (!record) return StreamMaterial(path, priority, onLoaded);
 
-    return eastl::make_shared<MaterialHandle>(index);
+    eastl::hash_map<uint32_t, TextureHandle> resolvedTextures;
+    MaterialHandle handle = CreateCookedMaterial(path, *record, priority, resolvedTextures);
+    if (onLoaded) onLoaded(true);
+    return handle;
+}
+
+
+void AssetManager::LoadMaterials(const eastl::vector<Path> &paths, StreamPriority priority,
+                                 eastl::vector<MaterialHandle> &outHandles)
+{
+    BLAINN_PROFILE_FUNC();
+
+    MaterialTable &table = m_loader->GetMaterialTable();
+    eastl::hash_map<uint32_t, TextureHandle> resolvedTextures;
+    outHandles.reserve(outHandles.size() + paths.size());
+
+    for (const Path &path : paths)
+    {
+        if (HasMaterial(path))
+            outHandles.push_back(GetMaterial(path));
+        else if (const MaterialTable::Record *record = table.Find(path))
+            outHandles.push_back(CreateCookedMaterial(path, *record, priority, resolvedTextures));
+        else
+            outHandles.push_back(StreamMaterial(path, priority, {}));
+    }
+}
+
+
+MaterialHandle AssetManager::CreateCookedMaterial(const Path &relativePath, const MaterialTable::Record &record,
+                                                  StreamPriority priority,
+                                                  eastl::hash_map<uint32_t, TextureHandle> &resolvedTextures)
+{
+    const MaterialTable &table = m_loader->GetMaterialTable();
+    const auto resolveTexture = [&](uint32_t textureIndex, TextureType type)
+    {
+        if (auto it = resolvedTextures.find(textureIndex); it != resolvedTextures.end()) return it->second;
+
+        const Path texturePath = table.GetTexturePath(textureIndex);
+        TextureHandle handle =
+            HasTexture(texturePath) ? GetTexture(texturePath) : LoadTexture(texturePath, type, priority);
+        resolvedTextures[textureIndex] = handle;
+        return handle;
+    };
+
+    const eastl::string pathStr = ToEASTLString(relativePath.string());
+    auto material = m_loader->CreateMaterial(relativePath, record, resolveTexture);
+    const auto index = static_cast<uint32_t>(m_materials.emplace(AssetSlot<Material>{eastl::move(material), pathStr}));
+    m_materialPaths[pathStr] = index;
+
+    return AcquireMaterial(index);
+}
+
+
+MaterialHandle AssetManager::StreamMaterial(const Path &path, StreamPriority priority,
+                                            const AssetLoadedCallback &onLoaded)
+{
+    const eastl::string pathStr = ToEASTLString(path.string());
+    const auto index =
+        static_cast<uint32_t>(m_materials.emplace(AssetSlot<Material>{eastl::make_shared<Material>(), pathStr}));
+    m_materialPaths[pathStr] = index;
+
+    m_streamer->Enqueue(
+        MakeStreamJob(StreamAssetType::Material, path, index, m_materials.generation(index), priority, onLoaded));
+
+    return AcquireMaterial(index);
 }
 
 
 void AssetManager::UpdateMaterial(const Path &relativePath)
 {
-    if (!HasMaterial(relativePath)) return;
+    auto it = m_materialPaths.find(ToEASTLString(relativePath.string()));
+    if (it == m_materialPaths.end()) return;
 
-    LoadMaterial(relativePath, m_materialPaths[ToEASTLString(relativePath.string())]);
+    // edited in the editor, the old version stays visible until the new one is published
+    const uint32_t index = it->second;
+    m_streamer->Enqueue(MakeStreamJob(StreamAssetType::Material, relativePath, index, m_materials.generation(index),
+                                      StreamPriority::High, {}));
 }
 
 
 Material &AssetManager::GetMaterialByIndex(unsigned int index)
 {
-    if (index >= m_materials.size()) return GetDefaultMaterial();
+    if (index >= m_materials.size() || !m_materials[index].Asset) return GetDefaultMaterial();
 
-    return *m_materials[index];
+    return *m_materials[index].Asset;
 }
 
 
 Material &AssetManager::GetMaterialByHandle(const MaterialHandle &handle)
 {
-    unsigned int index = handle.GetIndex();
-    if (index >= m_materials.size())
-    {
-        BF_FATAL("Failed to get material by index. Index is greater than m_materials size!");
-        throw std::exception("Failed to get texture by index.");
-    }
+    if (Material *material = FindMaterial(handle)) return *material;
 
-    return *m_materials[index];
+    BF_ERROR("Failed to get material by handle. The material was unloaded.");
+    return GetDefaultMaterial();
 }
 
 
-eastl::shared_ptr<MaterialHandle> AssetManager::GetDefaultMaterialHandle()
+MaterialHandle AssetManager::GetDefaultMaterialHandle()
 {
-    return eastl::make_shared<MaterialHandle>(0);
+    return GetInstance().AcquireMaterial(0u);
 }
 
 
 Path AssetManager::GetMaterialPath(const MaterialHandle &handle)
 {
-    auto a = m_materials[handle.GetIndex()]->GetPath();
-    return m_materials[handle.GetIndex()]->GetPath();
+    // the placeholder of a material in flight has no path, the slot has
+    if (auto *slot = FindSlot(m_materials, handle)) return slot->Path.c_str();
+    return {};
 }
 
 
@@ -279,6 +493,9 @@ void AssetManager::OpenScene(const Path &relativePath)
         scene = YAML::LoadFile(absolute_path.string());
     }
 
+    // all loads start before the old scene releases its assets, the entities then find them in flight
+    GetInstance().PreloadScene(SceneDependencies::FromSceneNode(scene));
+
     Engine::GetSceneManager().CloseScenes();
     Engine::GetSceneManager().OpenScene(scene, Single);
 }
@@ -303,26 +520,21 @@ void AssetManager::CreateScene(const Path &relativePath)
 
 Texture &AssetManager::GetTextureByIndex(unsigned int index)
 {
-    return *m_textures[index];
+    if (index >= m_textures.size() || !m_textures[index].Asset) return GetDefaultTexture();
+
+    return *m_textures[index].Asset;
 }
 
 
 Texture &AssetManager::GetTextureByHandle(const TextureHandle &handle)
 {
-    assert(false);
-    unsigned int index = handle.GetIndex();
-    if (index >= m_textures.size())
-    {
-        BF_FATAL("Failed to get texture by index. Index is greater than m_textures size!");
-        throw std::exception("Failed to get texture by index.");
-    }
-
-    return *m_textures[index];
+    return handle.GetTexture();
 }
 
 Path AssetManager::GetTexturePath(const TextureHandle &handle)
 {
-    return m_textures[handle.GetIndex()]->GetPath();
+    if (Texture *texture = FindTexture(handle)) return texture->GetPath();
+    return {};
 }
 
 bool AssetManager::HasMaterial(const Path &relativePath)
@@ -336,131 +548,252 @@ void AssetManager::ResetTextures()
     m_loader->ResetTextureOffsetsTable();
 }
 
-void AssetManager::AddTextureWhenLoaded(const Path &path, const unsigned int index, const TextureType type)
+// a slot erased while its load was in flight has a new generation and is left alone
+bool AssetManager::IsStreamJobCurrent(const StreamJob &job) const
 {
-    assert(path.is_relative());
+    switch (job.Type)
+    {
+    case StreamAssetType::Texture:
+        return job.Index < m_textures.size() && m_textures.generation(job.Index) == job.Generation;
+    case StreamAssetType::Material:
+        return job.Index < m_materials.size() && m_materials.generation(job.Index) == job.Generation;
+    case StreamAssetType::Mesh:
+        return job.Index < m_meshes.size() && m_meshes.generation(job.Index) == job.Generation;
+    }
+    return false;
+}
+
+
+void AssetManager::PublishStreamJobs(AssetStreamer::JobList &jobs)
+{
+    BLAINN_PROFILE_FUNC();
+
+    bool isDeviceFlushed = false;
+    uint64_t retireFenceValue = 0u;
+    for (auto &job : jobs)
+    {
+        // failed loads keep the placeholder of the slot
+        const bool isCurrent = IsStreamJobCurrent(*job);
+        const bool isLoaded = job->bIsDecoded && isCurrent;
+
+        // a failed mip range keeps the resident one, the texture leaves residency instead of retrying every frame
+        if (job->Type == StreamAssetType::Texture && isCurrent && m_texturesStreamingMips.erase(job->Index) > 0u
+            && !isLoaded)
+        {
+            BF_WARN("Failed to stream mips of {0}, its resident mips are kept", job->RelativePath.string());
+            m_textureResidency.RemoveTexture(job->Index);
+        }
 
-    m_textures[index] = m_loader->LoadTexture(path, type, index);
+        if (isLoaded)
+        {
+            switch (job->Type)
+            {
+            case StreamAssetType::Texture:
+            {
+                Texture &texture = *job->LoadedTexture;
+                auto &previous = m_textures[job->Index].Asset;
+                if (previous && previous->IsInitialized())
+                {
+                    // the skybox has a single view in the heap, replacing it still waits for the GPU
+                    if (texture.GetType() == TextureType::CUBEMAP)
+                    {
+                        if (!isDeviceFlushed) Device::GetInstance().Flush();
+                        isDeviceFlushed = true;
+                    }
+                    else
+                    {
+                        // frames from now on copy the new view into their table, only the submitted ones still
+                        // read the previous texture
+                        if (retireFenceValue == 0u)
+                            retireFenceValue = Device::GetInstance().GetCommandQueue()->Signal();
+                        m_retiredTextures.push_back({eastl::move(previous), retireFenceValue});
+                    }
+                }
+
+                texture.CreateView();
+                if (texture.GetType() != TextureType::CUBEMAP)
+                {
+                    if (m_textureResidency.HasTexture(job->Index))
+                        m_textureResidency.SetResidentMip(job->Index, texture.GetResidentMip());
+                    else
+                        m_textureResidency.AddTexture(job->Index, texture.GetWidth(), texture.GetHeight(),
+                                                      texture.GetMipSizes().data(), texture.GetMipCount(),
+                                                      texture.GetTailMip(), texture.GetResidentMip());
+                }
+
+                m_textures[job->Index].Asset = eastl::move(job->LoadedTexture);
+                break;
+            }
+            case StreamAssetType::Material:
+                // textures of the material are streamed with its priority
+                m_materials[job->Index].Asset =
+                    m_loader->CreateMaterial(job->RelativePath, job->LoadedMaterial, job->Priority);
+                break;
+            case StreamAssetType::Mesh:
+                m_meshes[job->Index].Asset = eastl::move(job->LoadedMesh);
+                break;
+            }
+        }
+
+        for (const auto &callback : job->Callbacks)
+            callback(isLoaded);
+    }
 }
 
 
-void AssetManager::AddMaterialWhenLoaded(const Path &relativePath, const unsigned int index)
+void AssetManager::ReleaseRetiredTextures()
 {
-    assert(relativePath.is_relative());
-    m_materials[index] = m_loader->LoadMaterial(relativePath);
+    if (m_retiredTextures.empty()) return;
+
+    auto commandQueue = Device::GetInstance().GetCommandQueue();
+    auto released = eastl::remove_if(m_retiredTextures.begin(), m_retiredTextures.end(),
+                                     [&commandQueue](const RetiredTexture &retired)
+                                     { return commandQueue->IsFenceComplete(retired.FenceValue); });
+    m_retiredTextures.erase(released, m_retiredTextures.end());
 }
 
 
-void AssetManager::AddMeshWhenLoaded(const Path &relativePath, const unsigned int index, const ImportMeshData data)
+void AssetManager::StreamTextureMips()
 {
-    assert(relativePath.is_relative());
-    m_meshes[index] = m_loader->ImportModel(relativePath, data);
+    BLAINN_PROFILE_FUNC();
+    m_textureResidency.Solve(m_textureMemoryBudget);
+
+    for (uint32_t index : m_textureResidency.GetChangedTextures())
+    {
+        // the next solve picks up whatever changed while the range was in flight
+        if (!m_texturesStreamingMips.insert(index).second) continue;
+
+        // the whole chain is read again, the texture is recreated with the target range and replaces the slot
+        const Texture &texture = *m_textures[index].Asset;
+        auto job = MakeStreamJob(StreamAssetType::Texture, texture.GetPath(), index, m_textures.generation(index),
+                                 StreamPriority::Low, {});
+        job->TextureKind = texture.GetType();
+        job->ResidentMip = m_textureResidency.GetTargetMip(index);
+        m_streamer->Enqueue(eastl::move(job));
+    }
+}
+
+
+void AssetManager::ReleaseScenePreload()
+{
+    m_preloadedMaterials.clear();
+    m_preloadedMeshes.clear();
+    m_preloadedTextures.clear();
 }
 
 
 Texture &AssetManager::GetDefaultTexture(uint32_t index /*= 0u*/)
 {
-    return *m_textures[index];
+    return *m_textures[index].Asset;
 }
 
 
 Material &AssetManager::GetDefaultMaterial()
 {
-    return *m_materials[0];
+    return *m_materials[0].Asset;
 }
 
 
 Model &AssetManager::GetDefaultModel(uint32_t index /*= 0u*/)
 {
-    return *m_meshes[index];
+    return *m_meshes[index].Asset;
 }
 
 
-void AssetManager::IncreaseTextureRefCount(const unsigned int index)
+Texture *AssetManager::FindTexture(const Handle &handle)
 {
-    for (auto &[key, value] : m_texturePaths)
-        if (static_cast<unsigned int>(value.index) == index) ++value.refCount;
+    auto *slot = FindSlot(m_textures, handle);
+    return slot ? slot->Asset.get() : nullptr;
 }
 
 
-void AssetManager::IncreaseMaterialRefCount(const unsigned int index)
+Material *AssetManager::FindMaterial(const Handle &handle)
 {
-    for (auto &[key, value] : m_materialPaths)
-        if (static_cast<unsigned int>(value.index) == index) ++value.refCount;
+    auto *slot = FindSlot(m_materials, handle);
+    return slot ? slot->Asset.get() : nullptr;
 }
 
 
-void AssetManager::IncreaseMeshRefCount(const unsigned int index)
+Model *AssetManager::FindMesh(const Handle &handle)
 {
-    for (auto &[key, value] : m_meshPaths)
-        if (static_cast<unsigned int>(value.index) == index) ++value.refCount;
+    auto *slot = FindSlot(m_meshes, handle);
+    return slot ? slot->Asset.get() : nullptr;
 }
 
 
-void AssetManager::DecreaseTextureRefCount(const unsigned int index)
+TextureHandle AssetManager::AcquireTexture(uint32_t index)
 {
-    // 0: default diffuse
-    if (index == 0) return;
+    assert(index < m_textures.size());
+    ++m_textures[index].RefCount;
+    return TextureHandle(index, m_textures.generation(index));
+}
 
-    for (auto &[key, value] : m_texturePaths)
-    {
-        if (static_cast<unsigned int>(value.index) == index)
-        {
-            --value.refCount;
 
-            if (value.refCount == 1) // 1 because we have shared ptr in free list vector
-            {
-                Device::GetInstance().Flush();
-                m_textures.erase(index);
-                m_texturePaths.erase(key);
-                return;
-            }
-        }
-    }
+MaterialHandle AssetManager::AcquireMaterial(uint32_t index)
+{
+    assert(index < m_materials.size());
+    ++m_materials[index].RefCount;
+    return MaterialHandle(index, m_materials.generation(index));
 }
 
 
-void AssetManager::DecreaseMaterialRefCount(const unsigned int index)
+MeshHandle AssetManager::AcquireMesh(uint32_t index)
 {
-    if (index == 0) return;
+    assert(index < m_meshes.size());
+    ++m_meshes[index].RefCount;
+    return MeshHandle(index, m_meshes.generation(index));
+}
 
-    for (auto &[key, value] : m_materialPaths)
-    {
-        if (static_cast<unsigned int>(value.index) == index)
-        {
-            --value.refCount;
 
-            if (value.refCount == 1) // 1 because we have shared ptr in free list vector
-            {
-                m_materials.erase(index);
-                m_materialPaths.erase(key);
-                return;
-            }
-        }
-    }
+void AssetManager::IncreaseTextureRefCount(const Handle &handle)
+{
+    if (auto *slot = FindSlot(m_textures, handle)) ++slot->RefCount;
 }
 
 
-void AssetManager::DecreaseMeshRefCount(const unsigned int index)
+void AssetManager::IncreaseMaterialRefCount(const Handle &handle)
 {
-    if (index == 0) return;
+    if (auto *slot = FindSlot(m_materials, handle)) ++slot->RefCount;
+}
 
-    for (auto &[key, value] : m_meshPaths)
-    {
-        if (static_cast<unsigned int>(value.index) == index)
-        {
-            --value.refCount;
 
+void AssetManager::IncreaseMeshRefCount(const Handle &handle)
+{
+    if (auto *slot = FindSlot(m_meshes, handle)) ++slot->RefCount;
+}
 
-            if (value.refCount == 1) // 1 because we have shared ptr in free list vector
-            {
-                Device::GetInstance().Flush();
-                m_meshes.erase(index);
-                m_meshPaths.erase(key);
-                return;
-            }
-        }
-    }
+
+void AssetManager::DecreaseTextureRefCount(const Handle &handle)
+{
+    auto *slot = FindSlot(m_textures, handle);
+    if (!slot || --slot->RefCount > 0u) return;
+
+    Device::GetInstance().Flush();
+    ErasePath(m_texturePaths, *slot, handle.GetIndex());
+    m_textureResidency.RemoveTexture(handle.GetIndex());
+    m_texturesStreamingMips.erase(handle.GetIndex());
+    m_textures.erase(handle.GetIndex());
+}
+
+
+void AssetManager::DecreaseMaterialRefCount(const Handle &handle)
+{
+    auto *slot = FindSlot(m_materials, handle);
+    if (!slot || --slot->RefCount > 0u) return;
+
+    ErasePath(m_materialPaths, *slot, handle.GetIndex());
+    m_materials.erase(handle.GetIndex());
+}
+
+
+void AssetManager::DecreaseMeshRefCount(const Handle &handle)
+{
+    auto *slot = FindSlot(m_meshes, handle);
+    if (!slot || --slot->RefCount > 0u) return;
+
+    Device::GetInstance().Flush();
+    ErasePath(m_meshPaths, *slot, handle.GetIndex());
+    m_meshes.erase(handle.GetIndex());
 }
 
 } // namespace Blainn
@@ -0,0 +1,328 @@
+#include "pch.h"
+
+#include "subsystems/AssetStreamer.h"
+
+#include "Engine.h"
+#include "Render/CommandQueue.h"
+#include "Render/Device.h"
+#include "file-system/Model.h"
+#include "file-system/Texture.h"
+#include "subsystems/AssetLoader.h"
+
+#pragma warning(push)
+#pragma warning(disable : 4100)
+#include "VGJS.h"
+#pragma warning(pop)
+
+#include <filesystem>
+#include <thread>
+
+namespace Blainn
+{
+namespace
+{
+// smallest charge of a job, keeps tiny files from flooding the workers
+constexpr uint64_t kMinJobMemoryCost = 4ull * 1024ull;
+// compressed images grow when decoded, the mip chain adds another third. Block compressed cache entries are
+// smaller, the charge is corrected to the decoded size once the worker is done
+constexpr uint64_t kTextureDecodeExpansion = 4ull;
+
+uint64_t GetFileSize(const Path &absolutePath)
+{
+    std::error_code error;
+    const uintmax_t size = std::filesystem::file_size(absolutePath, error);
+    return error ? 0ull : static_cast<uint64_t>(size);
+}
+} // namespace
+
+AssetStreamer::AssetStreamer(AssetLoader &loader, JobFilter isJobCurrent)
+    : m_loader(loader)
+    , m_isJobCurrent(eastl::move(isJobCurrent))
+    , m_copyQueue(Device::GetInstance().GetCommandQueue(D3D12_COMMAND_LIST_TYPE_COPY))
+{
+}
+
+
+AssetStreamer::~AssetStreamer()
+{
+    Shutdown();
+}
+
+
+void AssetStreamer::Enqueue(eastl::unique_ptr<StreamJob> job)
+{
+    m_queues[static_cast<size_t>(job->Priority)].push_back(eastl::move(job));
+}
+
+
+void AssetStreamer::Update(JobList &outFinished)
+{
+    BLAINN_PROFILE_FUNC();
+
+    PublishUploaded(outFinished);
+    SubmitDecoded(outFinished);
+    // budget freed above is reused in the same frame
+    DispatchQueued(outFinished);
+}
+
+
+void AssetStreamer::Flush(JobList &outFinished)
+{
+    BLAINN_PROFILE_FUNC();
+
+    while (!IsIdle())
+    {
+        Update(outFinished);
+
+        if (!m_uploadBatches.empty())
+            m_copyQueue->WaitForFenceValue(m_uploadBatches.back().FenceValue);
+        else if (m_workersInFlight > 0u)
+            std::this_thread::yield();
+    }
+}
+
+
+void AssetStreamer::Shutdown()
+{
+    for (auto &queue : m_queues)
+        queue.clear();
+
+    eastl::vector<StreamJob *> decoded;
+    while (m_workersInFlight > 0u)
+    {
+        TakeDecoded(decoded);
+        for (StreamJob *job : decoded)
+            delete job;
+
+        m_workersInFlight -= static_cast<uint32_t>(decoded.size());
+        if (m_workersInFlight > 0u) std::this_thread::yield();
+    }
+
+    if (!m_uploadBatches.empty()) m_copyQueue->WaitForFenceValue(m_uploadBatches.back().FenceValue);
+    m_uploadBatches.clear();
+    m_bytesInFlight = 0u;
+}
+
+
+bool AssetStreamer::IsIdle() const
+{
+    return GetPendingJobCount() == 0u;
+}
+
+
+uint32_t AssetStreamer::GetPendingJobCount() const
+{
+    size_t count = m_workersInFlight;
+    for (const auto &queue : m_queues)
+        count += queue.size();
+    for (const auto &batch : m_uploadBatches)
+        count += batch.Jobs.size();
+    return static_cast<uint32_t>(count);
+}
+
+
+void AssetStreamer::RunWorkerStages(StreamJob &job)
+{
+    BLAINN_PROFILE_FUNC();
+
+    switch (job.Type)
+    {
+    case StreamAssetType::Texture:
+        DecodeTexture(job);
+        break;
+    case StreamAssetType::Material:
+        DecodeMaterial(job);
+        break;
+    case StreamAssetType::Mesh:
+        DecodeMesh(job);
+        break;
+    }
+}
+
+
+void AssetStreamer::DecodeTexture(StreamJob &job)
+{
+    // WIC needs COM on every thread that decodes, a thread that already has it keeps its apartment
+    static thread_local const HRESULT comResult = CoInitializeEx(nullptr, COINIT_MULTITHREADED);
+    (void)comResult;
+
+    auto texture = eastl::make_shared<Texture>(job.RelativePath, job.TextureKind);
+    if (!texture->ReadAndDecode()) return;
+    texture->SetResidentMip(job.ResidentMip);
+
+    job.DecodedSize = texture->GetDecodedSize();
+    job.LoadedTexture = eastl::move(texture);
+    job.bIsDecoded = true;
+}
+
+
+void AssetStreamer::DecodeMaterial(StreamJob &job)
+{
+    eastl::vector<uint8_t> fileData;
+    if (!FileSystemObject::ReadFileData(Engine::GetContentDirectory() / job.RelativePath, fileData))
+    {
+        BF_ERROR("AssetStreamer: failed to read material {0}", job.RelativePath.string());
+        return;
+    }
+
+    job.DecodedSize = fileData.size();
+    job.bIsDecoded = AssetLoader::ParseMaterial(job.RelativePath, fileData, job.LoadedMaterial);
+}
+
+
+void AssetStreamer::DecodeMesh(StreamJob &job)
+{
+    // the cached cook is read straight into the merged buffers, Assimp only runs on a miss
+    auto model = eastl::make_shared<Model>(job.RelativePath);
+    if (!m_loader.LoadModelData(job.RelativePath, job.MeshData, *model))
+    {
+        BF_ERROR("AssetStreamer: failed to load mesh {0}", job.RelativePath.string());
+        return;
+    }
+
+    job.DecodedSize = model->GetCPUDataSize();
+    job.LoadedMesh = eastl::move(model);
+    job.bIsDecoded = true;
+}
+
+
+void AssetStreamer::PublishUploaded(JobList &outFinished)
+{
+    // batches are signaled in order, the first unfinished one ends the scan
+    while (!m_uploadBatches.empty() && m_copyQueue->IsFenceComplete(m_uploadBatches.front().FenceValue))
+    {
+        UploadBatch &batch = m_uploadBatches.front();
+        for (auto &job : batch.Jobs)
+        {
+            if (job->LoadedTexture) job->LoadedTexture->MarkUploaded();
+            if (job->LoadedMesh) job->LoadedMesh->MarkUploaded();
+            Finish(eastl::move(job), outFinished);
+        }
+        m_uploadBatches.pop_front();
+    }
+}
+
+
+void AssetStreamer::SubmitDecoded(JobList &outFinished)
+{
+    eastl::vector<StreamJob *> decoded;
+    TakeDecoded(decoded);
+    if (decoded.empty()) return;
+
+    BLAINN_PROFILE_FUNC();
+    m_workersInFlight -= static_cast<uint32_t>(decoded.size());
+
+    UploadBatch batch;
+    ComPtr<ID3D12GraphicsCommandList2> cmdList;
+
+    for (StreamJob *decodedJob : decoded)
+    {
+        eastl::unique_ptr<StreamJob> job(decodedJob);
+
+        // the estimate is replaced by what the decode actually holds, upload heaps are about the same size
+        m_bytesInFlight = m_bytesInFlight - job->MemoryCost + job->DecodedSize;
+        job->MemoryCost = job->DecodedSize;
+
+        const bool needsUpload = job->bIsDecoded && (job->LoadedTexture || job->LoadedMesh);
+        if (!needsUpload || !m_isJobCurrent(*job))
+        {
+            Finish(eastl::move(job), outFinished);
+            continue;
+        }
+
+        if (!cmdList)
+        {
+            batch.CommandAllocator = m_copyQueue->GetCommandAllocator();
+            cmdList = m_copyQueue->GetCommandList(batch.CommandAllocator.Get());
+        }
+
+        const bool isRecorded = job->LoadedTexture ? job->LoadedTexture->RecordUpload(cmdList.Get(), job->Index)
+                                                   : job->LoadedMesh->RecordGPUUpload(cmdList.Get());
+        if (!isRecorded)
+        {
+            job->LoadedTexture.reset();
+            job->LoadedMesh.reset();
+            job->bIsDecoded = false;
+            Finish(eastl::move(job), outFinished);
+            continue;
+        }
+
+        batch.Jobs.push_back(eastl::move(job));
+    }
+
+    if (!cmdList) return;
+
+    // one submission and one fence for everything decoded since the last frame
+    m_copyQueue->ExecuteCommandList(cmdList);
+    batch.FenceValue = m_copyQueue->Signal();
+    m_uploadBatches.push_back(eastl::move(batch));
+}
+
+
+void AssetStreamer::DispatchQueued(JobList &outFinished)
+{
+    for (auto &queue : m_queues)
+    {
+        while (!queue.empty())
+        {
+            if (!m_isJobCurrent(*queue.front()))
+            {
+                Finish(eastl::move(queue.front()), outFinished);
+                queue.pop_front();
+                continue;
+            }
+
+            // one job always runs, an asset larger than the whole budget must not stall the queue.
+            // Lower classes wait too, they don't overtake a blocked higher one.
+            const uint64_t cost = EstimateMemoryCost(*queue.front());
+            if (m_bytesInFlight > 0u && m_bytesInFlight + cost > m_memoryBudget) return;
+
+            // the worker owns the job until it hands it back through m_decoded
+            StreamJob *job = queue.front().release();
+            queue.pop_front();
+
+            job->MemoryCost = cost;
+            m_bytesInFlight += cost;
+            ++m_workersInFlight;
+
+            vgjs::schedule(
+                [this, job]()
+                {
+                    RunWorkerStages(*job);
+
+                    std::lock_guard<std::mutex> lock(m_decodedMutex);
+                    m_decoded.push_back(job);
+                });
+        }
+    }
+}
+
+
+void AssetStreamer::Finish(eastl::unique_ptr<StreamJob> job, JobList &outFinished)
+{
+    m_bytesInFlight -= job->MemoryCost;
+    job->MemoryCost = 0u;
+    outFinished.push_back(eastl::move(job));
+}
+
+
+void AssetStreamer::TakeDecoded(eastl::vector<StreamJob *> &outJobs)
+{
+    outJobs.clear();
+
+    std::lock_guard<std::mutex> lock(m_decodedMutex);
+    outJobs.swap(m_decoded);
+}
+
+
+uint64_t AssetStreamer::EstimateMemoryCost(const StreamJob &job)
+{
+    const Path absolutePath = Engine::GetContentDirectory() / job.RelativePath;
+
+    // cache keys need the source hash, the main thread sticks to the source size
+    uint64_t fileSize = GetFileSize(absolutePath);
+    if (job.Type == StreamAssetType::Texture) fileSize *= kTextureDecodeExpansion;
+
+    return eastl::max(fileSize, kMinJobMemoryCost);
+}
+} // namespace Blainn
@@ -10,6 +10,7 @@
 #include "components/MeshComponent.h"
 #include "components/NavMeshVolumeComponent.h"
 #include "scene/TransformComponent.h"
+#include "file-system/DerivedDataCache.h"
 #include "file-system/Model.h"
 #include <fstream>
 #include <AABBHelpers.h>
@@ -17,6 +18,33 @@
 
 namespace Blainn
 {
+namespace
+{
+// bump on any change to NavmeshBuilder
+constexpr uint32_t kNavMeshBakeVersion = 1u;
+
+// a bake depends only on the collected geometry, the volume and the settings
+DerivedDataCache::Key MakeNavMeshKey(const eastl::vector<NavMeshInputMesh> &geometry, const JPH::AABox &bounds,
+                                     const NavMeshBuildSettings &settings)
+{
+    uint64_t geometryHash = DerivedDataCache::kHashSeed;
+    for (const NavMeshInputMesh &mesh : geometry)
+    {
+        geometryHash = DerivedDataCache::HashBytes(mesh.positions.data(), mesh.positions.size() * sizeof(float),
+                                                   geometryHash);
+        geometryHash =
+            DerivedDataCache::HashBytes(mesh.indices.data(), mesh.indices.size() * sizeof(int), geometryHash);
+    }
+
+    const float boundsValues[] = {bounds.mMin.GetX(), bounds.mMin.GetY(), bounds.mMin.GetZ(),
+                                  bounds.mMax.GetX(), bounds.mMax.GetY(), bounds.mMax.GetZ()};
+    geometryHash = DerivedDataCache::HashBytes(boundsValues, sizeof(boundsValues), geometryHash);
+
+    return DerivedDataCache::MakeKey(&geometryHash, sizeof(geometryHash), "NavMesh", kNavMeshBakeVersion,
+                                     DerivedDataCache::HashBytes(&settings, sizeof(settings)));
+}
+} // namespace
+
 class AIController;
 void NavigationSubsystem::Init()
 {
@@ -172,14 +200,27 @@ bool NavigationSubsystem::BakeNavMesh(Scene &scene, Entity navVolumeEntity, cons
     settings.agentMaxClimb = volume.AgentMaxClimb;
     settings.agentMaxSlope = volume.AgentMaxSlope;
 
-    auto result = NavmeshBuilder::BuildNavMesh(geometry, worldBounds, settings);
-    if (!result.success || !result.navData || result.navDataSize <= 0)
+    const DerivedDataCache::Key key = MakeNavMeshKey(geometry, worldBounds, settings);
+    eastl::vector<uint8_t> navData;
+    if (DerivedDataCache::Read(key, navData))
     {
-        BF_ERROR("NavMesh build failed: {}", result.errorMsg.empty() ? "Unknown error" : result.errorMsg.c_str());
-        return false;
+        BF_INFO("Navmesh is unchanged, taken from the derived data cache. Size: {} bytes", navData.size());
     }
+    else
+    {
+        auto result = NavmeshBuilder::BuildNavMesh(geometry, worldBounds, settings);
+        if (!result.success || !result.navData || result.navDataSize <= 0)
+        {
+            BF_ERROR("NavMesh build failed: {}", result.errorMsg.empty() ? "Unknown error" : result.errorMsg.c_str());
+            return false;
+        }
 
-    BF_INFO("Navmesh build SUCCESS. Size: {} bytes", result.navDataSize);
+        BF_INFO("Navmesh build SUCCESS. Size: {} bytes", result.navDataSize);
+
+        navData.assign(result.navData, result.navData + result.navDataSize);
+        dtFree(result.navData);
+        DerivedDataCache::Write(key, navData.data(), navData.size());
+    }
 
     Path absPath = Engine::GetContentDirectory() / outputRelativePath;
     std::filesystem::create_directories(absPath.parent_path());
@@ -187,16 +228,13 @@ bool NavigationSubsystem::BakeNavMesh(Scene &scene, Entity navVolumeEntity, cons
     std::ofstream file(absPath, std::ios::binary);
     if (!file.is_open())
     {
-        dtFree(result.navData);
         BF_ERROR("Failed to open output file: {}", absPath.string().c_str());
         return false;
     }
 
-    file.write(reinterpret_cast<const char *>(result.navData), result.navDataSize);
+    file.write(reinterpret_cast<const char *>(navData.data()), static_cast<std::streamsize>(navData.size()));
     file.close();
 
-    dtFree(result.navData);
-
     Path scenePath = Engine::GetContentDirectory() / scene.GetName().c_str();
     YAML::Node sceneNode = YAML::LoadFile(scenePath.string());
     sceneNode["NavMeshData"]["Path"] = outputRelativePath.string();
@@ -399,7 +437,7 @@ eastl::vector<NavMeshInputMesh> NavigationSubsystem::CollectGeometryForNavmesh(S
 
     for (const auto &[entity, mesh, transform] : entities)
     {
-        auto &meshData = mesh.MeshHandle->GetMesh();
+        auto &meshData = mesh.MeshHandle.GetMesh();
         if (meshData.GetAllVertices().empty() || meshData.GetAllIndices().empty()) continue;
 
         eastl::vector<float> worldPositions;
@@ -418,11 +456,13 @@ eastl::vector<NavMeshInputMesh> NavigationSubsystem::CollectGeometryForNavmesh(S
         JPH::AABox meshAABB = CalculateAABBFromPositions(worldPositions);
         if (!meshAABB.Overlaps(navVolumeWorldBounds)) continue;
 
+        // only LOD 0, simplified levels follow it in the merged index buffer
+        const auto &allIndices = meshData.GetAllIndices();
         eastl::vector<int> indicesInt;
-        indicesInt.reserve(meshData.GetAllIndices().size());
-        for (uint32_t idx : meshData.GetAllIndices())
+        indicesInt.reserve(meshData.GetIndicesCount());
+        for (uint32_t i = 0; i < meshData.GetIndicesCount(); ++i)
         {
-            indicesInt.push_back(static_cast<int>(idx));
+            indicesInt.push_back(static_cast<int>(allIndices[i]));
         }
 
         result.push_back({.positions = eastl::move(worldPositions), .indices = eastl::move(indicesInt)});
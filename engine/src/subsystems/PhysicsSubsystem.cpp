@@ -39,6 +39,7 @@ void PhysicsSubsystem::Init(Timeline<eastl::chrono::milliseconds> &globalTimelin
     m_joltJobSystem = eastl::make_unique<JPH::JobSystemSingleThreaded>(JPH::cMaxPhysicsJobs);
 
     m_joltPhysicsSystem = eastl::make_unique<JPH::PhysicsSystem>();
+    m_bodyEntityConnections.resize(cNumBodies);
 
     m_factory = eastl::make_unique<JPH::Factory>();
     JPH::Factory::sInstance = m_factory.get();
@@ -161,6 +162,41 @@ void PhysicsSubsystem::StopSimulation()
     }
 }
 
+void PhysicsSubsystem::SaveBodyStates()
+{
+    BLAINN_PROFILE_FUNC();
+
+    m_savedBodyStates = eastl::make_unique<JPH::StateRecorderImpl>();
+    m_joltPhysicsSystem->SaveState(*m_savedBodyStates, JPH::EStateRecorderState::Bodies);
+}
+
+bool PhysicsSubsystem::RestoreBodyStates()
+{
+    BLAINN_PROFILE_FUNC();
+    if (!m_savedBodyStates) return false;
+
+    m_savedBodyStates->Rewind();
+    const bool isRestored = m_joltPhysicsSystem->RestoreState(*m_savedBodyStates);
+    m_savedBodyStates.reset();
+    return isRestored;
+}
+
+void PhysicsSubsystem::ResetBodies()
+{
+    BLAINN_PROFILE_FUNC();
+    m_savedBodyStates.reset();
+
+    for (auto &scene : Engine::GetSceneManager().GetActiveScenes())
+    {
+        const auto &view = scene->GetAllEntitiesWith<IDComponent, PhysicsComponent>();
+        for (const auto &[_, idComp, physicsComp] : view.each())
+        {
+            UpdateBodyInJolt(idComp.ID);
+            GetBodyUpdater(scene->GetEntityWithUUID(idComp.ID)).SetVelocity(Vec3::Zero).SetAngularVelocity(Vec3::Zero);
+        }
+    }
+}
+
 void PhysicsSubsystem::CreateAttachPhysicsComponent(PhysicsComponentSettings &settings)
 {
     TransformComponent *transformComponentPtr = settings.entity.TryGetComponent<TransformComponent>();
@@ -206,7 +242,7 @@ void PhysicsSubsystem::CreateAttachPhysicsComponent(PhysicsComponentSettings &se
         .SetAllowedDOFs(settings.allowedDOFs);
 
     component.bodyId = builder.Build(settings.activate);
-    m_bodyEntityConnections.try_emplace(component.bodyId, parentId);
+    ConnectBodyToEntity(component.bodyId, parentId);
 
     settings.entity.AddComponent<PhysicsComponent>(eastl::move(component));
 }
@@ -224,7 +260,7 @@ void PhysicsSubsystem::DestroyPhysicsComponent(Entity entity)
     JPH::BodyInterface &bodyInterface = m_joltPhysicsSystem->GetBodyInterface();
     bodyInterface.RemoveBody(component->bodyId);
     bodyInterface.DestroyBody(component->bodyId);
-    m_bodyEntityConnections.erase(component->bodyId);
+    DisconnectBody(component->bodyId);
     entity.RemoveComponent<PhysicsComponent>();
 }
 
@@ -237,13 +273,36 @@ JPH::BodyID PhysicsSubsystem::GetBodyId(Entity entity)
 
 eastl::optional<Entity> Blainn::PhysicsSubsystem::GetEntityByBodyId(JPH::BodyID bodyId)
 {
-    if (!m_bodyEntityConnections.contains(bodyId)) [[unlikely]]
+    const uuid *entityId = TryGetEntityIdByBodyId(bodyId);
+    if (!entityId) [[unlikely]]
     {
         BF_ERROR("can not get entity by body id {} - does not exist", bodyId.GetIndexAndSequenceNumber());
         return eastl::optional<Entity>{};
     }
 
-    return eastl::optional<Entity>(Engine::GetSceneManager().TryGetEntityWithUUID(m_bodyEntityConnections[bodyId]));
+    return eastl::optional<Entity>(Engine::GetSceneManager().TryGetEntityWithUUID(*entityId));
+}
+
+const uuid *PhysicsSubsystem::TryGetEntityIdByBodyId(JPH::BodyID bodyId)
+{
+    if (bodyId.IsInvalid() || bodyId.GetIndex() >= m_bodyEntityConnections.size()) return nullptr;
+
+    const BodyEntityConnection &connection = m_bodyEntityConnections[bodyId.GetIndex()];
+    if (connection.bodyId != bodyId) return nullptr;
+
+    return &connection.entityId;
+}
+
+void PhysicsSubsystem::ConnectBodyToEntity(JPH::BodyID bodyId, const uuid &entityId)
+{
+    assert(bodyId.GetIndex() < m_bodyEntityConnections.size());
+    m_bodyEntityConnections[bodyId.GetIndex()] = BodyEntityConnection{.bodyId = bodyId, .entityId = entityId};
+}
+
+void PhysicsSubsystem::DisconnectBody(JPH::BodyID bodyId)
+{
+    if (!TryGetEntityIdByBodyId(bodyId)) return;
+    m_bodyEntityConnections[bodyId.GetIndex()] = BodyEntityConnection{};
 }
 
 PhysicsEventHandle PhysicsSubsystem::AddEventListener(
@@ -257,6 +316,30 @@ void PhysicsSubsystem::RemoveEventListener(const PhysicsEventType eventType, con
     s_physicsEventQueue.removeListener(eventType, handle);
 }
 
+PhysicsEventHandle PhysicsSubsystem::AddEntityEventListener(
+    const uuid &entityId, const PhysicsEventType eventType,
+    eastl::function<void(const eastl::shared_ptr<PhysicsEvent> &)> listener)
+{
+    return s_entityEventDispatchers[entityId].appendListener(eventType, listener);
+}
+
+void PhysicsSubsystem::RemoveEntityEventListener(const uuid &entityId, const PhysicsEventType eventType,
+                                                 const PhysicsEventHandle &handle)
+{
+    auto it = s_entityEventDispatchers.find(entityId);
+    if (it == s_entityEventDispatchers.end()) return;
+
+    EntityPhysicsEventDispatcher &dispatcher = it->second;
+    dispatcher.removeListener(eventType, handle);
+
+    if (dispatcher.hasAnyListener(PhysicsEventType::CollisionStarted)
+        || dispatcher.hasAnyListener(PhysicsEventType::CollisionEnded))
+        return;
+
+    if (s_isDispatchingEntityEvents) s_emptyEntityDispatchers.push_back(entityId);
+    else s_entityEventDispatchers.erase(it);
+}
+
 JPH::PhysicsSystem &PhysicsSubsystem::GetPhysicsSystem()
 {
     return *m_joltPhysicsSystem;
@@ -283,7 +366,8 @@ eastl::optional<RayCastResult> PhysicsSubsystem::CastRay(Vec3 origin, Vec3 direc
     Vec3 bodyPosition = bodyGetter.GetPosition();
 
     RayCastResult rayCastResult;
-    rayCastResult.entityId = m_bodyEntityConnections[hitBodyId];
+    const uuid *hitEntityId = TryGetEntityIdByBodyId(hitBodyId);
+    rayCastResult.entityId = hitEntityId ? *hitEntityId : uuid{};
     rayCastResult.distance = joltResult.mFraction * directionAndDistance.Length();
     rayCastResult.hitPoint = origin + directionAndDistance * joltResult.mFraction;
 
@@ -352,16 +436,56 @@ eastl::optional<RayCastResult> PhysicsSubsystem::FilteredCastRay(eastl::queue<uu
 
 void Blainn::PhysicsSubsystem::ProcessEvents()
 {
-    s_physicsEventQueue.process();
+    BLAINN_PROFILE_FUNC();
+
+    m_contactListener->CollectEvents(s_collectedEvents);
+
+    for (const PhysicsEvent &collectedEvent : s_collectedEvents)
+    {
+        const eastl::shared_ptr<PhysicsEvent> physicsEvent = eastl::make_shared<PhysicsEvent>(collectedEvent);
+        s_physicsEventQueue.dispatch(physicsEvent);
+        DispatchEntityEvent(physicsEvent);
+    }
+    s_collectedEvents.clear();
+}
+
+void Blainn::PhysicsSubsystem::DispatchEntityEvent(const eastl::shared_ptr<PhysicsEvent> &physicsEvent)
+{
+    if (s_entityEventDispatchers.empty()) return;
+
+    s_isDispatchingEntityEvents = true;
+    DispatchEntityEvent(physicsEvent->entity1, physicsEvent);
+    DispatchEntityEvent(physicsEvent->entity2, physicsEvent);
+    s_isDispatchingEntityEvents = false;
+
+    for (const uuid &entityId : s_emptyEntityDispatchers)
+    {
+        auto it = s_entityEventDispatchers.find(entityId);
+        if (it == s_entityEventDispatchers.end()) continue;
+
+        if (!it->second.hasAnyListener(PhysicsEventType::CollisionStarted)
+            && !it->second.hasAnyListener(PhysicsEventType::CollisionEnded))
+            s_entityEventDispatchers.erase(it);
+    }
+    s_emptyEntityDispatchers.clear();
+}
+
+void Blainn::PhysicsSubsystem::DispatchEntityEvent(const uuid &entityId,
+                                                   const eastl::shared_ptr<PhysicsEvent> &physicsEvent)
+{
+    // hash map nodes are stable, so listeners added for other entities during dispatch do not invalidate it
+    auto it = s_entityEventDispatchers.find(entityId);
+    if (it == s_entityEventDispatchers.end()) return;
+
+    it->second.dispatch(physicsEvent);
 }
 
 
 PhysicsComponent &Blainn::PhysicsSubsystem::GetPhysicsComponentByBodyId(JPH::BodyID bodyId)
 {
-    assert(m_bodyEntityConnections.contains(bodyId));
-    return Engine::GetSceneManager()
-        .TryGetEntityWithUUID(m_bodyEntityConnections.at(bodyId))
-        .GetComponent<PhysicsComponent>();
+    const uuid *entityId = TryGetEntityIdByBodyId(bodyId);
+    assert(entityId);
+    return Engine::GetSceneManager().TryGetEntityWithUUID(*entityId).GetComponent<PhysicsComponent>();
 }
 
 bool PhysicsSubsystem::IsBodyActive(Entity entity)
@@ -6,38 +6,306 @@
 
 #include "Engine.h"
 #include "components/PrefabComponent.h"
+#include "file-system/FileSystemObject.h"
+#include "scene/Scene.h"
+#include "tools/ComponentRegistry.h"
+
+#include <chrono>
 
 namespace Blainn
 {
+namespace
+{
+using ComponentDelta = PrefabTemplate::ComponentDelta;
+
+eastl::string MakeKey(const Path &relativePath)
+{
+    return ToEASTLString(relativePath.lexically_normal().generic_string());
+}
+
+// fields of an instance root that the prefab doesn't drive: its placement and what the user overrode
+bool IsOverridden(Entity root, entt::id_type typeId, const eastl::string &field)
+{
+    if (typeId == entt::type_hash<TransformComponent>::value() && (field == "Translation" || field == "Rotation"))
+        return true;
+
+    const PrefabComponent *prefab = root.TryGetComponent<PrefabComponent>();
+    if (!prefab) return false;
+
+    auto it = prefab->Overrides.find(typeId);
+    if (it == prefab->Overrides.end()) return false;
+
+    return eastl::any_of(it->second.begin(), it->second.end(),
+                         [&field](const PrefabOverride &entry) { return entry.Path == field; });
+}
+
+// instance entities in template node order, false if the user changed the hierarchy of the instance
+bool MatchInstance(const eastl::vector<eastl::vector<uint32_t>> &templateChildren, Entity root,
+                   eastl::vector<Entity> &outEntities)
+{
+    outEntities.assign(templateChildren.size(), Entity{});
+    outEntities[0] = root;
+
+    eastl::vector<uint32_t> stack = {0u};
+    while (!stack.empty())
+    {
+        const uint32_t nodeIndex = stack.back();
+        stack.pop_back();
+
+        const auto &children = outEntities[nodeIndex].Children();
+        const auto &childNodes = templateChildren[nodeIndex];
+        if (children.size() != childNodes.size()) return false;
+
+        for (size_t i = 0; i < childNodes.size(); ++i)
+        {
+            Entity child = Engine::GetSceneManager().TryGetEntityWithUUID(children[i]);
+            if (!child) return false;
+
+            outEntities[childNodes[i]] = child;
+            stack.push_back(childNodes[i]);
+        }
+    }
+    return true;
+}
+
+// the instance keeps its values for overridden fields and takes the prefab's for the rest
+void MergeFields(Entity entity, entt::id_type typeId, const ComponentMeta &meta, const YAML::Node &source,
+                 const eastl::vector<eastl::string> &fields)
+{
+    YAML::Emitter out;
+    out << YAML::BeginMap;
+    meta.serializer(entity, out);
+    out << YAML::EndMap;
+
+    YAML::Node merged = YAML::Load(out.c_str());
+    YAML::Node component = merged[meta.name.c_str()];
+    const YAML::Node prefabComponent = source[meta.name.c_str()];
+    for (const eastl::string &field : fields)
+    {
+        if (prefabComponent[field.c_str()])
+            component[field.c_str()] = YAML::Clone(prefabComponent[field.c_str()]);
+        else
+            component.remove(field.c_str());
+    }
+
+    if (meta.assignTemplate)
+    {
+        entt::registry scratch;
+        const entt::entity value = scratch.create();
+        meta.decodeTemplate(scratch, value, merged);
+        meta.assignTemplate(scratch, value, &entity, 1u);
+        return;
+    }
+
+    Scene::DestroyComponent(entity, typeId);
+    meta.deserializer(entity, merged);
+}
+
+void ApplyDelta(const PrefabTemplate &prefab, const ComponentDelta &delta, const eastl::vector<Entity> &instances)
+{
+    const auto &[typeId, meta] = g_componentRegistry[delta.Component];
+    const PrefabTemplate::Node &node = prefab.GetNodes()[delta.Node];
+    // only instance roots carry overrides
+    const bool isRoot = delta.Node == 0u;
+
+    if (delta.Kind == ComponentDelta::Change::Removed)
+    {
+        for (Entity entity : instances)
+            Scene::DestroyComponent(entity, typeId);
+        return;
+    }
+
+    if (typeId == entt::type_hash<TagComponent>::value())
+    {
+        for (Entity entity : instances)
+            if (!isRoot || !IsOverridden(entity, typeId, "Tag"))
+                entity.GetComponent<TagComponent>().Tag = node.Tag.empty() ? "Untagged" : node.Tag;
+        return;
+    }
+
+    // instances that take the prefab component whole are updated together
+    eastl::vector<Entity> assigned;
+    eastl::vector<Entity> added;
+    eastl::vector<eastl::string> fields;
+    for (Entity entity : instances)
+    {
+        if (!entity.HasComponent(typeId))
+        {
+            added.push_back(entity);
+            continue;
+        }
+
+        fields.clear();
+        if (isRoot)
+        {
+            for (const eastl::string &field : delta.Fields)
+                if (!IsOverridden(entity, typeId, field)) fields.push_back(field);
+        }
+
+        if (!isRoot || fields.size() == delta.Fields.size())
+            assigned.push_back(entity);
+        else if (!fields.empty())
+            MergeFields(entity, typeId, meta, node.Source, fields);
+    }
+
+    if (meta.assignTemplate)
+    {
+        meta.assignTemplate(prefab.GetComponents(), node.Prototype, assigned.data(), assigned.size());
+        meta.instantiateTemplate(prefab.GetComponents(), node.Prototype, added.data(), added.size());
+        return;
+    }
+
+    for (Entity entity : assigned)
+    {
+        Scene::DestroyComponent(entity, typeId);
+        meta.deserializer(entity, node.Source);
+    }
+    for (Entity entity : added)
+        meta.deserializer(entity, node.Source);
+}
+} // namespace
+
+
+PrefabSubsystem &PrefabSubsystem::GetInstance()
+{
+    static PrefabSubsystem instance;
+    return instance;
+}
+
+
+void PrefabSubsystem::Destroy()
+{
+    m_templates.clear();
+}
+
+
 void PrefabSubsystem::UpdatePrefabRefs(const Path &relativePath)
 {
-    // TODO: Get prefab from relative path
-    Path absolutePath = Engine::GetContentDirectory() / relativePath;
-    YAML::Node prefab = YAML::LoadFile(absolutePath.string());
+    BLAINN_PROFILE_FUNC();
+    using Clock = std::chrono::steady_clock;
+    const auto start = Clock::now();
+
+    // the version instances were made from, the diff against it is all that gets applied
+    const eastl::string key = MakeKey(relativePath);
+    eastl::unique_ptr<PrefabTemplate> previous;
+    if (auto it = m_templates.find(key); it != m_templates.end())
+    {
+        previous = eastl::move(it->second.Template);
+        m_templates.erase(it);
+    }
+
+    const PrefabTemplate *prefab = GetTemplate(relativePath);
+    if (!prefab) return;
 
+    eastl::vector<ComponentDelta> deltas;
+    if (!PrefabTemplate::Diff(previous.get(), *prefab, deltas))
+    {
+        BF_WARN("Prefab {0}: hierarchy changed, reopen the scenes to update its instances", relativePath.string());
+        return;
+    }
+    if (deltas.empty()) return;
+
+    const auto &nodes = prefab->GetNodes();
+    eastl::vector<eastl::vector<uint32_t>> templateChildren(nodes.size());
+    for (uint32_t i = 0; i < static_cast<uint32_t>(nodes.size()); ++i)
+        if (nodes[i].Parent != PrefabTemplate::kNoParent) templateChildren[nodes[i].Parent].push_back(i);
+
+    // every instance of a node across the open scenes, so a delta is applied to all of them at once
+    eastl::vector<eastl::vector<Entity>> nodeInstances(nodes.size());
+    eastl::vector<Entity> matched;
+    uint32_t instanceCount = 0u;
+    uint32_t skippedCount = 0u;
     for (auto &scene : Engine::GetSceneManager().GetActiveScenes())
     {
-        const auto &view = scene->GetAllEntitiesWith<IDComponent, PrefabComponent>();
-        for (const auto &[entity, id, prefabComponent] : view.each())
+        for (auto [entity, prefabComponent] : scene->GetAllEntitiesWith<PrefabComponent>().each())
         {
-            if (prefabComponent.Path == relativePath)
+            if (MakeKey(prefabComponent.Path) != key) continue;
+
+            if (!MatchInstance(templateChildren, Entity{entity, scene.get()}, matched))
             {
-                // TODO: change all components
+                ++skippedCount;
+                continue;
             }
+
+            for (size_t i = 0; i < matched.size(); ++i)
+                if (matched[i]) nodeInstances[i].push_back(matched[i]);
+            ++instanceCount;
         }
     }
+
+    for (const ComponentDelta &delta : deltas)
+        ApplyDelta(*prefab, delta, nodeInstances[delta.Node]);
+
+    if (skippedCount > 0u)
+        BF_WARN("Prefab {0}: {1} instances have a different hierarchy and were not updated", relativePath.string(),
+                skippedCount);
+    BF_INFO("Prefab {0}: {1} changes applied to {2} instances in {3:.2f} ms", relativePath.string(), deltas.size(),
+            instanceCount, std::chrono::duration<double, std::milli>(Clock::now() - start).count());
 }
 
 
-Entity PrefabSubsystem::CreateEntityFromPrefab(const Path &relativePath, const Scene &scene, const Vec3 &position,
+const PrefabTemplate *PrefabSubsystem::GetTemplate(const Path &relativePath)
+{
+    const Path absolutePath = Engine::GetContentDirectory() / relativePath;
+    int64_t writeTime = 0;
+    uint64_t size = 0u;
+    if (!FileSystemObject::GetFileStamp(absolutePath, writeTime, size))
+    {
+        BF_ERROR("Prefab {0} not found", relativePath.string());
+        return nullptr;
+    }
+
+    CachedTemplate &cached = m_templates[MakeKey(relativePath)];
+    if (cached.Template && cached.WriteTime == writeTime && cached.Size == size) return cached.Template.get();
+
+    BLAINN_PROFILE_SCOPE_DYNAMIC("PrefabSubsystem parse prefab");
+    auto prefab = eastl::make_unique<PrefabTemplate>();
+    try
+    {
+        if (!prefab->Build(YAML::LoadFile(absolutePath.string()))) prefab.reset();
+    }
+    catch (const YAML::Exception &e)
+    {
+        BF_ERROR("Failed to parse prefab {0}: {1}", relativePath.string(), e.what());
+        prefab.reset();
+    }
+
+    cached.Template = eastl::move(prefab);
+    cached.WriteTime = writeTime;
+    cached.Size = size;
+    return cached.Template.get();
+}
+
+
+Entity PrefabSubsystem::CreateEntityFromPrefab(const Path &relativePath, Scene &scene, const Vec3 &position,
                                                const Quat &rotation, const Vec3 &scale)
 {
-    (void)relativePath;
-    (void)scene;
-    (void)position;
-    (void)rotation;
-    (void)scale;
-    assert(false && "Not implemented");
-    return {};
+    eastl::vector<Entity> roots;
+    CreateEntitiesFromPrefab(relativePath, scene, {Placement{position, rotation, scale}}, roots);
+    return roots.empty() ? Entity{} : roots.front();
+}
+
+
+void PrefabSubsystem::CreateEntitiesFromPrefab(const Path &relativePath, Scene &scene,
+                                               const eastl::vector<Placement> &placements,
+                                               eastl::vector<Entity> &outRoots)
+{
+    BLAINN_PROFILE_FUNC();
+
+    outRoots.clear();
+    const PrefabTemplate *prefab = GetTemplate(relativePath);
+    if (!prefab) return;
+
+    scene.CreatePrefabEntities(*prefab, placements.size(), outRoots);
+
+    for (size_t i = 0; i < outRoots.size(); ++i)
+    {
+        TransformComponent *transform = outRoots[i].TryGetComponent<TransformComponent>();
+        if (!transform) transform = &outRoots[i].AddComponent<TransformComponent>();
+
+        transform->SetTranslation(placements[i].Position);
+        transform->SetRotation(placements[i].Rotation);
+        transform->SetScale(placements[i].Scale);
+    }
 }
-} // namespace Blainn
+} // namespace Blainn
\ No newline at end of file
@@ -41,7 +41,14 @@
 #include "Components/MeshComponent.h"
 #include "scene/Entity.h"
 
+#pragma warning(push)
+#pragma warning(disable : 4100)
+#include "VGJS.h"
+#pragma warning(pop)
+
+#include <atomic>
 #include <cassert>
+#include <latch>
 
 namespace Blainn
 {
@@ -173,13 +180,20 @@ void Blainn::RenderSubsystem::Render(float deltaTime)
     {
         commandQueue->WaitForFenceValue(m_currFrameResource->Fence);
     }
+    // GPU is done with this frame resource, its per draw data can be overwritten
+    m_currFrameResource->FrameUploadBuffer->Reset();
+    m_textureViews.CopyChangedViews(m_currFrameResourceIndex);
 
     UpdateObjectsCB(deltaTime);
     UpdateLightsBuffers(deltaTime);
+    UpdateLightClusters();
     UpdateMaterialBuffer(deltaTime);
 
     UpdateShadowTransform(deltaTime);
     UpdateShadowPassCB(deltaTime); // pass
+    CullRenderables();
+    RequestTextureMips();
+    BuildDrawLists();
 
     UpdateGeometryPassCB(deltaTime); // pass
     UpdateDeferredPassCB(deltaTime); // pass
@@ -187,21 +201,15 @@ void Blainn::RenderSubsystem::Render(float deltaTime)
 #pragma endregion UpdateStage
 
 #pragma region RenderStage
-    // Get the current frame resource command allocator
-    // Command list allocators can only be reset when the associated command lists have finished execution on the GPU;
-    // apps should use fences to determine GPU execution progress.
-    auto currCmdAlloc = m_currFrameResource->commandAllocator.Get();
-    currCmdAlloc->Reset();
-#if defined(DEBUG) || defined(_DEBUG)
-    wchar_t name[32] = {};
-    UINT size = sizeof(name);
-    currCmdAlloc->GetPrivateData(WKPDID_D3DDebugObjectNameW, &size, name);
-#endif
+    // Command list allocators can only be reset when the associated command lists have finished execution on the GPU,
+    // the fence wait above guarantees that for all allocators of the current frame resource.
+    const uint32_t commandListCount = RecordCommandLists();
 
-    auto commandList = commandQueue->GetCommandList(currCmdAlloc);
-    PopulateCommandList(commandList.Get());
+    ID3D12CommandList *ppCommandLists[FrameCommandListCount] = {};
+    for (uint32_t i = 0; i < commandListCount; i++)
+        ppCommandLists[i] = m_currFrameResource->CommandLists[i].Get();
 
-    commandQueue->ExecuteCommandList(commandList);
+    commandQueue->ExecuteCommandLists(ppCommandLists, commandListCount);
     Present();
 
     m_currFrameResource->Fence =
@@ -294,17 +302,100 @@ uuid RenderSubsystem::GetUUIDAt(uint32_t x, uint32_t y)
     return id;
 }
 
-void Blainn::RenderSubsystem::PopulateCommandList(ID3D12GraphicsCommandList2 *pCommandList)
+namespace Blainn
+{
+// shared with the scheduled jobs, which may start after the frame has been recorded by other threads
+struct PassRecordingState
+{
+    explicit PassRecordingState(uint32_t jobCount)
+        : JobCount(jobCount)
+        , JobsDone(jobCount)
+    {
+    }
+
+    const uint32_t JobCount;
+    std::atomic<uint32_t> NextJob{0u};
+    std::latch JobsDone;
+};
+} // namespace Blainn
+
+uint32_t Blainn::RenderSubsystem::RecordCommandLists()
+{
+    BLAINN_PROFILE_FUNC();
+    const uint32_t jobCount = static_cast<uint32_t>(m_recordingJobs.size());
+    assert(jobCount < FrameCommandListCount && "one command list is reserved for the main thread");
+
+    auto state = eastl::make_shared<PassRecordingState>(jobCount);
+    // the main thread takes jobs too once its own list is recorded, so it never waits on a busy pool
+    for (uint32_t i = 1u; i < jobCount; i++)
+    {
+        vgjs::schedule([this, state]() { RecordPassJobs(*state); });
+    }
+
+    auto *pCommandAllocator = m_currFrameResource->CommandAllocators[jobCount].Get();
+    auto *pCommandList = m_currFrameResource->CommandLists[jobCount].Get();
+    ThrowIfFailed(pCommandAllocator->Reset());
+    ThrowIfFailed(pCommandList->Reset(pCommandAllocator, nullptr));
+    PopulateCommandList(pCommandList);
+    ThrowIfFailed(pCommandList->Close());
+
+    RecordPassJobs(*state);
+    state->JobsDone.wait();
+
+    return jobCount + 1u;
+}
+
+void Blainn::RenderSubsystem::RecordPassJobs(PassRecordingState &state)
+{
+    for (uint32_t jobIndex = state.NextJob.fetch_add(1u); jobIndex < state.JobCount;
+         jobIndex = state.NextJob.fetch_add(1u))
+    {
+        RecordPassJob(jobIndex);
+        state.JobsDone.count_down();
+    }
+}
+
+void Blainn::RenderSubsystem::RecordPassJob(uint32_t jobIndex)
 {
     BLAINN_PROFILE_FUNC();
+    const auto &job = m_recordingJobs[jobIndex];
+    auto *pCommandAllocator = m_currFrameResource->CommandAllocators[jobIndex].Get();
+    auto *pCommandList = m_currFrameResource->CommandLists[jobIndex].Get();
+
+    ThrowIfFailed(pCommandAllocator->Reset());
+    ThrowIfFailed(pCommandList->Reset(pCommandAllocator, nullptr));
+    BeginCommandList(pCommandList);
+
+    switch (job.Pass)
+    {
+    case EPassType::DepthShadow:
+        RenderDepthOnlyPass(pCommandList, job);
+        break;
+    case EPassType::DeferredGeometry:
+        RenderGeometryPass(pCommandList, job);
+        break;
+    default:
+        assert(false && "pass is not recorded by jobs");
+        break;
+    }
+
+    ThrowIfFailed(pCommandList->Close());
+}
+
+void Blainn::RenderSubsystem::BeginCommandList(ID3D12GraphicsCommandList2 *pCommandList)
+{
     pCommandList->SetGraphicsRootSignature(m_rootSignature->Get());
 
     // Access for setting and using root descriptor table
     ID3D12DescriptorHeap *descriptorHeaps[] = {m_device.GetDescriptorHeap().Get()};
     pCommandList->SetDescriptorHeaps(_countof(descriptorHeaps), descriptorHeaps);
+}
+
+void Blainn::RenderSubsystem::PopulateCommandList(ID3D12GraphicsCommandList2 *pCommandList)
+{
+    BLAINN_PROFILE_FUNC();
+    BeginCommandList(pCommandList);
 
-    RenderDepthOnlyPass(pCommandList);
-    RenderGeometryPass(pCommandList);
     RenderLightingPass(pCommandList);
     RenderForwardPasses(pCommandList);
 
@@ -352,6 +443,11 @@ VOID Blainn::RenderSubsystem::CreateDescriptorHeaps()
     m_rtvDescriptorSize = m_device.GetDescriptorHandleIncrementSize(D3D12_DESCRIPTOR_HEAP_TYPE_RTV);
     m_dsvDescriptorSize = m_device.GetDescriptorHandleIncrementSize(D3D12_DESCRIPTOR_HEAP_TYPE_DSV);
     m_cbvSrvUavDescriptorSize = m_device.GetDescriptorHandleIncrementSize();
+
+    // created before the assets load so textures have somewhere to write their views, the tables of all frame
+    // resources have to end before the hardcoded views from 2100 on
+    m_textureViews.Init(m_device.GetDevice2().Get(), m_srvHeap.Get(), TextureSrvHeapStartIndex, MAX_TEXTURES,
+                        gNumFrameResources);
 }
 
 VOID Blainn::RenderSubsystem::Reset()
@@ -512,7 +608,8 @@ void Blainn::RenderSubsystem::CreateFrameResources()
     for (int i = 0; i < gNumFrameResources; i++)
     {
         m_frameResources.push_back(eastl::make_unique<FrameResource>(m_device, static_cast<UINT>(EPassType::NumPasses),
-                                                                     MAX_MATERIALS, MaxPointLights, MaxSpotLights));
+                                                                     MAX_MATERIALS, MaxPointLights, MaxSpotLights,
+                                                                     FrameUploadBufferSize, FrameCommandListCount));
     }
 }
 
@@ -598,6 +695,7 @@ void Blainn::RenderSubsystem::LoadSrvAndSamplerDescriptorHeaps()
         localHandle.Offset(1, m_cbvSrvUavDescriptorSize);
     }
     m_texturesSrvHeapStartIndex = m_skyCubeSrvHeapStartIndex + 1;
+    assert(m_texturesSrvHeapStartIndex == TextureSrvHeapStartIndex);
 }
 
 void Blainn::RenderSubsystem::CreateRootSignature()
@@ -623,8 +721,8 @@ void Blainn::RenderSubsystem::CreateRootSignature()
     CD3DX12_ROOT_PARAMETER slotRootParameter[RootSignature::ERootParam::NumRootParameters];
 
     // Perfomance TIP: Order from most frequent to least frequent.
-    slotRootParameter[RootSignature::ERootParam::PerObjectDataCB].InitAsConstantBufferView(
-        SHADER_REGISTER(0u), REGISTER_SPACE_0, D3D12_SHADER_VISIBILITY_ALL);
+    slotRootParameter[RootSignature::ERootParam::PerObjectDataSB].InitAsShaderResourceView(
+        SHADER_REGISTER(3u), REGISTER_SPACE_0, D3D12_SHADER_VISIBILITY_ALL);
     slotRootParameter[RootSignature::ERootParam::PerPassDataCB].InitAsConstantBufferView(
         SHADER_REGISTER(1u), REGISTER_SPACE_0, D3D12_SHADER_VISIBILITY_ALL);
 
@@ -634,6 +732,10 @@ void Blainn::RenderSubsystem::CreateRootSignature()
         SHADER_REGISTER(1u), REGISTER_SPACE_0, D3D12_SHADER_VISIBILITY_ALL);
     slotRootParameter[RootSignature::ERootParam::SpotLightsDataSB].InitAsShaderResourceView(
         SHADER_REGISTER(2u), REGISTER_SPACE_0, D3D12_SHADER_VISIBILITY_ALL);
+    slotRootParameter[RootSignature::ERootParam::ClusterGridSB].InitAsShaderResourceView(
+        SHADER_REGISTER(4u), REGISTER_SPACE_0, D3D12_SHADER_VISIBILITY_PIXEL);
+    slotRootParameter[RootSignature::ERootParam::ClusterLightIndicesSB].InitAsShaderResourceView(
+        SHADER_REGISTER(5u), REGISTER_SPACE_0, D3D12_SHADER_VISIBILITY_PIXEL);
 
     slotRootParameter[RootSignature::ERootParam::CascadedShadowMaps].InitAsDescriptorTable(
         1u, &cascadeShadowSrv, D3D12_SHADER_VISIBILITY_PIXEL);
@@ -665,6 +767,14 @@ void Blainn::RenderSubsystem::CreateShaders()
 
     const D3D_SHADER_MACRO shadowDebugDefines[] = {"SHADOW_DEBUG", "1", NULL, NULL};
 
+    const D3D_SHADER_MACRO compactVertexDefines[] = {"COMPACT_VERTEX", "1", NULL, NULL};
+
+#if UseCompactVertexFormat
+    const D3D_SHADER_MACRO *meshVertexDefines = compactVertexDefines;
+#else
+    const D3D_SHADER_MACRO *meshVertexDefines = nullptr;
+#endif
+
     m_shaders[Shader::EShaderType::CascadedShadowsVS] =
         FreyaUtil::CompileShader(L"./Content/Shaders/ShadowVS.hlsl", nullptr, "main", "vs_5_1");
     m_shaders[Shader::EShaderType::CascadedShadowsGS] =
@@ -672,7 +782,7 @@ void Blainn::RenderSubsystem::CreateShaders()
 
 #pragma region DeferredShading
     m_shaders[Shader::EShaderType::DeferredGeometryVS] =
-        FreyaUtil::CompileShader(L"./Content/Shaders/GBufferPassVS.hlsl", nullptr, "main", "vs_5_1");
+        FreyaUtil::CompileShader(L"./Content/Shaders/GBufferPassVS.hlsl", meshVertexDefines, "main", "vs_5_1");
     m_shaders[Shader::EShaderType::DeferredGeometryPS] =
         FreyaUtil::CompileShader(L"./Content/Shaders/GBufferPassPS.hlsl", nullptr, "main", "ps_5_1");
 
@@ -681,14 +791,9 @@ void Blainn::RenderSubsystem::CreateShaders()
     m_shaders[Shader::EShaderType::DeferredDirPS] =
         FreyaUtil::CompileShader(L"./Content/Shaders/DeferredDirectionalLightPS.hlsl", nullptr, "main", "ps_5_1");
 
-    m_shaders[Shader::EShaderType::DeferredPointVS] =
-        FreyaUtil::CompileShader(L"./Content/Shaders/DeferredLightVolumesVS.hlsl", nullptr, "PointLightVS", "vs_5_1");
-    m_shaders[Shader::EShaderType::DeferredPointPS] =
-        FreyaUtil::CompileShader(L"./Content/Shaders/DeferredLightVolumesPS.hlsl", nullptr, "PointLightPS", "ps_5_1");
-    m_shaders[Shader::EShaderType::DeferredSpotVS] =
-        FreyaUtil::CompileShader(L"./Content/Shaders/DeferredLightVolumesVS.hlsl", nullptr, "SpotLightVS", "vs_5_1");
-    m_shaders[Shader::EShaderType::DeferredSpotPS] =
-        FreyaUtil::CompileShader(L"./Content/Shaders/DeferredLightVolumesPS.hlsl", nullptr, "SpotLightPS", "ps_5_1");
+    // fullscreen, shares DeferredDirVS
+    m_shaders[Shader::EShaderType::DeferredClusteredLightsPS] =
+        FreyaUtil::CompileShader(L"./Content/Shaders/DeferredClusteredLightsPS.hlsl", nullptr, "main", "ps_5_1");
 #pragma endregion DeferredShading
 
 #pragma region ForwardShading
@@ -719,7 +824,11 @@ void Blainn::RenderSubsystem::CreatePipelineStateObjects()
     defaultPsoDesc.RasterizerState = CD3DX12_RASTERIZER_DESC(D3D12_DEFAULT);
 
     defaultPsoDesc.DepthStencilState = CD3DX12_DEPTH_STENCIL_DESC(D3D12_DEFAULT);
+#if UseCompactVertexFormat
+    defaultPsoDesc.InputLayout = BlainnCompactVertex::InputLayout;
+#else
     defaultPsoDesc.InputLayout = BlainnVertex::InputLayout;
+#endif
     defaultPsoDesc.PrimitiveTopologyType = D3D12_PRIMITIVE_TOPOLOGY_TYPE_TRIANGLE;
     defaultPsoDesc.NumRenderTargets = 1u;
     defaultPsoDesc.RTVFormats[0] = BackBufferFormat;
@@ -788,11 +897,10 @@ void Blainn::RenderSubsystem::CreatePipelineStateObjects()
         dirLightPsoDesc, m_pipelineStates[PipelineStateObject::EPsoType::DeferredDirectional]));
 #pragma endregion DeferredDirectionalLight
 
-#pragma region DeferredPointLight
-    // Still needs to be configured
-    // Hack with DSS and RS
-    D3D12_GRAPHICS_PIPELINE_STATE_DESC pointLightIntersectsFarPlanePsoDesc = dirLightPsoDesc;
+#pragma region DeferredClusteredLights
+    D3D12_GRAPHICS_PIPELINE_STATE_DESC clusteredLightsPsoDesc = dirLightPsoDesc;
 
+    // lights are added on top of the directional light
     D3D12_RENDER_TARGET_BLEND_DESC RTBlendDesc = {};
     ZeroMemory(&RTBlendDesc, sizeof(D3D12_RENDER_TARGET_BLEND_DESC));
     RTBlendDesc.BlendEnable = TRUE;
@@ -806,58 +914,19 @@ void Blainn::RenderSubsystem::CreatePipelineStateObjects()
     RTBlendDesc.LogicOp = D3D12_LOGIC_OP_NOOP;
     RTBlendDesc.RenderTargetWriteMask = D3D12_COLOR_WRITE_ENABLE_ALL;
 
-    pointLightIntersectsFarPlanePsoDesc.VS = D3D12_SHADER_BYTECODE(
-        {reinterpret_cast<BYTE *>(m_shaders.at(Shader::EShaderType::DeferredPointVS)->GetBufferPointer()),
-         m_shaders.at(Shader::EShaderType::DeferredPointVS)->GetBufferSize()});
-    pointLightIntersectsFarPlanePsoDesc.PS = D3D12_SHADER_BYTECODE(
-        {reinterpret_cast<BYTE *>(m_shaders.at(Shader::EShaderType::DeferredPointPS)->GetBufferPointer()),
-         m_shaders.at(Shader::EShaderType::DeferredPointPS)->GetBufferSize()});
-    pointLightIntersectsFarPlanePsoDesc.BlendState.AlphaToCoverageEnable = FALSE;
-    pointLightIntersectsFarPlanePsoDesc.BlendState.IndependentBlendEnable = FALSE;
-    pointLightIntersectsFarPlanePsoDesc.BlendState.RenderTarget[0] = RTBlendDesc;
-
-    pointLightIntersectsFarPlanePsoDesc.RasterizerState.CullMode = D3D12_CULL_MODE_BACK;
-    pointLightIntersectsFarPlanePsoDesc.DepthStencilState.DepthEnable = FALSE;
-    pointLightIntersectsFarPlanePsoDesc.DepthStencilState.DepthWriteMask = D3D12_DEPTH_WRITE_MASK_ZERO;
-    pointLightIntersectsFarPlanePsoDesc.DepthStencilState.DepthFunc = D3D12_COMPARISON_FUNC_LESS_EQUAL;
-    pointLightIntersectsFarPlanePsoDesc.DepthStencilState.StencilEnable = FALSE;
-    pointLightIntersectsFarPlanePsoDesc.DepthStencilState.StencilReadMask = 0xFF;
-    pointLightIntersectsFarPlanePsoDesc.DepthStencilState.StencilWriteMask = 0xFF;
-    ThrowIfFailed(m_device.CreateGraphicsPipelineState(
-        pointLightIntersectsFarPlanePsoDesc,
-        m_pipelineStates[PipelineStateObject::EPsoType::DeferredPointIntersectsFarPlane]));
+    clusteredLightsPsoDesc.PS = D3D12_SHADER_BYTECODE(
+        {reinterpret_cast<BYTE *>(m_shaders.at(Shader::EShaderType::DeferredClusteredLightsPS)->GetBufferPointer()),
+         m_shaders.at(Shader::EShaderType::DeferredClusteredLightsPS)->GetBufferSize()});
+    clusteredLightsPsoDesc.BlendState.AlphaToCoverageEnable = FALSE;
+    clusteredLightsPsoDesc.BlendState.IndependentBlendEnable = FALSE;
+    clusteredLightsPsoDesc.BlendState.RenderTarget[0] = RTBlendDesc;
 
-    D3D12_GRAPHICS_PIPELINE_STATE_DESC pointLightWithinFrustumPsoDesc = pointLightIntersectsFarPlanePsoDesc;
-    pointLightWithinFrustumPsoDesc.RasterizerState.CullMode = D3D12_CULL_MODE_FRONT;
-    pointLightWithinFrustumPsoDesc.DepthStencilState.DepthFunc = D3D12_COMPARISON_FUNC_GREATER;
+    clusteredLightsPsoDesc.DepthStencilState.DepthEnable = FALSE;
+    clusteredLightsPsoDesc.DepthStencilState.DepthWriteMask = D3D12_DEPTH_WRITE_MASK_ZERO;
+    clusteredLightsPsoDesc.DepthStencilState.StencilEnable = FALSE;
     ThrowIfFailed(m_device.CreateGraphicsPipelineState(
-        pointLightWithinFrustumPsoDesc, m_pipelineStates[PipelineStateObject::EPsoType::DeferredPointWithinFrustum]));
-
-    // pointLightFullQuadPsoDesc
-
-#pragma endregion DeferredPointLight
-
-#pragma region DeferredSpotLight
-    D3D12_GRAPHICS_PIPELINE_STATE_DESC spotLightIntersectsFarPlanePsoDesc = pointLightIntersectsFarPlanePsoDesc;
-    spotLightIntersectsFarPlanePsoDesc.VS = D3D12_SHADER_BYTECODE(
-        {reinterpret_cast<BYTE *>(m_shaders.at(Shader::EShaderType::DeferredSpotVS)->GetBufferPointer()),
-         m_shaders.at(Shader::EShaderType::DeferredSpotVS)->GetBufferSize()});
-    spotLightIntersectsFarPlanePsoDesc.PS = D3D12_SHADER_BYTECODE(
-        {reinterpret_cast<BYTE *>(m_shaders.at(Shader::EShaderType::DeferredSpotPS)->GetBufferPointer()),
-         m_shaders.at(Shader::EShaderType::DeferredSpotPS)->GetBufferSize()});
-    ThrowIfFailed(m_device.CreateGraphicsPipelineState(
-        spotLightIntersectsFarPlanePsoDesc,
-        m_pipelineStates[PipelineStateObject::EPsoType::DeferredSpotIntersectsFarPlane]));
-
-    D3D12_GRAPHICS_PIPELINE_STATE_DESC spotLightWithinFrustumPsoDesc = spotLightIntersectsFarPlanePsoDesc;
-    spotLightWithinFrustumPsoDesc.RasterizerState.CullMode = D3D12_CULL_MODE_FRONT;
-    spotLightWithinFrustumPsoDesc.DepthStencilState.DepthFunc = D3D12_COMPARISON_FUNC_GREATER;
-    ThrowIfFailed(m_device.CreateGraphicsPipelineState(
-        spotLightWithinFrustumPsoDesc, m_pipelineStates[PipelineStateObject::EPsoType::DeferredSpotWithinFrustum]));
-
-    // spotLightFullQuadPsoDesc
-
-#pragma endregion DeferredSpotLight
+        clusteredLightsPsoDesc, m_pipelineStates[PipelineStateObject::EPsoType::DeferredClusteredLights]));
+#pragma endregion DeferredClusteredLights
 #pragma endregion DeferredShading
 
 #pragma region Sky
@@ -960,6 +1029,12 @@ void Blainn::RenderSubsystem::UpdateObjectsCB(float deltaTime)
 {
     (void)deltaTime;
     BLAINN_PROFILE_FUNC();
+    // pixels covered by one world unit at distance 1
+    const float projectionScale = static_cast<float>(m_height) / (2.0f * tanf(0.5f * m_camera->GetFovYRad()));
+    const Vec3 cameraPosition = m_camera->GetPosition3f();
+
+    m_renderables.clear();
+    m_culler.Clear();
 
     for (auto &scene : Engine::GetSceneManager().GetActiveScenes())
     {
@@ -970,7 +1045,10 @@ void Blainn::RenderSubsystem::UpdateObjectsCB(float deltaTime)
             const auto &_entity = Engine::GetSceneManager().TryGetEntityWithUUID(entityID.ID);
             if (!_entity.IsValid()) continue;
 
-            if (entityTransform.IsFramesDirty() || entityMesh.MaterialHandle->GetMaterial().IsFramesDirty())
+            const Model &model = entityMesh.MeshHandle.GetMesh();
+            bool worldChanged = false;
+            // parents are walked too, moving a parent does not mark its children dirty
+            if (Engine::GetSceneManager().IsWorldSpaceTransformFramesDirty(_entity) || entityMesh.BoundsModel != &model)
             {
                 ObjectConstants objConstants;
 
@@ -981,20 +1059,193 @@ void Blainn::RenderSubsystem::UpdateObjectsCB(float deltaTime)
                 XMStoreFloat4x4(&objConstants.World, transposeWorld);
                 XMStoreFloat4x4(&objConstants.InvTransposeWorld, XMMatrixTranspose(invTransposeWorld));
                 XMStoreFloat4x4(&objConstants.TexTransform,
-                                XMMatrixTranspose(entityMesh.MeshHandle->GetMesh().GetTextureTransform()));
-                objConstants.MaterialIndex = entityMesh.MaterialHandle->GetIndex();
+                                XMMatrixTranspose(model.GetTextureTransform()));
 
-                entityMesh.UpdateMeshCB(objConstants);
+                entityMesh.PerObjectCBData = objConstants;
                 entityTransform.FrameResetDirtyFlags();
+                worldChanged = true;
             }
+
+            if (worldChanged) UpdateMeshBounds(entityMesh);
+            // material dirty flags only track material buffer uploads, the handle itself can be swapped any frame
+            entityMesh.PerObjectCBData.MaterialIndex = entityMesh.MaterialHandle.GetIndex();
+
+            if (!entityMesh.Enabled) continue;
+
+            entityMesh.LOD = SelectMeshLOD(entityMesh, cameraPosition, projectionScale);
+
+            const auto &sphere = entityMesh.WorldBoundingSphere;
+            m_culler.AddSphere(sphere.Center.x, sphere.Center.y, sphere.Center.z, sphere.Radius);
+            m_renderables.push_back(&entityMesh);
         }
     }
 }
 
+void RenderSubsystem::UpdateMeshBounds(MeshComponent &mesh) const
+{
+    const auto &model = mesh.MeshHandle.GetMesh();
+    const XMMATRIX world = XMMatrixTranspose(XMLoadFloat4x4(&mesh.PerObjectCBData.World));
+
+    model.GetBounds().Transform(mesh.WorldBoundingBox, world);
+    // tighter than a sphere around the transformed box
+    BoundingSphere localSphere;
+    BoundingSphere::CreateFromBoundingBox(localSphere, model.GetBounds());
+    localSphere.Transform(mesh.WorldBoundingSphere, world);
+
+    mesh.BoundsModel = &model;
+}
+
+void RenderSubsystem::CullRenderables()
+{
+    BLAINN_PROFILE_FUNC();
+    m_cameraVisibleRenderables.clear();
+    m_shadowVisibleRenderables.clear();
+
+    XMFLOAT4X4 cameraViewProj;
+    XMStoreFloat4x4(&cameraViewProj, XMMatrixMultiply(m_camera->GetViewMatrix(),
+                                                      m_camera->GetPerspectiveProjectionMatrix()));
+    m_culler.Cull(FrustumPlanes::FromViewProjection(cameraViewProj.m), m_cameraVisibleRenderables);
+    m_culler.CullAny(m_cascadeFrustums.data(), m_cascadeFrustums.size(), m_shadowVisibleRenderables);
+}
+
+void RenderSubsystem::RequestTextureMips()
+{
+    BLAINN_PROFILE_FUNC();
+    const float projectionScale = static_cast<float>(m_height) / (2.0f * tanf(0.5f * m_camera->GetFovYRad()));
+    const Vec3 cameraPosition = m_camera->GetPosition3f();
+    auto &assetManager = AssetManager::GetInstance();
+
+    // projected diameter of the bounds, UVs are taken to span the mesh once
+    for (uint32_t renderableIndex : m_cameraVisibleRenderables)
+    {
+        const MeshComponent &entityMesh = *m_renderables[renderableIndex];
+        const auto &sphere = entityMesh.WorldBoundingSphere;
+        const float distance =
+            eastl::max(Vec3::Distance(cameraPosition, sphere.Center) - sphere.Radius, m_camera->GetNearZ());
+
+        assetManager.RequestTextureMips(entityMesh.MaterialHandle, 2.0f * sphere.Radius * projectionScale / distance);
+    }
+}
+
+void RenderSubsystem::BuildDrawLists()
+{
+    BLAINN_PROFILE_FUNC();
+    m_drawMeshIds.clear();
+    m_drawModels.clear();
+    m_recordingJobs.clear();
+
+    m_shadowInstanceData = BuildDrawList(EPassType::DepthShadow, PipelineStateObject::EPsoType::CascadedShadowsOpaque,
+                                         m_shadowVisibleRenderables, m_shadowDrawList);
+    AddPassRecordingJobs(EPassType::DepthShadow, m_shadowDrawList);
+
+    m_geometryInstanceData = BuildDrawList(EPassType::DeferredGeometry,
+                                           PipelineStateObject::EPsoType::DeferredGeometry, m_cameraVisibleRenderables,
+                                           m_geometryDrawList);
+    AddPassRecordingJobs(EPassType::DeferredGeometry, m_geometryDrawList);
+}
+
+D3D12_GPU_VIRTUAL_ADDRESS RenderSubsystem::BuildDrawList(EPassType pass, PipelineStateObject::EPsoType pipeline,
+                                                         const eastl::vector<uint32_t> &visibleRenderables,
+                                                         DrawList &drawList)
+{
+    drawList.Clear();
+    drawList.Reserve(static_cast<uint32_t>(visibleRenderables.size()));
+
+    XMFLOAT4X4 view;
+    XMStoreFloat4x4(&view, m_camera->GetViewMatrix());
+    const float farZ = m_camera->GetFarZ();
+
+    for (uint32_t renderableIndex : visibleRenderables)
+    {
+        const MeshComponent &entityMesh = *m_renderables[renderableIndex];
+        const Model *model = &entityMesh.MeshHandle.GetMesh();
+
+        auto meshIt = m_drawMeshIds.find(model);
+        if (meshIt == m_drawMeshIds.end())
+        {
+            meshIt = m_drawMeshIds.emplace(model, static_cast<uint32_t>(m_drawModels.size())).first;
+            m_drawModels.push_back(model);
+        }
+
+        // index into m_drawModels with the LOD in the low bits, LODs of one model use different index ranges
+        const uint32_t lod = eastl::min(entityMesh.LOD, 7u);
+        const uint32_t meshKey = (meshIt->second << 3u) | lod;
+
+        // front to back inside a batch, helps early z of the geometry pass
+        const auto &center = entityMesh.WorldBoundingSphere.Center;
+        const float viewDepth = center.x * view._13 + center.y * view._23 + center.z * view._33 + view._43;
+
+        // a narrower field would merge materials into one batch
+        static_assert(DrawSortKey::MaterialBits >= Handle::kIndexBits);
+        drawList.Add(DrawSortKey::Make(static_cast<uint32_t>(pass), static_cast<uint32_t>(pipeline),
+                                       entityMesh.MaterialHandle.GetIndex(), meshKey,
+                                       DrawSortKey::QuantizeDepth(viewDepth, farZ)),
+                     renderableIndex);
+    }
+
+    drawList.Sort();
+    drawList.BuildBatches();
+    if (drawList.GetItems().empty()) return 0u;
+
+    // a batch reads ItemCount entries starting at its first item
+    m_instanceScratch.clear();
+    for (const auto &item : drawList.GetItems())
+        m_instanceScratch.push_back(m_renderables[item.Index]->PerObjectCBData);
+
+    return m_currFrameResource->FrameUploadBuffer->PushStructured(m_instanceScratch.data(),
+                                                                  static_cast<uint32_t>(m_instanceScratch.size()));
+}
+
+void RenderSubsystem::AddPassRecordingJobs(EPassType pass, const DrawList &drawList)
+{
+    const uint32_t batchCount = static_cast<uint32_t>(drawList.GetBatches().size());
+    const uint32_t jobCount = eastl::clamp((batchCount + MinBatchesPerRecordingJob - 1u) / MinBatchesPerRecordingJob,
+                                           1u, MaxRecordingJobsPerPass);
+    const uint32_t batchesPerJob = (batchCount + jobCount - 1u) / jobCount;
+
+    for (uint32_t i = 0; i < jobCount; i++)
+    {
+        const uint32_t firstBatch = eastl::min(i * batchesPerJob, batchCount);
+        m_recordingJobs.push_back({pass, firstBatch, eastl::min(batchesPerJob, batchCount - firstBatch), i == 0u,
+                                   i == jobCount - 1u});
+    }
+}
+
+uint32_t RenderSubsystem::SelectMeshLOD(const MeshComponent &mesh, const Vec3 &cameraPosition,
+                                        float projectionScale) const
+{
+    const auto &model = mesh.MeshHandle.GetMesh();
+    if (model.GetLODs().size() < 2u) return 0u;
+
+    const float localRadius = Vec3(model.GetBounds().Extents).Length();
+    if (localRadius <= 0.0f) return 0u;
+
+    // LOD errors are in model space, scale them to world space and project from the closest point of the bounds
+    const auto &worldSphere = mesh.WorldBoundingSphere;
+    const float worldScale = worldSphere.Radius / localRadius;
+    const float distance =
+        eastl::max(Vec3::Distance(cameraPosition, worldSphere.Center) - worldSphere.Radius, m_camera->GetNearZ());
+
+    return model.SelectLOD(worldScale * projectionScale / distance, LODErrorThresholdPixels);
+}
+
 void RenderSubsystem::UpdateLightsBuffers(float deltaTime)
 {
     (void)deltaTime;
     BLAINN_PROFILE_FUNC();
+    m_pointLightsCount = 0u;
+    m_spotLightsCount = 0u;
+    m_pointLightBounds.clear();
+    m_spotLightBounds.clear();
+
+    const XMMATRIX view = m_camera->GetViewMatrix();
+    auto toViewSpaceBounds = [&view](const XMFLOAT3 &position, float radius)
+    {
+        XMFLOAT3 positionV;
+        XMStoreFloat3(&positionV, XMVector3TransformCoord(XMLoadFloat3(&position), view));
+        return LightBounds{positionV.x, positionV.y, positionV.z, radius};
+    };
+
 #pragma region PointLights
     auto currPointLightSB = m_currFrameResource->PointLightSB.get();
 
@@ -1007,6 +1258,7 @@ void RenderSubsystem::UpdateLightsBuffers(float deltaTime)
         {
             const auto &_entity = Engine::GetSceneManager().TryGetEntityWithUUID(entityID.ID);
             if (!_entity.IsValid()) continue;
+            if (m_pointLightsCount >= MaxPointLights) break;
 
             // if (!entityTransform.IsFramesDirty() && !entityLight.IsFramesDirty()) continue;
 
@@ -1021,6 +1273,8 @@ void RenderSubsystem::UpdateLightsBuffers(float deltaTime)
             m_perInstanceSBData.Light.Position = entityTransform.GetTranslation();
 
             currPointLightSB->CopyData(m_pointLightsCount++, m_perInstanceSBData);
+            m_pointLightBounds.push_back(
+                toViewSpaceBounds(m_perInstanceSBData.Light.Position, m_perInstanceSBData.Light.FalloffEnd));
 
             /*entityTransform.FrameResetDirtyFlags();
             entityLight.FrameResetDirtyFlags();*/
@@ -1041,6 +1295,7 @@ void RenderSubsystem::UpdateLightsBuffers(float deltaTime)
         {
             const auto &_entity = Engine::GetSceneManager().TryGetEntityWithUUID(entityID.ID);
             if (!_entity.IsValid()) continue;
+            if (m_spotLightsCount >= MaxSpotLights) break;
 
             // if (!entityTransform.IsFramesDirty() && !entityLight.IsFramesDirty()) continue;
 
@@ -1056,6 +1311,9 @@ void RenderSubsystem::UpdateLightsBuffers(float deltaTime)
             m_perInstanceSBData.Light.Position = entityTransform.GetTranslation();
 
             currSpotLightSB->CopyData(m_spotLightsCount++, m_perInstanceSBData);
+            // the cone is inside the sphere of its range, the shader cuts lights off at FalloffEnd
+            m_spotLightBounds.push_back(
+                toViewSpaceBounds(m_perInstanceSBData.Light.Position, m_perInstanceSBData.Light.FalloffEnd));
 
             /*entityTransform.FrameResetDirtyFlags();
             entityLight.FrameResetDirtyFlags();*/
@@ -1064,6 +1322,35 @@ void RenderSubsystem::UpdateLightsBuffers(float deltaTime)
 #pragma endregion SpotLights
 }
 
+void RenderSubsystem::UpdateLightClusters()
+{
+    BLAINN_PROFILE_FUNC();
+    XMFLOAT4X4 proj;
+    XMStoreFloat4x4(&proj, m_camera->GetPerspectiveProjectionMatrix());
+
+    LightClusterGridDesc desc;
+    desc.CountX = LightClusterCountX;
+    desc.CountY = LightClusterCountY;
+    desc.CountZ = LightClusterCountZ;
+    desc.ProjScaleX = proj._11;
+    desc.ProjScaleY = proj._22;
+    desc.NearZ = m_camera->GetNearZ();
+    desc.FarZ = m_camera->GetFarZ();
+
+    m_lightClusters.Build(desc, m_pointLightBounds.data(), m_pointLightsCount, m_spotLightBounds.data(),
+                          m_spotLightsCount);
+
+    auto *uploadBuffer = m_currFrameResource->FrameUploadBuffer.get();
+    const auto &clusters = m_lightClusters.GetClusters();
+    const auto &lightIndices = m_lightClusters.GetLightIndices();
+    m_clusterGridData = uploadBuffer->PushStructured(clusters.data(), static_cast<uint32_t>(clusters.size()));
+    // no light touches a cluster, the shader never reads the indices but the root descriptor still needs an address
+    m_clusterLightIndicesData =
+        lightIndices.empty()
+            ? m_clusterGridData
+            : uploadBuffer->PushStructured(lightIndices.data(), static_cast<uint32_t>(lightIndices.size()));
+}
+
 void Blainn::RenderSubsystem::UpdateMaterialBuffer(float deltaTime)
 {
     (void)deltaTime;
@@ -1071,43 +1358,46 @@ void Blainn::RenderSubsystem::UpdateMaterialBuffer(float deltaTime)
     auto currMaterialDataSB = m_currFrameResource->MaterialSB.get();
 
     auto &materials = AssetManager::GetInstance().m_materials;
+    const size_t materialCount = eastl::min<size_t>(materials.size(), MAX_MATERIALS);
+
+    // every frame resource has its own copy of the buffer, a material stays dirty until all of them are written
+    UINT rangeStart = 0u;
+    m_dirtyMaterialsSBData.clear();
+    auto flushRange = [&]()
+    {
+        if (m_dirtyMaterialsSBData.empty()) return;
+        currMaterialDataSB->CopyData(static_cast<int>(rangeStart), m_dirtyMaterialsSBData.data(),
+                                     static_cast<uint32_t>(m_dirtyMaterialsSBData.size()));
+        m_dirtyMaterialsSBData.clear();
+    };
 
-    for (size_t matIndex = 0; matIndex < materials.size(); ++matIndex)
+    for (size_t matIndex = 0; matIndex < materialCount; ++matIndex)
     {
-        m_perMaterialSBData = MaterialData();
-        if (materials[matIndex] /* && materials[matIndex]->IsFramesDirty()*/)
+        auto &material = materials[matIndex].Asset;
+        if (!material || !material->IsFramesDirty())
         {
-            XMStoreFloat4x4(&m_perMaterialSBData.MatTransform,
-                            XMMatrixTranspose(materials[matIndex]->GetMaterialTransform()));
-
-            m_perMaterialSBData.DiffuseAlbedo = materials[matIndex]->GetDefaultAldedo();
-            // m_perMaterialSBData.FresnelR0 = mat->FresnelR0;
-            m_perMaterialSBData.Roughness = materials[matIndex]->GetDefaultRougnessScale();
-            m_perMaterialSBData.DiffuseMapIndex =
-                materials[matIndex]->HasTexture(TextureType::ALBEDO)
-                    ? materials[matIndex]->GetTextureHandle(TextureType::ALBEDO).GetIndex()
-                    : static_cast<uint32_t>(-1);
-            m_perMaterialSBData.NormalMapIndex =
-                materials[matIndex]->HasTexture(TextureType::NORMAL)
-                    ? materials[matIndex]->GetTextureHandle(TextureType::NORMAL).GetIndex()
-                    : static_cast<uint32_t>(-1);
-            m_perMaterialSBData.RoughnessMapIndex =
-                materials[matIndex]->HasTexture(TextureType::ROUGHNESS)
-                    ? materials[matIndex]->GetTextureHandle(TextureType::ROUGHNESS).GetIndex()
-                    : static_cast<uint32_t>(-1);
-            m_perMaterialSBData.MetallicMapIndex =
-                materials[matIndex]->HasTexture(TextureType::METALLIC)
-                    ? materials[matIndex]->GetTextureHandle(TextureType::METALLIC).GetIndex()
-                    : static_cast<uint32_t>(-1);
-
-            // m_perMaterialSBData.AOMapIndex = materials[matIndex]->GetTextureHandle(TextureType::AO).GetIndex();
-
-            // currMaterialDataSB->CopyData(matIndex, m_perMaterialSBData);
-
-            materials[matIndex]->FrameResetDirtyFlags();
+            flushRange();
+            continue;
         }
-        currMaterialDataSB->CopyData(static_cast<UINT>(matIndex), m_perMaterialSBData);
+
+        if (m_dirtyMaterialsSBData.empty()) rangeStart = static_cast<UINT>(matIndex);
+
+        MaterialData &materialData = m_dirtyMaterialsSBData.push_back();
+        materialData = MaterialData();
+        XMStoreFloat4x4(&materialData.MatTransform, XMMatrixTranspose(material->GetMaterialTransform()));
+
+        materialData.DiffuseAlbedo = material->GetDefaultAldedo();
+        // materialData.FresnelR0 = mat->FresnelR0;
+        materialData.Roughness = material->GetDefaultRougnessScale();
+        materialData.DiffuseMapIndex = material->GetTextureIndex(TextureType::ALBEDO);
+        materialData.NormalMapIndex = material->GetTextureIndex(TextureType::NORMAL);
+        materialData.RoughnessMapIndex = material->GetTextureIndex(TextureType::ROUGHNESS);
+        materialData.MetallicMapIndex = material->GetTextureIndex(TextureType::METALLIC);
+        // materialData.AOMapIndex = material->GetTextureIndex(TextureType::AO);
+
+        material->FrameResetDirtyFlags();
     }
+    flushRange();
 }
 
 void Blainn::RenderSubsystem::UpdateShadowTransform(float deltaTime)
@@ -1122,6 +1412,12 @@ void Blainn::RenderSubsystem::UpdateShadowTransform(float deltaTime)
         XMMATRIX shadowTransform = lightSpaceMatrices[i].first * lightSpaceMatrices[i].second;
         m_shadowPassCBData.Cascades.CascadeViewProj[i] = XMMatrixTranspose(shadowTransform);
 
+        XMFLOAT4X4 cascadeViewProj;
+        XMStoreFloat4x4(&cascadeViewProj, shadowTransform);
+        m_cascadeFrustums[i] = FrustumPlanes::FromViewProjection(cascadeViewProj.m);
+        // casters between the light and the cascade still shadow it, the shadow PSO pancakes them onto near
+        m_cascadeFrustums[i].DisableNearPlane();
+
         m_deferredPassCBData.Cascades.CascadeViewProj[i] = XMMatrixTranspose(shadowTransform);
         m_deferredPassCBData.Cascades.Distances[i] = m_camera->GetFrustumCascadesLevel(i);
     }
@@ -1197,6 +1493,11 @@ void Blainn::RenderSubsystem::UpdateDeferredPassCB(float deltaTime)
 
     m_deferredPassCBData.Ambient = {0.25f, 0.25f, 0.35f, 1.0f};
 
+    m_deferredPassCBData.ClusterTileScale =
+        XMFLOAT2(static_cast<float>(LightClusterCountX) / m_width, static_cast<float>(LightClusterCountY) / m_height);
+    m_deferredPassCBData.ClusterDepthScale = m_lightClusters.GetDepthSliceScale();
+    m_deferredPassCBData.ClusterDepthBias = m_lightClusters.GetDepthSliceBias();
+
 #pragma region DirLight
     // Invert sign because other way light would be pointing up
 
@@ -1250,7 +1551,8 @@ void Blainn::RenderSubsystem::ResourceBarrier(ID3D12GraphicsCommandList2 *pComma
     pCommandList->ResourceBarrier(1u, &transition);
 }
 
-void Blainn::RenderSubsystem::RenderDepthOnlyPass(ID3D12GraphicsCommandList2 *pCommandList)
+void Blainn::RenderSubsystem::RenderDepthOnlyPass(ID3D12GraphicsCommandList2 *pCommandList,
+                                                  const PassRecordingJob &job)
 {
     BLAINN_PROFILE_FUNC();
     UINT passCBByteSize = FreyaUtil::CalcConstantBufferByteSize(sizeof(PassConstants));
@@ -1262,8 +1564,9 @@ void Blainn::RenderSubsystem::RenderDepthOnlyPass(ID3D12GraphicsCommandList2 *pC
     pCommandList->RSSetScissorRects(1u, &csmScissor);
 
     // change to depth write state
-    ResourceBarrier(pCommandList, m_cascadeShadowMap->Get(), D3D12_RESOURCE_STATE_GENERIC_READ,
-                    D3D12_RESOURCE_STATE_DEPTH_WRITE);
+    if (job.IsFirst)
+        ResourceBarrier(pCommandList, m_cascadeShadowMap->Get(), D3D12_RESOURCE_STATE_GENERIC_READ,
+                        D3D12_RESOURCE_STATE_DEPTH_WRITE);
 
 #pragma region BypassResources
     auto currFramePassCB = m_currFrameResource->PassCB->Get();
@@ -1275,17 +1578,19 @@ void Blainn::RenderSubsystem::RenderDepthOnlyPass(ID3D12GraphicsCommandList2 *pC
 
     CD3DX12_CPU_DESCRIPTOR_HANDLE dsvHandle(m_cascadeShadowMap->GetDsv());
     pCommandList->OMSetRenderTargets(0u, nullptr, TRUE, &dsvHandle);
-    pCommandList->ClearDepthStencilView(dsvHandle, D3D12_CLEAR_FLAG_DEPTH | D3D12_CLEAR_FLAG_STENCIL, 1.0f, 0u, 0u,
-                                        nullptr);
+    if (job.IsFirst)
+        pCommandList->ClearDepthStencilView(dsvHandle, D3D12_CLEAR_FLAG_DEPTH | D3D12_CLEAR_FLAG_STENCIL, 1.0f, 0u,
+                                            0u, nullptr);
 
-    pCommandList->SetPipelineState(m_pipelineStates.at(PipelineStateObject::EPsoType::CascadedShadowsOpaque).Get());
-    DrawMeshes(pCommandList);
+    DrawMeshes(pCommandList, m_shadowDrawList, m_shadowInstanceData, job.FirstBatch, job.BatchCount);
 
-    ResourceBarrier(pCommandList, m_cascadeShadowMap->Get(), D3D12_RESOURCE_STATE_DEPTH_WRITE,
-                    D3D12_RESOURCE_STATE_GENERIC_READ);
+    if (job.IsLast)
+        ResourceBarrier(pCommandList, m_cascadeShadowMap->Get(), D3D12_RESOURCE_STATE_DEPTH_WRITE,
+                        D3D12_RESOURCE_STATE_GENERIC_READ);
 }
 
-void Blainn::RenderSubsystem::RenderGeometryPass(ID3D12GraphicsCommandList2 *pCommandList)
+void Blainn::RenderSubsystem::RenderGeometryPass(ID3D12GraphicsCommandList2 *pCommandList,
+                                                 const PassRecordingJob &job)
 {
     BLAINN_PROFILE_FUNC();
     UINT passCBByteSize = FreyaUtil::CalcConstantBufferByteSize(sizeof(PassConstants));
@@ -1293,13 +1598,16 @@ void Blainn::RenderSubsystem::RenderGeometryPass(ID3D12GraphicsCommandList2 *pCo
     pCommandList->RSSetViewports(1u, &m_viewport);
     pCommandList->RSSetScissorRects(1u, &m_scissorRect);
 
-    for (unsigned i = 0; i < GBuffer::EGBufferLayer::MAX - 1u; i++)
+    if (job.IsFirst)
     {
-        ResourceBarrier(pCommandList, m_GBuffer->Get(i), D3D12_RESOURCE_STATE_GENERIC_READ,
-                        D3D12_RESOURCE_STATE_RENDER_TARGET);
+        for (unsigned i = 0; i < GBuffer::EGBufferLayer::MAX - 1u; i++)
+        {
+            ResourceBarrier(pCommandList, m_GBuffer->Get(i), D3D12_RESOURCE_STATE_GENERIC_READ,
+                            D3D12_RESOURCE_STATE_RENDER_TARGET);
+        }
+        ResourceBarrier(pCommandList, m_GBuffer->Get(GBuffer::EGBufferLayer::DEPTH),
+                        D3D12_RESOURCE_STATE_GENERIC_READ, D3D12_RESOURCE_STATE_DEPTH_WRITE);
     }
-    ResourceBarrier(pCommandList, m_GBuffer->Get(GBuffer::EGBufferLayer::DEPTH), D3D12_RESOURCE_STATE_GENERIC_READ,
-                    D3D12_RESOURCE_STATE_DEPTH_WRITE);
 
 #pragma region BypassResources
     auto currFramePassCB = m_currFrameResource->PassCB->Get();
@@ -1315,10 +1623,8 @@ void Blainn::RenderSubsystem::RenderGeometryPass(ID3D12GraphicsCommandList2 *pCo
 
     // Bind all the textures used in this scene. Observe that we only have to specify the first descriptor in the table.
     // The root signature knows how many descriptors are expected in the table.
-    pCommandList->SetGraphicsRootDescriptorTable(
-        RootSignature::ERootParam::Textures,
-        CD3DX12_GPU_DESCRIPTOR_HANDLE(m_srvHeap->GetGPUDescriptorHandleForHeapStart(), m_texturesSrvHeapStartIndex,
-                                      m_cbvSrvUavDescriptorSize));
+    pCommandList->SetGraphicsRootDescriptorTable(RootSignature::ERootParam::Textures,
+                                                 m_textureViews.GetTable(m_currFrameResourceIndex));
 #pragma endregion BypassResources
 
     // start of the GBuffer rtvs in rtvHeap
@@ -1327,35 +1633,40 @@ void Blainn::RenderSubsystem::RenderGeometryPass(ID3D12GraphicsCommandList2 *pCo
     CD3DX12_CPU_DESCRIPTOR_HANDLE dsvHandle(m_GBuffer->GetDsv(GBuffer::EGBufferLayer::DEPTH));
     pCommandList->OMSetRenderTargets(GBuffer::EGBufferLayer::DEPTH, &rtvHandle, TRUE, &dsvHandle);
 
-    const float clearColor[4] = {0.0f, 0.0f, 0.0f, 0.0f};
-    pCommandList->ClearRenderTargetView(m_GBuffer->GetRtv(GBuffer::EGBufferLayer::DIFFUSE_ALBEDO),
-                                        Colors::LightSteelBlue, 0u, nullptr);
-    pCommandList->ClearRenderTargetView(m_GBuffer->GetRtv(GBuffer::EGBufferLayer::AMBIENT_OCCLUSION), clearColor, 0u,
-                                        nullptr);
-    pCommandList->ClearRenderTargetView(m_GBuffer->GetRtv(GBuffer::EGBufferLayer::NORMAL), clearColor, 0u, nullptr);
-    pCommandList->ClearRenderTargetView(m_GBuffer->GetRtv(GBuffer::EGBufferLayer::SPECULAR), clearColor, 0u, nullptr);
-    pCommandList->ClearDepthStencilView(m_GBuffer->GetDsv(GBuffer::EGBufferLayer::DEPTH),
-                                        D3D12_CLEAR_FLAG_DEPTH | D3D12_CLEAR_FLAG_STENCIL, 1.0f, 0u, 0u, nullptr);
-
-    pCommandList->SetPipelineState(m_pipelineStates.at(PipelineStateObject::EPsoType::DeferredGeometry).Get());
+    if (job.IsFirst)
+    {
+        const float clearColor[4] = {0.0f, 0.0f, 0.0f, 0.0f};
+        pCommandList->ClearRenderTargetView(m_GBuffer->GetRtv(GBuffer::EGBufferLayer::DIFFUSE_ALBEDO),
+                                            Colors::LightSteelBlue, 0u, nullptr);
+        pCommandList->ClearRenderTargetView(m_GBuffer->GetRtv(GBuffer::EGBufferLayer::AMBIENT_OCCLUSION), clearColor,
+                                            0u, nullptr);
+        pCommandList->ClearRenderTargetView(m_GBuffer->GetRtv(GBuffer::EGBufferLayer::NORMAL), clearColor, 0u,
+                                            nullptr);
+        pCommandList->ClearRenderTargetView(m_GBuffer->GetRtv(GBuffer::EGBufferLayer::SPECULAR), clearColor, 0u,
+                                            nullptr);
+        pCommandList->ClearDepthStencilView(m_GBuffer->GetDsv(GBuffer::EGBufferLayer::DEPTH),
+                                            D3D12_CLEAR_FLAG_DEPTH | D3D12_CLEAR_FLAG_STENCIL, 1.0f, 0u, 0u, nullptr);
+    }
 
-    DrawMeshes(pCommandList);
+    DrawMeshes(pCommandList, m_geometryDrawList, m_geometryInstanceData, job.FirstBatch, job.BatchCount);
 
-    for (unsigned i = 0; i < GBuffer::EGBufferLayer::MAX - 1u; i++)
+    if (job.IsLast)
     {
-        ResourceBarrier(pCommandList, m_GBuffer->Get(i), D3D12_RESOURCE_STATE_RENDER_TARGET,
-                        D3D12_RESOURCE_STATE_GENERIC_READ);
+        for (unsigned i = 0; i < GBuffer::EGBufferLayer::MAX - 1u; i++)
+        {
+            ResourceBarrier(pCommandList, m_GBuffer->Get(i), D3D12_RESOURCE_STATE_RENDER_TARGET,
+                            D3D12_RESOURCE_STATE_GENERIC_READ);
+        }
+        ResourceBarrier(pCommandList, m_GBuffer->Get(GBuffer::EGBufferLayer::DEPTH),
+                        D3D12_RESOURCE_STATE_DEPTH_WRITE, D3D12_RESOURCE_STATE_GENERIC_READ);
     }
-    ResourceBarrier(pCommandList, m_GBuffer->Get(GBuffer::EGBufferLayer::DEPTH), D3D12_RESOURCE_STATE_DEPTH_WRITE,
-                    D3D12_RESOURCE_STATE_GENERIC_READ);
 }
 
 void Blainn::RenderSubsystem::RenderLightingPass(ID3D12GraphicsCommandList2 *pCommandList)
 {
     BLAINN_PROFILE_FUNC();
     DeferredDirectionalLightPass(pCommandList);
-    DeferredPointLightPass(pCommandList);
-    DeferredSpotLightPass(pCommandList);
+    DeferredClusteredLightPass(pCommandList);
 }
 
 void Blainn::RenderSubsystem::DeferredDirectionalLightPass(ID3D12GraphicsCommandList2 *pCommandList)
@@ -1404,37 +1715,22 @@ void Blainn::RenderSubsystem::DeferredDirectionalLightPass(ID3D12GraphicsCommand
     DrawQuad(pCommandList);
 }
 
-void Blainn::RenderSubsystem::DeferredPointLightPass(ID3D12GraphicsCommandList2 *pCommandList)
+void Blainn::RenderSubsystem::DeferredClusteredLightPass(ID3D12GraphicsCommandList2 *pCommandList)
 {
-    auto instanceBuffer = m_currFrameResource->PointLightSB->Get();
-    pCommandList->SetGraphicsRootShaderResourceView(RootSignature::ERootParam::PointLightsDataSB,
-                                                    instanceBuffer->GetGPUVirtualAddress());
+    if (!m_pointLightsCount && !m_spotLightsCount) return;
+    // upload buffer overflow was reported already
+    if (!m_clusterGridData || !m_clusterLightIndicesData) return;
 
-    // !!! HACK (TO DRAW EVEN IF FRUSTUM INTERSECTS LIGHT VOLUME)
-    pCommandList->SetPipelineState(
-        m_pipelineStates.at(PipelineStateObject::EPsoType::DeferredPointWithinFrustum).Get());
-
-    if (m_pointLightsCount)
-        DrawInstancedMesh(pCommandList,
-                          AssetManager::GetInstance().GetDefaultModel(static_cast<uint32_t>(EPrebuiltMeshType::SPHERE)),
-                          m_pointLightsCount);
-    m_pointLightsCount = 0u;
-}
-
-void Blainn::RenderSubsystem::DeferredSpotLightPass(ID3D12GraphicsCommandList2 *pCommandList)
-{
-    auto instanceBuffer = m_currFrameResource->SpotLightSB->Get();
+    pCommandList->SetGraphicsRootShaderResourceView(RootSignature::ERootParam::PointLightsDataSB,
+                                                    m_currFrameResource->PointLightSB->Get()->GetGPUVirtualAddress());
     pCommandList->SetGraphicsRootShaderResourceView(RootSignature::ERootParam::SpotLightsDataSB,
-                                                    instanceBuffer->GetGPUVirtualAddress());
+                                                    m_currFrameResource->SpotLightSB->Get()->GetGPUVirtualAddress());
+    pCommandList->SetGraphicsRootShaderResourceView(RootSignature::ERootParam::ClusterGridSB, m_clusterGridData);
+    pCommandList->SetGraphicsRootShaderResourceView(RootSignature::ERootParam::ClusterLightIndicesSB,
+                                                    m_clusterLightIndicesData);
 
-    // !!! HACK (TO DRAW EVEN IF FRUSTUM INTERSECTS LIGHT VOLUME)
-    pCommandList->SetPipelineState(m_pipelineStates.at(PipelineStateObject::EPsoType::DeferredSpotWithinFrustum).Get());
-
-    if (m_spotLightsCount)
-        DrawInstancedMesh(pCommandList,
-                          AssetManager::GetInstance().GetDefaultModel(static_cast<uint32_t>(EPrebuiltMeshType::CONE)),
-                          m_spotLightsCount);
-    m_spotLightsCount = 0u;
+    pCommandList->SetPipelineState(m_pipelineStates.at(PipelineStateObject::EPsoType::DeferredClusteredLights).Get());
+    DrawQuad(pCommandList);
 }
 
 void Blainn::RenderSubsystem::RenderForwardPasses(ID3D12GraphicsCommandList2 *pCommandList)
@@ -1477,15 +1773,14 @@ void Blainn::RenderSubsystem::RenderSkyBoxPass(ID3D12GraphicsCommandList2 *pComm
 
     ObjectConstants obj;
     XMStoreFloat4x4(&obj.World, XMMatrixTranspose(XMMatrixScaling(5000.0f, 5000.0f, 5000.0f)));
-    skyBox->UpdateMeshCB(obj);
-
-    UINT objCBByteSize = (UINT)FreyaUtil::CalcConstantBufferByteSize(sizeof(ObjectConstants));
-    auto currFrameObjCB = skyBox->ObjectCB->Get();
-    D3D12_GPU_VIRTUAL_ADDRESS objCBAddress =
-        FreyaUtil::GetGPUVirtualAddress(currFrameObjCB->GetGPUVirtualAddress(), objCBByteSize, 0u);
-    pCommandList->SetGraphicsRootConstantBufferView(RootSignature::ERootParam::PerObjectDataCB, objCBAddress);
-
-    DrawMesh(pCommandList, AssetManager::GetInstance().GetDefaultModel(static_cast<uint32_t>(EPrebuiltMeshType::BOX)));
+    skyBox->PerObjectCBData = obj;
+    const auto skyBoxDataAddress = m_currFrameResource->FrameUploadBuffer->PushStructured(&skyBox->PerObjectCBData, 1u);
+    if (skyBoxDataAddress)
+    {
+        pCommandList->SetGraphicsRootShaderResourceView(RootSignature::ERootParam::PerObjectDataSB, skyBoxDataAddress);
+        DrawMesh(pCommandList,
+                 AssetManager::GetInstance().GetDefaultModel(static_cast<uint32_t>(EPrebuiltMeshType::BOX)));
+    }
 
     ResourceBarrier(pCommandList, m_GBuffer->Get(GBuffer::EGBufferLayer::DEPTH), D3D12_RESOURCE_STATE_DEPTH_READ,
                     D3D12_RESOURCE_STATE_GENERIC_READ);
@@ -1612,7 +1907,7 @@ void RenderSubsystem::RenderUUIDPass(ID3D12GraphicsCommandList2 *pCommandList)
 
             pCommandList->SetGraphicsRoot32BitConstants(0, sizeof(objData) / 4, &objData, 0);
 
-            auto &model = meshComponent.MeshHandle->GetMesh();
+            auto &model = meshComponent.MeshHandle.GetMesh();
             auto currVBV = model.VertexBufferView();
             auto currIBV = model.IndexBufferView();
 
@@ -1673,45 +1968,60 @@ void Blainn::RenderSubsystem::DrawMesh(ID3D12GraphicsCommandList2 *pCommandList,
     }
 }
 
-void Blainn::RenderSubsystem::DrawMeshes(ID3D12GraphicsCommandList2 *pCommandList)
+void Blainn::RenderSubsystem::DrawMeshes(ID3D12GraphicsCommandList2 *pCommandList, const DrawList &drawList,
+                                         D3D12_GPU_VIRTUAL_ADDRESS instanceData, uint32_t firstBatch,
+                                         uint32_t batchCount)
 {
     BLAINN_PROFILE_FUNC();
-    auto commandQueue = m_device.GetCommandQueue();
+    // instance data did not fit into the upload buffer
+    if (!instanceData || !batchCount) return;
 
-    UINT objCBByteSize = (UINT)FreyaUtil::CalcConstantBufferByteSize(sizeof(ObjectConstants));
-
-    for (auto &scene : Engine::GetSceneManager().GetActiveScenes())
-    {
-        const auto &renderEntitiesView = scene->GetAllEntitiesWith<IDComponent, TransformComponent, MeshComponent>();
+    const auto &items = drawList.GetItems();
+    const auto &batches = drawList.GetBatches();
 
-        for (const auto &[entity, entityID, entityTransform, entityMesh] : renderEntitiesView.each())
-        {
-            if (!entityMesh.Enabled) continue;
+    pCommandList->IASetPrimitiveTopology(D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
 
-            auto currObjectCB = entityMesh.ObjectCB->Get();
+    uint32_t currPipeline = UINT32_MAX;
+    const Model *currModel = nullptr;
 
-            auto &model = entityMesh.MeshHandle->GetMesh();
+    for (uint32_t batchIndex = firstBatch; batchIndex < firstBatch + batchCount; batchIndex++)
+    {
+        // every instance of a batch shares pipeline, material, model and LOD, only per instance data differs
+        const auto &batch = batches[batchIndex];
+        const uint64_t key = items[batch.FirstItem].Key;
+        const uint32_t meshKey = DrawSortKey::GetMesh(key);
+        const Model &model = *m_drawModels[meshKey >> 3u];
+        const uint32_t lodIndex = meshKey & 7u;
+
+        const uint32_t pipeline = DrawSortKey::GetPipeline(key);
+        if (pipeline != currPipeline)
+        {
+            pCommandList->SetPipelineState(
+                m_pipelineStates.at(static_cast<PipelineStateObject::EPsoType>(pipeline)).Get());
+            currPipeline = pipeline;
+        }
 
+        auto currIBV = model.IndexBufferView();
+        if (&model != currModel)
+        {
             auto currVBV = model.VertexBufferView();
-            auto currIBV = model.IndexBufferView();
-
-            pCommandList->IASetPrimitiveTopology(D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
             pCommandList->IASetVertexBuffers(0u, 1u, &currVBV);
             pCommandList->IASetIndexBuffer(&currIBV);
+            currModel = &model;
+        }
 
-            D3D12_GPU_VIRTUAL_ADDRESS objCBAddress =
-                FreyaUtil::GetGPUVirtualAddress(currObjectCB->GetGPUVirtualAddress(), objCBByteSize, 0u);
-            pCommandList->SetGraphicsRootConstantBufferView(RootSignature::ERootParam::PerObjectDataCB, objCBAddress);
+        pCommandList->SetGraphicsRootShaderResourceView(RootSignature::ERootParam::PerObjectDataSB,
+                                                        instanceData + batch.FirstItem * sizeof(ObjectConstants));
 
-            [[likely]]
-            if (currIBV.SizeInBytes)
-            {
-                pCommandList->DrawIndexedInstanced(static_cast<UINT>(model.GetIndicesCount()), 1u, 0u, 0u, 0u);
-            }
-            else
-            {
-                pCommandList->DrawInstanced(static_cast<UINT>(model.GetVerticesCount()), 1u, 0u, 0u);
-            }
+        [[likely]]
+        if (currIBV.SizeInBytes)
+        {
+            const auto &lod = model.GetLODs()[eastl::min<size_t>(lodIndex, model.GetLODs().size() - 1u)];
+            pCommandList->DrawIndexedInstanced(lod.IndexCount, batch.ItemCount, lod.FirstIndex, 0, 0u);
+        }
+        else
+        {
+            pCommandList->DrawInstanced(static_cast<UINT>(model.GetVerticesCount()), batch.ItemCount, 0u, 0u);
         }
     }
 }
@@ -3,17 +3,51 @@
 #include "subsystems/ScriptingSubsystem.h"
 
 #include <cassert>
+#include <fstream>
 #include <sol/sol.hpp>
 
 
 #include "Engine.h"
+#include "Render/UI/UIRenderer.h"
 #include "ScriptingSubsystem.h"
+#include "subsystems/RenderSubsystem.h"
 #include "scene/Scene.h"
 #include "scripting/TypeRegistration.h"
 #include "sol_ImGui.h"
 
 using namespace Blainn;
 
+namespace
+{
+#if defined(DEBUG) || defined(_DEBUG)
+// every callback is protected separately, failed slots and messages are appended to errors
+constexpr const char *kScriptBatchRunner = R"(
+return function(callbacks, count, deltaTimeMs, errors)
+    for i = 1, count do
+        local callback = callbacks[i]
+        if callback then
+            local ok, err = pcall(callback, deltaTimeMs)
+            if not ok then
+                errors[#errors + 1] = i
+                errors[#errors + 1] = tostring(err)
+            end
+        end
+    end
+end
+)";
+#else
+// the whole batch is one protected call, an error skips the rest of the batch for this frame
+constexpr const char *kScriptBatchRunner = R"(
+return function(callbacks, count, deltaTimeMs)
+    for i = 1, count do
+        local callback = callbacks[i]
+        if callback then callback(deltaTimeMs) end
+    end
+end
+)";
+#endif
+} // namespace
+
 void ScriptingSubsystem::Init()
 {
     m_lua.open_libraries(sol::lib::base, sol::lib::package, sol::lib::math, sol::lib::string, sol::lib::table,
@@ -21,6 +55,9 @@ void ScriptingSubsystem::Init()
 
     RegisterBlainnTypes();
 
+    s_batchRunner = m_lua.script(kScriptBatchRunner);
+    s_environmentMetatable = m_lua.create_table_with(sol::meta_function::index, m_lua.globals());
+
     m_isInitialized = true;
 }
 
@@ -36,6 +73,12 @@ void ScriptingSubsystem::Destroy()
         }
     }
     m_scriptEntityConnections = {};
+    s_sceneScriptBatches = {};
+    s_deferredRemovals = {};
+    s_deferredSceneErases = {};
+    s_batchRunner = sol::lua_nil;
+    s_compiledScripts = {};
+    s_environmentMetatable = sol::lua_nil;
 }
 
 void Blainn::ScriptingSubsystem::LoadAllScripts(Scene &scene)
@@ -63,20 +106,144 @@ void Blainn::ScriptingSubsystem::UnloadAllScripts(Scene &scene)
             ScriptingSubsystem::UnloadScript(scriptUuid);
         }
     }
+
+    // the emptied batches still hold their lua tables, drop them with the scene entry
+    if (s_isRunningBatches)
+        s_deferredSceneErases.push_back(scene.GetSceneID());
+    else
+        s_sceneScriptBatches.erase(scene.GetSceneID());
 }
 
 void ScriptingSubsystem::Update(Scene &scene, float deltaTimeMs)
 {
     BLAINN_PROFILE_FUNC();
-    auto view = scene.GetAllEntitiesWith<ScriptingComponent, IDComponent>();
-    for (const auto &[entity, scriptingComponent, idComp] : view.each())
+    auto it = s_sceneScriptBatches.find(scene.GetSceneID());
+    if (it == s_sceneScriptBatches.end()) return;
+
+    s_isRunningBatches = true;
+    RunBatches(it->second.onUpdate, "OnUpdate", deltaTimeMs);
+    if (RenderSubsystem::GetInstance().GetUIRenderer().ShouldRenderScriptUI)
+        RunBatches(it->second.onDrawUI, "OnDrawUI", deltaTimeMs);
+    s_isRunningBatches = false;
+
+    for (const auto &[batch, scriptId] : s_deferredRemovals)
+        RemoveFromBatch(*batch, scriptId);
+    s_deferredRemovals.clear();
+
+    for (const uuid &sceneId : s_deferredSceneErases)
     {
-        for (auto &script : scriptingComponent.scripts)
+        auto sceneIt = s_sceneScriptBatches.find(sceneId);
+        if (sceneIt == s_sceneScriptBatches.end()) continue;
+
+        // scripts loaded into the scene again after the unload keep it
+        const auto isEmpty = [](const auto &batches)
         {
-            script.second.OnUpdateCall(deltaTimeMs);
-            script.second.OnDrawUI();
+            return eastl::all_of(batches.begin(), batches.end(),
+                                 [](const auto &entry) { return entry.second.scriptIds.empty(); });
+        };
+        if (isEmpty(sceneIt->second.onUpdate) && isEmpty(sceneIt->second.onDrawUI))
+            s_sceneScriptBatches.erase(sceneIt);
+    }
+    s_deferredSceneErases.clear();
+}
+
+void ScriptingSubsystem::RunBatches(eastl::unordered_map<eastl::string, ScriptBatch> &batches,
+                                    const char *callbackName, float deltaTimeMs)
+{
+    // callbacks can load scripts and insert new batches, collect the batches first to not iterate a rehashed map
+    s_batchesToRun.clear();
+    for (auto &[path, batch] : batches)
+    {
+        if (!batch.scriptIds.empty()) s_batchesToRun.emplace_back(&path, &batch);
+    }
+
+    for (const auto &[path, batch] : s_batchesToRun)
+    {
+        const uint32_t count = static_cast<uint32_t>(batch->scriptIds.size());
+
+#if defined(DEBUG) || defined(_DEBUG)
+        sol::table errors = m_lua.create_table();
+        sol::protected_function_result result = s_batchRunner(batch->callbacks, count, deltaTimeMs, errors);
+#else
+        sol::protected_function_result result = s_batchRunner(batch->callbacks, count, deltaTimeMs);
+#endif
+        if (!result.valid())
+        {
+            sol::error err = result;
+            BF_ERROR("Lua {} error in {}:\n\t\t{}", callbackName, path->c_str(), err.what());
+        }
+
+#if defined(DEBUG) || defined(_DEBUG)
+        for (size_t i = 1; i < errors.size(); i += 2)
+        {
+            const uint32_t slot = errors.get<uint32_t>(i) - 1;
+            const eastl::string scriptId = slot < batch->scriptIds.size() ? batch->scriptIds[slot].str().c_str() : "";
+            BF_ERROR("Lua {} error in {} (script {}):\n\t\t{}", callbackName, path->c_str(), scriptId.c_str(),
+                     errors.get<std::string>(i + 1));
         }
+#endif
+    }
+}
+
+void ScriptingSubsystem::AddToBatches(const LuaScript &script, const uuid &sceneId)
+{
+    const eastl::string path = script.GetScriptPath().string().c_str();
+    SceneScriptBatches &sceneBatches = s_sceneScriptBatches[sceneId];
+
+    if (script.GetOnUpdateFunction().valid())
+        AddToBatch(sceneBatches.onUpdate[path], script.GetId(), script.GetOnUpdateFunction());
+    if (script.GetOnDrawUIFunction().valid())
+        AddToBatch(sceneBatches.onDrawUI[path], script.GetId(), script.GetOnDrawUIFunction());
+}
+
+void ScriptingSubsystem::RemoveFromBatches(const LuaScript &script, const uuid &sceneId)
+{
+    auto it = s_sceneScriptBatches.find(sceneId);
+    if (it == s_sceneScriptBatches.end()) return;
+
+    const eastl::string path = script.GetScriptPath().string().c_str();
+    if (auto batchIt = it->second.onUpdate.find(path); batchIt != it->second.onUpdate.end())
+        RemoveFromBatch(batchIt->second, script.GetId());
+    if (auto batchIt = it->second.onDrawUI.find(path); batchIt != it->second.onDrawUI.end())
+        RemoveFromBatch(batchIt->second, script.GetId());
+}
+
+void ScriptingSubsystem::AddToBatch(ScriptBatch &batch, const uuid &scriptId, const sol::protected_function &callback)
+{
+    if (!batch.callbacks.valid()) batch.callbacks = m_lua.create_table();
+
+    const uint32_t slot = static_cast<uint32_t>(batch.scriptIds.size());
+    batch.callbacks.raw_set(slot + 1, callback);
+    batch.scriptIds.push_back(scriptId);
+    batch.slots[scriptId] = slot;
+}
+
+void ScriptingSubsystem::RemoveFromBatch(ScriptBatch &batch, const uuid &scriptId)
+{
+    auto slotIt = batch.slots.find(scriptId);
+    if (slotIt == batch.slots.end()) return;
+
+    const uint32_t slot = slotIt->second;
+    if (s_isRunningBatches)
+    {
+        // the runner skips nil callbacks
+        batch.callbacks.raw_set(slot + 1, sol::lua_nil);
+        s_deferredRemovals.emplace_back(&batch, scriptId);
+        return;
+    }
+
+    const uint32_t last = static_cast<uint32_t>(batch.scriptIds.size()) - 1;
+    batch.slots.erase(slotIt);
+
+    // swap with the last callback to keep the lua array dense
+    if (slot != last)
+    {
+        batch.callbacks.raw_set(slot + 1, batch.callbacks.raw_get<sol::object>(last + 1));
+        batch.scriptIds[slot] = batch.scriptIds[last];
+        batch.slots[batch.scriptIds[slot]] = slot;
     }
+    batch.callbacks.raw_set(last + 1, sol::lua_nil);
+    batch.scriptIds.pop_back();
 }
 
 void Blainn::ScriptingSubsystem::CreateAttachScriptingComponent(Entity entity)
@@ -118,6 +285,60 @@ sol::state &ScriptingSubsystem::GetLuaState()
     return m_lua;
 }
 
+sol::protected_function ScriptingSubsystem::GetCompiledScript(const Path &scriptPath)
+{
+    BLAINN_PROFILE_FUNC();
+
+    std::error_code error;
+    const std::filesystem::file_time_type writeTime = std::filesystem::last_write_time(scriptPath, error);
+    const eastl::string key = scriptPath.string().c_str();
+
+    auto it = s_compiledScripts.find(key);
+    if (it != s_compiledScripts.end() && !error && it->second.writeTime == writeTime) return it->second.factory;
+
+    std::ifstream file(scriptPath, std::ios::binary);
+    if (!file)
+    {
+        BF_ERROR("Failed to open Lua script: {}", scriptPath.string());
+        return sol::protected_function{};
+    }
+    std::string source((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+
+    // same as luaL_loadfile: skip utf-8 bom and comment out a shebang line, keeping line numbers
+    if (source.starts_with("\xEF\xBB\xBF")) source.erase(0, 3);
+    if (source.starts_with("#")) source.insert(0, "--");
+
+    // the wrapper stays on the first line so error line numbers match the file
+    sol::load_result chunk =
+        m_lua.load("return function(_ENV, ...) " + source + "\nend", "@" + scriptPath.string(), sol::load_mode::text);
+    if (!chunk.valid())
+    {
+        sol::error err = chunk;
+        BF_ERROR("Failed to load Lua script: {}\nError: {}", scriptPath.string(), err.what());
+        return sol::protected_function{};
+    }
+
+    sol::protected_function_result factory = chunk.get<sol::protected_function>()();
+    if (!factory.valid())
+    {
+        sol::error err = factory;
+        BF_ERROR("Failed to load Lua script: {}\nError: {}", scriptPath.string(), err.what());
+        return sol::protected_function{};
+    }
+
+    CompiledScript &compiledScript = s_compiledScripts[key];
+    compiledScript.writeTime = writeTime;
+    compiledScript.factory = factory.get<sol::protected_function>();
+    return compiledScript.factory;
+}
+
+sol::environment ScriptingSubsystem::CreateScriptEnvironment()
+{
+    sol::environment environment(m_lua, sol::create);
+    environment[sol::metatable_key] = s_environmentMetatable;
+    return environment;
+}
+
 sol::object ScriptingSubsystem::GetValueFromScript(const uuid &scriptUuid, const eastl::string &valueName)
 {
     ScriptingComponent *scriptingComponent =
@@ -163,13 +384,20 @@ eastl::optional<uuid> ScriptingSubsystem::LoadScript(Entity entity, const Path &
 
     eastl::unordered_map<uuid, LuaScript> &scripts = component->scripts;
     LuaScript luaScript = LuaScript{};
-    if (!luaScript.Load(scriptLoadPath, entity)) return eastl::nullopt;
-    if (callOnStart) luaScript.OnStartCall();
+    uuid scriptUuid = luaScript.GetId();
+
+    // load in place: physics listeners capture the script address, so it must not be copied after Load
+    LuaScript &loadedScript = scripts[scriptUuid] = eastl::move(luaScript);
+    if (!loadedScript.Load(scriptLoadPath, entity))
+    {
+        scripts.erase(scriptUuid);
+        return eastl::nullopt;
+    }
+    AddToBatches(loadedScript, entity.GetSceneUUID());
+    if (callOnStart) loadedScript.OnStartCall();
 
     // BF_WARN("Loaded script " + scriptLoadPath.string() + " for entity " + entity.GetUUID().bytes());
 
-    uuid scriptUuid = luaScript.GetId();
-    scripts[scriptUuid] = eastl::move(luaScript);
     m_scriptEntityConnections[scriptUuid] = entity;
     return eastl::optional(eastl::move(scriptUuid));
 }
@@ -202,11 +430,13 @@ void ScriptingSubsystem::UnloadScript(const uuid &scriptUuid)
     // BF_WARN("Unloaded script " + scriptUuid.bytes() + " for entity "
     //         + m_scriptEntityConnections.at(scriptUuid).GetUUID().bytes());
 
+    const uuid sceneId = m_scriptEntityConnections.at(scriptUuid).GetSceneUUID();
     m_scriptEntityConnections.erase(scriptUuid);
     eastl::unordered_map<uuid, LuaScript> &scripts = component->scripts;
     if (scripts.contains(scriptUuid))
     {
         LuaScript &script = scripts.at(scriptUuid);
+        RemoveFromBatches(script, sceneId);
         script.OnDestroyCall();
         scripts.erase(scriptUuid);
     }
@@ -0,0 +1,661 @@
+#include "tools/MeshOptimizer.h"
+
+#include <EASTL/algorithm.h>
+#include <EASTL/sort.h>
+#include <cfloat>
+#include <cmath>
+#include <cstring>
+
+using namespace Blainn;
+
+namespace
+{
+constexpr uint32_t kInvalidIndex = ~0u;
+
+// Forsyth scoring parameters, values from the original article
+constexpr uint32_t kCacheSize = 32u;
+constexpr float kCacheDecayPower = 1.5f;
+constexpr float kLastTriScore = 0.75f;
+constexpr float kValenceBoostScale = 2.0f;
+constexpr float kValenceBoostPower = 0.5f;
+
+// cache used to find cluster boundaries for the overdraw pass, matches AnalyzeVertexCache default
+constexpr uint32_t kOverdrawCacheSize = 16u;
+
+float VertexScore(uint32_t cachePosition, uint32_t remainingTriangles)
+{
+    if (remainingTriangles == 0u) return -1.0f;
+
+    float score = 0.0f;
+    if (cachePosition != kInvalidIndex)
+    {
+        if (cachePosition < 3u)
+        {
+            // vertices of the last triangle get a fixed score so it is not reused right away
+            score = kLastTriScore;
+        }
+        else
+        {
+            const float scaler = 1.0f / static_cast<float>(kCacheSize - 3u);
+            score = powf(1.0f - static_cast<float>(cachePosition - 3u) * scaler, kCacheDecayPower);
+        }
+    }
+
+    // boost vertices with few triangles left so they get finished and do not become lonely
+    score += kValenceBoostScale * powf(static_cast<float>(remainingTriangles), -kValenceBoostPower);
+    return score;
+}
+
+// symmetric 4x4 plane quadric, double precision because errors are summed over many planes
+struct Quadric
+{
+    double a00 = 0.0, a01 = 0.0, a02 = 0.0, a11 = 0.0, a12 = 0.0, a22 = 0.0;
+    double b0 = 0.0, b1 = 0.0, b2 = 0.0;
+    double c = 0.0;
+
+    static Quadric FromPlane(double nx, double ny, double nz, double d, double weight)
+    {
+        Quadric q;
+        q.a00 = nx * nx * weight;
+        q.a01 = nx * ny * weight;
+        q.a02 = nx * nz * weight;
+        q.a11 = ny * ny * weight;
+        q.a12 = ny * nz * weight;
+        q.a22 = nz * nz * weight;
+        q.b0 = nx * d * weight;
+        q.b1 = ny * d * weight;
+        q.b2 = nz * d * weight;
+        q.c = d * d * weight;
+        return q;
+    }
+
+    Quadric &operator+=(const Quadric &other)
+    {
+        a00 += other.a00;
+        a01 += other.a01;
+        a02 += other.a02;
+        a11 += other.a11;
+        a12 += other.a12;
+        a22 += other.a22;
+        b0 += other.b0;
+        b1 += other.b1;
+        b2 += other.b2;
+        c += other.c;
+        return *this;
+    }
+
+    // sum of squared distances to the planes, weighted by area
+    double Evaluate(const float *p) const
+    {
+        const double x = p[0], y = p[1], z = p[2];
+        return a00 * x * x + a11 * y * y + a22 * z * z + 2.0 * (a01 * x * y + a02 * x * z + a12 * y * z)
+               + 2.0 * (b0 * x + b1 * y + b2 * z) + c;
+    }
+};
+
+struct Collapse
+{
+    uint32_t From; // position id that is removed
+    uint32_t To;   // position id it moves onto
+    float Error;
+};
+
+// a vertex of the removed position and the vertex at the target position it is replaced with
+struct CollapseVertex
+{
+    uint32_t From;
+    uint32_t To;
+};
+
+void TriangleNormal(const float *p0, const float *p1, const float *p2, float *outNormal)
+{
+    const float e1[3] = {p1[0] - p0[0], p1[1] - p0[1], p1[2] - p0[2]};
+    const float e2[3] = {p2[0] - p0[0], p2[1] - p0[1], p2[2] - p0[2]};
+    outNormal[0] = e1[1] * e2[2] - e1[2] * e2[1];
+    outNormal[1] = e1[2] * e2[0] - e1[0] * e2[2];
+    outNormal[2] = e1[0] * e2[1] - e1[1] * e2[0];
+}
+} // namespace
+
+MeshOptimizer::VertexCacheStatistics MeshOptimizer::AnalyzeVertexCache(const uint32_t *indices, size_t indexCount,
+                                                                        size_t vertexCount, uint32_t cacheSize)
+{
+    VertexCacheStatistics stats;
+    if (indexCount < 3u || vertexCount == 0u || cacheSize == 0u) return stats;
+
+    // FIFO cache: a vertex is cached while it was inserted less than cacheSize misses ago
+    eastl::vector<size_t> insertedAt(vertexCount, 0u);
+    size_t misses = 0u;
+    eastl::vector<bool> referenced(vertexCount, false);
+    size_t referencedCount = 0u;
+
+    for (size_t i = 0u; i < indexCount; ++i)
+    {
+        const uint32_t index = indices[i];
+        if (!referenced[index])
+        {
+            referenced[index] = true;
+            ++referencedCount;
+        }
+
+        if (insertedAt[index] == 0u || misses + 1u - insertedAt[index] > cacheSize)
+        {
+            ++misses;
+            insertedAt[index] = misses;
+        }
+    }
+
+    stats.ACMR = static_cast<float>(misses) / static_cast<float>(indexCount / 3u);
+    stats.ATVR = referencedCount ? static_cast<float>(misses) / static_cast<float>(referencedCount) : 0.0f;
+    return stats;
+}
+
+void MeshOptimizer::OptimizeVertexCache(uint32_t *indices, size_t indexCount, size_t vertexCount)
+{
+    const size_t triangleCount = indexCount / 3u;
+    if (triangleCount < 2u || vertexCount == 0u) return;
+
+    // vertex -> triangles adjacency, triangles are swap removed from the live range once emitted
+    eastl::vector<uint32_t> remaining(vertexCount, 0u);
+    for (size_t i = 0u; i < triangleCount * 3u; ++i)
+        ++remaining[indices[i]];
+
+    eastl::vector<uint32_t> adjacencyOffsets(vertexCount + 1u, 0u);
+    for (size_t v = 0u; v < vertexCount; ++v)
+        adjacencyOffsets[v + 1u] = adjacencyOffsets[v] + remaining[v];
+
+    eastl::vector<uint32_t> adjacency(triangleCount * 3u);
+    {
+        eastl::vector<uint32_t> fill(adjacencyOffsets.begin(), adjacencyOffsets.end() - 1);
+        for (size_t t = 0u; t < triangleCount; ++t)
+            for (size_t k = 0u; k < 3u; ++k)
+                adjacency[fill[indices[t * 3u + k]]++] = static_cast<uint32_t>(t);
+    }
+
+    eastl::vector<uint32_t> cachePosition(vertexCount, kInvalidIndex);
+    eastl::vector<float> vertexScores(vertexCount);
+    for (size_t v = 0u; v < vertexCount; ++v)
+        vertexScores[v] = VertexScore(kInvalidIndex, remaining[v]);
+
+    eastl::vector<bool> emitted(triangleCount, false);
+    eastl::vector<uint32_t> output(triangleCount * 3u);
+
+    // cache has room for the new triangle's vertices before the tail is dropped
+    uint32_t cache[kCacheSize + 3u];
+    uint32_t cacheCount = 0u;
+    uint32_t newCache[kCacheSize + 3u];
+
+    size_t fallbackCursor = 0u;
+    uint32_t bestTriangle = kInvalidIndex;
+
+    for (size_t outputTriangle = 0u; outputTriangle < triangleCount; ++outputTriangle)
+    {
+        if (bestTriangle == kInvalidIndex)
+        {
+            // nothing adjacent to the cache is left, continue with the next unemitted triangle in input order
+            while (emitted[fallbackCursor])
+                ++fallbackCursor;
+            bestTriangle = static_cast<uint32_t>(fallbackCursor);
+        }
+
+        emitted[bestTriangle] = true;
+        const uint32_t *triangle = indices + static_cast<size_t>(bestTriangle) * 3u;
+        memcpy(&output[outputTriangle * 3u], triangle, 3u * sizeof(uint32_t));
+
+        // emitted vertices go to the front, the rest of the cache keeps its order
+        uint32_t newCacheCount = 0u;
+        for (size_t k = 0u; k < 3u; ++k)
+        {
+            const uint32_t vertex = triangle[k];
+            newCache[newCacheCount++] = vertex;
+
+            // remove the triangle from the vertex's live adjacency
+            uint32_t *begin = adjacency.data() + adjacencyOffsets[vertex];
+            uint32_t *end = begin + remaining[vertex];
+            uint32_t *it = eastl::find(begin, end, bestTriangle);
+            *it = *(end - 1);
+            --remaining[vertex];
+        }
+        for (uint32_t i = 0u; i < cacheCount; ++i)
+        {
+            const uint32_t vertex = cache[i];
+            if (vertex != triangle[0] && vertex != triangle[1] && vertex != triangle[2])
+                newCache[newCacheCount++] = vertex;
+        }
+
+        // vertices pushed out of the cache lose their cache score
+        for (uint32_t i = kCacheSize; i < newCacheCount; ++i)
+        {
+            cachePosition[newCache[i]] = kInvalidIndex;
+            vertexScores[newCache[i]] = VertexScore(kInvalidIndex, remaining[newCache[i]]);
+        }
+        cacheCount = eastl::min(newCacheCount, kCacheSize);
+        memcpy(cache, newCache, cacheCount * sizeof(uint32_t));
+
+        // rescore the cache and pick the best triangle touching it
+        for (uint32_t i = 0u; i < cacheCount; ++i)
+        {
+            cachePosition[cache[i]] = i;
+            vertexScores[cache[i]] = VertexScore(i, remaining[cache[i]]);
+        }
+
+        bestTriangle = kInvalidIndex;
+        float bestScore = -1.0f;
+        for (uint32_t i = 0u; i < cacheCount; ++i)
+        {
+            const uint32_t vertex = cache[i];
+            const uint32_t *begin = adjacency.data() + adjacencyOffsets[vertex];
+            for (uint32_t j = 0u; j < remaining[vertex]; ++j)
+            {
+                const uint32_t t = begin[j];
+                const float score = vertexScores[indices[t * 3u]] + vertexScores[indices[t * 3u + 1u]]
+                                    + vertexScores[indices[t * 3u + 2u]];
+                if (score > bestScore)
+                {
+                    bestScore = score;
+                    bestTriangle = t;
+                }
+            }
+        }
+    }
+
+    memcpy(indices, output.data(), output.size() * sizeof(uint32_t));
+}
+
+void MeshOptimizer::OptimizeOverdraw(uint32_t *indices, size_t indexCount, const float *positions, size_t vertexCount,
+                                     size_t positionStride)
+{
+    const size_t triangleCount = indexCount / 3u;
+    if (triangleCount < 2u || vertexCount == 0u) return;
+
+    const auto position = [positions, positionStride](uint32_t index) {
+        return reinterpret_cast<const float *>(reinterpret_cast<const uint8_t *>(positions) + index * positionStride);
+    };
+
+    // split into clusters where all three vertices of a triangle miss the cache, reordering there costs no ACMR
+    eastl::vector<uint32_t> clusterStarts;
+    {
+        eastl::vector<size_t> insertedAt(vertexCount, 0u);
+        size_t misses = 0u;
+        for (size_t t = 0u; t < triangleCount; ++t)
+        {
+            uint32_t triangleMisses = 0u;
+            for (size_t k = 0u; k < 3u; ++k)
+            {
+                const uint32_t index = indices[t * 3u + k];
+                if (insertedAt[index] == 0u || misses + 1u - insertedAt[index] > kOverdrawCacheSize)
+                {
+                    ++misses;
+                    ++triangleMisses;
+                    insertedAt[index] = misses;
+                }
+            }
+            if (t == 0u || triangleMisses == 3u) clusterStarts.push_back(static_cast<uint32_t>(t));
+        }
+    }
+    if (clusterStarts.size() < 2u) return;
+
+    struct Cluster
+    {
+        uint32_t FirstTriangle = 0u;
+        uint32_t TriangleCount = 0u;
+        float WeightedCentroid[3] = {0.0f, 0.0f, 0.0f}; // sum of triangle centroids * area
+        float Normal[3] = {0.0f, 0.0f, 0.0f};           // sum of unnormalized triangle normals
+        float Area = 0.0f;
+        float SortKey = 0.0f;
+    };
+    eastl::vector<Cluster> clusters(clusterStarts.size());
+
+    // area weighted mesh centroid
+    float meshCentroid[3] = {0.0f, 0.0f, 0.0f};
+    float meshArea = 0.0f;
+
+    for (size_t c = 0u; c < clusterStarts.size(); ++c)
+    {
+        Cluster &cluster = clusters[c];
+        cluster.FirstTriangle = clusterStarts[c];
+        const uint32_t last =
+            c + 1u < clusterStarts.size() ? clusterStarts[c + 1u] : static_cast<uint32_t>(triangleCount);
+        cluster.TriangleCount = last - cluster.FirstTriangle;
+
+        for (uint32_t t = cluster.FirstTriangle; t < last; ++t)
+        {
+            const float *p0 = position(indices[t * 3u]);
+            const float *p1 = position(indices[t * 3u + 1u]);
+            const float *p2 = position(indices[t * 3u + 2u]);
+
+            const float e1[3] = {p1[0] - p0[0], p1[1] - p0[1], p1[2] - p0[2]};
+            const float e2[3] = {p2[0] - p0[0], p2[1] - p0[1], p2[2] - p0[2]};
+            // unnormalized normal, its length is twice the area
+            const float n[3] = {e1[1] * e2[2] - e1[2] * e2[1], e1[2] * e2[0] - e1[0] * e2[2],
+                                e1[0] * e2[1] - e1[1] * e2[0]};
+            const float area = sqrtf(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]) * 0.5f;
+
+            for (size_t k = 0u; k < 3u; ++k)
+            {
+                cluster.WeightedCentroid[k] += (p0[k] + p1[k] + p2[k]) / 3.0f * area;
+                cluster.Normal[k] += n[k];
+            }
+            cluster.Area += area;
+        }
+
+        for (size_t k = 0u; k < 3u; ++k)
+            meshCentroid[k] += cluster.WeightedCentroid[k];
+        meshArea += cluster.Area;
+    }
+
+    if (meshArea <= 0.0f) return;
+    for (size_t k = 0u; k < 3u; ++k)
+        meshCentroid[k] /= meshArea;
+
+    for (Cluster &cluster : clusters)
+    {
+        const float normalLength = sqrtf(cluster.Normal[0] * cluster.Normal[0] + cluster.Normal[1] * cluster.Normal[1]
+                                         + cluster.Normal[2] * cluster.Normal[2]);
+        if (cluster.Area <= 0.0f || normalLength <= 0.0f) continue;
+
+        // clusters facing away from the mesh center are likely to occlude the others, draw them first
+        for (size_t k = 0u; k < 3u; ++k)
+            cluster.SortKey +=
+                (cluster.WeightedCentroid[k] / cluster.Area - meshCentroid[k]) * (cluster.Normal[k] / normalLength);
+    }
+
+    eastl::stable_sort(clusters.begin(), clusters.end(),
+                       [](const Cluster &a, const Cluster &b) { return a.SortKey > b.SortKey; });
+
+    eastl::vector<uint32_t> output;
+    output.reserve(triangleCount * 3u);
+    for (const Cluster &cluster : clusters)
+        output.insert(output.end(), indices + cluster.FirstTriangle * 3u,
+                      indices + (cluster.FirstTriangle + cluster.TriangleCount) * 3u);
+
+    memcpy(indices, output.data(), output.size() * sizeof(uint32_t));
+}
+
+size_t MeshOptimizer::OptimizeVertexFetch(void *vertices, uint32_t *indices, size_t indexCount, size_t vertexCount,
+                                          size_t vertexStride)
+{
+    if (vertexCount == 0u) return 0u;
+
+    eastl::vector<uint32_t> remap(vertexCount, kInvalidIndex);
+    uint32_t nextVertex = 0u;
+    for (size_t i = 0u; i < indexCount; ++i)
+    {
+        uint32_t &target = remap[indices[i]];
+        if (target == kInvalidIndex) target = nextVertex++;
+        indices[i] = target;
+    }
+    const size_t referencedCount = nextVertex;
+
+    // keep unreferenced vertices so vertex ranges of the model stay valid
+    for (size_t v = 0u; v < vertexCount; ++v)
+        if (remap[v] == kInvalidIndex) remap[v] = nextVertex++;
+
+    const uint8_t *source = static_cast<const uint8_t *>(vertices);
+    eastl::vector<uint8_t> reordered(vertexCount * vertexStride);
+    for (size_t v = 0u; v < vertexCount; ++v)
+        memcpy(&reordered[remap[v] * vertexStride], source + v * vertexStride, vertexStride);
+
+    memcpy(vertices, reordered.data(), reordered.size());
+    return referencedCount;
+}
+
+size_t MeshOptimizer::Simplify(uint32_t *destination, const uint32_t *indices, size_t indexCount,
+                               const float *positions, size_t vertexCount, size_t positionStride,
+                               size_t targetIndexCount, float targetError, float *outResultError)
+{
+    memcpy(destination, indices, indexCount * sizeof(uint32_t));
+    if (outResultError) *outResultError = 0.0f;
+    if (indexCount <= targetIndexCount || vertexCount == 0u) return indexCount;
+
+    const auto position = [positions, positionStride](uint32_t index) {
+        return reinterpret_cast<const float *>(reinterpret_cast<const uint8_t *>(positions) + index * positionStride);
+    };
+
+    // vertices split by normals or uvs share a position id, quadrics and topology work on position ids
+    eastl::vector<uint32_t> positionIds(vertexCount);
+    size_t positionCount = 0u;
+    {
+        eastl::vector<uint32_t> sorted(vertexCount);
+        for (size_t v = 0u; v < vertexCount; ++v)
+            sorted[v] = static_cast<uint32_t>(v);
+        eastl::sort(sorted.begin(), sorted.end(), [&position](uint32_t a, uint32_t b) {
+            return memcmp(position(a), position(b), 3u * sizeof(float)) < 0;
+        });
+
+        for (size_t i = 0u; i < vertexCount; ++i)
+        {
+            const bool samePosition =
+                i > 0u && memcmp(position(sorted[i]), position(sorted[i - 1u]), 3u * sizeof(float)) == 0;
+            if (!samePosition) ++positionCount;
+            positionIds[sorted[i]] = static_cast<uint32_t>(positionCount - 1u);
+        }
+    }
+
+    // representative vertex of every position id
+    eastl::vector<uint32_t> positionVertex(positionCount);
+    for (size_t v = 0u; v < vertexCount; ++v)
+        positionVertex[positionIds[v]] = static_cast<uint32_t>(v);
+
+    // an edge used by a single triangle is a border, its ends are locked
+    eastl::vector<bool> locked(positionCount, false);
+    {
+        eastl::vector<uint64_t> edges;
+        edges.reserve(indexCount);
+        for (size_t i = 0u; i < indexCount; i += 3u)
+        {
+            for (size_t k = 0u; k < 3u; ++k)
+            {
+                uint32_t a = positionIds[indices[i + k]];
+                uint32_t b = positionIds[indices[i + (k + 1u) % 3u]];
+                if (a > b) eastl::swap(a, b);
+                edges.push_back((static_cast<uint64_t>(a) << 32u) | b);
+            }
+        }
+        eastl::sort(edges.begin(), edges.end());
+
+        for (size_t i = 0u; i < edges.size();)
+        {
+            size_t j = i + 1u;
+            while (j < edges.size() && edges[j] == edges[i])
+                ++j;
+            if (j - i == 1u)
+            {
+                locked[static_cast<uint32_t>(edges[i] >> 32u)] = true;
+                locked[static_cast<uint32_t>(edges[i] & 0xffffffffu)] = true;
+            }
+            i = j;
+        }
+    }
+
+    // area weighted, the error of a position is the average squared distance to its planes
+    eastl::vector<Quadric> quadrics(positionCount);
+    eastl::vector<double> quadricWeights(positionCount, 0.0);
+    for (size_t i = 0u; i < indexCount; i += 3u)
+    {
+        const float *p0 = position(indices[i]);
+        float normal[3];
+        TriangleNormal(p0, position(indices[i + 1u]), position(indices[i + 2u]), normal);
+
+        const double length = sqrt(static_cast<double>(normal[0]) * normal[0]
+                                   + static_cast<double>(normal[1]) * normal[1]
+                                   + static_cast<double>(normal[2]) * normal[2]);
+        if (length <= 0.0) continue;
+
+        const double nx = normal[0] / length, ny = normal[1] / length, nz = normal[2] / length;
+        const double d = -(nx * p0[0] + ny * p0[1] + nz * p0[2]);
+        const double area = length * 0.5;
+        const Quadric q = Quadric::FromPlane(nx, ny, nz, d, area);
+        for (size_t k = 0u; k < 3u; ++k)
+        {
+            quadrics[positionIds[indices[i + k]]] += q;
+            quadricWeights[positionIds[indices[i + k]]] += area;
+        }
+    }
+
+    const auto collapseError = [&](uint32_t from, uint32_t to) {
+        Quadric q = quadrics[from];
+        q += quadrics[to];
+        const double weight = quadricWeights[from] + quadricWeights[to];
+        const double error = weight > 0.0 ? eastl::max(q.Evaluate(position(positionVertex[to])), 0.0) / weight : 0.0;
+        return static_cast<float>(sqrt(error));
+    };
+
+    size_t currentCount = indexCount;
+    float resultError = 0.0f;
+
+    eastl::vector<uint32_t> adjacencyOffsets(positionCount + 1u);
+    eastl::vector<uint32_t> adjacency;
+    eastl::vector<Collapse> collapses;
+    eastl::vector<bool> touched(positionCount);
+    eastl::vector<uint32_t> vertexRemap(vertexCount);
+    eastl::vector<CollapseVertex> collapseVertices;
+
+    // every pass collapses an independent set of the cheapest edges, then rebuilds the topology
+    while (currentCount > targetIndexCount)
+    {
+        const size_t triangleCount = currentCount / 3u;
+
+        eastl::fill(adjacencyOffsets.begin(), adjacencyOffsets.end(), 0u);
+        for (size_t i = 0u; i < currentCount; ++i)
+            ++adjacencyOffsets[positionIds[destination[i]] + 1u];
+        for (size_t p = 0u; p < positionCount; ++p)
+            adjacencyOffsets[p + 1u] += adjacencyOffsets[p];
+        adjacency.resize(currentCount);
+        {
+            eastl::vector<uint32_t> fill(adjacencyOffsets.begin(), adjacencyOffsets.end() - 1);
+            for (size_t i = 0u; i < currentCount; ++i)
+                adjacency[fill[positionIds[destination[i]]]++] = static_cast<uint32_t>(i / 3u);
+        }
+
+        collapses.clear();
+        for (size_t t = 0u; t < triangleCount; ++t)
+        {
+            for (size_t k = 0u; k < 3u; ++k)
+            {
+                const uint32_t a = positionIds[destination[t * 3u + k]];
+                const uint32_t b = positionIds[destination[t * 3u + (k + 1u) % 3u]];
+                // interior edges are seen from both triangles, take one of them
+                if (a >= b) continue;
+
+                Collapse best = {0u, 0u, FLT_MAX};
+                if (!locked[a]) best = {a, b, collapseError(a, b)};
+                if (!locked[b])
+                {
+                    const float error = collapseError(b, a);
+                    if (error < best.Error) best = {b, a, error};
+                }
+                if (best.Error <= targetError) collapses.push_back(best);
+            }
+        }
+        if (collapses.empty()) break;
+
+        eastl::sort(collapses.begin(), collapses.end(),
+                    [](const Collapse &a, const Collapse &b) { return a.Error < b.Error; });
+
+        eastl::fill(touched.begin(), touched.end(), false);
+        for (size_t v = 0u; v < vertexCount; ++v)
+            vertexRemap[v] = static_cast<uint32_t>(v);
+
+        // an interior collapse removes two triangles
+        const size_t trianglesToRemove = (currentCount - targetIndexCount + 2u) / 3u;
+        size_t removed = 0u;
+        size_t applied = 0u;
+
+        for (const Collapse &collapse : collapses)
+        {
+            if (removed >= trianglesToRemove) break;
+            if (touched[collapse.From] || touched[collapse.To]) continue;
+
+            // every vertex of From moves onto the vertex at To it shares an edge with. On an attribute seam that
+            // holds only for collapses along the seam, where both sides go to their own vertex at To. A vertex
+            // without such an edge, or two vertices sharing one, would tear the seam apart.
+            collapseVertices.clear();
+            bool isConsistent = true;
+            for (uint32_t j = adjacencyOffsets[collapse.From]; j < adjacencyOffsets[collapse.From + 1u] && isConsistent;
+                 ++j)
+            {
+                const uint32_t *triangle = destination + adjacency[j] * 3u;
+                CollapseVertex pair = {kInvalidIndex, kInvalidIndex};
+                for (size_t k = 0u; k < 3u; ++k)
+                {
+                    const uint32_t p = positionIds[triangle[k]];
+                    if (p == collapse.From) pair.From = triangle[k];
+                    else if (p == collapse.To) pair.To = triangle[k];
+                }
+
+                auto known = eastl::find_if(collapseVertices.begin(), collapseVertices.end(),
+                                            [&pair](const CollapseVertex &v) { return v.From == pair.From; });
+                if (known == collapseVertices.end()) collapseVertices.push_back(pair);
+                else if (known->To == kInvalidIndex) known->To = pair.To;
+                else isConsistent = pair.To == kInvalidIndex || pair.To == known->To;
+            }
+            for (size_t i = 0u; i < collapseVertices.size() && isConsistent; ++i)
+            {
+                isConsistent = collapseVertices[i].To != kInvalidIndex;
+                for (size_t j = 0u; j < i && isConsistent; ++j)
+                    isConsistent = collapseVertices[j].To != collapseVertices[i].To;
+            }
+            if (!isConsistent) continue;
+
+            // reject collapses that flip a triangle of the fan around From
+            bool flips = false;
+            const float *target = position(positionVertex[collapse.To]);
+            for (uint32_t j = adjacencyOffsets[collapse.From]; j < adjacencyOffsets[collapse.From + 1u] && !flips; ++j)
+            {
+                const uint32_t *triangle = destination + adjacency[j] * 3u;
+                const float *corners[3];
+                const float *moved[3];
+                bool hasTo = false;
+                for (size_t k = 0u; k < 3u; ++k)
+                {
+                    const uint32_t p = positionIds[triangle[k]];
+                    hasTo |= p == collapse.To;
+                    corners[k] = position(triangle[k]);
+                    moved[k] = p == collapse.From ? target : corners[k];
+                }
+                if (hasTo) continue;
+
+                float before[3], after[3];
+                TriangleNormal(corners[0], corners[1], corners[2], before);
+                TriangleNormal(moved[0], moved[1], moved[2], after);
+                flips = before[0] * after[0] + before[1] * after[1] + before[2] * after[2] <= 0.0f;
+            }
+            if (flips) continue;
+
+            // the fan changes shape, collapses touching it wait for the next pass
+            for (uint32_t j = adjacencyOffsets[collapse.From]; j < adjacencyOffsets[collapse.From + 1u]; ++j)
+                for (size_t k = 0u; k < 3u; ++k)
+                    touched[positionIds[destination[adjacency[j] * 3u + k]]] = true;
+
+            for (const CollapseVertex &vertex : collapseVertices)
+                vertexRemap[vertex.From] = vertex.To;
+            quadrics[collapse.To] += quadrics[collapse.From];
+            quadricWeights[collapse.To] += quadricWeights[collapse.From];
+
+            resultError = eastl::max(resultError, collapse.Error);
+            removed += 2u;
+            ++applied;
+        }
+        if (applied == 0u) break;
+
+        // remap and drop the triangles that became degenerate
+        size_t writeCount = 0u;
+        for (size_t i = 0u; i < currentCount; i += 3u)
+        {
+            const uint32_t v0 = vertexRemap[destination[i]];
+            const uint32_t v1 = vertexRemap[destination[i + 1u]];
+            const uint32_t v2 = vertexRemap[destination[i + 2u]];
+            const uint32_t p0 = positionIds[v0], p1 = positionIds[v1], p2 = positionIds[v2];
+            if (p0 == p1 || p1 == p2 || p0 == p2) continue;
+
+            destination[writeCount++] = v0;
+            destination[writeCount++] = v1;
+            destination[writeCount++] = v2;
+        }
+        currentCount = writeCount;
+    }
+
+    if (outResultError) *outResultError = resultError;
+    return currentCount;
+}
@@ -5,6 +5,7 @@
 
 #include "ComponentRegistry.h"
 #include "components/PrefabComponent.h"
+#include "subsystems/PrefabSubsystem.h"
 
 namespace Blainn
 {
@@ -32,15 +33,18 @@ void Serializer::CreatePrefab(Entity &entity, const Path &relativePath)
         {
             if (typeId == entt::type_hash<RelationshipComponent>::value())
             {
+                // one key for all children, a key per child is a duplicate key and only the first child loads
+                if (entity.Children().empty()) continue;
+
+                out << YAML::Key << "RelationshipComponent" << YAML::Value << YAML::BeginMap;
+                out << YAML::Key << "Entities" << YAML::Value << YAML::BeginSeq; // Entities
                 for (auto childID : entity.Children())
                 {
-                    out << YAML::Key << "RelationshipComponent" << YAML::Value << YAML::BeginMap;
-                    out << YAML::Key << "Entities" << YAML::Value << YAML::BeginSeq; // Entities
                     auto child = Engine::GetSceneManager().TryGetEntityWithUUID(childID);
                     fn(child, out);
-                    out << YAML::EndSeq;
-                    out << YAML::EndMap;
                 }
+                out << YAML::EndSeq;
+                out << YAML::EndMap;
 
                 continue;
             }
@@ -67,6 +71,8 @@ void Serializer::CreatePrefab(Entity &entity, const Path &relativePath)
 
     std::ofstream fout(absolutePath);
     fout << out.c_str();
+    fout.close();
+    PrefabSubsystem::GetInstance().UpdatePrefabRefs(relativePath);
 
     BF_DEBUG("Created prefab {}", relativePath.string());
 }
@@ -187,9 +193,9 @@ void Serializer::Mesh(Entity &entity, YAML::Emitter &out)
     out << YAML::Key << "MeshComponent" << YAML::Value << YAML::BeginMap;
     out << YAML::Key << "Enabled" << YAML::Value << mesh.Enabled;
     out << YAML::Key << "IsWalkable" << YAML::Value << mesh.IsWalkable;
-    out << YAML::Key << "Path" << YAML::Value << AssetManager::GetInstance().GetMeshPath(*mesh.MeshHandle).string();
+    out << YAML::Key << "Path" << YAML::Value << AssetManager::GetInstance().GetMeshPath(mesh.MeshHandle).string();
     out << YAML::Key << "Material" << YAML::Value
-        << AssetManager::GetInstance().GetMaterialPath(*mesh.MaterialHandle).string();
+        << AssetManager::GetInstance().GetMaterialPath(mesh.MaterialHandle).string();
     out << YAML::EndMap;
 }
 
@@ -286,7 +292,7 @@ void Serializer::Skybox(Entity &entity, YAML::Emitter &out)
     auto skybox = entity.GetComponent<SkyboxComponent>();
     out << YAML::Key << "SkyboxComponent" << YAML::Value << YAML::BeginMap;
     out << YAML::Key << "Path" << YAML::Value
-        << AssetManager::GetInstance().GetTexturePath(*skybox.textureHandle).string();
+        << AssetManager::GetInstance().GetTexturePath(skybox.textureHandle).string();
     out << YAML::EndMap;
 }
 
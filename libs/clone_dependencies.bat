@@ -16,6 +16,7 @@ https://github.com/skypjack/entt.git ^
 https://github.com/cameron314/concurrentqueue.git ^
 https://github.com/GPUOpen-LibrariesAndSDKs/D3D12MemoryAllocator.git ^
 https://github.com/microsoft/DirectXTex.git ^
+https://github.com/nothings/stb.git ^
 https://github.com/wqking/eventpp.git ^
 https://github.com/recastnavigation/recastnavigation.git ^
 https://github.com/ocornut/imgui.git ^
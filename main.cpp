@@ -14,6 +14,7 @@
 #endif
 
 #include "engine/include/Engine.h"
+#include "engine/include/file-system/Model.h"
 #include "engine/include/tools/Timeline.h"
 
 #define MAX_NAME_STRING 256
@@ -41,11 +42,18 @@ int main(int argc, char **argv)
 
     WindowWidth = 1280;
     WindowHeight = 720;
+
+    // navmeshes are baked in the editor, a standalone build doesn't need mesh data after GPU upload
+    Blainn::Model::SetKeepCPUDataAfterUpload(false);
 #endif
 
+    // offline cooks run instead of Engine::Init, without the device, job system, physics or scene
+    if (argc > 1 && strncmp(argv[1], "--cook-", 7) == 0) return Blainn::Engine::Cook(argv[1]) ? 0 : 1;
+
     Blainn::Timeline<eastl::chrono::milliseconds> globalTimeline{nullptr};
 
     Blainn::Engine::Init(globalTimeline);
+
     HWND hwnd = NULL;
 
 #if defined(BLAINN_INCLUDE_EDITOR)
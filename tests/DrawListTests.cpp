@@ -0,0 +1,187 @@
+#include "TestFramework.h"
+
+#include "Render/DrawList.h"
+
+#include <EASTL/vector.h>
+#include <algorithm>
+#include <cstdint>
+#include <random>
+
+using namespace Blainn;
+
+namespace
+{
+// std::stable_sort by key is the reference, ties keep insertion order
+bool SortsLikeStableSort(const eastl::vector<uint64_t> &keys)
+{
+    DrawList drawList;
+    eastl::vector<DrawList::Item> expected;
+    for (uint32_t i = 0; i < keys.size(); ++i)
+    {
+        drawList.Add(keys[i], i);
+        expected.push_back({keys[i], i});
+    }
+    std::stable_sort(expected.begin(), expected.end(),
+                     [](const DrawList::Item &a, const DrawList::Item &b) { return a.Key < b.Key; });
+
+    drawList.Sort();
+    const auto &items = drawList.GetItems();
+    bool matches = items.size() == expected.size();
+    for (size_t i = 0; i < items.size() && matches; ++i)
+        matches = items[i].Key == expected[i].Key && items[i].Index == expected[i].Index;
+    return matches;
+}
+
+// every item in exactly one batch, batches in order, equal batch keys inside, at most maxInstances long,
+// and a new batch starts only where the key changes or the previous one is full
+bool AreBatchesValid(const DrawList &drawList, uint32_t maxInstances)
+{
+    const auto &items = drawList.GetItems();
+    const auto &batches = drawList.GetBatches();
+
+    uint32_t next = 0;
+    for (size_t b = 0; b < batches.size(); ++b)
+    {
+        const DrawList::Batch &batch = batches[b];
+        if (batch.FirstItem != next || batch.ItemCount == 0 || batch.ItemCount > maxInstances) return false;
+
+        const uint64_t batchKey = DrawSortKey::GetBatchKey(items[batch.FirstItem].Key);
+        for (uint32_t i = batch.FirstItem; i < batch.FirstItem + batch.ItemCount; ++i)
+            if (DrawSortKey::GetBatchKey(items[i].Key) != batchKey) return false;
+
+        if (b > 0 && batches[b - 1].ItemCount < maxInstances
+            && DrawSortKey::GetBatchKey(items[batch.FirstItem - 1].Key) == batchKey)
+            return false;
+        next += batch.ItemCount;
+    }
+    return next == items.size();
+}
+} // namespace
+
+BLAINN_TEST(SortKeyFieldsRoundTrip)
+{
+    const uint64_t key = DrawSortKey::Make(3u, 17u, 1234u, 56789u, 42u);
+    BLAINN_CHECK(DrawSortKey::GetPipeline(key) == 17u);
+    BLAINN_CHECK(DrawSortKey::GetMesh(key) == 56789u);
+    BLAINN_CHECK(DrawSortKey::GetBatchKey(key) == DrawSortKey::GetBatchKey(DrawSortKey::Make(3u, 17u, 1234u, 56789u, 7u)));
+    BLAINN_CHECK(DrawSortKey::GetBatchKey(key) != DrawSortKey::GetBatchKey(DrawSortKey::Make(3u, 17u, 1235u, 56789u, 42u)));
+
+    // material handles use 20 index bits, the highest one still tells batches apart
+    BLAINN_CHECK(DrawSortKey::GetBatchKey(DrawSortKey::Make(0u, 0u, 1u << 19u, 0u, 0u)) != 0u);
+
+    // fields are masked, an overflowing one never spills into its neighbour
+    const uint64_t overflow = DrawSortKey::Make(0u, 0u, 0u, 1u << DrawSortKey::MeshBits, ~0u);
+    BLAINN_CHECK(DrawSortKey::GetMesh(overflow) == 0u);
+    BLAINN_CHECK(DrawSortKey::GetBatchKey(overflow) == 0u);
+
+    // pass is the most significant field, depth the least
+    BLAINN_CHECK(DrawSortKey::Make(1u, 0u, 0u, 0u, 0u) > DrawSortKey::Make(0u, ~0u, ~0u, ~0u, ~0u));
+    BLAINN_CHECK(DrawSortKey::Make(0u, 0u, 0u, 1u, 0u) > DrawSortKey::Make(0u, 0u, 0u, 0u, ~0u));
+}
+
+BLAINN_TEST(QuantizeDepthIsMonotonicAndClamped)
+{
+    const uint32_t maxDepth = (1u << DrawSortKey::DepthBits) - 1u;
+    BLAINN_CHECK(DrawSortKey::QuantizeDepth(-1.0f, 100.0f) == 0u);
+    BLAINN_CHECK(DrawSortKey::QuantizeDepth(0.0f, 100.0f) == 0u);
+    BLAINN_CHECK(DrawSortKey::QuantizeDepth(100.0f, 100.0f) == maxDepth);
+    BLAINN_CHECK(DrawSortKey::QuantizeDepth(1e9f, 100.0f) == maxDepth);
+    BLAINN_CHECK(DrawSortKey::QuantizeDepth(10.0f, 0.0f) == 0u);
+
+    bool isMonotonic = true;
+    uint32_t previous = 0u;
+    for (int i = 0; i <= 1000; ++i)
+    {
+        const uint32_t depth = DrawSortKey::QuantizeDepth(static_cast<float>(i) * 0.1f, 100.0f);
+        isMonotonic &= depth >= previous;
+        previous = depth;
+    }
+    BLAINN_CHECK(isMonotonic);
+}
+
+BLAINN_TEST(SortMatchesStableSortOnRandomKeys)
+{
+    std::mt19937_64 random(1u);
+    for (const size_t count : {size_t(0), size_t(1), size_t(2), size_t(3), size_t(257), size_t(5000)})
+    {
+        eastl::vector<uint64_t> keys(count);
+        for (uint64_t &key : keys)
+            key = random();
+        BLAINN_CHECK(SortsLikeStableSort(keys));
+    }
+}
+
+BLAINN_TEST(SortMatchesStableSortWithConstantBytes)
+{
+    std::mt19937_64 random(2u);
+
+    // only some bytes vary, the skipped passes must not change the order of the others
+    for (const uint64_t varyingMask : {0x00000000000000FFull, 0x0000FF0000FF0000ull, 0xFF000000000000FFull,
+                                       0x00FFFF0000000F00ull, 0x0000000000000000ull})
+    {
+        const uint64_t constantBits = random() & ~varyingMask;
+        eastl::vector<uint64_t> keys(3000);
+        for (uint64_t &key : keys)
+            key = constantBits | (random() & varyingMask);
+        BLAINN_CHECK(SortsLikeStableSort(keys));
+    }
+
+    // what the renderer produces: one pass, few pipelines and materials, many duplicates
+    eastl::vector<uint64_t> keys(4000);
+    for (uint64_t &key : keys)
+    {
+        const uint32_t value = static_cast<uint32_t>(random());
+        key = DrawSortKey::Make(1u, value % 3u, (value >> 4) % 7u, (value >> 8) % 11u, (value >> 12) % 5u);
+    }
+    BLAINN_CHECK(SortsLikeStableSort(keys));
+}
+
+BLAINN_TEST(BuildBatchesSplitsAtKeyChangesAndMaxInstances)
+{
+    DrawList drawList;
+    // five of one mesh at different depths, three of another
+    for (uint32_t i = 0; i < 5; ++i)
+        drawList.Add(DrawSortKey::Make(0u, 1u, 2u, 3u, i), i);
+    for (uint32_t i = 0; i < 3; ++i)
+        drawList.Add(DrawSortKey::Make(0u, 1u, 2u, 4u, i), 5u + i);
+    drawList.Sort();
+
+    drawList.BuildBatches();
+    const auto &batches = drawList.GetBatches();
+    BLAINN_CHECK(batches.size() == 2);
+    BLAINN_CHECK(batches.size() == 2 && batches[0].FirstItem == 0 && batches[0].ItemCount == 5);
+    BLAINN_CHECK(batches.size() == 2 && batches[1].FirstItem == 5 && batches[1].ItemCount == 3);
+
+    drawList.BuildBatches(2u);
+    const uint32_t expected[][2] = {{0, 2}, {2, 2}, {4, 1}, {5, 2}, {7, 1}};
+    BLAINN_CHECK(batches.size() == 5);
+    for (size_t b = 0; b < batches.size() && b < 5; ++b)
+        BLAINN_CHECK(batches[b].FirstItem == expected[b][0] && batches[b].ItemCount == expected[b][1]);
+
+    drawList.BuildBatches(0u);
+    BLAINN_CHECK(batches.empty());
+}
+
+BLAINN_TEST(BuildBatchesCoversRandomSortedItems)
+{
+    std::mt19937 random(3u);
+    DrawList drawList;
+    for (uint32_t i = 0; i < 3000; ++i)
+    {
+        const uint32_t value = static_cast<uint32_t>(random());
+        drawList.Add(DrawSortKey::Make(value % 2u, (value >> 1) % 3u, (value >> 3) % 4u, (value >> 5) % 6u,
+                                       value >> 8),
+                     i);
+    }
+    drawList.Sort();
+
+    for (const uint32_t maxInstances : {1u, 3u, 64u, UINT32_MAX})
+    {
+        drawList.BuildBatches(maxInstances);
+        BLAINN_CHECK(AreBatchesValid(drawList, maxInstances));
+    }
+
+    drawList.Clear();
+    drawList.BuildBatches();
+    BLAINN_CHECK(drawList.GetBatches().empty());
+}
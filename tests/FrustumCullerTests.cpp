@@ -0,0 +1,303 @@
+#include "TestFramework.h"
+
+#include "Render/FrustumCuller.h"
+
+#include <EASTL/vector.h>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <random>
+
+using namespace Blainn;
+
+namespace
+{
+using Matrix = float[4][4];
+
+// row vector layout, p * a * b
+void Multiply(const Matrix &a, const Matrix &b, Matrix &out)
+{
+    for (int r = 0; r < 4; ++r)
+        for (int c = 0; c < 4; ++c)
+            out[r][c] = a[r][0] * b[0][c] + a[r][1] * b[1][c] + a[r][2] * b[2][c] + a[r][3] * b[3][c];
+}
+
+// left handed, same as XMMatrixPerspectiveFovLH
+void Perspective(float fovY, float aspect, float nearZ, float farZ, Matrix &out)
+{
+    const float yScale = 1.0f / std::tan(fovY * 0.5f);
+    const float range = farZ / (farZ - nearZ);
+    const Matrix m = {{yScale / aspect, 0, 0, 0}, {0, yScale, 0, 0}, {0, 0, range, 1}, {0, 0, -range * nearZ, 0}};
+    memcpy(out, m, sizeof(m));
+}
+
+// same as XMMatrixOrthographicLH
+void Orthographic(float width, float height, float nearZ, float farZ, Matrix &out)
+{
+    const float range = 1.0f / (farZ - nearZ);
+    const Matrix m = {{2.0f / width, 0, 0, 0}, {0, 2.0f / height, 0, 0}, {0, 0, range, 0}, {0, 0, -range * nearZ, 1}};
+    memcpy(out, m, sizeof(m));
+}
+
+// a camera at eye turned by yaw around y, the inverse of its world transform
+void View(float eyeX, float eyeY, float eyeZ, float yaw, Matrix &out)
+{
+    const float c = std::cos(yaw), s = std::sin(yaw);
+    const Matrix m = {{c, 0, s, 0},
+                      {0, 1, 0, 0},
+                      {-s, 0, c, 0},
+                      {-(eyeX * c - eyeZ * s), -eyeY, -(eyeX * s + eyeZ * c), 1}};
+    memcpy(out, m, sizeof(m));
+}
+
+FrustumPlanes MakePerspectiveFrustum(float eyeX, float eyeZ, float yaw, float farZ)
+{
+    Matrix view, projection, viewProjection;
+    View(eyeX, 1.0f, eyeZ, yaw, view);
+    Perspective(1.0f, 16.0f / 9.0f, 0.1f, farZ, projection);
+    Multiply(view, projection, viewProjection);
+    return FrustumPlanes::FromViewProjection(viewProjection);
+}
+
+FrustumPlanes MakeOrthographicFrustum(float eyeX, float eyeZ, float yaw)
+{
+    Matrix view, projection, viewProjection;
+    View(eyeX, 0.0f, eyeZ, yaw, view);
+    Orthographic(30.0f, 20.0f, -10.0f, 40.0f, projection);
+    Multiply(view, projection, viewProjection);
+    return FrustumPlanes::FromViewProjection(viewProjection);
+}
+
+struct Sphere
+{
+    float X, Y, Z, Radius;
+};
+
+// scalar reference in double, the smallest signed distance of the sphere surface to the planes
+double GetMargin(const FrustumPlanes &frustum, const Sphere &sphere)
+{
+    double margin = INFINITY;
+    for (const auto &plane : frustum.Planes)
+    {
+        const double distance = static_cast<double>(plane[0]) * sphere.X + static_cast<double>(plane[1]) * sphere.Y
+                                + static_cast<double>(plane[2]) * sphere.Z + static_cast<double>(plane[3]);
+        margin = std::fmin(margin, distance + sphere.Radius);
+    }
+    return margin;
+}
+
+// spheres this close to a plane may go either way in float
+constexpr double kAmbiguousMargin = 1e-3;
+
+eastl::vector<Sphere> MakeRandomSpheres(size_t count, uint32_t seed)
+{
+    std::mt19937 random(seed);
+    std::uniform_real_distribution<float> position(-60.0f, 60.0f);
+    std::uniform_real_distribution<float> radius(0.0f, 4.0f);
+    eastl::vector<Sphere> spheres(count);
+    for (Sphere &sphere : spheres)
+        sphere = {position(random), position(random) * 0.25f, position(random), radius(random)};
+    return spheres;
+}
+
+void AddSpheres(FrustumCuller &culler, const eastl::vector<Sphere> &spheres)
+{
+    culler.Clear();
+    culler.Reserve(spheres.size());
+    for (const Sphere &sphere : spheres)
+        culler.AddSphere(sphere.X, sphere.Y, sphere.Z, sphere.Radius);
+}
+
+// the result has to be in insertion order and agree with the reference except for ambiguous spheres
+bool MatchesReference(const eastl::vector<Sphere> &spheres, const FrustumPlanes *frustums, size_t frustumCount,
+                      const eastl::vector<uint32_t> &visible)
+{
+    bool matches = true;
+    size_t next = 0;
+    for (uint32_t i = 0; i < spheres.size(); ++i)
+    {
+        double margin = -INFINITY;
+        for (size_t f = 0; f < frustumCount; ++f)
+            margin = std::fmax(margin, GetMargin(frustums[f], spheres[i]));
+
+        const bool isReported = next < visible.size() && visible[next] == i;
+        if (isReported) ++next;
+        if (std::fabs(margin) > kAmbiguousMargin) matches &= isReported == (margin > 0.0);
+    }
+    // anything left is out of order, a duplicate or a padding lane
+    return matches && next == visible.size();
+}
+} // namespace
+
+BLAINN_TEST(FrustumPlanesContainPointsOfTheClipVolume)
+{
+    const FrustumPlanes frustum = MakePerspectiveFrustum(0.0f, 0.0f, 0.0f, 100.0f);
+    // the camera looks down +z: points in front are inside, behind the eye and past far are not
+    BLAINN_CHECK(GetMargin(frustum, {0.0f, 1.0f, 10.0f, 0.0f}) > 0.0);
+    BLAINN_CHECK(GetMargin(frustum, {0.0f, 1.0f, -1.0f, 0.0f}) < 0.0);
+    BLAINN_CHECK(GetMargin(frustum, {0.0f, 1.0f, 0.05f, 0.0f}) < 0.0);
+    BLAINN_CHECK(GetMargin(frustum, {0.0f, 1.0f, 101.0f, 0.0f}) < 0.0);
+    BLAINN_CHECK(GetMargin(frustum, {50.0f, 1.0f, 10.0f, 0.0f}) < 0.0);
+
+    // normalized, so the margin is a distance: the near plane is at z = 0.1
+    BLAINN_CHECK_NEAR(GetMargin(frustum, {0.0f, 1.0f, 0.1f, 0.5f}), 0.5, 1e-4);
+}
+
+BLAINN_TEST(CullMatchesScalarReference)
+{
+    const FrustumPlanes frustums[] = {
+        MakePerspectiveFrustum(0.0f, 0.0f, 0.0f, 50.0f),
+        MakePerspectiveFrustum(5.0f, -3.0f, 2.1f, 80.0f),
+        MakeOrthographicFrustum(-4.0f, 7.0f, -0.7f),
+    };
+
+    FrustumCuller culler;
+    eastl::vector<uint32_t> visible;
+    for (const size_t count : {size_t(1), size_t(3), size_t(4), size_t(1001), size_t(4096), size_t(10003)})
+    {
+        const eastl::vector<Sphere> spheres = MakeRandomSpheres(count, static_cast<uint32_t>(count));
+        AddSpheres(culler, spheres);
+        BLAINN_CHECK(culler.GetCount() == count);
+
+        for (const FrustumPlanes &frustum : frustums)
+        {
+            visible.clear();
+            culler.Cull(frustum, visible);
+            BLAINN_CHECK(MatchesReference(spheres, &frustum, 1, visible));
+        }
+    }
+}
+
+BLAINN_TEST(CullAnyMatchesUnionOfFrustums)
+{
+    const FrustumPlanes frustums[] = {
+        MakePerspectiveFrustum(0.0f, 0.0f, 0.0f, 20.0f),
+        MakePerspectiveFrustum(0.0f, 0.0f, 3.14f, 20.0f),
+        MakeOrthographicFrustum(10.0f, 10.0f, 1.0f),
+    };
+    const eastl::vector<Sphere> spheres = MakeRandomSpheres(2051, 7u);
+
+    FrustumCuller culler;
+    AddSpheres(culler, spheres);
+    for (size_t frustumCount = 1; frustumCount <= 3; ++frustumCount)
+    {
+        eastl::vector<uint32_t> visible;
+        culler.CullAny(frustums, frustumCount, visible);
+        BLAINN_CHECK(MatchesReference(spheres, frustums, frustumCount, visible));
+    }
+}
+
+BLAINN_TEST(PaddingLanesAreNeverVisible)
+{
+    // a frustum containing the origin, where the padding spheres sit, with spheres covering everything
+    const FrustumPlanes frustum = MakeOrthographicFrustum(0.0f, 0.0f, 0.0f);
+
+    FrustumCuller culler;
+    eastl::vector<uint32_t> visible;
+    for (uint32_t count = 0; count <= 9; ++count)
+    {
+        culler.Clear();
+        for (uint32_t i = 0; i < count; ++i)
+            BLAINN_CHECK(culler.AddSphere(0.0f, 0.0f, 0.0f, 1000.0f) == i);
+
+        visible.clear();
+        culler.Cull(frustum, visible);
+        bool isExact = visible.size() == count;
+        for (uint32_t i = 0; i < visible.size() && isExact; ++i)
+            isExact = visible[i] == i;
+        BLAINN_CHECK(isExact);
+    }
+}
+
+BLAINN_TEST(EmptyCullerReportsNothing)
+{
+    FrustumCuller culler;
+    eastl::vector<uint32_t> visible = {42u};
+    culler.Cull(MakePerspectiveFrustum(0.0f, 0.0f, 0.0f, 10.0f), visible);
+    // appends only
+    BLAINN_CHECK(visible.size() == 1 && visible[0] == 42u);
+}
+
+BLAINN_BENCHMARK(Cull100kSpheres)
+{
+    using Clock = std::chrono::steady_clock;
+    constexpr int kRepeats = 50;
+
+    const eastl::vector<Sphere> spheres = MakeRandomSpheres(100000, 11u);
+    FrustumCuller culler;
+    AddSpheres(culler, spheres);
+
+    const FrustumPlanes cascades[] = {
+        MakePerspectiveFrustum(0.0f, 0.0f, 0.0f, 60.0f),
+        MakeOrthographicFrustum(0.0f, 0.0f, 0.5f),
+        MakeOrthographicFrustum(10.0f, 0.0f, 0.5f),
+        MakeOrthographicFrustum(20.0f, 0.0f, 0.5f),
+    };
+
+    eastl::vector<uint32_t> visible;
+    visible.reserve(spheres.size());
+    size_t checksum = 0;
+
+    // scalar loop over an array of structures, what culling looked like per entity before
+    auto start = Clock::now();
+    for (int repeat = 0; repeat < kRepeats; ++repeat)
+    {
+        visible.clear();
+        for (uint32_t i = 0; i < spheres.size(); ++i)
+        {
+            bool isInside = true;
+            for (const auto &plane : cascades[0].Planes)
+                isInside &= plane[0] * spheres[i].X + plane[1] * spheres[i].Y + plane[2] * spheres[i].Z + plane[3]
+                            >= -spheres[i].Radius;
+            if (isInside) visible.push_back(i);
+        }
+        checksum += visible.size();
+    }
+    const double scalarMs = std::chrono::duration<double, std::milli>(Clock::now() - start).count() / kRepeats;
+
+    start = Clock::now();
+    for (int repeat = 0; repeat < kRepeats; ++repeat)
+    {
+        visible.clear();
+        culler.Cull(cascades[0], visible);
+        checksum += visible.size();
+    }
+    const double cullMs = std::chrono::duration<double, std::milli>(Clock::now() - start).count() / kRepeats;
+
+    start = Clock::now();
+    for (int repeat = 0; repeat < kRepeats; ++repeat)
+    {
+        visible.clear();
+        culler.CullAny(cascades, 4, visible);
+        checksum += visible.size();
+    }
+    const double cullAnyMs = std::chrono::duration<double, std::milli>(Clock::now() - start).count() / kRepeats;
+
+    printf("  100k spheres: scalar %.3f ms, Cull %.3f ms, CullAny of 4 frustums %.3f ms (%zu)\n", scalarMs, cullMs,
+           cullAnyMs, checksum);
+}
+
+BLAINN_TEST(DisabledNearPlaneKeepsCastersBehindIt)
+{
+    // a light looking down +z with its cascade starting at z = 0
+    Matrix projection;
+    Orthographic(20.0f, 20.0f, 0.0f, 50.0f, projection);
+    FrustumPlanes frustum = FrustumPlanes::FromViewProjection(projection);
+
+    FrustumCuller culler;
+    culler.AddSphere(0.0f, 0.0f, -30.0f, 1.0f); // between the light and the cascade
+    culler.AddSphere(0.0f, 0.0f, 25.0f, 1.0f);
+    culler.AddSphere(0.0f, 0.0f, 80.0f, 1.0f);  // past far
+    culler.AddSphere(40.0f, 0.0f, -30.0f, 1.0f); // behind and to the side
+
+    eastl::vector<uint32_t> visible;
+    culler.Cull(frustum, visible);
+    BLAINN_CHECK(visible.size() == 1 && visible[0] == 1u);
+
+    frustum.DisableNearPlane();
+    visible.clear();
+    culler.Cull(frustum, visible);
+    // the padding lanes of the second block still never show up
+    BLAINN_CHECK(visible.size() == 2 && visible[0] == 0u && visible[1] == 1u);
+}
@@ -0,0 +1,218 @@
+#include "TestFramework.h"
+
+#include "handles/HandleBase.h"
+#include "tools/FreeListVector.h"
+
+#include <cstdint>
+#include <utility>
+
+using namespace Blainn;
+
+namespace
+{
+// the reference counting of AssetManager in small: slots in a FreeListVector, erased when the count drops to zero
+struct TestSlot
+{
+    uint32_t RefCount = 0u;
+    uint32_t Value = 0u;
+};
+
+FreeListVector<TestSlot> g_slots;
+uint32_t g_unloadCount = 0u;
+
+TestSlot *FindSlot(const Handle &handle)
+{
+    if (!handle.IsValid() || handle.GetIndex() >= g_slots.size()) return nullptr;
+    if (!handle.Matches(g_slots.generation(handle.GetIndex()))) return nullptr;
+    return &g_slots[handle.GetIndex()];
+}
+
+struct TestHandle : RefCountedHandle<TestHandle>
+{
+    TestHandle() = default;
+
+    static TestHandle Load(uint32_t value)
+    {
+        const size_t index = g_slots.emplace(TestSlot{1u, value});
+        return TestHandle(static_cast<uint32_t>(index), g_slots.generation(index));
+    }
+
+    static void AddReference(const Handle &handle)
+    {
+        if (TestSlot *slot = FindSlot(handle)) ++slot->RefCount;
+    }
+
+    static void Release(const Handle &handle)
+    {
+        TestSlot *slot = FindSlot(handle);
+        if (!slot || --slot->RefCount > 0u) return;
+
+        g_slots.erase(handle.GetIndex());
+        ++g_unloadCount;
+    }
+
+private:
+    TestHandle(uint32_t index, uint32_t generation)
+        : RefCountedHandle(index, generation)
+    {
+    }
+};
+
+uint32_t GetRefCount(const Handle &handle)
+{
+    const TestSlot *slot = FindSlot(handle);
+    return slot ? slot->RefCount : 0u;
+}
+
+// fresh generations, clear() would keep counting them
+void ResetSlots()
+{
+    g_slots = FreeListVector<TestSlot>();
+    g_unloadCount = 0u;
+}
+} // namespace
+
+BLAINN_TEST(DefaultHandleIsInvalid)
+{
+    ResetSlots();
+    const TestHandle handle;
+    BLAINN_CHECK(!handle.IsValid() && !handle);
+    BLAINN_CHECK(handle.GetIndex() == Handle::kIndexMask);
+    BLAINN_CHECK(!handle.Matches(0u) && !handle.Matches(Handle::kGenerationMask));
+    BLAINN_CHECK(FindSlot(handle) == nullptr);
+}
+
+BLAINN_TEST(CopiesAddReferencesAndMovesTransferThem)
+{
+    ResetSlots();
+    {
+        TestHandle handle = TestHandle::Load(1u);
+        BLAINN_CHECK(GetRefCount(handle) == 1u);
+
+        TestHandle copy(handle);
+        BLAINN_CHECK(GetRefCount(handle) == 2u);
+        BLAINN_CHECK(copy == handle);
+
+        TestHandle assigned;
+        assigned = copy;
+        BLAINN_CHECK(GetRefCount(handle) == 3u);
+
+        TestHandle moved(std::move(copy));
+        BLAINN_CHECK(GetRefCount(handle) == 3u);
+        BLAINN_CHECK(!copy.IsValid() && moved == handle);
+
+        TestHandle moveAssigned;
+        moveAssigned = std::move(moved);
+        BLAINN_CHECK(GetRefCount(handle) == 3u);
+        BLAINN_CHECK(!moved.IsValid() && moveAssigned == handle);
+
+        // assigning over a handle releases what it held
+        assigned = TestHandle();
+        BLAINN_CHECK(GetRefCount(handle) == 2u);
+        BLAINN_CHECK(g_unloadCount == 0u);
+    }
+    BLAINN_CHECK(g_unloadCount == 1u);
+    BLAINN_CHECK(g_slots.actual_size() == 0u);
+}
+
+BLAINN_TEST(SelfAssignmentKeepsTheCount)
+{
+    ResetSlots();
+    TestHandle handle = TestHandle::Load(2u);
+    // through a reference, so compilers don't flag the self assignment
+    TestHandle &alias = handle;
+
+    handle = alias;
+    BLAINN_CHECK(GetRefCount(handle) == 1u && handle.IsValid());
+
+    handle = std::move(alias);
+    BLAINN_CHECK(GetRefCount(handle) == 1u && handle.IsValid());
+    BLAINN_CHECK(g_unloadCount == 0u);
+}
+
+BLAINN_TEST(AssigningBetweenAssetsMovesTheReferences)
+{
+    ResetSlots();
+    TestHandle first = TestHandle::Load(3u);
+    TestHandle second = TestHandle::Load(4u);
+    const TestHandle keepSecond = second;
+
+    // the last reference of first goes away, second gains one
+    first = second;
+    BLAINN_CHECK(g_unloadCount == 1u);
+    BLAINN_CHECK(GetRefCount(second) == 3u);
+    BLAINN_CHECK(FindSlot(first) && FindSlot(first)->Value == 4u);
+}
+
+BLAINN_TEST(StaleHandlesAreDetectedAfterSlotReuse)
+{
+    ResetSlots();
+    Handle stale;
+    {
+        const TestHandle handle = TestHandle::Load(5u);
+        stale = handle;
+    }
+    BLAINN_CHECK(g_unloadCount == 1u);
+    BLAINN_CHECK(FindSlot(stale) == nullptr);
+
+    // the slot is reused by the next load, the old handle must not reach the new asset
+    TestHandle reused = TestHandle::Load(6u);
+    BLAINN_CHECK(reused.GetIndex() == stale.GetIndex());
+    BLAINN_CHECK(reused.GetGeneration() != stale.GetGeneration());
+    BLAINN_CHECK(FindSlot(stale) == nullptr);
+
+    // a release through the stale handle leaves the new asset alone
+    TestHandle::Release(stale);
+    BLAINN_CHECK(GetRefCount(reused) == 1u);
+    BLAINN_CHECK(g_unloadCount == 1u);
+}
+
+BLAINN_TEST(GenerationWrapsAtTwelveBits)
+{
+    ResetSlots();
+    Handle first;
+    Handle beforeWrap;
+    for (uint32_t reuse = 0u; reuse <= Handle::kGenerationMask + 1u; ++reuse)
+    {
+        const TestHandle handle = TestHandle::Load(reuse);
+        BLAINN_CHECK(handle.GetIndex() == 0u);
+        if (reuse == 0u) first = handle;
+        if (reuse == Handle::kGenerationMask) beforeWrap = handle;
+        if (reuse == Handle::kGenerationMask + 1u)
+        {
+            // the slot generation went past 12 bits, the handle keeps the low ones
+            BLAINN_CHECK(g_slots.generation(0u) == Handle::kGenerationMask + 1u);
+            BLAINN_CHECK(handle.GetGeneration() == 0u);
+            BLAINN_CHECK(FindSlot(handle) != nullptr);
+            BLAINN_CHECK(FindSlot(beforeWrap) == nullptr);
+            // the known limit: a handle kept over exactly 4096 reuses aliases the current asset
+            BLAINN_CHECK(first.Matches(g_slots.generation(0u)));
+        }
+    }
+    BLAINN_CHECK(g_unloadCount == Handle::kGenerationMask + 2u);
+}
+
+BLAINN_TEST(FreeListVectorReusesSlotsAndBumpsGenerations)
+{
+    FreeListVector<uint32_t> slots;
+    const size_t a = slots.push_back(10u);
+    const size_t b = slots.push_back(11u);
+    BLAINN_CHECK(a == 0u && b == 1u);
+    BLAINN_CHECK(slots.generation(a) == 0u);
+
+    slots.erase(a);
+    BLAINN_CHECK(slots[a] == 0u && slots.generation(a) == 1u);
+    BLAINN_CHECK(!slots.is_occupied(a) && slots.is_occupied(b));
+    BLAINN_CHECK(slots.next_free_index() == a && slots.actual_size() == 1u);
+
+    BLAINN_CHECK(slots.push_back(12u) == a);
+    BLAINN_CHECK(slots.generation(a) == 1u && slots.is_occupied(a));
+
+    // generations survive clear, handles to the old items stay stale
+    slots.clear();
+    BLAINN_CHECK(slots.empty());
+    BLAINN_CHECK(slots.push_back(13u) == 0u);
+    BLAINN_CHECK(slots.generation(0u) == 2u);
+    BLAINN_CHECK(slots.push_back(14u) == 1u);
+    BLAINN_CHECK(slots.generation(1u) == 1u);
+}
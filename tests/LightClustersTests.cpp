@@ -0,0 +1,228 @@
+#include "TestFramework.h"
+
+#include "Render/LightClusters.h"
+
+#include <EASTL/vector.h>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <random>
+
+using namespace Blainn;
+
+namespace
+{
+constexpr float kScreenWidth = 1600.0f;
+constexpr float kScreenHeight = 900.0f;
+
+LightClusterGridDesc MakeDesc()
+{
+    LightClusterGridDesc desc;
+    desc.ProjScaleY = 1.0f / std::tan(0.5f * 1.0471976f);
+    desc.ProjScaleX = desc.ProjScaleY * kScreenHeight / kScreenWidth;
+    desc.NearZ = 0.1f;
+    desc.FarZ = 100.0f;
+    return desc;
+}
+
+// GetClusterIndex of DeferredClusteredLightsPS.hlsl for a view space point, false when it is off screen
+bool GetShaderClusterIndex(const LightClusterGrid &grid, float x, float y, float z, uint32_t &outIndex)
+{
+    const LightClusterGridDesc &desc = grid.GetDesc();
+    if (z < desc.NearZ || z > desc.FarZ) return false;
+
+    // SV_Position of the pixel, y grows downwards
+    const float pixelX = (x * desc.ProjScaleX / z * 0.5f + 0.5f) * kScreenWidth;
+    const float pixelY = (0.5f - y * desc.ProjScaleY / z * 0.5f) * kScreenHeight;
+    if (pixelX < 0.0f || pixelX >= kScreenWidth || pixelY < 0.0f || pixelY >= kScreenHeight) return false;
+
+    // gClusterTileScale is the cluster count over the render target size
+    const uint32_t tileX = std::min(static_cast<uint32_t>(pixelX * static_cast<float>(desc.CountX) / kScreenWidth),
+                                    desc.CountX - 1u);
+    const uint32_t tileY = std::min(static_cast<uint32_t>(pixelY * static_cast<float>(desc.CountY) / kScreenHeight),
+                                    desc.CountY - 1u);
+    const float slice = std::floor(std::log(z) * grid.GetDepthSliceScale() - grid.GetDepthSliceBias());
+    const uint32_t sliceIndex =
+        static_cast<uint32_t>(std::fmin(std::fmax(slice, 0.0f), static_cast<float>(desc.CountZ) - 1.0f));
+
+    outIndex = grid.GetClusterIndex(tileX, tileY, sliceIndex);
+    return true;
+}
+
+bool ClusterHasLight(const LightClusterGrid &grid, uint32_t clusterIndex, uint32_t lightIndex, bool isSpot)
+{
+    const LightCluster &cluster = grid.GetClusters()[clusterIndex];
+    const uint32_t first = cluster.Offset + (isSpot ? cluster.PointCount : 0u);
+    const uint32_t last = isSpot ? cluster.Offset + cluster.PointCount + cluster.SpotCount : cluster.Offset + cluster.PointCount;
+    for (uint32_t i = first; i < last; ++i)
+        if (grid.GetLightIndices()[i] == lightIndex) return true;
+    return false;
+}
+
+// every point inside the light that a pixel can see has to find the light in its cluster. Points are kept a bit
+// inside the sphere, right at its surface float rounding of the shader math may pick the neighbouring cluster.
+bool IsLightInEveryClusterItReaches(const LightClusterGrid &grid, const LightBounds &light, uint32_t lightIndex,
+                                    bool isSpot, std::mt19937 &random, uint32_t &outCheckedPoints)
+{
+    std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+    bool isFound = true;
+    for (int sample = 0; sample < 4000; ++sample)
+    {
+        float dx, dy, dz;
+        do
+        {
+            dx = unit(random);
+            dy = unit(random);
+            dz = unit(random);
+        } while (dx * dx + dy * dy + dz * dz > 1.0f);
+
+        const float radius = light.Radius * 0.99f;
+        uint32_t clusterIndex;
+        if (!GetShaderClusterIndex(grid, light.X + dx * radius, light.Y + dy * radius, light.Z + dz * radius,
+                                   clusterIndex))
+            continue;
+
+        ++outCheckedPoints;
+        isFound &= ClusterHasLight(grid, clusterIndex, lightIndex, isSpot);
+    }
+    return isFound;
+}
+
+eastl::vector<LightBounds> MakeRandomLights(uint32_t count, uint32_t seed)
+{
+    std::mt19937 random(seed);
+    std::uniform_real_distribution<float> depth(0.5f, 60.0f);
+    std::uniform_real_distribution<float> side(-1.2f, 1.2f);
+    std::uniform_real_distribution<float> radius(0.2f, 6.0f);
+    eastl::vector<LightBounds> lights(count);
+    for (LightBounds &light : lights)
+    {
+        const float z = depth(random);
+        light = {side(random) * z, side(random) * z * 0.6f, z, radius(random)};
+    }
+    return lights;
+}
+} // namespace
+
+BLAINN_TEST(LightsLandInEveryClusterTheyReach)
+{
+    const eastl::vector<LightBounds> points = MakeRandomLights(60, 1u);
+    const eastl::vector<LightBounds> spots = MakeRandomLights(40, 2u);
+
+    LightClusterGrid grid;
+    grid.Build(MakeDesc(), points.data(), static_cast<uint32_t>(points.size()), spots.data(),
+               static_cast<uint32_t>(spots.size()));
+
+    std::mt19937 random(3u);
+    uint32_t checkedPoints = 0u;
+    bool isFound = true;
+    for (uint32_t i = 0; i < points.size(); ++i)
+        isFound &= IsLightInEveryClusterItReaches(grid, points[i], i, false, random, checkedPoints);
+    for (uint32_t i = 0; i < spots.size(); ++i)
+        isFound &= IsLightInEveryClusterItReaches(grid, spots[i], i, true, random, checkedPoints);
+
+    BLAINN_CHECK(isFound);
+    BLAINN_CHECK(checkedPoints > 100000u);
+}
+
+BLAINN_TEST(LightsAtTheNearPlaneAndAroundTheCamera)
+{
+    const LightBounds points[] = {
+        {0.0f, 0.0f, 0.05f, 1.0f},  // straddles the near plane
+        {0.3f, -0.2f, 0.1f, 0.5f},  // centered on it
+        {0.0f, 0.0f, 0.0f, 5.0f},   // contains the camera
+        {1.0f, 0.5f, -2.0f, 3.0f},  // behind the camera, reaching past near
+        {0.0f, 0.0f, -5.0f, 1.0f},  // behind the camera, invisible
+        {0.0f, 0.0f, 150.0f, 10.0f}, // past far
+        {50.0f, 0.0f, 5.0f, 1.0f},  // off to the side
+    };
+    const LightBounds spots[] = {{-0.5f, 0.5f, 0.2f, 2.0f}};
+
+    LightClusterGrid grid;
+    grid.Build(MakeDesc(), points, 7u, spots, 1u);
+    BLAINN_CHECK(grid.GetVisibleLightCount() == 5u);
+
+    std::mt19937 random(4u);
+    uint32_t checkedPoints = 0u;
+    for (uint32_t i = 0; i < 4; ++i)
+        BLAINN_CHECK(IsLightInEveryClusterItReaches(grid, points[i], i, false, random, checkedPoints));
+    BLAINN_CHECK(IsLightInEveryClusterItReaches(grid, spots[0], 0u, true, random, checkedPoints));
+    BLAINN_CHECK(checkedPoints > 1000u);
+
+    // the light around the camera covers the whole first slice
+    bool isEverywhere = true;
+    for (uint32_t y = 0; y < grid.GetDesc().CountY; ++y)
+        for (uint32_t x = 0; x < grid.GetDesc().CountX; ++x)
+            isEverywhere &= ClusterHasLight(grid, grid.GetClusterIndex(x, y, 0u), 2u, false);
+    BLAINN_CHECK(isEverywhere);
+
+    // lights that no pixel sees are in no cluster
+    bool isAbsent = true;
+    for (uint32_t c = 0; c < grid.GetClusters().size(); ++c)
+        for (const uint32_t invisible : {4u, 5u, 6u})
+            isAbsent &= !ClusterHasLight(grid, c, invisible, false);
+    BLAINN_CHECK(isAbsent);
+}
+
+BLAINN_TEST(ClusterListsKeepPointsFirstInInputOrder)
+{
+    const eastl::vector<LightBounds> points = MakeRandomLights(80, 5u);
+    const eastl::vector<LightBounds> spots = MakeRandomLights(50, 6u);
+
+    LightClusterGrid grid;
+    grid.Build(MakeDesc(), points.data(), 80u, spots.data(), 50u);
+
+    bool isOrdered = true;
+    uint32_t nextOffset = 0u;
+    for (const LightCluster &cluster : grid.GetClusters())
+    {
+        isOrdered &= cluster.Offset == nextOffset && cluster.Pad == 0u;
+        for (uint32_t i = 1; i < cluster.PointCount; ++i)
+            isOrdered &= grid.GetLightIndices()[cluster.Offset + i - 1] < grid.GetLightIndices()[cluster.Offset + i];
+        for (uint32_t i = 1; i < cluster.SpotCount; ++i)
+        {
+            const uint32_t spot = cluster.Offset + cluster.PointCount + i;
+            isOrdered &= grid.GetLightIndices()[spot - 1] < grid.GetLightIndices()[spot];
+        }
+        nextOffset += cluster.PointCount + cluster.SpotCount;
+    }
+    BLAINN_CHECK(isOrdered);
+    BLAINN_CHECK(nextOffset == grid.GetLightIndices().size());
+}
+
+BLAINN_TEST(BuildIsDeterministic)
+{
+    const eastl::vector<LightBounds> points = MakeRandomLights(100, 7u);
+    const eastl::vector<LightBounds> spots = MakeRandomLights(30, 8u);
+    const eastl::vector<LightBounds> otherPoints = MakeRandomLights(20, 9u);
+
+    LightClusterGrid grid;
+    grid.Build(MakeDesc(), points.data(), 100u, spots.data(), 30u);
+    const eastl::vector<LightCluster> clusters = grid.GetClusters();
+    const eastl::vector<uint32_t> indices = grid.GetLightIndices();
+    const uint32_t visibleCount = grid.GetVisibleLightCount();
+
+    const auto isSame = [&](const LightClusterGrid &other) {
+        if (other.GetClusters().size() != clusters.size() || other.GetLightIndices() != indices) return false;
+        if (other.GetVisibleLightCount() != visibleCount) return false;
+        for (size_t i = 0; i < clusters.size(); ++i)
+        {
+            const LightCluster &a = clusters[i];
+            const LightCluster &b = other.GetClusters()[i];
+            if (a.Offset != b.Offset || a.PointCount != b.PointCount || a.SpotCount != b.SpotCount || a.Pad != b.Pad)
+                return false;
+        }
+        return true;
+    };
+
+    // the same grid again, and after a build with other lights left its state behind
+    grid.Build(MakeDesc(), points.data(), 100u, spots.data(), 30u);
+    BLAINN_CHECK(isSame(grid));
+    grid.Build(MakeDesc(), otherPoints.data(), 20u, nullptr, 0u);
+    grid.Build(MakeDesc(), points.data(), 100u, spots.data(), 30u);
+    BLAINN_CHECK(isSame(grid));
+
+    LightClusterGrid freshGrid;
+    freshGrid.Build(MakeDesc(), points.data(), 100u, spots.data(), 30u);
+    BLAINN_CHECK(isSame(freshGrid));
+}
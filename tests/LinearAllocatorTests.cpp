@@ -0,0 +1,161 @@
+#include "TestFramework.h"
+
+#include "Render/LinearAllocator.h"
+
+#include <EASTL/vector.h>
+#include <cstdint>
+
+using namespace Blainn;
+
+namespace
+{
+// CPU memory backend, the same the upload heap mapping provides on the device
+struct CpuRange
+{
+    explicit CpuRange(uint64_t capacity)
+        : Memory(static_cast<size_t>(capacity) + kBaseAlignment)
+    {
+    }
+
+    // first byte at kBaseAlignment, so offsets and addresses share alignment as in a mapped heap
+    uint8_t *GetBase()
+    {
+        const uintptr_t address = reinterpret_cast<uintptr_t>(Memory.data());
+        return Memory.data() + ((kBaseAlignment - address % kBaseAlignment) % kBaseAlignment);
+    }
+
+    static constexpr uint64_t kBaseAlignment = 256u;
+    eastl::vector<uint8_t> Memory;
+};
+
+constexpr uint64_t kGpuBase = 0x10000u;
+} // namespace
+
+BLAINN_TEST(LinearAllocatorAlignsAllocations)
+{
+    CpuRange range(1024u);
+    LinearAllocator allocator(range.GetBase(), kGpuBase, 1024u);
+
+    const auto first = allocator.Allocate(3u, 1u);
+    BLAINN_CHECK(first.IsValid());
+    BLAINN_CHECK(first.Offset == 0u);
+
+    // constant buffer views need 256 byte aligned addresses
+    const auto constants = allocator.Allocate(64u, 256u);
+    BLAINN_CHECK(constants.IsValid());
+    BLAINN_CHECK(constants.Offset == 256u);
+    BLAINN_CHECK(constants.GpuAddress == kGpuBase + 256u);
+    BLAINN_CHECK(constants.CpuAddress == range.GetBase() + 256u);
+    BLAINN_CHECK(reinterpret_cast<uintptr_t>(constants.CpuAddress) % 256u == 0u);
+
+    const auto small = allocator.Allocate(4u, 16u);
+    BLAINN_CHECK(small.Offset == 320u);
+    BLAINN_CHECK(allocator.GetUsedBytes() == 324u);
+
+    // aligned offsets never overlap the previous allocation
+    for (uint64_t alignment = 1u; alignment <= 128u; alignment *= 2u)
+    {
+        const uint64_t used = allocator.GetUsedBytes();
+        const auto allocation = allocator.Allocate(1u, alignment);
+        BLAINN_CHECK(allocation.IsValid());
+        BLAINN_CHECK(allocation.Offset % alignment == 0u);
+        BLAINN_CHECK(allocation.Offset >= used);
+    }
+}
+
+BLAINN_TEST(LinearAllocatorPushCopiesData)
+{
+    struct Constants
+    {
+        float World[4];
+        uint32_t MaterialIndex;
+    };
+
+    CpuRange range(512u);
+    LinearAllocator allocator(range.GetBase(), kGpuBase, 512u);
+
+    const Constants constants = {{1.0f, 2.0f, 3.0f, 4.0f}, 7u};
+    const auto allocation = allocator.Push(constants, 256u);
+    BLAINN_CHECK(allocation.IsValid());
+
+    const Constants *written = reinterpret_cast<const Constants *>(allocation.CpuAddress);
+    BLAINN_CHECK(written->World[3] == 4.0f);
+    BLAINN_CHECK(written->MaterialIndex == 7u);
+}
+
+BLAINN_TEST(LinearAllocatorFailsWhenExhausted)
+{
+    CpuRange range(256u);
+    LinearAllocator allocator(range.GetBase(), kGpuBase, 256u);
+
+    // exactly full is fine
+    BLAINN_CHECK(allocator.Allocate(200u, 1u).IsValid());
+    BLAINN_CHECK(allocator.Allocate(56u, 1u).IsValid());
+    BLAINN_CHECK(allocator.GetUsedBytes() == 256u);
+
+    // one more byte is not, and a failed allocation uses nothing
+    BLAINN_CHECK(!allocator.Allocate(1u, 1u).IsValid());
+    BLAINN_CHECK(allocator.GetUsedBytes() == 256u);
+
+    allocator.Reset();
+    BLAINN_CHECK(allocator.Allocate(100u, 1u).IsValid());
+    // the size fits, the padding to the alignment doesn't
+    BLAINN_CHECK(!allocator.Allocate(100u, 256u).IsValid());
+    BLAINN_CHECK(allocator.GetUsedBytes() == 100u);
+    BLAINN_CHECK(allocator.Allocate(100u, 4u).IsValid());
+
+    // a range without memory has no capacity
+    LinearAllocator empty(nullptr, 0u, 1024u);
+    BLAINN_CHECK(empty.GetCapacity() == 0u);
+    BLAINN_CHECK(!empty.Allocate(1u, 1u).IsValid());
+}
+
+BLAINN_TEST(LinearAllocatorRejectsOverflowingRequests)
+{
+    CpuRange range(256u);
+    LinearAllocator allocator(range.GetBase(), kGpuBase, 256u);
+    BLAINN_CHECK(allocator.Allocate(16u, 1u).IsValid());
+
+    // offset + size wraps past zero
+    BLAINN_CHECK(!allocator.Allocate(UINT64_MAX, 1u).IsValid());
+    BLAINN_CHECK(!allocator.Allocate(UINT64_MAX - 8u, 16u).IsValid());
+    // offset + alignment wraps past zero
+    BLAINN_CHECK(!allocator.Allocate(1u, 1ull << 63u).IsValid());
+
+    BLAINN_CHECK(allocator.GetUsedBytes() == 16u);
+    BLAINN_CHECK(allocator.Allocate(16u, 16u).IsValid());
+}
+
+BLAINN_TEST(LinearAllocatorResetsPerFrame)
+{
+    // one range per frame in flight, reset when the frame's fence has passed
+    constexpr uint32_t kFrameCount = 3u;
+    constexpr uint64_t kCapacity = 4096u;
+    CpuRange range(kCapacity * kFrameCount);
+    eastl::vector<LinearAllocator> frames;
+    for (uint32_t i = 0; i < kFrameCount; ++i)
+        frames.push_back(LinearAllocator(range.GetBase() + i * kCapacity, kGpuBase + i * kCapacity, kCapacity));
+
+    for (uint32_t frame = 0; frame < 10u; ++frame)
+    {
+        LinearAllocator &allocator = frames[frame % kFrameCount];
+        allocator.Reset();
+        BLAINN_CHECK(allocator.GetUsedBytes() == 0u);
+
+        // more objects on later frames, every frame starts at the beginning of its range
+        const uint32_t objectCount = 2u + frame;
+        for (uint32_t object = 0; object < objectCount; ++object)
+        {
+            const auto allocation = allocator.Allocate(64u, 256u);
+            BLAINN_CHECK(allocation.IsValid());
+            BLAINN_CHECK(allocation.Offset == object * 256u);
+            BLAINN_CHECK(allocation.GpuAddress == kGpuBase + (frame % kFrameCount) * kCapacity + object * 256u);
+        }
+        BLAINN_CHECK(allocator.GetUsedBytes() == (objectCount - 1u) * 256u + 64u);
+    }
+
+    // the peak outlives the resets, it is what the range gets sized by
+    BLAINN_CHECK(frames[0].GetPeakUsedBytes() == 10u * 256u + 64u);
+    BLAINN_CHECK(frames[0].GetUsedBytes() == frames[0].GetPeakUsedBytes());
+    BLAINN_CHECK(frames[1].GetPeakUsedBytes() == 8u * 256u + 64u);
+}
@@ -0,0 +1,284 @@
+#include "TestFramework.h"
+
+#include "tools/MeshOptimizer.h"
+
+#include <EASTL/algorithm.h>
+#include <EASTL/sort.h>
+#include <EASTL/vector.h>
+#include <cmath>
+#include <cstdint>
+#include <random>
+
+using namespace Blainn;
+
+namespace
+{
+constexpr uint32_t kInvalidCopy = ~0u;
+
+struct TestMesh
+{
+    eastl::vector<float> Positions; // xyz
+    eastl::vector<uint32_t> Indices;
+
+    size_t GetVertexCount() const { return Positions.size() / 3; }
+};
+
+TestMesh MakeGrid(uint32_t size)
+{
+    TestMesh mesh;
+    for (uint32_t y = 0; y <= size; ++y)
+    {
+        for (uint32_t x = 0; x <= size; ++x)
+        {
+            mesh.Positions.push_back(static_cast<float>(x));
+            mesh.Positions.push_back(static_cast<float>(y));
+            mesh.Positions.push_back(0.0f);
+        }
+    }
+    for (uint32_t y = 0; y < size; ++y)
+    {
+        for (uint32_t x = 0; x < size; ++x)
+        {
+            const uint32_t corner = y * (size + 1) + x;
+            const uint32_t quad[6] = {corner, corner + 1, corner + size + 1, corner + 1, corner + size + 2, corner + size + 1};
+            mesh.Indices.insert(mesh.Indices.end(), quad, quad + 6);
+        }
+    }
+    return mesh;
+}
+
+TestMesh MakeSphere(uint32_t rings, uint32_t segments)
+{
+    constexpr float kPi = 3.14159265358979f;
+    TestMesh mesh;
+    for (uint32_t ring = 0; ring <= rings; ++ring)
+    {
+        const float theta = kPi * static_cast<float>(ring) / static_cast<float>(rings);
+        for (uint32_t segment = 0; segment <= segments; ++segment)
+        {
+            const float phi = 2.0f * kPi * static_cast<float>(segment) / static_cast<float>(segments);
+            mesh.Positions.push_back(std::sin(theta) * std::cos(phi));
+            mesh.Positions.push_back(std::cos(theta));
+            mesh.Positions.push_back(std::sin(theta) * std::sin(phi));
+        }
+    }
+    for (uint32_t ring = 0; ring < rings; ++ring)
+    {
+        for (uint32_t segment = 0; segment < segments; ++segment)
+        {
+            const uint32_t corner = ring * (segments + 1) + segment;
+            const uint32_t quad[6] = {corner, corner + segments + 1, corner + 1,
+                                      corner + 1, corner + segments + 1, corner + segments + 2};
+            mesh.Indices.insert(mesh.Indices.end(), quad, quad + 6);
+        }
+    }
+    return mesh;
+}
+
+void ShuffleTriangles(eastl::vector<uint32_t> &indices, uint32_t seed)
+{
+    std::mt19937 random(seed);
+    const size_t triangleCount = indices.size() / 3;
+    for (size_t i = triangleCount - 1; i > 0; --i)
+    {
+        const size_t j = std::uniform_int_distribution<size_t>(0, i)(random);
+        for (size_t corner = 0; corner < 3; ++corner)
+            eastl::swap(indices[i * 3 + corner], indices[j * 3 + corner]);
+    }
+}
+
+struct Triangle
+{
+    uint32_t A, B, C;
+
+    bool operator<(const Triangle &other) const
+    {
+        if (A != other.A) return A < other.A;
+        if (B != other.B) return B < other.B;
+        return C < other.C;
+    }
+    bool operator==(const Triangle &other) const { return A == other.A && B == other.B && C == other.C; }
+};
+
+// rotated so the smallest index comes first, the winding is part of the triangle
+eastl::vector<Triangle> GetSortedTriangles(const uint32_t *indices, size_t indexCount)
+{
+    eastl::vector<Triangle> triangles;
+    for (size_t i = 0; i < indexCount; i += 3)
+    {
+        Triangle triangle{indices[i], indices[i + 1], indices[i + 2]};
+        while (triangle.A > triangle.B || triangle.A > triangle.C)
+            triangle = {triangle.B, triangle.C, triangle.A};
+        triangles.push_back(triangle);
+    }
+    eastl::sort(triangles.begin(), triangles.end());
+    return triangles;
+}
+} // namespace
+
+BLAINN_TEST(VertexCacheOptimizationLowersACMROfShuffledGrid)
+{
+    TestMesh grid = MakeGrid(64);
+    ShuffleTriangles(grid.Indices, 1u);
+    const eastl::vector<Triangle> triangles = GetSortedTriangles(grid.Indices.data(), grid.Indices.size());
+
+    const auto before = MeshOptimizer::AnalyzeVertexCache(grid.Indices.data(), grid.Indices.size(), grid.GetVertexCount());
+    MeshOptimizer::OptimizeVertexCache(grid.Indices.data(), grid.Indices.size(), grid.GetVertexCount());
+    const auto after = MeshOptimizer::AnalyzeVertexCache(grid.Indices.data(), grid.Indices.size(), grid.GetVertexCount());
+
+    printf("  ACMR %f -> %f\n", before.ACMR, after.ACMR);
+    BLAINN_CHECK(after.ACMR < before.ACMR);
+    // a 16 entry FIFO gets a regular grid well below one vertex per triangle
+    BLAINN_CHECK(after.ACMR < 0.8f);
+    BLAINN_CHECK(GetSortedTriangles(grid.Indices.data(), grid.Indices.size()) == triangles);
+}
+
+BLAINN_TEST(VertexCacheOptimizationLowersACMROfShuffledSphere)
+{
+    TestMesh sphere = MakeSphere(32, 64);
+    ShuffleTriangles(sphere.Indices, 2u);
+
+    const auto before =
+        MeshOptimizer::AnalyzeVertexCache(sphere.Indices.data(), sphere.Indices.size(), sphere.GetVertexCount());
+    MeshOptimizer::OptimizeVertexCache(sphere.Indices.data(), sphere.Indices.size(), sphere.GetVertexCount());
+    const auto after =
+        MeshOptimizer::AnalyzeVertexCache(sphere.Indices.data(), sphere.Indices.size(), sphere.GetVertexCount());
+
+    printf("  ACMR %f -> %f\n", before.ACMR, after.ACMR);
+    BLAINN_CHECK(after.ACMR < before.ACMR);
+    BLAINN_CHECK(after.ACMR < 0.8f);
+}
+
+BLAINN_TEST(OverdrawSortKeepsTrianglesAndCacheEfficiency)
+{
+    TestMesh sphere = MakeSphere(32, 64);
+    ShuffleTriangles(sphere.Indices, 3u);
+    const eastl::vector<Triangle> triangles = GetSortedTriangles(sphere.Indices.data(), sphere.Indices.size());
+
+    MeshOptimizer::OptimizeVertexCache(sphere.Indices.data(), sphere.Indices.size(), sphere.GetVertexCount());
+    const auto cacheOptimized =
+        MeshOptimizer::AnalyzeVertexCache(sphere.Indices.data(), sphere.Indices.size(), sphere.GetVertexCount());
+
+    MeshOptimizer::OptimizeOverdraw(sphere.Indices.data(), sphere.Indices.size(), sphere.Positions.data(),
+                                    sphere.GetVertexCount(), sizeof(float) * 3);
+    const auto overdrawOptimized =
+        MeshOptimizer::AnalyzeVertexCache(sphere.Indices.data(), sphere.Indices.size(), sphere.GetVertexCount());
+
+    BLAINN_CHECK(GetSortedTriangles(sphere.Indices.data(), sphere.Indices.size()) == triangles);
+    // clusters only split where the cache restarts anyway
+    BLAINN_CHECK(overdrawOptimized.ACMR <= cacheOptimized.ACMR * 1.05f);
+}
+
+BLAINN_TEST(VertexFetchRemapIsPermutationThatKeepsTriangles)
+{
+    struct Vertex
+    {
+        uint32_t Id;
+        float Padding[3];
+    };
+
+    TestMesh grid = MakeGrid(16);
+    ShuffleTriangles(grid.Indices, 4u);
+
+    // two vertices nobody references, they have to end up after the referenced ones
+    const size_t referencedCount = grid.GetVertexCount();
+    eastl::vector<Vertex> vertices(referencedCount + 2);
+    for (uint32_t i = 0; i < vertices.size(); ++i)
+        vertices[i] = {i, {0.0f, 0.0f, 0.0f}};
+
+    eastl::vector<uint32_t> triangleIds;
+    for (const uint32_t index : grid.Indices)
+        triangleIds.push_back(vertices[index].Id);
+
+    const size_t resultCount = MeshOptimizer::OptimizeVertexFetch(vertices.data(), grid.Indices.data(),
+                                                                  grid.Indices.size(), vertices.size(), sizeof(Vertex));
+    BLAINN_CHECK(resultCount == referencedCount);
+
+    // every original vertex is still there exactly once
+    eastl::vector<uint32_t> ids;
+    for (const Vertex &vertex : vertices)
+        ids.push_back(vertex.Id);
+    eastl::sort(ids.begin(), ids.end());
+    bool isPermutation = true;
+    for (uint32_t i = 0; i < ids.size(); ++i)
+        isPermutation &= ids[i] == i;
+    BLAINN_CHECK(isPermutation);
+
+    bool areTrianglesKept = true;
+    for (size_t i = 0; i < grid.Indices.size(); ++i)
+        areTrianglesKept &= vertices[grid.Indices[i]].Id == triangleIds[i];
+    BLAINN_CHECK(areTrianglesKept);
+
+    BLAINN_CHECK(vertices[referencedCount].Id >= referencedCount && vertices[referencedCount + 1].Id >= referencedCount);
+
+    // first use order: indices never jump more than one past the highest seen so far
+    bool isFirstUseOrder = true;
+    uint32_t nextVertex = 0;
+    for (const uint32_t index : grid.Indices)
+    {
+        isFirstUseOrder &= index <= nextVertex;
+        if (index == nextVertex) ++nextVertex;
+    }
+    BLAINN_CHECK(isFirstUseOrder);
+}
+
+BLAINN_TEST(SimplifyCollapsesAlongAttributeSeamsWithoutTearingThem)
+{
+    // a flat grid cut by a uv seam down the middle column: the vertices of the column are duplicated and the
+    // triangles right of it use the copies
+    constexpr uint32_t kSize = 16u;
+    constexpr uint32_t kSeamColumn = kSize / 2u;
+    TestMesh grid = MakeGrid(kSize);
+    const uint32_t leftVertexCount = static_cast<uint32_t>(grid.GetVertexCount());
+
+    eastl::vector<uint32_t> seamCopy(leftVertexCount, kInvalidCopy);
+    for (uint32_t y = 0; y <= kSize; ++y)
+    {
+        const uint32_t original = y * (kSize + 1u) + kSeamColumn;
+        seamCopy[original] = static_cast<uint32_t>(grid.GetVertexCount());
+        grid.Positions.insert(grid.Positions.end(), &grid.Positions[original * 3u], &grid.Positions[original * 3u + 3u]);
+    }
+    for (size_t i = 0; i < grid.Indices.size(); i += 3)
+    {
+        bool isRightOfSeam = false;
+        for (size_t k = 0; k < 3; ++k)
+            isRightOfSeam |= grid.Indices[i + k] % (kSize + 1u) > kSeamColumn;
+        if (!isRightOfSeam) continue;
+        for (size_t k = 0; k < 3; ++k)
+            if (seamCopy[grid.Indices[i + k]] != kInvalidCopy) grid.Indices[i + k] = seamCopy[grid.Indices[i + k]];
+    }
+
+    eastl::vector<uint32_t> simplified(grid.Indices.size());
+    float resultError = 0.0f;
+    const size_t count = MeshOptimizer::Simplify(simplified.data(), grid.Indices.data(), grid.Indices.size(),
+                                                 grid.Positions.data(), grid.GetVertexCount(), sizeof(float) * 3, 0u,
+                                                 1e-3f, &resultError);
+    BLAINN_CHECK(resultError <= 1e-3f);
+
+    // a triangle never mixes the two sides, seam vertices of the left side stay on the left
+    bool isSeamKept = true;
+    eastl::vector<bool> isSeamPositionUsed(kSize + 1u, false);
+    for (size_t i = 0; i < count; i += 3)
+    {
+        bool hasLeft = false;
+        bool hasRight = false;
+        for (size_t k = 0; k < 3; ++k)
+        {
+            const uint32_t vertex = simplified[i + k];
+            const bool isCopy = vertex >= leftVertexCount;
+            const uint32_t column = isCopy ? kSeamColumn : vertex % (kSize + 1u);
+            hasLeft |= !isCopy && column < kSeamColumn;
+            hasRight |= isCopy || column > kSeamColumn;
+            if (isCopy) isSeamPositionUsed[vertex - leftVertexCount] = true;
+        }
+        isSeamKept &= !(hasLeft && hasRight);
+    }
+    BLAINN_CHECK(isSeamKept);
+
+    // the seam is a straight line, only its ends on the border have to stay
+    const size_t seamPositionsLeft =
+        static_cast<size_t>(eastl::count(isSeamPositionUsed.begin(), isSeamPositionUsed.end(), true));
+    printf("  %zu of %u triangles, %zu of %u seam positions\n", count / 3, kSize * kSize * 2u, seamPositionsLeft,
+           kSize + 1u);
+    BLAINN_CHECK(seamPositionsLeft < kSize / 2u);
+}
@@ -0,0 +1,65 @@
+#pragma once
+
+#include <cmath>
+#include <cstdio>
+
+// Minimal self registering tests: the engine has no test framework among its dependencies and the CPU side code
+// needs nothing more than checks and a runner.
+namespace Blainn::Tests
+{
+using TestFunction = void (*)();
+
+struct TestCase
+{
+    const char *Name;
+    TestFunction Function;
+    bool IsBenchmark;
+    TestCase *Next;
+};
+
+inline TestCase *&GetTestList()
+{
+    static TestCase *head = nullptr;
+    return head;
+}
+
+inline int &GetFailedCheckCount()
+{
+    static int count = 0;
+    return count;
+}
+
+struct TestRegistrar
+{
+    TestRegistrar(TestCase &testCase)
+    {
+        testCase.Next = GetTestList();
+        GetTestList() = &testCase;
+    }
+};
+
+inline void ReportFailure(const char *file, int line, const char *expression)
+{
+    ++GetFailedCheckCount();
+    printf("  %s(%d): check failed: %s\n", file, line, expression);
+}
+} // namespace Blainn::Tests
+
+#define BLAINN_REGISTER_TEST(name, isBenchmark)                                                                      \
+    static void name();                                                                                              \
+    static Blainn::Tests::TestCase name##Case{#name, &name, isBenchmark, nullptr};                                   \
+    static Blainn::Tests::TestRegistrar name##Registrar{name##Case};                                                 \
+    static void name()
+
+/// @brief a test run by ctest
+#define BLAINN_TEST(name) BLAINN_REGISTER_TEST(name, false)
+/// @brief timing only, run with --benchmark
+#define BLAINN_BENCHMARK(name) BLAINN_REGISTER_TEST(name, true)
+
+#define BLAINN_CHECK(expression)                                                                                     \
+    do                                                                                                               \
+    {                                                                                                                \
+        if (!(expression)) Blainn::Tests::ReportFailure(__FILE__, __LINE__, #expression);                            \
+    } while (false)
+
+#define BLAINN_CHECK_NEAR(a, b, tolerance) BLAINN_CHECK(std::fabs((a) - (b)) <= (tolerance))
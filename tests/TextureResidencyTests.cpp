@@ -0,0 +1,215 @@
+#include "TestFramework.h"
+
+#include "Render/TextureResidency.h"
+
+#include <EASTL/vector.h>
+#include <cstdint>
+#include <random>
+
+using namespace Blainn;
+
+namespace
+{
+constexpr uint32_t kMipCount = 11u; // 1024 down to 1
+constexpr uint32_t kTailMip = 4u;   // 64x64 and smaller always stay
+
+eastl::vector<uint64_t> MakeMipSizes(uint32_t size)
+{
+    eastl::vector<uint64_t> sizes;
+    for (uint32_t mip = 0; mip < kMipCount; ++mip)
+    {
+        const uint64_t extent = eastl::max(size >> mip, 1u);
+        sizes.push_back(extent * extent * 4u);
+    }
+    return sizes;
+}
+
+// bytes of the levels from mip to the smallest one
+uint64_t GetBytesFrom(const eastl::vector<uint64_t> &sizes, uint32_t mip)
+{
+    uint64_t bytes = 0u;
+    for (uint32_t level = mip; level < sizes.size(); ++level)
+        bytes += sizes[level];
+    return bytes;
+}
+
+// the streamer finished every upload the last Solve asked for
+void CompleteUploads(TextureResidency &residency)
+{
+    for (const uint32_t id : residency.GetChangedTextures())
+        residency.SetResidentMip(id, residency.GetTargetMip(id));
+}
+} // namespace
+
+BLAINN_TEST(NeededMipAtItsBoundaries)
+{
+    // one texel per pixel or more pixels than texels needs the full texture
+    BLAINN_CHECK(TextureResidency::GetNeededMip(1024u, 1024u, kTailMip, 1024.0f) == 0u);
+    BLAINN_CHECK(TextureResidency::GetNeededMip(1024u, 1024u, kTailMip, 4096.0f) == 0u);
+    BLAINN_CHECK(TextureResidency::GetNeededMip(1024u, 1024u, kTailMip, 1023.0f) == 0u);
+    // a level is dropped only once a surface is at most half as large
+    BLAINN_CHECK(TextureResidency::GetNeededMip(1024u, 1024u, kTailMip, 513.0f) == 0u);
+    BLAINN_CHECK(TextureResidency::GetNeededMip(1024u, 1024u, kTailMip, 512.0f) == 1u);
+    BLAINN_CHECK(TextureResidency::GetNeededMip(1024u, 1024u, kTailMip, 257.0f) == 1u);
+    BLAINN_CHECK(TextureResidency::GetNeededMip(1024u, 1024u, kTailMip, 256.0f) == 2u);
+    // never past the tail, nothing requested means the tail
+    BLAINN_CHECK(TextureResidency::GetNeededMip(1024u, 1024u, kTailMip, 1.0f) == kTailMip);
+    BLAINN_CHECK(TextureResidency::GetNeededMip(1024u, 1024u, kTailMip, 0.0f) == kTailMip);
+    BLAINN_CHECK(TextureResidency::GetNeededMip(1024u, 1024u, kTailMip, -5.0f) == kTailMip);
+    // the larger side counts
+    BLAINN_CHECK(TextureResidency::GetNeededMip(1024u, 64u, kTailMip, 512.0f) == 1u);
+    BLAINN_CHECK(TextureResidency::GetNeededMip(64u, 1024u, kTailMip, 512.0f) == 1u);
+}
+
+BLAINN_TEST(TailsStayWhenTheBudgetIsBelowThem)
+{
+    const eastl::vector<uint64_t> sizes = MakeMipSizes(1024u);
+    TextureResidency residency;
+    for (uint32_t id = 0; id < 4; ++id)
+        residency.AddTexture(id, 1024u, 1024u, sizes.data(), kMipCount, kTailMip, 0u);
+
+    for (const uint64_t budget : {uint64_t(0), uint64_t(1000), GetBytesFrom(sizes, kTailMip) * 4u - 1u})
+    {
+        for (uint32_t id = 0; id < 4; ++id)
+            residency.Request(id, 2048.0f);
+        residency.Solve(budget);
+
+        bool isAtTail = true;
+        for (uint32_t id = 0; id < 4; ++id)
+            isAtTail &= residency.GetTargetMip(id) == kTailMip;
+        BLAINN_CHECK(isAtTail);
+        BLAINN_CHECK(residency.GetTailBytes() == GetBytesFrom(sizes, kTailMip) * 4u);
+        BLAINN_CHECK(residency.GetTargetBytes() == residency.GetTailBytes());
+    }
+}
+
+BLAINN_TEST(AmpleBudgetGivesEveryTextureItsNeededMip)
+{
+    const eastl::vector<uint64_t> sizes = MakeMipSizes(1024u);
+    TextureResidency residency;
+    const float screenSizes[] = {2000.0f, 600.0f, 300.0f, 100.0f, 0.0f};
+    for (uint32_t id = 0; id < 5; ++id)
+    {
+        residency.AddTexture(id, 1024u, 1024u, sizes.data(), kMipCount, kTailMip, kTailMip);
+        residency.Request(id, screenSizes[id]);
+    }
+    residency.Solve(UINT64_MAX);
+
+    uint64_t expectedBytes = 0u;
+    for (uint32_t id = 0; id < 5; ++id)
+    {
+        const uint32_t neededMip = TextureResidency::GetNeededMip(1024u, 1024u, kTailMip, screenSizes[id]);
+        BLAINN_CHECK(residency.GetTargetMip(id) == neededMip);
+        expectedBytes += GetBytesFrom(sizes, neededMip);
+    }
+    BLAINN_CHECK(residency.GetTargetBytes() == expectedBytes);
+    // every texture but the unrequested one has an upload to do
+    BLAINN_CHECK(residency.GetChangedTextures().size() == 4u);
+}
+
+BLAINN_TEST(TargetsAreWholeMipChainsWithinBudget)
+{
+    std::mt19937 random(1u);
+    const uint32_t textureSizes[] = {2048u, 1024u, 512u, 256u};
+
+    TextureResidency residency;
+    eastl::vector<eastl::vector<uint64_t>> mipSizes;
+    for (uint32_t id = 0; id < 40; ++id)
+    {
+        const uint32_t size = textureSizes[random() % 4u];
+        mipSizes.push_back(MakeMipSizes(size));
+        residency.AddTexture(id, size, size, mipSizes.back().data(), kMipCount, kTailMip, kTailMip);
+    }
+
+    for (int frame = 0; frame < 50; ++frame)
+    {
+        for (uint32_t id = 0; id < 40; ++id)
+            if (random() % 3u != 0u) residency.Request(id, static_cast<float>(random() % 3000u));
+        const uint64_t budget = static_cast<uint64_t>(random() % 64u) * 1024u * 1024u;
+        residency.Solve(budget);
+        CompleteUploads(residency);
+
+        // a texture pays for every level from its target down to the smallest one, nothing finer is ever held
+        // without the coarser levels
+        uint64_t bytes = 0u;
+        bool isChainValid = true;
+        for (uint32_t id = 0; id < 40; ++id)
+        {
+            isChainValid &= residency.GetTargetMip(id) <= kTailMip;
+            bytes += GetBytesFrom(mipSizes[id], residency.GetTargetMip(id));
+        }
+        BLAINN_CHECK(isChainValid);
+        BLAINN_CHECK(bytes == residency.GetTargetBytes());
+        BLAINN_CHECK(residency.GetTargetBytes() <= eastl::max(budget, residency.GetTailBytes()));
+    }
+}
+
+BLAINN_TEST(ShrinkingBudgetEvictsLeastRecentlyRequestedFirst)
+{
+    const eastl::vector<uint64_t> sizes = MakeMipSizes(1024u);
+    TextureResidency residency;
+    residency.AddTexture(0u, 1024u, 1024u, sizes.data(), kMipCount, kTailMip, kTailMip);
+    residency.AddTexture(1u, 1024u, 1024u, sizes.data(), kMipCount, kTailMip, kTailMip);
+
+    // texture 0 is seen first, texture 1 one frame later, both fully streamed in
+    residency.Request(0u, 1024.0f);
+    residency.Solve(UINT64_MAX);
+    CompleteUploads(residency);
+    residency.Request(1u, 1024.0f);
+    residency.Solve(UINT64_MAX);
+    CompleteUploads(residency);
+    BLAINN_CHECK(residency.GetTargetMip(0u) == 0u && residency.GetTargetMip(1u) == 0u);
+
+    // nothing is requested now, room for the tails and one full texture: the older one goes
+    const uint64_t tails = GetBytesFrom(sizes, kTailMip) * 2u;
+    const uint64_t fineLevels = GetBytesFrom(sizes, 0u) - GetBytesFrom(sizes, kTailMip);
+    residency.Solve(tails + fineLevels);
+    CompleteUploads(residency);
+    BLAINN_CHECK(residency.GetTargetMip(0u) == kTailMip);
+    BLAINN_CHECK(residency.GetTargetMip(1u) == 0u);
+
+    // less again: the finest level of the remaining one goes before its coarser ones
+    residency.Solve(tails + fineLevels - sizes[0]);
+    CompleteUploads(residency);
+    BLAINN_CHECK(residency.GetTargetMip(0u) == kTailMip);
+    BLAINN_CHECK(residency.GetTargetMip(1u) == 1u);
+
+    // a requested texture wins over a merely resident one, however recent
+    residency.Request(0u, 300.0f);
+    residency.Solve(tails + fineLevels - sizes[0]);
+    BLAINN_CHECK(residency.GetTargetMip(0u) == TextureResidency::GetNeededMip(1024u, 1024u, kTailMip, 300.0f));
+    BLAINN_CHECK(residency.GetTargetMip(1u) > 1u);
+}
+
+BLAINN_TEST(ResidentLevelsSurviveSurfacesHoveringAtABoundary)
+{
+    const eastl::vector<uint64_t> sizes = MakeMipSizes(1024u);
+    TextureResidency residency;
+    residency.AddTexture(0u, 1024u, 1024u, sizes.data(), kMipCount, kTailMip, 0u);
+    residency.AddTexture(1u, 1024u, 1024u, sizes.data(), kMipCount, kTailMip, 0u);
+
+    // room for one of the finest levels, texture 1 needs it every frame
+    const uint64_t fullBytes = GetBytesFrom(sizes, 0u);
+    const uint64_t budget = fullBytes * 2u - sizes[0];
+
+    // texture 0 hovers around the size where it stops needing its finest level
+    for (int frame = 0; frame < 6; ++frame)
+    {
+        residency.Request(0u, frame % 2 == 0 ? 520.0f : 500.0f);
+        residency.Request(1u, 515.0f);
+        residency.Solve(budget);
+
+        BLAINN_CHECK(residency.GetTargetMip(0u) == 0u);
+        BLAINN_CHECK(residency.GetTargetMip(1u) == 1u);
+        // only the first frame has an eviction to do
+        BLAINN_CHECK(residency.GetChangedTextures().size() == (frame == 0 ? 1u : 0u));
+        CompleteUploads(residency);
+    }
+
+    // a surface well past the boundary gives its level up
+    residency.Request(0u, 300.0f);
+    residency.Request(1u, 515.0f);
+    residency.Solve(budget);
+    BLAINN_CHECK(residency.GetTargetMip(0u) == 1u);
+    BLAINN_CHECK(residency.GetTargetMip(1u) == 0u);
+}
@@ -0,0 +1,197 @@
+#include "TestFramework.h"
+
+#include "VertexEncoding.h"
+
+#include <cfloat>
+#include <cmath>
+#include <cstdint>
+
+using namespace Blainn::VertexEncoding;
+
+namespace
+{
+constexpr float kPi = 3.14159265358979f;
+// two snorm16 of the octahedral square are good for about 0.0036 degrees, the tangent spends one bit of v on the sign
+constexpr double kMaxNormalErrorDegrees = 0.005;
+constexpr double kMaxTangentErrorDegrees = 0.008;
+
+struct Direction
+{
+    float X, Y, Z;
+};
+
+Direction Normalize(Direction d)
+{
+    const float length = std::sqrt(d.X * d.X + d.Y * d.Y + d.Z * d.Z);
+    return {d.X / length, d.Y / length, d.Z / length};
+}
+
+// atan2 in double, acos of a float dot product alone is off by ~0.02 degrees near 1
+double AngleDegrees(Direction a, Direction b)
+{
+    const double crossX = static_cast<double>(a.Y) * b.Z - static_cast<double>(a.Z) * b.Y;
+    const double crossY = static_cast<double>(a.Z) * b.X - static_cast<double>(a.X) * b.Z;
+    const double crossZ = static_cast<double>(a.X) * b.Y - static_cast<double>(a.Y) * b.X;
+    const double dot = static_cast<double>(a.X) * b.X + static_cast<double>(a.Y) * b.Y + static_cast<double>(a.Z) * b.Z;
+    return std::atan2(std::sqrt(crossX * crossX + crossY * crossY + crossZ * crossZ), dot) * 180.0 / 3.14159265358979;
+}
+
+// what the vertex stream stores for a normal and what GBufferPassVS reads back
+Direction RoundTripNormal(Direction d)
+{
+    float u, v;
+    OctEncode(d.X, d.Y, d.Z, u, v);
+    Direction result;
+    OctDecode(Snorm16ToFloat(FloatToSnorm16(u)), Snorm16ToFloat(FloatToSnorm16(v)), result.X, result.Y, result.Z);
+    return result;
+}
+
+Direction RoundTripTangent(Direction d, float sign, float &outSign)
+{
+    float u, v;
+    OctEncode(d.X, d.Y, d.Z, u, v);
+    const float packedV = Snorm16ToFloat(FloatToSnorm16(PackSignIntoOct(v, sign)));
+
+    float unpackedV;
+    UnpackSignFromOct(packedV, unpackedV, outSign);
+    Direction result;
+    OctDecode(Snorm16ToFloat(FloatToSnorm16(u)), unpackedV, result.X, result.Y, result.Z);
+    return result;
+}
+
+// poles, axes, the diagonals and the octahedron fold lines where the encoding is discontinuous
+const Direction kSpecialDirections[] = {
+    {1, 0, 0},  {-1, 0, 0}, {0, 1, 0},   {0, -1, 0},  {0, 0, 1},   {0, 0, -1},   {1, 1, 1},
+    {-1, -1, -1}, {1, -1, 0}, {-1, 1, 0}, {1, 0, -1}, {0, -1, -1}, {1, 1e-6f, -1}, {-1e-6f, 1, -1e-6f},
+};
+
+// evenly spread points of the sphere
+template <typename TFunction> void ForEachSphereDirection(int count, TFunction &&function)
+{
+    const float goldenAngle = kPi * (3.0f - std::sqrt(5.0f));
+    for (int i = 0; i < count; ++i)
+    {
+        const float z = 1.0f - 2.0f * (static_cast<float>(i) + 0.5f) / static_cast<float>(count);
+        const float radius = std::sqrt(1.0f - z * z);
+        const float angle = goldenAngle * static_cast<float>(i);
+        function(Direction{radius * std::cos(angle), radius * std::sin(angle), z});
+    }
+    for (const Direction &direction : kSpecialDirections)
+        function(Normalize(direction));
+}
+} // namespace
+
+BLAINN_TEST(OctNormalRoundTripStaysWithinErrorBound)
+{
+    double maxError = 0.0;
+    ForEachSphereDirection(20000, [&](Direction d) { maxError = std::fmax(maxError, AngleDegrees(d, RoundTripNormal(d))); });
+    printf("  max normal error %f degrees\n", maxError);
+    BLAINN_CHECK(maxError <= kMaxNormalErrorDegrees);
+}
+
+BLAINN_TEST(OctTangentRoundTripKeepsDirectionAndHandedness)
+{
+    double maxError = 0.0;
+    bool isSignKept = true;
+    for (const float sign : {1.0f, -1.0f})
+    {
+        ForEachSphereDirection(20000, [&](Direction d) {
+            float decodedSign;
+            maxError = std::fmax(maxError, AngleDegrees(d, RoundTripTangent(d, sign, decodedSign)));
+            isSignKept &= decodedSign == sign;
+        });
+    }
+    printf("  max tangent error %f degrees\n", maxError);
+    BLAINN_CHECK(maxError <= kMaxTangentErrorDegrees);
+    BLAINN_CHECK(isSignKept);
+}
+
+BLAINN_TEST(OctEncodeOfAxesIsExact)
+{
+    for (int axis = 0; axis < 3; ++axis)
+    {
+        for (const float direction : {1.0f, -1.0f})
+        {
+            float components[3] = {0.0f, 0.0f, 0.0f};
+            components[axis] = direction;
+            const Direction d{components[0], components[1], components[2]};
+            BLAINN_CHECK(AngleDegrees(d, RoundTripNormal(d)) == 0.0);
+
+            for (const float sign : {1.0f, -1.0f})
+            {
+                float decodedSign;
+                const Direction tangent = RoundTripTangent(d, sign, decodedSign);
+                BLAINN_CHECK(AngleDegrees(d, tangent) <= kMaxTangentErrorDegrees);
+                BLAINN_CHECK(decodedSign == sign);
+            }
+        }
+    }
+}
+
+BLAINN_TEST(OctEncodeOfZeroVectorIsPositiveZ)
+{
+    float u, v;
+    OctEncode(0.0f, 0.0f, 0.0f, u, v);
+    Direction d;
+    OctDecode(u, v, d.X, d.Y, d.Z);
+    BLAINN_CHECK(d.X == 0.0f && d.Y == 0.0f && d.Z == 1.0f);
+}
+
+BLAINN_TEST(NegativeSignSurvivesAtTheLowEdgeOfV)
+{
+    // v = -1 remaps to 0, which would read back as a positive sign without the clamp in PackSignIntoOct
+    float v, sign;
+    UnpackSignFromOct(Snorm16ToFloat(FloatToSnorm16(PackSignIntoOct(-1.0f, -1.0f))), v, sign);
+    BLAINN_CHECK(sign == -1.0f);
+    BLAINN_CHECK_NEAR(v, -1.0f, 1e-4f);
+
+    UnpackSignFromOct(Snorm16ToFloat(FloatToSnorm16(PackSignIntoOct(-1.0f, 1.0f))), v, sign);
+    BLAINN_CHECK(sign == 1.0f);
+    BLAINN_CHECK_NEAR(v, -1.0f, 1e-4f);
+}
+
+BLAINN_TEST(HalfFloatRoundTripOfUVs)
+{
+    // exactly representable texture coordinates come back unchanged
+    for (const float value : {0.0f, 0.5f, 1.0f, 2.0f, -1.0f, 0.25f, 1024.0f, 65504.0f, -65504.0f})
+        BLAINN_CHECK(HalfToFloat(FloatToHalf(value)) == value);
+
+    // everything else is within half a unit in the last place, 11 significant bits
+    float maxRelativeError = 0.0f;
+    for (int i = 1; i < 100000; ++i)
+    {
+        const float value = static_cast<float>(i) / 100000.0f * 4.0f - 2.0f;
+        if (value == 0.0f) continue;
+        maxRelativeError = std::fmax(maxRelativeError, std::fabs(HalfToFloat(FloatToHalf(value)) - value) / std::fabs(value));
+    }
+    BLAINN_CHECK(maxRelativeError <= 1.0f / 2048.0f);
+}
+
+BLAINN_TEST(HalfFloatEdgeCases)
+{
+    BLAINN_CHECK(FloatToHalf(0.0f) == 0x0000u);
+    BLAINN_CHECK(FloatToHalf(-0.0f) == 0x8000u);
+    BLAINN_CHECK(FloatToHalf(65504.0f) == 0x7BFFu);
+    // past the largest half, rounds to infinity
+    BLAINN_CHECK(FloatToHalf(65520.0f) == 0x7C00u);
+    BLAINN_CHECK(FloatToHalf(-1e10f) == 0xFC00u);
+    BLAINN_CHECK(FloatToHalf(INFINITY) == 0x7C00u);
+    BLAINN_CHECK((FloatToHalf(NAN) & 0x7C00u) == 0x7C00u && (FloatToHalf(NAN) & 0x3FFu) != 0u);
+    BLAINN_CHECK(std::isnan(HalfToFloat(FloatToHalf(NAN))));
+
+    // smallest normal and subnormals
+    BLAINN_CHECK(FloatToHalf(6.103515625e-05f) == 0x0400u);
+    BLAINN_CHECK(FloatToHalf(5.9604644775390625e-08f) == 0x0001u);
+    BLAINN_CHECK(HalfToFloat(0x0001u) == 5.9604644775390625e-08f);
+    BLAINN_CHECK(HalfToFloat(0x03FFu) == 6.0975551605224609e-05f);
+    // below half of the smallest subnormal flushes to zero, above it rounds up
+    BLAINN_CHECK(FloatToHalf(2.0e-08f) == 0x0000u);
+    BLAINN_CHECK(FloatToHalf(4.0e-08f) == 0x0001u);
+
+    // ties round to even: 1 + 2^-11 lies halfway between 1 and the next half
+    BLAINN_CHECK(FloatToHalf(1.0f + 1.0f / 2048.0f) == 0x3C00u);
+    BLAINN_CHECK(FloatToHalf(1.0f + 3.0f / 2048.0f) == 0x3C02u);
+
+    // wrapping UVs above 1 keep a usable precision up to the tiling counts used in the content
+    BLAINN_CHECK_NEAR(HalfToFloat(FloatToHalf(15.999f)), 15.999f, 1.0f / 128.0f);
+}
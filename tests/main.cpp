@@ -0,0 +1,52 @@
+#include "TestFramework.h"
+
+#include <EASTL/vector.h>
+#include <cstring>
+
+// EASTL leaves its allocation entry points to the application, the engine defines them in pch.h
+void *operator new[](size_t size, const char *, int, unsigned, const char *, int)
+{
+    return ::operator new[](size);
+}
+
+void *operator new[](size_t size, size_t, size_t, const char *, int, unsigned, const char *, int)
+{
+    return ::operator new[](size);
+}
+
+// BlainnTests [--benchmark] [filter], only the tests with the filter in their name run
+int main(int argc, char **argv)
+{
+    using namespace Blainn::Tests;
+
+    bool runBenchmarks = false;
+    const char *filter = nullptr;
+    for (int i = 1; i < argc; ++i)
+    {
+        if (strcmp(argv[i], "--benchmark") == 0) runBenchmarks = true;
+        else filter = argv[i];
+    }
+
+    // registration prepends, run in declaration order so the output follows the files
+    eastl::vector<TestCase *> tests;
+    for (TestCase *test = GetTestList(); test; test = test->Next)
+        tests.push_back(test);
+
+    int failedTests = 0;
+    int runTests = 0;
+    for (auto it = tests.rbegin(); it != tests.rend(); ++it)
+    {
+        TestCase &test = **it;
+        if (test.IsBenchmark != runBenchmarks) continue;
+        if (filter && !strstr(test.Name, filter)) continue;
+
+        const int failedChecksBefore = GetFailedCheckCount();
+        printf("%s\n", test.Name);
+        test.Function();
+        ++runTests;
+        if (GetFailedCheckCount() != failedChecksBefore) ++failedTests;
+    }
+
+    printf("%d of %d passed\n", runTests - failedTests, runTests);
+    return failedTests == 0 ? 0 : 1;
+}